@@ -543,6 +543,7 @@ impl Client {
 
             let options = OnUpdateOptions {
                 mode: Some(OnUpdateMode::Row),
+                ..OnUpdateOptions::default()
             };
 
             let on_update_token = view.on_update(callback, options).await?;
@@ -55,7 +55,7 @@ pub use crate::table::{
 };
 pub use crate::table_data::{TableData, UpdateData};
 pub use crate::view::{
-    ColumnWindow, OnUpdateData, OnUpdateMode, OnUpdateOptions, View, ViewWindow,
+    ColumnWindow, OnUpdateData, OnUpdateMode, OnUpdateOptions, View, ViewStream, ViewWindow,
 };
 
 pub type ClientError = utils::ClientError;
@@ -117,11 +117,13 @@ macro_rules! assert_view_api {
                     &$x::get_config,
                     &$x::get_min_max,
                     &$x::num_rows,
+                    &$x::profile,
                   //  &$x::on_update,
                     &$x::remove_update,
                     &$x::on_delete,
                     &$x::remove_delete,
                     &$x::schema,
+                    &$x::set_sort,
                     &$x::to_arrow,
                     &$x::to_columns_string,
                     &$x::to_json_string,
@@ -21,6 +21,7 @@ use serde::{Deserialize, Serialize};
 use ts_rs::TS;
 
 use self::view_on_update_req::Mode;
+use self::view_stream_req::Format;
 use crate::assert_view_api;
 use crate::client::Client;
 use crate::proto::request::ClientReq;
@@ -34,6 +35,21 @@ pub use crate::utils::*;
 #[derive(Default, Debug, Deserialize, TS)]
 pub struct OnUpdateOptions {
     pub mode: Option<OnUpdateMode>,
+
+    /// The window of the [`View`] to send in [`OnUpdateMode::Viewport`] mode.
+    #[serde(default)]
+    pub viewport: Option<ViewWindow>,
+
+    /// Don't send an update until the callback for the previous one has
+    /// returned, merging the updates in between into one, so a slow callback
+    /// never falls behind.
+    #[serde(default)]
+    pub conflate: Option<bool>,
+
+    /// Don't send updates more often than every `min_interval_ms`, merging
+    /// the updates in between into one.
+    #[serde(default)]
+    pub min_interval_ms: Option<u32>,
 }
 
 /// The update mode for [`View::on_update`].
@@ -42,11 +58,19 @@ pub struct OnUpdateOptions {
 /// Apache Arrow to the callback provided to [`View::on_update`]. This allows
 /// incremental updates if your callbakc can read this format, but should be
 /// disabled otherwise.
+///
+/// `Viewport` mode provides only the rows of [`OnUpdateOptions::viewport`]
+/// which changed (or moved into it), with each row's index in the [`View`]
+/// in the `__ROW__` column, and skips updates which do not touch it. Move
+/// the viewport with [`View::set_on_update_viewport`].
 #[derive(Default, Debug, Deserialize, TS)]
 pub enum OnUpdateMode {
     #[default]
     #[serde(rename = "row")]
     Row,
+
+    #[serde(rename = "viewport")]
+    Viewport,
 }
 
 impl FromStr for OnUpdateMode {
@@ -55,6 +79,8 @@ impl FromStr for OnUpdateMode {
     fn from_str(s: &str) -> Result<Self, Self::Err> {
         if s == "row" {
             Ok(OnUpdateMode::Row)
+        } else if s == "viewport" {
+            Ok(OnUpdateMode::Viewport)
         } else {
             Err(ClientError::Option)
         }
@@ -150,6 +176,46 @@ impl Deref for OnUpdateData {
     }
 }
 
+/// A chunked export of a [`View`], from [`View::to_arrow_stream`] or
+/// [`View::to_csv_stream`]. Each chunk is read from the server when
+/// [`ViewStream::next`] is called, so neither side holds more than one chunk
+/// of the export at a time.
+#[derive(Debug)]
+pub struct ViewStream {
+    view: View,
+    id: u32,
+    pending: Option<Vec<u8>>,
+    done: bool,
+}
+
+impl ViewStream {
+    /// The next chunk of this export, or `None` once it is complete.
+    pub async fn next(&mut self) -> ClientResult<Option<Bytes>> {
+        let chunk = match self.pending.take() {
+            Some(chunk) => chunk,
+            None if self.done => return Ok(None),
+            None => {
+                let resp = self.view.stream_next(self.id, false).await?;
+                self.done = resp.done;
+                resp.chunk
+            },
+        };
+
+        Ok((!chunk.is_empty()).then(|| chunk.into()))
+    }
+
+    /// Stop this export before it is complete, dropping it on the server.
+    pub async fn cancel(&mut self) -> ClientResult<()> {
+        self.pending = None;
+        if !self.done {
+            self.done = true;
+            self.view.stream_next(self.id, true).await?;
+        }
+
+        Ok(())
+    }
+}
+
 /// The [`View`] struct is Perspective's query and serialization interface. It
 /// represents a query on the `Table`'s dataset and is always created from an
 /// existing `Table` instance via the [`Table::view`] method.
@@ -298,6 +364,30 @@ impl View {
         }
     }
 
+    /// A report of the work this [`View`] does to build and update itself,
+    /// for finding which part of its config makes it slow.
+    ///
+    /// - `context_type` - `unit`, `flat`, `one_sided` or `two_sided`.
+    /// - `trees` - The number of nodes at each depth of each sparse tree,
+    ///   and the nodes changed and removed by the last update.
+    /// - `aggregates` - Whether each aggregate is updated incrementally, or
+    ///   by reading every row beneath each changed group.
+    /// - `expressions` - The rows each expression was evaluated for.
+    /// - `hidden_sort` - Sorted columns which are not in `columns`.
+    /// - `num_table_rows`, `num_filtered_rows` - The filter's selectivity.
+    /// - `traversal_rows`, `traversal_columns` - The expanded size of this
+    ///   [`View`].
+    /// - `last_update` - The rows of the last update of the
+    ///   [`crate::Table`], before and after merging repeated primary keys
+    ///   and masking out removes.
+    pub async fn profile(&self) -> ClientResult<ViewProfileResp> {
+        let msg = self.client_message(ClientReq::ViewProfileReq(ViewProfileReq {}));
+        match self.client.oneshot(&msg).await? {
+            ClientResp::ViewProfileResp(resp) => Ok(resp),
+            resp => Err(resp.into()),
+        }
+    }
+
     /// The expression schema of this [`View`], which contains only the
     /// expressions created on this [`View`]. See [`View::schema`] for
     /// details.
@@ -374,6 +464,20 @@ impl View {
         }
     }
 
+    /// Serializes a [`View`] to the Apache Arrow data format, in chunks of
+    /// `chunk_rows` rows (or one chunk if `0`), each a complete Arrow IPC
+    /// stream. Unlike [`View::to_arrow`], memory use is proportional to
+    /// `chunk_rows` rather than to `window`, so this is suited to exporting
+    /// very large [`View`]s. Each chunk reflects the [`View`] when it is
+    /// read.
+    pub async fn to_arrow_stream(
+        &self,
+        window: ViewWindow,
+        chunk_rows: u32,
+    ) -> ClientResult<ViewStream> {
+        self.stream(window, chunk_rows, Format::Arrow).await
+    }
+
     /// Serializes this [`View`] to a string of JSON data. Useful if you want to
     /// save additional round trip serialize/deserialize cycles.    
     pub async fn to_columns_string(&self, window: ViewWindow) -> ClientResult<String> {
@@ -444,6 +548,53 @@ impl View {
         }
     }
 
+    /// Serializes this [`View`] to CSV data in a standard format, in chunks
+    /// of `chunk_rows` rows (or one chunk if `0`). Only the first chunk has
+    /// a header row. See [`View::to_arrow_stream`] for details.
+    pub async fn to_csv_stream(
+        &self,
+        window: ViewWindow,
+        chunk_rows: u32,
+    ) -> ClientResult<ViewStream> {
+        self.stream(window, chunk_rows, Format::Csv).await
+    }
+
+    async fn stream(
+        &self,
+        window: ViewWindow,
+        chunk_rows: u32,
+        format: Format,
+    ) -> ClientResult<ViewStream> {
+        let msg = self.client_message(ClientReq::ViewStreamReq(ViewStreamReq {
+            viewport: Some(window.clone().into()),
+            chunk_rows,
+            format: format as i32,
+            compression: window.compression,
+        }));
+
+        match self.client.oneshot(&msg).await? {
+            ClientResp::ViewStreamResp(ViewStreamResp { chunk, done }) => Ok(ViewStream {
+                view: self.clone(),
+                id: msg.msg_id,
+                pending: Some(chunk),
+                done,
+            }),
+            resp => Err(resp.into()),
+        }
+    }
+
+    async fn stream_next(&self, id: u32, cancel: bool) -> ClientResult<ViewStreamResp> {
+        let msg = self.client_message(ClientReq::ViewStreamNextReq(ViewStreamNextReq {
+            id,
+            cancel,
+        }));
+
+        match self.client.oneshot(&msg).await? {
+            ClientResp::ViewStreamResp(resp) => Ok(resp),
+            resp => Err(resp.into()),
+        }
+    }
+
     /// Delete this [`View`] and clean up all resources associated with it.
     /// [`View`] objects do not stop consuming resources or processing
     /// updates when they are garbage collected - you must call this method
@@ -486,19 +637,40 @@ impl View {
     ///   parameter.
     /// - `options` - If this is provided as `OnUpdateOptions { mode:
     ///   Some(OnUpdateMode::Row) }`, then `delta` is an Arrow of the updated
-    ///   rows. Otherwise `delta` will be [`Option::None`].
+    ///   rows, or with [`OnUpdateMode::Viewport`], of the updated rows in
+    ///   `viewport`. Otherwise `delta` will be [`Option::None`].
     pub async fn on_update<T, U>(&self, on_update: T, options: OnUpdateOptions) -> ClientResult<u32>
     where
         T: Fn(OnUpdateData) -> U + Send + Sync + 'static,
         U: Future<Output = ()> + Send + 'static,
     {
+        let msg = self.client_message(ClientReq::ViewOnUpdateReq(ViewOnUpdateReq {
+            mode: options.mode.map(|mode| match mode {
+                OnUpdateMode::Row => Mode::Row as i32,
+                OnUpdateMode::Viewport => Mode::Viewport as i32,
+            }),
+            viewport: options.viewport.map(ViewPort::from),
+            ack: options.conflate,
+            min_interval_ms: options.min_interval_ms,
+        }));
+
+        let ack = options
+            .conflate
+            .unwrap_or_default()
+            .then(|| (self.clone(), msg.msg_id));
+
         let on_update = Arc::new(on_update);
         let callback = move |resp: Response| {
             let on_update = on_update.clone();
+            let ack = ack.clone();
             async move {
                 match resp.client_resp {
                     Some(ClientResp::ViewOnUpdateResp(resp)) => {
                         on_update(OnUpdateData(resp)).await;
+                        if let Some((view, update_id)) = ack {
+                            view.ack_update(update_id).await?;
+                        }
+
                         Ok(())
                     },
                     resp => Err(resp.into()),
@@ -506,10 +678,6 @@ impl View {
             }
         };
 
-        let msg = self.client_message(ClientReq::ViewOnUpdateReq(ViewOnUpdateReq {
-            mode: options.mode.map(|OnUpdateMode::Row| Mode::Row as i32),
-        }));
-
         self.client.subscribe(&msg, callback).await?;
         Ok(msg.msg_id)
     }
@@ -540,6 +708,45 @@ impl View {
         }
     }
 
+    /// Acknowledge an update sent to a conflated [`View::on_update`]
+    /// callback, so the server may send the next one. This runs within
+    /// [`Client::handle_response`], so it must not await the response.
+    async fn ack_update(&self, update_id: u32) -> ClientResult<()> {
+        let msg = self.client_message(ClientReq::ViewOnUpdateAckReq(ViewOnUpdateAckReq {
+            id: update_id,
+        }));
+
+        self.client
+            .subscribe_once(&msg, Box::new(|_| Ok(())))
+            .await
+    }
+
+    /// Move the viewport of an [`OnUpdateMode::Viewport`] update callback,
+    /// e.g. when the user scrolls. The rows now in `window` are not sent, so
+    /// the caller should read them with [`View::to_arrow`].
+    ///
+    /// # Arguments
+    ///
+    /// - `update_id` - A callback `id` as returned by [`View::on_update`].
+    /// - `window` - The new viewport.
+    pub async fn set_on_update_viewport(
+        &self,
+        update_id: u32,
+        window: ViewWindow,
+    ) -> ClientResult<()> {
+        let msg = self.client_message(ClientReq::ViewSetOnUpdateViewportReq(
+            ViewSetOnUpdateViewportReq {
+                id: update_id,
+                viewport: Some(window.into()),
+            },
+        ));
+
+        match self.client.oneshot(&msg).await? {
+            ClientResp::ViewSetOnUpdateViewportResp(_) => Ok(()),
+            resp => Err(resp.into()),
+        }
+    }
+
     /// Register a callback with this [`View`]. Whenever the [`View`] is
     /// deleted, this callback will be invoked.
     pub async fn on_delete(
@@ -597,4 +804,18 @@ impl View {
             resp => Err(resp.into()),
         }
     }
+
+    /// Replace this [`View`]'s `sort`, re-sorting its existing rows rather
+    /// than recomputing them. Returns `false` (leaving the [`View`]
+    /// unchanged) if the new `sort` needs a column or aggregate this [`View`]
+    /// does not already have, or would un-sort a `group_by` or `split_by`;
+    /// in that case, create a new [`View`] with the new sort instead.
+    pub async fn set_sort(&self, sort: Vec<crate::config::Sort>) -> ClientResult<bool> {
+        let sort = sort.into_iter().map(|x| x.into()).collect();
+        let msg = self.client_message(ClientReq::ViewSetSortReq(ViewSetSortReq { sort }));
+        match self.client.oneshot(&msg).await? {
+            ClientResp::ViewSetSortResp(ViewSetSortResp { applied }) => Ok(applied),
+            resp => Err(resp.into()),
+        }
+    }
 }
@@ -10,6 +10,9 @@
 // ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
 // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
 
+use std::sync::Arc;
+
+use futures::lock::Mutex;
 use js_sys::{Array, ArrayBuffer, Function, Object};
 use perspective_client::{
     ColumnWindow, OnUpdateData, OnUpdateOptions, ViewWindow, assert_view_api,
@@ -47,6 +50,36 @@ impl From<ViewWindow> for JsViewWindow {
     }
 }
 
+/// A chunked export of a [`View`], from [`View::to_arrow_stream`] or
+/// [`View::to_csv_stream`].
+#[wasm_bindgen]
+#[derive(Clone)]
+pub struct ViewStream {
+    stream: Arc<Mutex<perspective_client::ViewStream>>,
+    is_csv: bool,
+}
+
+#[wasm_bindgen]
+impl ViewStream {
+    /// The next chunk of this export, as an `ArrayBuffer` of Arrow (or a
+    /// CSV string), or `undefined` once it is complete.
+    #[wasm_bindgen]
+    pub async fn next(&self) -> ApiResult<JsValue> {
+        let chunk = self.stream.lock().await.next().await?;
+        Ok(match chunk {
+            None => JsValue::UNDEFINED,
+            Some(chunk) if self.is_csv => String::from_utf8_lossy(&chunk).as_ref().into(),
+            Some(chunk) => js_sys::Uint8Array::from(&chunk[..]).buffer().into(),
+        })
+    }
+
+    /// Stop this export before it is complete.
+    #[wasm_bindgen]
+    pub async fn cancel(&self) -> ApiResult<()> {
+        Ok(self.stream.lock().await.cancel().await?)
+    }
+}
+
 /// The [`View`] struct is Perspective's query and serialization interface. It
 /// represents a query on the `Table`'s dataset and is always created from an
 /// existing `Table` instance via the [`Table::view`] method.
@@ -122,6 +155,15 @@ impl View {
         Ok(JsValue::from_serde_ext(&dimensions)?)
     }
 
+    /// A report of the work this [`View`] does to build and update itself,
+    /// for finding which part of its config makes it slow. See
+    /// [`perspective_client::View::profile`] for details.
+    #[wasm_bindgen]
+    pub async fn profile(&self) -> ApiResult<JsValue> {
+        let profile = self.0.profile().await?;
+        Ok(JsValue::from_serde_ext(&profile)?)
+    }
+
     /// The expression schema of this [`View`], which contains only the
     /// expressions created on this [`View`]. See [`View::schema`] for
     /// details.
@@ -189,6 +231,27 @@ impl View {
             .unchecked_into())
     }
 
+    /// Serializes a [`View`] to the Apache Arrow data format, in chunks of
+    /// `chunk_rows` rows, each a complete Arrow IPC stream. See
+    /// [`perspective_client::View::to_arrow_stream`] for details.
+    #[wasm_bindgen]
+    pub async fn to_arrow_stream(
+        &self,
+        window: Option<JsViewWindow>,
+        chunk_rows: u32,
+    ) -> ApiResult<ViewStream> {
+        let window = window.into_serde_ext::<Option<ViewWindow>>()?;
+        let stream = self
+            .0
+            .to_arrow_stream(window.unwrap_or_default(), chunk_rows)
+            .await?;
+
+        Ok(ViewStream {
+            stream: Arc::new(Mutex::new(stream)),
+            is_csv: false,
+        })
+    }
+
     /// Serializes this [`View`] to a string of JSON data. Useful if you want to
     /// save additional round trip serialize/deserialize cycles.
     #[wasm_bindgen]
@@ -238,6 +301,26 @@ impl View {
         Ok(self.0.to_csv(window.unwrap_or_default()).await?)
     }
 
+    /// Serializes this [`View`] to CSV data in a standard format, in chunks
+    /// of `chunk_rows` rows. Only the first chunk has a header row.
+    #[wasm_bindgen]
+    pub async fn to_csv_stream(
+        &self,
+        window: Option<JsViewWindow>,
+        chunk_rows: u32,
+    ) -> ApiResult<ViewStream> {
+        let window = window.into_serde_ext::<Option<ViewWindow>>()?;
+        let stream = self
+            .0
+            .to_csv_stream(window.unwrap_or_default(), chunk_rows)
+            .await?;
+
+        Ok(ViewStream {
+            stream: Arc::new(Mutex::new(stream)),
+            is_csv: true,
+        })
+    }
+
     /// Register a callback with this [`View`]. Whenever the view's underlying
     /// table emits an update, this callback will be invoked with an object
     /// containing `port_id`, indicating which port the update fired on, and
@@ -299,6 +382,27 @@ impl View {
         Ok(self.0.remove_update(callback_id).await?)
     }
 
+    /// Move the viewport of an `on_update` callback registered with `{
+    /// mode: "viewport" }`.
+    ///
+    /// # Arguments
+    ///
+    /// - `id` - A callback `id` as returned by a recipricol call to
+    ///   [`View::on_update`].
+    /// - `window` - The new viewport.
+    #[wasm_bindgen]
+    pub async fn set_on_update_viewport(
+        &self,
+        callback_id: u32,
+        window: Option<JsViewWindow>,
+    ) -> ApiResult<()> {
+        let window = window.into_serde_ext::<Option<ViewWindow>>()?;
+        Ok(self
+            .0
+            .set_on_update_viewport(callback_id, window.unwrap_or_default())
+            .await?)
+    }
+
     /// Register a callback with this [`View`]. Whenever the [`View`] is
     /// deleted, this callback will be invoked.
     #[wasm_bindgen]
@@ -352,4 +456,12 @@ impl View {
     pub async fn set_depth(&self, depth: u32) -> ApiResult<()> {
         Ok(self.0.set_depth(depth).await?)
     }
+
+    /// Replace this view's `sort` in place, returning `false` if it could
+    /// not be applied without creating a new view.
+    #[wasm_bindgen]
+    pub async fn set_sort(&self, sort: JsValue) -> ApiResult<bool> {
+        let sort = sort.into_serde_ext::<Vec<perspective_client::config::Sort>>()?;
+        Ok(self.0.set_sort(sort).await?)
+    }
 }
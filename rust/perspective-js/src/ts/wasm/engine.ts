@@ -22,6 +22,25 @@ export interface PerspectiveServerOptions {
     on_poll_request?: (x: PerspectiveServer) => Promise<void>;
 }
 
+export interface TableTreeOptions {
+    /**
+     * The largest update, in rows times the depth of a view's `group_by` or
+     * `split_by`, which is grouped straight into the view's tree rather than
+     * through an intermediate dense tree. `0` always uses the dense tree.
+     * Defaults to 65536.
+     */
+    strand_direct_apply_max_cost?: number;
+
+    /**
+     * The most entries, in rows times indexed aggregates times tree depth,
+     * which the indices maintaining a view's "min", "max", "dominant",
+     * "unique", "first" and "last" aggregates may hold. A view which outgrows
+     * this reads each changed group's rows instead, until it shrinks to half
+     * of it. `0` disables the indices. Defaults to 4194304.
+     */
+    index_max_entries?: number;
+}
+
 export class PerspectivePollThread {
     private poll_handle?: Promise<void>;
     private server: PerspectiveServer;
@@ -63,6 +82,8 @@ export class PerspectiveServer {
     server: EmscriptenServer;
     module: MainModule;
     on_poll_request?: (x: PerspectiveServer) => Promise<void>;
+    private poll_timer?: ReturnType<typeof setTimeout>;
+    private poll_deadline?: number;
     constructor(module: MainModule, options?: PerspectiveServerOptions) {
         this.clients = new Map();
         this.module = module;
@@ -86,6 +107,7 @@ export class PerspectiveServer {
             client_id,
             this.clients,
             this.on_poll_request && (() => this.on_poll_request!(this)),
+            () => this.schedule_poll_timeout(),
         );
     }
 
@@ -98,9 +120,72 @@ export class PerspectiveServer {
                 await this.clients.get(msg.client_id)!(msg.data);
             },
         );
+
+        this.schedule_poll_timeout();
+    }
+
+    /**
+     * Schedule a `poll()` (or `on_poll_request`) for when deferred work which
+     * no request will trigger, e.g. an update coalescing window whose latency
+     * limit expires or an `on_update` held back by `min_interval_ms`, next
+     * becomes due, unless one is scheduled sooner already.
+     */
+    schedule_poll_timeout() {
+        const timeout = this.module._psp_poll_timeout(this.server as any);
+        if (timeout < 0) {
+            return;
+        }
+
+        const deadline = Date.now() + timeout;
+        if (this.poll_timer !== undefined) {
+            if (this.poll_deadline! <= deadline) {
+                return;
+            }
+
+            clearTimeout(this.poll_timer);
+        }
+
+        this.poll_deadline = deadline;
+        this.poll_timer = setTimeout(() => {
+            this.poll_timer = undefined;
+            this.poll_deadline = undefined;
+            const poll = this.on_poll_request
+                ? this.on_poll_request(this)
+                : this.poll();
+
+            poll.catch((e) => console.error("Scheduled poll failed", e));
+        }, timeout);
+    }
+
+    /**
+     * Set the tree options of views created on the table named `table_id`
+     * after this call, leaving every other table's unchanged.
+     */
+    async set_table_tree_options(table_id: string, options: TableTreeOptions) {
+        const name = new TextEncoder().encode(table_id);
+        const found = await convert_typed_array_to_pointer(
+            this.module,
+            name,
+            async (ptr) =>
+                this.module._psp_set_table_tree_options(
+                    this.server as any,
+                    ptr as any,
+                    this.module._psp_is_memory64()
+                        ? (BigInt(name.byteLength) as any as number)
+                        : (name.byteLength as any),
+                    options.strand_direct_apply_max_cost ?? 65536,
+                    options.index_max_entries ?? 1 << 22,
+                ) as any,
+        );
+
+        if (!found) {
+            throw new Error(`No table named "${table_id}"`);
+        }
     }
 
     delete() {
+        clearTimeout(this.poll_timer);
+        this.poll_timer = undefined;
         this.module._psp_delete_server(this.server as any);
     }
 }
@@ -112,6 +197,7 @@ export class PerspectiveSession {
         private client_id: number,
         private client_map: Map<number, (buffer: Uint8Array) => Promise<void>>,
         private on_poll_request?: () => Promise<void>,
+        private on_poll?: () => void,
     ) {}
 
     async handle_request(view: Uint8Array) {
@@ -154,6 +240,8 @@ export class PerspectiveSession {
                 }
             },
         );
+
+        this.on_poll?.();
     }
 
     close() {
@@ -206,4 +206,99 @@ import type * as psp_types from "@finos/perspective";
             table.delete();
         });
     });
+
+    // The index column of an indexed table shares its storage with the
+    // table's primary keys, so it must follow them through removes, reused
+    // rows, `replace()` and `clear()`.
+    test.describe("Indexed tables", function () {
+        const KEYS: Record<string, (number | string)[]> = {
+            integer: [1, 2, 3, 4],
+            string: ["a", "b", "c", "d"],
+        };
+
+        for (const [type, keys] of Object.entries(KEYS)) {
+            test(`${type} index follows removes, replace and clear`, async function () {
+                const table = await perspective.table(
+                    { k: keys, v: [1, 2, 3, 4] },
+                    { index: "k" },
+                );
+
+                const flat = await table.view();
+                const filtered = await table.view({
+                    filter: [["k", "==", keys[1]]],
+                });
+
+                const pivot = await table.view({
+                    group_by: ["k"],
+                    columns: ["v"],
+                    aggregates: { v: "sum" },
+                });
+
+                // `rows` must be sorted by key.
+                const expect_rows = async (
+                    rows: (readonly [unknown, number])[],
+                ) => {
+                    expect(await table.size()).toEqual(rows.length);
+                    expect(await flat.to_columns()).toEqual({
+                        k: rows.map((x) => x[0]),
+                        v: rows.map((x) => x[1]),
+                    });
+
+                    const matches = rows.filter((x) => x[0] === keys[1]);
+                    expect(await filtered.to_columns()).toEqual({
+                        k: matches.map((x) => x[0]),
+                        v: matches.map((x) => x[1]),
+                    });
+
+                    if (rows.length > 0) {
+                        const total = rows.reduce((x, y) => x + y[1], 0);
+                        expect(await pivot.to_columns()).toEqual({
+                            __ROW_PATH__: [[], ...rows.map((x) => [x[0]])],
+                            v: [total, ...rows.map((x) => x[1])],
+                        });
+                    }
+                };
+
+                await expect_rows(keys.map((k, i) => [k, i + 1] as const));
+
+                await table.remove([keys[1], keys[3]]);
+                await expect_rows([
+                    [keys[0], 1],
+                    [keys[2], 3],
+                ]);
+
+                // The removed keys are added back to the rows they left.
+                await table.update({ k: [keys[3], keys[1]], v: [40, 20] });
+                await expect_rows([
+                    [keys[0], 1],
+                    [keys[1], 20],
+                    [keys[2], 3],
+                    [keys[3], 40],
+                ]);
+
+                await table.replace({ k: [keys[2], keys[0]], v: [30, 10] });
+                await expect_rows([
+                    [keys[0], 10],
+                    [keys[2], 30],
+                ]);
+
+                await table.clear();
+                await expect_rows([]);
+
+                await table.update({ k: keys, v: [5, 6, 7, 8] });
+                await expect_rows(keys.map((k, i) => [k, i + 5] as const));
+
+                const rebuilt = await table.view();
+                expect(await rebuilt.to_columns()).toEqual(
+                    await flat.to_columns(),
+                );
+
+                await rebuilt.delete();
+                await pivot.delete();
+                await filtered.delete();
+                await flat.delete();
+                await table.delete();
+            });
+        }
+    });
 })(perspective);
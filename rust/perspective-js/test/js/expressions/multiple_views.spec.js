@@ -1468,5 +1468,101 @@ import * as expressions_common from "./common.js";
             await v1.delete();
             await table.delete();
         });
+
+        test.describe("Views created after an update", () => {
+            const expressions = { e: `"x" * 10 + length("y")` };
+            const configs = {
+                "0-sided": { expressions },
+                "1-sided": {
+                    group_by: ["y"],
+                    columns: ["x", "e"],
+                    aggregates: { e: "sum" },
+                    expressions,
+                },
+                "2-sided": {
+                    group_by: ["y"],
+                    split_by: ["z"],
+                    columns: ["e"],
+                    aggregates: { e: "sum" },
+                    expressions,
+                },
+            };
+
+            // The first update has fewer rows than the table, the second as
+            // many rows as the table in a different order.
+            const updates = [
+                [{ x: 5, y: "eeeee", z: true }],
+                [
+                    { x: 5, y: "e", z: false },
+                    { x: 4, y: "dddd", z: true },
+                    { x: 3, y: "cc", z: false },
+                    { x: 2, y: "b", z: true },
+                    { x: 1, y: "aaa", z: false },
+                ],
+            ];
+
+            for (const [name, config] of Object.entries(configs)) {
+                test(`${name} view with an expression already computed`, async () => {
+                    const table = await perspective.table(
+                        expressions_common.data,
+                        { index: "x" },
+                    );
+
+                    const existing = await table.view({ expressions });
+                    const views = [];
+                    for (const update of updates) {
+                        await table.update(update);
+                        views.push(await table.view(config));
+                    }
+
+                    const expected_table = await perspective.table(
+                        expressions_common.data,
+                        { index: "x" },
+                    );
+
+                    for (const update of updates) {
+                        await expected_table.update(update);
+                    }
+
+                    const expected_view = await expected_table.view(config);
+                    const expected = await expected_view.to_columns();
+                    for (const view of views) {
+                        expect(await view.to_columns()).toEqual(expected);
+                    }
+
+                    for (const view of views.reverse()) {
+                        await view.delete();
+                    }
+
+                    await expected_view.delete();
+                    await expected_table.delete();
+                    await existing.delete();
+                    await table.delete();
+                });
+            }
+        });
+
+        test("Expressions which differ only in a comment's extent should not conflict", async () => {
+            const table = await perspective.table(expressions_common.data);
+            const v1 = await table.view({
+                columns: ["a"],
+                expressions: { a: `"x" // + 1\n* 2` },
+            });
+
+            const v2 = await table.view({
+                columns: ["b"],
+                expressions: { b: `"x" // + 1 * 2` },
+            });
+
+            expect(await v1.to_columns()).toEqual({ a: [2, 4, 6, 8] });
+            expect(await v2.to_columns()).toEqual({ b: [1, 2, 3, 4] });
+            await table.update([{ x: 5, y: "e", z: true }]);
+            expect(await v1.to_columns()).toEqual({ a: [2, 4, 6, 8, 10] });
+            expect(await v2.to_columns()).toEqual({ b: [1, 2, 3, 4, 5] });
+
+            await v2.delete();
+            await v1.delete();
+            await table.delete();
+        });
     });
 })(perspective);
@@ -1467,4 +1467,204 @@ const pivot_data = [
             table.delete();
         });
     });
+
+    // The master expression column of a row-local expression is recomputed
+    // only for rows whose inputs changed. Every expression is also evaluated
+    // for each row of the update's flattened, delta, prev and current tables.
+    test.describe("Incremental expression updates", () => {
+        async function last_rows_evaluated(view) {
+            const profile = await view.profile();
+            return Object.fromEntries(
+                profile.expressions.map((x) => [
+                    x.alias,
+                    x.last_rows_evaluated,
+                ]),
+            );
+        }
+
+        test("Row-local expressions are recomputed only for changed rows", async () => {
+            const table = await perspective.table(
+                {
+                    id: [1, 2, 3, 4],
+                    x: [1, 2, 3, 4],
+                    y: ["A", "B", "C", "D"],
+                    z: [0.5, 1.5, 2.5, 3.5],
+                },
+                { index: "id" },
+            );
+
+            const view = await table.view({
+                expressions: { double: '"x" * 2', lower: 'lower("y")' },
+            });
+
+            // No input of either expression changed.
+            await table.update({ id: [2], z: [10.5] });
+            expect(await last_rows_evaluated(view)).toEqual({
+                double: 4,
+                lower: 4,
+            });
+
+            // An input of `double` changed, but `y` is the same value.
+            await table.update({ id: [3], x: [30], y: ["C"] });
+            expect(await last_rows_evaluated(view)).toEqual({
+                double: 5,
+                lower: 4,
+            });
+
+            await table.update({ id: [1, 4], y: ["Q", null] });
+            expect(await last_rows_evaluated(view)).toEqual({
+                double: 8,
+                lower: 10,
+            });
+
+            // Added rows are always computed.
+            await table.update({ id: [5], x: [5], y: ["E"] });
+            expect(await last_rows_evaluated(view)).toEqual({
+                double: 5,
+                lower: 5,
+            });
+
+            const result = await view.to_columns();
+            expect(result["double"]).toEqual([2, 4, 60, 8, 10]);
+            expect(result["lower"]).toEqual(["q", "b", "c", null, "e"]);
+            view.delete();
+            table.delete();
+        });
+
+        test("Expressions which read other rows are fully recomputed", async () => {
+            const table = await perspective.table(
+                {
+                    id: [1, 2, 3, 4],
+                    y: ["A", "B", "C", "D"],
+                    z: [0.5, 1.5, 2.5, 3.5],
+                },
+                { index: "id" },
+            );
+
+            const view = await table.view({
+                expressions: {
+                    first: "vlookup('y', integer(0))",
+                    ordered: "order(\"y\", 'D', 'C')",
+                    rand: "random()",
+                },
+            });
+
+            await table.update({ id: [2], z: [10.5] });
+            expect(await last_rows_evaluated(view)).toEqual({
+                first: 8,
+                ordered: 8,
+                rand: 8,
+            });
+
+            // Every row reads the first row's `y`.
+            await table.update({ id: [1], y: ["Q"] });
+            expect(await last_rows_evaluated(view)).toEqual({
+                first: 8,
+                ordered: 8,
+                rand: 8,
+            });
+
+            const result = await view.to_columns();
+            expect(result["first"]).toEqual(["Q", "Q", "Q", "Q"]);
+            view.delete();
+            table.delete();
+        });
+
+        test("Rows reused from removed rows are recomputed", async () => {
+            const table = await perspective.table(
+                {
+                    id: [1, 2, 3, 4],
+                    x: [1, 2, 3, 4],
+                    z: [0.5, 1.5, 2.5, 3.5],
+                },
+                { index: "id" },
+            );
+
+            const view = await table.view({
+                expressions: { double: '"x" * 2' },
+            });
+
+            await table.remove([2]);
+
+            // `id` 5 takes the row `id` 2 was removed from.
+            await table.update({ id: [5], x: [50] });
+            expect(await last_rows_evaluated(view)).toEqual({ double: 5 });
+            await table.update({ id: [5], z: [4.5] });
+            expect(await last_rows_evaluated(view)).toEqual({ double: 4 });
+
+            // A removed key is a new row when it is added again.
+            await table.update({ id: [2], x: [20] });
+            expect(await last_rows_evaluated(view)).toEqual({ double: 5 });
+
+            const result = await view.to_columns();
+            expect(result["id"]).toEqual([1, 2, 3, 4, 5]);
+            expect(result["double"]).toEqual([2, 40, 6, 8, 100]);
+            view.delete();
+            table.delete();
+        });
+    });
+
+    // Strings returned by string functions only live until each expression's
+    // columns have copied them, so values computed by earlier updates must be
+    // unaffected by later ones.
+    test.describe("String expressions across updates", () => {
+        const WORDS = ["apple", "Fig", "kiwi", "PEAR", "date", "plum"];
+        const EXPRESSIONS = {
+            upper: 'upper("s")',
+            joined: `concat("s", '-', upper("s"))`,
+        };
+
+        test("String expressions match their inputs after many updates", async () => {
+            const rows = new Map();
+            for (let id = 0; id < 8; id++) {
+                rows.set(id, WORDS[id % WORDS.length]);
+            }
+
+            const table = await perspective.table(
+                { id: [...rows.keys()], s: [...rows.values()] },
+                { index: "id" },
+            );
+
+            const view = await table.view({ expressions: EXPRESSIONS });
+            const pivot_config = {
+                group_by: ["joined"],
+                columns: ["id", "upper"],
+                aggregates: { id: "count", upper: "dominant" },
+                expressions: EXPRESSIONS,
+            };
+
+            const pivot = await table.view(pivot_config);
+            for (let i = 0; i < 200; i++) {
+                const ids = [i % 11, (i * 7) % 13];
+                const s = ids.map((id) => `${WORDS[(i + id) % 6]}${i % 17}`);
+                await table.update({ id: ids, s });
+                ids.forEach((id, j) => rows.set(id, s[j]));
+                if (i % 10 !== 9) {
+                    continue;
+                }
+
+                const ids_sorted = [...rows.keys()].sort((a, b) => a - b);
+                const values = ids_sorted.map((id) => rows.get(id));
+                const result = await view.to_columns();
+                expect(result["s"]).toEqual(values);
+                expect(result["upper"]).toEqual(
+                    values.map((x) => x.toUpperCase()),
+                );
+
+                expect(result["joined"]).toEqual(
+                    values.map((x) => `${x}-${x.toUpperCase()}`),
+                );
+            }
+
+            const rebuilt = await table.view(pivot_config);
+            expect(await pivot.to_columns()).toEqual(
+                await rebuilt.to_columns(),
+            );
+
+            await rebuilt.delete();
+            await pivot.delete();
+            await view.delete();
+            await table.delete();
+        });
+    });
 })(perspective);
@@ -253,6 +253,36 @@ test.describe("leaks", function () {
             await table.delete();
         });
 
+        // Strings returned by string functions are freed once each update's
+        // expression columns have copied them. The inputs cycle, so the
+        // expression columns themselves stop growing.
+        test("string expressions do not leak across updates", async () => {
+            test.setTimeout(60000);
+            const table = await perspective.table(
+                { x: "integer", y: "string" },
+                { index: "x" },
+            );
+
+            const view = await table.view({
+                expressions: {
+                    upper: 'upper("y")',
+                    joined: `concat("y", '-', upper("y"))`,
+                },
+            });
+
+            let count = 0;
+            await leak_test(async () => {
+                const y = `TestTestTest${count++ % 10}`;
+                await table.update([{ x: 1, y }]);
+                const result = await view.to_columns();
+                expect(result["upper"]).toEqual([y.toUpperCase()]);
+                expect(result["joined"]).toEqual([`${y}-${y.toUpperCase()}`]);
+            });
+
+            await view.delete();
+            await table.delete();
+        });
+
         test("1 sided does not leak", async () => {
             const table = await perspective.table({
                 a: [1, 2, 3, 4],
@@ -0,0 +1,315 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+import { test, expect } from "@finos/perspective-test";
+import perspective from "./perspective_client";
+
+const DATA = {
+    id: [0, 1, 2, 3, 4, 5, 6, 7, 8, 9],
+    x: ["a", "b", "c", "d", "e", "f", "g", "h", "i", "j"],
+    v: [10, 9, 8, 7, 6, 5, 4, 3, 2, 1],
+};
+
+async function delta_to_json(delta) {
+    const table = await perspective.table(delta);
+    const view = await table.view();
+    const json = await view.to_json();
+    await view.delete();
+    await table.delete();
+    return json;
+}
+
+// Register an `on_update` callback which collects its arguments.
+async function capture(view, options) {
+    const updates = [];
+    const id = await view.on_update(
+        (updated) => updates.push(updated),
+        options,
+    );
+    return { id, updates };
+}
+
+test.describe("on_update", () => {
+    test.describe("Default mode", () => {
+        test("is called once per update, without a delta", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const { updates } = await capture(view);
+
+            await table.update({ id: [1], v: [100] });
+            await table.update({ id: [10], x: ["k"], v: [0] });
+            await expect.poll(() => updates.length).toBe(2);
+            for (const updated of updates) {
+                expect(updated.port_id).toBe(0);
+                expect(updated.delta).toBeFalsy();
+            }
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("receives the row delta when a row subscription has one", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const defaults = await capture(view);
+            const rows1 = await capture(view, { mode: "row" });
+            const rows2 = await capture(view, { mode: "row" });
+
+            await table.update({ id: [1], v: [100] });
+            await expect.poll(() => defaults.updates.length).toBe(1);
+            await expect.poll(() => rows1.updates.length).toBe(1);
+            await expect.poll(() => rows2.updates.length).toBe(1);
+
+            const expected = [{ id: 1, x: "b", v: 100 }];
+            for (const { updates } of [defaults, rows1, rows2]) {
+                expect(await delta_to_json(updates[0].delta)).toEqual(
+                    expected,
+                );
+            }
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("is not affected by a viewport subscription", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const defaults = await capture(view);
+            const viewport = await capture(view, {
+                mode: "viewport",
+                viewport: { start_row: 0, end_row: 2 },
+            });
+
+            await table.update({ id: [5], v: [50] });
+            await expect.poll(() => defaults.updates.length).toBe(1);
+            expect(defaults.updates[0].delta).toBeFalsy();
+            expect(viewport.updates.length).toBe(0);
+
+            await view.delete();
+            await table.delete();
+        });
+    });
+
+    test.describe("Viewport mode", () => {
+        test("sends only the changed rows in the viewport", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view({ columns: ["x", "v"] });
+            const { updates } = await capture(view, {
+                mode: "viewport",
+                viewport: { start_row: 0, end_row: 4 },
+            });
+
+            await table.update({ id: [2, 7], v: [20, 70] });
+            await expect.poll(() => updates.length).toBe(1);
+            expect(await delta_to_json(updates[0].delta)).toEqual([
+                { __ROW__: 2, x: "c", v: 20 },
+            ]);
+
+            // Outside the viewport, so not sent.
+            await table.update({ id: [8], v: [80] });
+            await table.update({ id: [0, 3], v: [1, 3] });
+            await expect.poll(() => updates.length).toBe(2);
+            expect(await delta_to_json(updates[1].delta)).toEqual([
+                { __ROW__: 0, x: "a", v: 1 },
+                { __ROW__: 3, x: "d", v: 3 },
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("sends only the viewport's columns", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view({ columns: ["id", "x", "v"] });
+            const { updates } = await capture(view, {
+                mode: "viewport",
+                viewport: {
+                    start_row: 0,
+                    end_row: 4,
+                    start_col: 2,
+                    end_col: 3,
+                },
+            });
+
+            await table.update({ id: [1], v: [90] });
+            await expect.poll(() => updates.length).toBe(1);
+            expect(await delta_to_json(updates[0].delta)).toEqual([
+                { __ROW__: 1, v: 90 },
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("sends rows which move into the viewport", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view({
+                columns: ["x", "v"],
+                sort: [["v", "desc"]],
+            });
+
+            const { updates } = await capture(view, {
+                mode: "viewport",
+                viewport: { start_row: 0, end_row: 3 },
+            });
+
+            // Row 9 moves to the top, which pushes every row of the viewport
+            // down by one.
+            await table.update({ id: [9], v: [11] });
+            await expect.poll(() => updates.length).toBe(1);
+            expect(await delta_to_json(updates[0].delta)).toEqual([
+                { __ROW__: 0, x: "j", v: 11 },
+                { __ROW__: 1, x: "a", v: 10 },
+                { __ROW__: 2, x: "b", v: 9 },
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("follows the viewport when it moves", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view({ columns: ["x", "v"] });
+            const { id, updates } = await capture(view, {
+                mode: "viewport",
+                viewport: { start_row: 0, end_row: 3 },
+            });
+
+            await view.set_on_update_viewport(id, {
+                start_row: 6,
+                end_row: 9,
+            });
+
+            await table.update({ id: [1], v: [90] });
+            await table.update({ id: [7], v: [70] });
+            await expect.poll(() => updates.length).toBe(1);
+            expect(await delta_to_json(updates[0].delta)).toEqual([
+                { __ROW__: 7, x: "h", v: 70 },
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("sends a group_by view's changed groups", async () => {
+            const table = await perspective.table(
+                {
+                    id: [0, 1, 2, 3],
+                    g: ["a", "a", "b", "b"],
+                    v: [1, 2, 3, 4],
+                },
+                { index: "id" },
+            );
+
+            const view = await table.view({
+                group_by: ["g"],
+                columns: ["v"],
+            });
+
+            const { updates } = await capture(view, {
+                mode: "viewport",
+                viewport: { start_row: 0, end_row: 3 },
+            });
+
+            await table.update({ id: [3], v: [40] });
+            await expect.poll(() => updates.length).toBe(1);
+            const rows = await delta_to_json(updates[0].delta);
+            expect(rows.map((row) => [row.__ROW__, row.v])).toEqual([
+                [0, 46],
+                [2, 43],
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+    });
+
+    test.describe("Conflation", () => {
+        test("sends an update held by min_interval_ms without further requests", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const { updates } = await capture(view, {
+                mode: "row",
+                min_interval_ms: 200,
+            });
+
+            await table.update({ id: [1], v: [100] });
+            await expect.poll(() => updates.length).toBe(1);
+            await table.update({ id: [2], v: [200] });
+            await table.update({ id: [3], v: [300] });
+            await table.size();
+            expect(updates.length).toBe(1);
+
+            // Nothing else is sent to the server while waiting.
+            await new Promise((resolve) => setTimeout(resolve, 600));
+            expect(updates.length).toBe(2);
+            expect(await delta_to_json(updates[1].delta)).toEqual([
+                { id: 2, x: "c", v: 200 },
+                { id: 3, x: "d", v: 300 },
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("merges every held update into one delta", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const { updates } = await capture(view, {
+                mode: "row",
+                min_interval_ms: 300,
+            });
+
+            await table.update({ id: [0], v: [0] });
+            await expect.poll(() => updates.length).toBe(1);
+            for (let i = 10; i < 30; i++) {
+                await table.update({ id: [i], x: [`x${i}`], v: [i] });
+                await table.size();
+            }
+
+            await expect.poll(() => updates.length).toBe(2);
+            const rows = await delta_to_json(updates[1].delta);
+            expect(rows.map((row) => row.id)).toEqual(
+                Array.from({ length: 20 }, (_, i) => i + 10),
+            );
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("sends each update once the previous callback returns", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const { updates } = await capture(view, {
+                mode: "row",
+                conflate: true,
+            });
+
+            for (let i = 0; i < 3; i++) {
+                await table.update({ id: [i], v: [i * 100] });
+                await expect.poll(() => updates.length).toBe(i + 1);
+            }
+
+            const rows = await Promise.all(
+                updates.map((x) => delta_to_json(x.delta)),
+            );
+            expect(rows.map((x) => x.map((row) => row.v))).toEqual([
+                [0],
+                [100],
+                [200],
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+    });
+});
@@ -0,0 +1,112 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+import { test, expect } from "@finos/perspective-test";
+import perspective from "./perspective_client";
+
+const DATA = {
+    id: [0, 1, 2, 3],
+    g: ["a", "a", "b", "b"],
+    v: [1, 2, 3, 4],
+    w: [1.5, 2.5, 3.5, 4.5],
+};
+
+test.describe("View.profile", () => {
+    test("reports a flat view's rows", async () => {
+        const table = await perspective.table(DATA, { index: "id" });
+        const view = await table.view({ filter: [["v", ">", 1]] });
+        const profile = await view.profile();
+        expect(profile.context_type).toEqual("flat");
+        expect(profile.trees).toEqual([]);
+        expect(profile.num_table_rows).toEqual(4);
+        expect(profile.num_filtered_rows).toEqual(3);
+        await view.delete();
+        await table.delete();
+    });
+
+    test("reports nodes per depth before and after an update", async () => {
+        const table = await perspective.table(DATA, { index: "id" });
+        const view = await table.view({ group_by: ["g"], columns: ["v"] });
+        let profile = await view.profile();
+        expect(profile.context_type).toEqual("one_sided");
+        expect(profile.trees.map((x) => x.nodes_per_depth)).toEqual([[1, 2]]);
+
+        await table.update({ id: [0], v: [10] });
+        profile = await view.profile();
+        expect(profile.trees[0].nodes_per_depth).toEqual([1, 2]);
+        expect(profile.trees[0].last_nodes_changed).toEqual(2);
+        expect(profile.trees[0].last_nodes_removed).toEqual(0);
+
+        await table.update({ id: [4], g: ["c"], v: [5] });
+        profile = await view.profile();
+        expect(profile.trees[0].nodes_per_depth).toEqual([1, 3]);
+        expect(profile.num_filtered_rows).toEqual(5);
+        await view.delete();
+        await table.delete();
+    });
+
+    test("reports one tree per side of a split view, row tree last", async () => {
+        const table = await perspective.table(DATA, { index: "id" });
+        const view = await table.view({
+            group_by: ["id"],
+            split_by: ["g"],
+            columns: ["v"],
+        });
+
+        const profile = await view.profile();
+        expect(profile.context_type).toEqual("two_sided");
+        expect(profile.trees.map((x) => x.nodes_per_depth)).toEqual([
+            [1, 2],
+            [1, 4],
+        ]);
+
+        await view.delete();
+        await table.delete();
+    });
+
+    test("reports whether each aggregate is incremental", async () => {
+        const table = await perspective.table(DATA, { index: "id" });
+        const view = await table.view({
+            group_by: ["g"],
+            columns: ["v", "w", "g", "e"],
+            expressions: { e: '"v" * 2' },
+            aggregates: { v: "sum", w: "mean", g: "count", e: "sum" },
+        });
+
+        const profile = await view.profile();
+        expect(profile.aggregates).toEqual([
+            { column: "v", aggregate: "sum", incremental: true },
+            { column: "w", aggregate: "mean", incremental: false },
+            { column: "g", aggregate: "count", incremental: true },
+            { column: "e", aggregate: "sum", incremental: false },
+        ]);
+
+        await view.delete();
+        await table.delete();
+    });
+
+    test("reports the rows of the last update at each stage", async () => {
+        const table = await perspective.table(DATA, { index: "id" });
+        const view = await table.view({ group_by: ["g"], columns: ["v"] });
+        await table.update({ id: [0, 0, 5], g: ["a", "a", "c"], v: [7, 8, 9] });
+        const profile = await view.profile();
+        expect(profile.last_update).toEqual({
+            input_rows: 3,
+            flattened_rows: 2,
+            applied_rows: 2,
+        });
+
+        expect(profile.num_table_rows).toEqual(5);
+        await view.delete();
+        await table.delete();
+    });
+});
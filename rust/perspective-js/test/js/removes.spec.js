@@ -488,3 +488,82 @@ test.describe("Removes", () => {
         }
     }
 });
+
+// A view created after rows are removed is built from a copy of just the
+// columns its config reads. Filters and sorts on other columns read from the
+// table itself, so each view is checked against the same view on a new table
+// of the remaining rows.
+test.describe("Views created after removes", () => {
+    const DATA = {
+        id: [1, 2, 3, 4, 5, 6, 7, 8],
+        a: ["x", "y", "x", "y", "z", "z", "x", "y"],
+        b: ["p", "q", "q", "p", "p", "q", "p", "q"],
+        s: ["m", "n", "m", "n", "m", "n", "o", "o"],
+        v: [1, 2, 3, 4, 5, 6, 7, 8],
+        w: [8.5, 1.5, 7.5, 2.5, 6.5, 3.5, 5.5, 4.5],
+    };
+
+    const CONFIGS = {
+        flat: {
+            columns: ["v"],
+            filter: [["w", ">", 2]],
+            sort: [["w", "desc"]],
+        },
+        "one-sided": {
+            group_by: ["a"],
+            columns: ["v"],
+            filter: [["s", "!=", "n"]],
+            sort: [["w", "asc"]],
+        },
+        "two-sided": {
+            group_by: ["a"],
+            split_by: ["b"],
+            columns: ["v"],
+            filter: [["w", "<", 8]],
+            sort: [["s", "desc"]],
+        },
+        "expression filter": {
+            group_by: ["b"],
+            columns: ["v"],
+            expressions: { e: '"w" * 2' },
+            filter: [["e", ">", 6]],
+            sort: [["e", "desc"]],
+        },
+    };
+
+    for (const [name, config] of Object.entries(CONFIGS)) {
+        test(`${name} matches a view of a table of the remaining rows`, async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            await table.remove([2, 5, 8]);
+            const view = await table.view(config);
+            const flat = await table.view();
+            const remaining = await perspective.table(await flat.to_columns(), {
+                index: "id",
+            });
+
+            const expected = await remaining.view(config);
+            expect(await view.to_columns()).toEqual(
+                await expected.to_columns(),
+            );
+
+            // The view keeps up with updates to the columns it did not copy.
+            const update = {
+                id: [1, 4, 9],
+                s: ["n", "m", "o"],
+                w: [0.5, 9.5, 3],
+            };
+
+            await table.update(update);
+            await remaining.update(update);
+            expect(await view.to_columns()).toEqual(
+                await expected.to_columns(),
+            );
+
+            await view.delete();
+            await expected.delete();
+            await flat.delete();
+            await remaining.delete();
+            await table.delete();
+        });
+    }
+});
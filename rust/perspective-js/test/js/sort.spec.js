@@ -838,5 +838,75 @@ const data3 = {
                 table.delete();
             });
         });
+
+        test.describe("set_sort", () => {
+            // Compare `view` to a new view with its config.
+            const expect_resorted = async (table, view) => {
+                const config = await view.get_config();
+                const expected = await table.view(config);
+                expect(await view.to_columns()).toEqual(
+                    await expected.to_columns(),
+                );
+
+                await expected.delete();
+            };
+
+            const update = {
+                w: [0.5, 9.5],
+                x: [5, 0],
+                y: ["a", "e"],
+                z: [false, true],
+            };
+
+            for (const [name, config, sort] of [
+                ["0-sided", { sort: [["x", "desc"]] }, [["w", "asc"]]],
+                [
+                    "1-sided",
+                    { group_by: ["y"], sort: [["x", "desc"]] },
+                    [["w", "asc"]],
+                ],
+                [
+                    "2-sided",
+                    { group_by: ["y"], split_by: ["z"], sort: [["x", "desc"]] },
+                    [["w", "desc"]],
+                ],
+            ]) {
+                test(`${name} view re-sorts in place and keeps its callbacks`, async function () {
+                    const table = await perspective.table(data);
+                    const view = await table.view(config);
+                    const updates = [];
+                    await view.on_update(() => updates.push(true));
+
+                    expect(await view.set_sort(sort)).toBe(true);
+                    expect((await view.get_config()).sort).toEqual(sort);
+                    await expect_resorted(table, view);
+
+                    await table.update(update);
+                    await expect.poll(() => updates.length).toEqual(1);
+                    await expect_resorted(table, view);
+
+                    await view.delete();
+                    await table.delete();
+                });
+            }
+
+            test("rejects a sort by a column the view does not have", async function () {
+                const table = await perspective.table(data);
+                const view = await table.view({
+                    group_by: ["y"],
+                    columns: ["w"],
+                    sort: [["w", "desc"]],
+                });
+
+                const before = await view.to_columns();
+                expect(await view.set_sort([["x", "asc"]])).toBe(false);
+                expect(await view.set_sort([])).toBe(false);
+                expect((await view.get_config()).sort).toEqual([["w", "desc"]]);
+                expect(await view.to_columns()).toEqual(before);
+
+                await view.delete();
+                await table.delete();
+            });
+        });
     });
 })(perspective);
@@ -0,0 +1,258 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+import { test, expect } from "@finos/perspective-test";
+import { make_client, PerspectiveServer } from "@finos/perspective";
+
+// Small updates to a pivoted view are applied to its sparse tree directly,
+// rather than through an intermediate dense tree, up to a per-table
+// `strand_direct_apply_max_cost`. Each spec uses its own server, so options
+// set here never leak into other specs.
+
+const DEFAULT_MAX_COST = 65536;
+
+const DATA = {
+    id: [1, 2, 3, 4, 5, 6, 7, 8],
+    a: ["x", "x", "y", "y", "z", "z", "x", "y"],
+    b: ["p", "q", "p", "q", "p", "q", "p", "q"],
+    v: [1, 2, 3, 4, 5, 6, 7, 8],
+    w: [1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5],
+};
+
+const STEPS = {
+    insert: async (table) => {
+        await table.update({
+            id: [9, 10],
+            a: ["w", "x"],
+            b: ["p", "r"],
+            v: [9, 10],
+            w: [9.5, 10.5],
+        });
+    },
+    update: async (table) => {
+        await table.update({ id: [1, 3, 8], v: [100, 300, 800] });
+    },
+    pivot_change: async (table) => {
+        await table.update({ id: [2, 5], a: ["y", "x"] });
+    },
+    split_change: async (table) => {
+        await table.update({ id: [6, 7], b: ["p", "q"] });
+    },
+    filter_change: async (table) => {
+        await table.update({ id: [1, 4], v: [-1, 2] });
+    },
+    delete: async (table) => {
+        await table.remove([4, 9]);
+    },
+    delete_group: async (table) => {
+        await table.remove([5, 6]);
+    },
+    reinsert: async (table) => {
+        await table.update({ id: [4, 5], a: ["z", "z"], b: ["q", "p"] });
+    },
+};
+
+const CONFIGS = {
+    "ctx1 sum/avg": {
+        group_by: ["a"],
+        columns: ["v", "w"],
+        aggregates: { v: "sum", w: "avg" },
+    },
+    "ctx1 two levels": {
+        group_by: ["a", "b"],
+        columns: ["v", "w", "id"],
+        aggregates: { v: "high", w: "low", id: "count" },
+    },
+    "ctx1 filtered": {
+        group_by: ["a"],
+        columns: ["v", "w"],
+        aggregates: { v: "sum", w: "last" },
+        filter: [["v", ">", 2]],
+    },
+    "ctx1 sorted": {
+        group_by: ["a"],
+        columns: ["v", "w"],
+        sort: [["v", "desc"]],
+    },
+    "ctx2 sum/avg": {
+        group_by: ["a"],
+        split_by: ["b"],
+        columns: ["v", "w"],
+        aggregates: { v: "sum", w: "avg" },
+    },
+    "ctx2 filtered": {
+        group_by: ["a", "b"],
+        split_by: ["b"],
+        columns: ["v", "id"],
+        aggregates: { v: "sum", id: "distinct count" },
+        filter: [["v", ">", 2]],
+    },
+    "ctx2 column only": {
+        split_by: ["a"],
+        columns: ["v"],
+    },
+};
+
+function connect(server) {
+    const session = server.make_session(async (msg) => {
+        await client.handle_response(msg);
+    });
+
+    const client = make_client(async (msg) => {
+        await session.handle_request(msg);
+    });
+
+    return client;
+}
+
+/**
+ * Create a table of `DATA` on `server`, with `max_cost` as its
+ * `strand_direct_apply_max_cost`.
+ */
+async function make_table(server, client, max_cost) {
+    const name = "strand-" + Math.random();
+    const table = await client.table(DATA, { index: "id", name });
+    await server.set_table_tree_options(name, {
+        strand_direct_apply_max_cost: max_cost,
+    });
+
+    return table;
+}
+
+/**
+ * Whether every tree of `view` applied its last update directly.
+ */
+async function applied_directly(view) {
+    const profile = await view.profile();
+    expect(profile.trees.length).toBeGreaterThan(0);
+    return profile.trees.every((tree) => tree.last_applied_directly);
+}
+
+/**
+ * Apply every step of `STEPS` in turn to a new table, reading `config`'s view
+ * after each, with strand tables up to `max_cost` applied directly.
+ */
+async function replay(max_cost, config) {
+    const server = new PerspectiveServer();
+    try {
+        const table = await make_table(server, connect(server), max_cost);
+        const view = await table.view(config);
+        const results = { init: await view.to_columns() };
+        for (const [name, step] of Object.entries(STEPS)) {
+            await step(table);
+            results[name] = await view.to_columns();
+        }
+
+        // A new view is built from the table, rather than incrementally.
+        const rebuilt = await table.view(config);
+        results.rebuilt = await rebuilt.to_columns();
+        await rebuilt.delete();
+        await view.delete();
+        await table.delete();
+        return results;
+    } finally {
+        server.delete();
+    }
+}
+
+test.describe("Direct strand application", () => {
+    test("applies updates up to max_cost directly", async () => {
+        const server = new PerspectiveServer();
+        const table = await make_table(server, connect(server), 16);
+        const view = await table.view({ group_by: ["a"], columns: ["v"] });
+
+        // One row, at depth 1, is well inside the limit.
+        await table.update({ id: [1], v: [10] });
+        expect(await applied_directly(view)).toBe(true);
+
+        // 100 new rows are not.
+        const ids = Array.from({ length: 100 }, (_, i) => 100 + i);
+        await table.update({
+            id: ids,
+            a: ids.map(() => "x"),
+            v: ids,
+        });
+
+        expect(await applied_directly(view)).toBe(false);
+        await table.update({ id: [2], v: [20] });
+        expect(await applied_directly(view)).toBe(true);
+        await view.delete();
+        await table.delete();
+        server.delete();
+    });
+
+    test("scopes max_cost to one table", async () => {
+        const server = new PerspectiveServer();
+        const client = connect(server);
+        const direct = await make_table(server, client, DEFAULT_MAX_COST);
+        const dense = await make_table(server, client, 0);
+        const config = { group_by: ["a"], split_by: ["b"], columns: ["v"] };
+        const direct_view = await direct.view(config);
+        const dense_view = await dense.view(config);
+
+        await direct.update({ id: [1], v: [10] });
+        await dense.update({ id: [1], v: [10] });
+        expect(await applied_directly(direct_view)).toBe(true);
+        expect(await applied_directly(dense_view)).toBe(false);
+
+        await direct_view.delete();
+        await dense_view.delete();
+        await direct.delete();
+        await dense.delete();
+        server.delete();
+    });
+
+    test("keeps the options a view was created with", async () => {
+        const server = new PerspectiveServer();
+        const client = connect(server);
+        const table = await make_table(server, client, 0);
+        const config = { group_by: ["a"], columns: ["v"] };
+        const before = await table.view(config);
+        await server.set_table_tree_options(await table.get_name(), {
+            strand_direct_apply_max_cost: DEFAULT_MAX_COST,
+        });
+
+        const after = await table.view(config);
+        await table.update({ id: [1], v: [10] });
+        expect(await applied_directly(before)).toBe(false);
+        expect(await applied_directly(after)).toBe(true);
+        expect(await before.to_columns()).toEqual(await after.to_columns());
+        await before.delete();
+        await after.delete();
+        await table.delete();
+        server.delete();
+    });
+
+    test("rejects options for a table which does not exist", async () => {
+        const server = new PerspectiveServer();
+        await expect(
+            server.set_table_tree_options("missing", {
+                strand_direct_apply_max_cost: 0,
+            }),
+        ).rejects.toThrow("missing");
+
+        server.delete();
+    });
+
+    for (const [name, config] of Object.entries(CONFIGS)) {
+        test(`${name} matches the dense tree path`, async () => {
+            const direct = await replay(DEFAULT_MAX_COST, config);
+            const dense = await replay(0, config);
+            expect(direct).toEqual(dense);
+        });
+
+        test(`${name} matches a rebuilt view`, async () => {
+            const direct = await replay(DEFAULT_MAX_COST, config);
+            expect(direct.reinsert).toEqual(direct.rebuilt);
+        });
+    }
+});
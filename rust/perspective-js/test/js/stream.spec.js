@@ -0,0 +1,225 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+import { test, expect } from "@finos/perspective-test";
+import { make_client, PerspectiveServer } from "@finos/perspective";
+import perspective from "./perspective_client";
+
+const DATA = {
+    id: [0, 1, 2, 3, 4, 5, 6, 7, 8, 9],
+    x: ["a", "b", "c", "d", "e", "f", "g", "h", "i", "j"],
+};
+
+async function chunk_to_json(chunk) {
+    const table = await perspective.table(chunk);
+    const view = await table.view();
+    const json = await view.to_json();
+    await view.delete();
+    await table.delete();
+    return json;
+}
+
+// Read every remaining chunk of `stream`, as JSON rows per chunk.
+async function read_all(stream) {
+    const chunks = [];
+    for (let chunk = await stream.next(); chunk; chunk = await stream.next()) {
+        chunks.push(await chunk_to_json(chunk));
+    }
+
+    return chunks;
+}
+
+function connect(server) {
+    const session = server.make_session(async (msg) => {
+        await client.handle_response(msg);
+    });
+
+    const client = make_client(async (msg) => {
+        await session.handle_request(msg);
+    });
+
+    return { client, session };
+}
+
+test.describe("View streams", () => {
+    test.describe("Chunk boundaries", () => {
+        test("splits the view into chunks of chunk_rows", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 4);
+            const chunks = await read_all(stream);
+            expect(chunks.map((x) => x.length)).toEqual([4, 4, 2]);
+            expect(chunks.flat()).toEqual(await view.to_json());
+            expect(await stream.next()).toBeUndefined();
+            await view.delete();
+            await table.delete();
+        });
+
+        test("ends on a chunk which exactly fills the view", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 5);
+            const chunks = await read_all(stream);
+            expect(chunks.map((x) => x.length)).toEqual([5, 5]);
+            await view.delete();
+            await table.delete();
+        });
+
+        test("reads one chunk when chunk_rows is 0", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 0);
+            const chunks = await read_all(stream);
+            expect(chunks.length).toEqual(1);
+            expect(chunks[0]).toEqual(await view.to_json());
+            await view.delete();
+            await table.delete();
+        });
+
+        test("reads only the rows of the window", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream(
+                { start_row: 2, end_row: 7 },
+                2,
+            );
+
+            const chunks = await read_all(stream);
+            expect(chunks.map((x) => x.map((row) => row.id))).toEqual([
+                [2, 3],
+                [4, 5],
+                [6],
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("writes the CSV header in the first chunk only", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_csv_stream({}, 3);
+            const chunks = [];
+            for (let x = await stream.next(); x; x = await stream.next()) {
+                chunks.push(x);
+            }
+
+            expect(chunks.length).toEqual(4);
+            expect(chunks[0].startsWith('"id","x"')).toBe(true);
+            for (const chunk of chunks.slice(1)) {
+                expect(chunk.includes('"id"')).toBe(false);
+            }
+
+            expect(chunks.join("")).toEqual(await view.to_csv());
+            await view.delete();
+            await table.delete();
+        });
+    });
+
+    test("reads an empty view as one chunk without rows", async () => {
+        const table = await perspective.table(DATA, { index: "id" });
+        const view = await table.view({ filter: [["id", ">", 100]] });
+        const stream = await view.to_arrow_stream({}, 4);
+        const chunks = await read_all(stream);
+        expect(chunks).toEqual([[]]);
+        await view.delete();
+        await table.delete();
+    });
+
+    test.describe("A view which changes mid-stream", () => {
+        test("includes rows added before they are reached", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 4);
+            const first = await chunk_to_json(await stream.next());
+            await table.update({ id: [10, 11], x: ["k", "l"] });
+            const rest = await read_all(stream);
+            expect([first, ...rest].map((x) => x.length)).toEqual([4, 4, 4]);
+
+            expect(rest.flat().map((row) => row.id)).toEqual([
+                4, 5, 6, 7, 8, 9, 10, 11,
+            ]);
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("ends early when rows are removed", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 4);
+            await stream.next();
+            await table.remove([4, 5, 6, 7, 8, 9]);
+            expect(await stream.next()).toBeUndefined();
+            await view.delete();
+            await table.delete();
+        });
+
+        test("ends when the view is deleted", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 4);
+            await stream.next();
+            await view.delete();
+            expect(await stream.next()).toBeUndefined();
+            await table.delete();
+        });
+    });
+
+    test.describe("Cancelling", () => {
+        test("ends the stream and leaves the view usable", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 4);
+            await stream.next();
+            await stream.cancel();
+            expect(await stream.next()).toBeUndefined();
+            await stream.cancel();
+
+            const again = await view.to_arrow_stream({}, 4);
+            expect((await read_all(again)).flat()).toEqual(
+                await view.to_json(),
+            );
+
+            await view.delete();
+            await table.delete();
+        });
+
+        test("drops a closed client's streams without affecting others", async () => {
+            const server = new PerspectiveServer();
+            const owner = connect(server);
+            const other = connect(server);
+            const name = "stream-" + Math.random();
+            const table = await owner.client.table(DATA, { index: "id", name });
+            const view = await table.view();
+            const stream = await view.to_arrow_stream({}, 4);
+            await stream.next();
+
+            const other_table = await other.client.open_table(name);
+            const other_view = await other_table.view();
+            const other_stream = await other_view.to_arrow_stream({}, 4);
+            await other_stream.next();
+            other.session.close();
+
+            // The closed client's view (and its stream) are gone, so the
+            // table can be deleted once the owner's view is.
+            const rest = await read_all(stream);
+            expect(rest.flat().map((row) => row.id)).toEqual([
+                4, 5, 6, 7, 8, 9,
+            ]);
+
+            await view.delete();
+            await table.delete();
+            server.delete();
+        });
+    });
+});
@@ -0,0 +1,333 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+import { test, expect } from "@finos/perspective-test";
+import { make_client, PerspectiveServer } from "@finos/perspective";
+
+// Pivoted views maintain some aggregates from per-node indices of the values
+// beneath each node, up to a per-table budget. These specs replay the same
+// updates with the indices disabled (a budget of 0), and with a budget small
+// enough that they are dropped, and expect the same results. Each replay
+// uses its own server, so budgets set here never leak into other specs.
+
+const DEFAULT_MAX_ENTRIES = 1 << 22;
+
+const DATA = {
+    id: [1, 2, 3, 4, 5, 6, 7, 8],
+    a: ["x", "x", "y", "y", "z", "z", "x", "y"],
+    s: ["pear", "fig", "fig", "kiwi", "apple", "fig", "date", "kiwi"],
+    v: [5, 2, 9, 4, 5, 1, 7, 3],
+    t: [10, 20, 30, 40, 50, 60, 70, 80],
+};
+
+const STEPS = {
+    update_extremum: async (table) => {
+        await table.update({ id: [3, 6], v: [-3, 100] });
+    },
+    update_string: async (table) => {
+        await table.update({ id: [1, 2, 5], s: ["fig", "zucchini", "fig"] });
+    },
+    move_group: async (table) => {
+        await table.update({ id: [3, 8], a: ["x", "z"] });
+    },
+    insert: async (table) => {
+        await table.update({
+            id: [9, 10, 11],
+            a: ["w", "x", "x"],
+            s: ["lime", "lime", "banana"],
+            v: [0, 7, 7],
+            t: [5, 90, 15],
+        });
+    },
+    reorder: async (table) => {
+        await table.update({ id: [1, 7, 10], t: [95, 1, 45] });
+    },
+    remove: async (table) => {
+        await table.remove([3, 6, 9]);
+    },
+    remove_group: async (table) => {
+        await table.remove([5, 8]);
+    },
+    nulls: async (table) => {
+        await table.update({ id: [2, 4], s: [null, null], v: [null, 8] });
+    },
+    reinsert: async (table) => {
+        await table.update({
+            id: [3, 5],
+            a: ["y", "y"],
+            s: ["fig", "plum"],
+            v: [9, -1],
+            t: [35, 25],
+        });
+    },
+};
+
+function connect(server) {
+    const session = server.make_session(async (msg) => {
+        await client.handle_response(msg);
+    });
+
+    const client = make_client(async (msg) => {
+        await session.handle_request(msg);
+    });
+
+    return client;
+}
+
+/**
+ * Create a table of `DATA` on `server`, whose views' indices may hold up to
+ * `max_entries` entries.
+ */
+async function make_table(server, max_entries) {
+    const name = "stree-index-" + Math.random();
+    const table = await connect(server).table(DATA, { index: "id", name });
+    await server.set_table_tree_options(name, {
+        index_max_entries: max_entries,
+    });
+
+    return table;
+}
+
+async function indexed(view) {
+    const profile = await view.profile();
+    return profile.trees.map((tree) => tree.indexed);
+}
+
+/**
+ * Apply every step of `steps` in turn to a new table, reading `config`'s view
+ * after each, with per-tree index budget `max_entries`.
+ */
+async function replay(max_entries, config, steps = STEPS) {
+    const server = new PerspectiveServer();
+    try {
+        const table = await make_table(server, max_entries);
+        const view = await table.view(config);
+        const results = { init: await view.to_columns() };
+        for (const [name, step] of Object.entries(steps)) {
+            await step(table);
+            results[name] = await view.to_columns();
+        }
+
+        // A new view is built from the table, rather than incrementally.
+        const rebuilt = await table.view(config);
+        results.rebuilt = await rebuilt.to_columns();
+        await rebuilt.delete();
+        await view.delete();
+        await table.delete();
+        return results;
+    } finally {
+        server.delete();
+    }
+}
+
+function test_index_configs(configs) {
+    for (const [name, config] of Object.entries(configs)) {
+        test(`${name} matches unindexed aggregates`, async () => {
+            const indexed = await replay(DEFAULT_MAX_ENTRIES, config);
+            const unindexed = await replay(0, config);
+            expect(indexed).toEqual(unindexed);
+        });
+
+        test(`${name} matches when indices are dropped`, async () => {
+            const dropped = await replay(24, config);
+            const unindexed = await replay(0, config);
+            expect(dropped).toEqual(unindexed);
+        });
+
+        test(`${name} matches a rebuilt view`, async () => {
+            const indexed = await replay(DEFAULT_MAX_ENTRIES, config);
+            expect(indexed.reinsert).toEqual(indexed.rebuilt);
+        });
+    }
+}
+
+test.describe("Value indices", () => {
+    test_index_configs({
+        "min/max": {
+            group_by: ["a"],
+            columns: ["v", "t"],
+            aggregates: { v: "min", t: "max" },
+        },
+        "string dominant": {
+            group_by: ["a"],
+            columns: ["s", "v"],
+            aggregates: { s: "dominant", v: "min" },
+        },
+        "unique/dominant": {
+            group_by: ["a"],
+            columns: ["s", "v"],
+            aggregates: { s: "unique", v: "dominant" },
+        },
+        "two levels, split": {
+            group_by: ["a", "s"],
+            split_by: ["a"],
+            columns: ["v", "s"],
+            aggregates: { v: "max", s: "unique" },
+        },
+    });
+});
+
+// Keys inserted before the first and after the last row of each group, and
+// removal of each group's first and last rows, move FIRST and LAST.
+const ORDERED_STEPS = {
+    ...STEPS,
+    insert_ends: async (table) => {
+        await table.update({
+            id: [0, 20],
+            a: ["x", "x"],
+            s: ["cherry", "quince"],
+            v: [11, 12],
+            t: [0, 100],
+        });
+    },
+    remove_ends: async (table) => {
+        await table.remove([0, 20, 1]);
+    },
+    update_ends: async (table) => {
+        await table.update({ id: [2, 11], s: ["grape", "melon"], v: [13, 14] });
+    },
+};
+
+test.describe("Ordered indices", () => {
+    for (const [name, config] of Object.entries({
+        "first/last": {
+            group_by: ["a"],
+            columns: ["s", "v"],
+            aggregates: { s: "first", v: "last by index" },
+        },
+        "last minus first": {
+            group_by: ["a"],
+            columns: ["v", "t"],
+            aggregates: { v: "last minus first", t: "first" },
+        },
+        "two levels, split": {
+            group_by: ["a", "s"],
+            split_by: ["a"],
+            columns: ["s", "v"],
+            aggregates: { s: "last by index", v: "first" },
+        },
+    })) {
+        test(`${name} keeps order after updates and removes`, async () => {
+            const indexed = await replay(
+                DEFAULT_MAX_ENTRIES,
+                config,
+                ORDERED_STEPS,
+            );
+
+            const unindexed = await replay(0, config, ORDERED_STEPS);
+            expect(indexed).toEqual(unindexed);
+            expect(indexed.update_ends).toEqual(indexed.rebuilt);
+        });
+
+        test(`${name} matches when indices are dropped`, async () => {
+            const dropped = await replay(24, config, ORDERED_STEPS);
+            const unindexed = await replay(0, config, ORDERED_STEPS);
+            expect(dropped).toEqual(unindexed);
+        });
+    }
+});
+
+test.describe("Index budget", () => {
+    const CONFIG = {
+        group_by: ["a"],
+        columns: ["v", "t"],
+        aggregates: { v: "min", t: "max" },
+    };
+
+    // Two indices over a tree of depth 2 hold 4 entries per row.
+    test("drops indices over budget and rebuilds them once under half", async () => {
+        const server = new PerspectiveServer();
+        const table = await make_table(server, 40);
+        const view = await table.view(CONFIG);
+        expect(await indexed(view)).toEqual([true]);
+
+        // Updating existing rows adds no entries.
+        await table.update({
+            id: [1, 2, 3, 4, 5, 6, 7, 8],
+            v: [8, 7, 6, 5, 4, 3, 2, 1],
+        });
+
+        expect(await indexed(view)).toEqual([true]);
+
+        // 11 rows hold 44 entries.
+        await table.update({
+            id: [9, 10, 11],
+            a: ["x", "y", "w"],
+            v: [0, 1, 2],
+        });
+
+        expect(await indexed(view)).toEqual([false]);
+
+        // 6 rows hold 24, more than half of the budget.
+        await table.remove([2, 3, 4, 6, 7]);
+        expect(await indexed(view)).toEqual([false]);
+
+        // 4 rows hold 16.
+        await table.remove([8, 9]);
+        expect(await indexed(view)).toEqual([true]);
+
+        await table.update({ id: [1, 5], v: [-1, 50], t: [500, -5] });
+        const rebuilt = await table.view(CONFIG);
+        expect(await view.to_columns()).toEqual(await rebuilt.to_columns());
+        await rebuilt.delete();
+        await view.delete();
+        await table.delete();
+        server.delete();
+    });
+
+    // 8 rows at depth 2 hold 16 nodes per index, and a DOMINANT index holds
+    // a second 16 to order its values by count. Each view has its own table,
+    // as views of one table which differ only in aggregates share a tree.
+    test("counts a dominant index twice", async () => {
+        const server = new PerspectiveServer();
+        const table = await make_table(server, 31);
+        const dominant_table = await make_table(server, 31);
+        const min = await table.view({
+            group_by: ["a"],
+            columns: ["v"],
+            aggregates: { v: "min" },
+        });
+
+        const dominant = await dominant_table.view({
+            group_by: ["a"],
+            columns: ["s"],
+            aggregates: { s: "dominant" },
+        });
+
+        expect(await indexed(min)).toEqual([true]);
+        expect(await indexed(dominant)).toEqual([false]);
+        await min.delete();
+        await dominant.delete();
+        await table.delete();
+        await dominant_table.delete();
+        server.delete();
+    });
+
+    test("is set per table", async () => {
+        const server = new PerspectiveServer();
+        const small = await make_table(server, 0);
+        const large = await make_table(server, DEFAULT_MAX_ENTRIES);
+        const small_view = await small.view(CONFIG);
+        const large_view = await large.view(CONFIG);
+        expect(await indexed(small_view)).toEqual([false]);
+        expect(await indexed(large_view)).toEqual([true]);
+        expect(await small_view.to_columns()).toEqual(
+            await large_view.to_columns(),
+        );
+
+        await small_view.delete();
+        await large_view.delete();
+        await small.delete();
+        await large.delete();
+        server.delete();
+    });
+});
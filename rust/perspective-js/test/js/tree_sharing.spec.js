@@ -0,0 +1,282 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+
+import { test, expect } from "@finos/perspective-test";
+import perspective from "./perspective_client";
+
+// Views on one table whose configs differ only in their aggregates, sort and
+// expansion share one sparse tree, which computes the aggregates of all of
+// them. Each view here is checked against the same view, sorted and expanded
+// the same way, on a copy of the table which it does not share.
+
+const DATA = {
+    id: [1, 2, 3, 4, 5, 6],
+    a: ["x", "x", "y", "y", "z", "z"],
+    b: ["p", "q", "p", "q", "p", "q"],
+    c: ["m", "n", "m", "m", "n", "n"],
+    v: [1, 2, 3, 4, 5, 6],
+};
+
+const STEPS = [
+    async (table) => {
+        await table.update({ id: [1, 4], v: [10, 40] });
+    },
+    async (table) => {
+        await table.update({
+            id: [7, 8],
+            a: ["w", "x"],
+            b: ["p", "r"],
+            c: ["n", "m"],
+            v: [7, 8],
+        });
+    },
+    async (table) => {
+        await table.update({ id: [2], a: ["z"] });
+    },
+    async (table) => {
+        await table.remove([3, 4]);
+    },
+];
+
+const PIVOTS = {
+    ctx1: { group_by: ["a", "b"] },
+    ctx2: { group_by: ["a", "b"], split_by: ["c"] },
+};
+
+/**
+ * A view of `config` on `table`, and the same view on a copy of `table`'s
+ * current rows, whose row deltas are both collected.
+ */
+async function make_view(table, config) {
+    const flat = await table.view();
+    const reference_table = await perspective.table(await flat.to_columns(), {
+        index: "id",
+    });
+
+    await flat.delete();
+    const view = await table.view(config);
+    const reference = await reference_table.view(config);
+    const deltas = [];
+    const reference_deltas = [];
+    await view.on_update((updated) => deltas.push(updated.delta), {
+        mode: "row",
+    });
+
+    await reference.on_update(
+        (updated) => reference_deltas.push(updated.delta),
+        { mode: "row" },
+    );
+
+    return { view, reference_table, reference, deltas, reference_deltas };
+}
+
+// Apply `step` to `table` and to the copy of it under each of `views`.
+async function apply(step, table, views) {
+    await step(table);
+    for (const { reference_table } of views) {
+        await step(reference_table);
+    }
+}
+
+// Apply `op` to a view and to its reference.
+async function both({ view, reference }, op) {
+    await op(view);
+    await op(reference);
+}
+
+async function expect_same(views) {
+    for (const { view, reference } of views) {
+        expect(await view.to_json()).toEqual(await reference.to_json());
+    }
+}
+
+async function delta_to_json(delta) {
+    const table = await perspective.table(delta);
+    const view = await table.view();
+    const json = await view.to_json();
+    await view.delete();
+    await table.delete();
+    return json;
+}
+
+async function expect_same_deltas({ deltas, reference_deltas }, count) {
+    await expect.poll(() => deltas.length).toBe(count);
+    await expect.poll(() => reference_deltas.length).toBe(count);
+    for (let i = 0; i < count; i++) {
+        expect(await delta_to_json(deltas[i])).toEqual(
+            await delta_to_json(reference_deltas[i]),
+        );
+    }
+}
+
+async function delete_views(table, views) {
+    for (const { view, reference, reference_table } of views) {
+        await view.delete();
+        await reference.delete();
+        await reference_table.delete();
+    }
+
+    await table.delete();
+}
+
+for (const [name, pivots] of Object.entries(PIVOTS)) {
+    test.describe(`Shared trees, ${name}`, () => {
+        test("views with different aggregates share a tree", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const views = [];
+            for (const config of [
+                { columns: ["v"], aggregates: { v: "sum" } },
+                // The same column name with another aggregate.
+                { columns: ["v", "id"], aggregates: { v: "max", id: "count" } },
+                // Aggregates of other views, in another order.
+                { columns: ["id", "v"], aggregates: { v: "sum", id: "count" } },
+                { columns: ["c"], aggregates: { c: "dominant" } },
+            ]) {
+                views.push(await make_view(table, { ...pivots, ...config }));
+            }
+
+            await expect_same(views);
+            for (const step of STEPS) {
+                await apply(step, table, views);
+                await expect_same(views);
+            }
+
+            // Each view's deltas only have its own columns.
+            for (const view of views) {
+                await expect_same_deltas(view, STEPS.length);
+            }
+
+            await delete_views(table, views);
+        });
+
+        test("a view sharing a tree keeps its own sort and expansion", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const leader = await make_view(table, {
+                ...pivots,
+                columns: ["v"],
+            });
+
+            // Sorted by an aggregate only this view computes.
+            const follower = await make_view(table, {
+                ...pivots,
+                columns: ["v", "id"],
+                aggregates: { id: "count" },
+                sort: [["id", "desc"]],
+            });
+
+            const views = [leader, follower];
+            await both(follower, (view) => view.collapse(1));
+            await expect_same(views);
+            for (const step of STEPS) {
+                await apply(step, table, views);
+                await expect_same(views);
+            }
+
+            await both(follower, (view) => view.expand(1));
+            await both(follower, (view) => view.collapse(2));
+            await expect_same(views);
+            expect(await leader.view.num_rows()).toBeGreaterThan(
+                await follower.view.num_rows(),
+            );
+
+            await delete_views(table, views);
+        });
+
+        test("views keep their sort and expansion when their tree gains aggregates", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const leader = await make_view(table, {
+                ...pivots,
+                columns: ["v"],
+            });
+
+            const follower = await make_view(table, {
+                ...pivots,
+                columns: ["v"],
+                sort: [["v", "asc"]],
+            });
+
+            await both(leader, (view) => view.collapse(1));
+            await both(follower, (view) => view.collapse(2));
+            await apply(STEPS[0], table, [leader, follower]);
+
+            // Both views adopt the tree this view builds for `min`.
+            const added = await make_view(table, {
+                ...pivots,
+                columns: ["v"],
+                aggregates: { v: "min" },
+            });
+
+            const views = [leader, follower, added];
+            await expect_same(views);
+            for (const step of STEPS.slice(1)) {
+                await apply(step, table, views);
+                await expect_same(views);
+            }
+
+            await expect_same_deltas(added, STEPS.length - 1);
+            await delete_views(table, views);
+        });
+
+        test("views share a tree again after the table is cleared or replaced", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const views = [
+                await make_view(table, { ...pivots, columns: ["v"] }),
+                await make_view(table, {
+                    ...pivots,
+                    columns: ["id"],
+                    aggregates: { id: "count" },
+                    sort: [["id", "asc"]],
+                }),
+            ];
+
+            await apply(STEPS[0], table, views);
+            await apply((table) => table.clear(), table, views);
+            await expect_same(views);
+            await apply((table) => table.replace(DATA), table, views);
+            await expect_same(views);
+            for (const step of STEPS) {
+                await apply(step, table, views);
+                await expect_same(views);
+            }
+
+            await delete_views(table, views);
+        });
+
+        test("deleting the view which built the tree leaves its sharers correct", async () => {
+            const table = await perspective.table(DATA, { index: "id" });
+            const builder = await make_view(table, {
+                ...pivots,
+                columns: ["v"],
+                aggregates: { v: "max" },
+            });
+
+            const sharer = await make_view(table, {
+                ...pivots,
+                columns: ["v"],
+            });
+
+            const views = [builder, sharer];
+            await apply(STEPS[0], table, views);
+            await builder.view.delete();
+            await builder.reference.delete();
+            await builder.reference_table.delete();
+            for (const step of STEPS.slice(1)) {
+                await apply(step, table, [sharer]);
+                await expect_same([sharer]);
+            }
+
+            await expect_same_deltas(sharer, STEPS.length);
+            await delete_views(table, [sharer]);
+        });
+    });
+}
@@ -0,0 +1,319 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+
+import { test, expect } from "@finos/perspective-test";
+import perspective from "./perspective_client";
+
+// Update batches take faster paths than the general one when they allow it.
+// A batch whose primary keys are unique and sorted is not flattened, and one
+// of inserts alone is applied by typed kernels which skip each row's op
+// handling. These specs queue each batch on two tables, the second in a way
+// which forces the general path, and expect the same views and deltas from
+// both.
+
+const MISSING = 1000;
+
+// A remove in the batch, even of a key which is not in the table, forces the
+// general path for each column.
+async function update_with_remove(table, data) {
+    await table.remove([MISSING]);
+    await table.update(data);
+}
+
+// A repeated primary key forces `flatten()`.
+async function update_twice(table, data) {
+    await table.update(data);
+    await table.update(data);
+}
+
+const SCHEMA = {
+    id: "integer",
+    i: "integer",
+    f: "float",
+    b: "boolean",
+    d: "date",
+    t: "datetime",
+    s: "string",
+};
+
+const CONFIGS = [
+    {},
+    { filter: [["i", ">", 2]] },
+    {
+        group_by: ["b"],
+        columns: ["i", "f", "t", "d"],
+        aggregates: { i: "sum", f: "avg", t: "max", d: "min" },
+    },
+    { group_by: ["s"], split_by: ["b"], columns: ["f", "i"] },
+];
+
+const INSERT_STEPS = {
+    insert: {
+        id: [1, 2, 3, 4],
+        i: [1, 2, null, 4],
+        f: [1.5, null, 3.5, 4.5],
+        b: [true, false, null, true],
+        d: ["2024-01-01", null, "2024-01-03", "2024-01-04"],
+        t: [
+            +new Date("2024-01-01T10:00:00Z"),
+            +new Date("2024-01-02T11:00:00Z"),
+            null,
+            +new Date("2024-01-04T13:00:00Z"),
+        ],
+        s: ["a", "b", "a", null],
+    },
+    partial: { id: [1, 3], f: [10.5, 30.5] },
+    nulls: {
+        id: [2, 4],
+        i: [null, 40],
+        b: [true, null],
+        d: ["2024-02-02", null],
+        t: [null, +new Date("2024-02-04T00:00:00Z")],
+    },
+    revalidate: {
+        id: [2, 3, 4],
+        i: [20, 30, 4],
+        f: [20.5, null, 4.5],
+        b: [false, false, true],
+        t: [+new Date("2024-03-02T00:00:00Z"), null, null],
+    },
+    unchanged: { id: [1, 2], i: [1, 20], b: [true, false], s: ["a", "b"] },
+    insert_partial: {
+        id: [5, 6],
+        i: [5, null],
+        d: ["2024-04-05", null],
+    },
+};
+
+async function delta_to_json(delta) {
+    const table = await perspective.table(delta);
+    const view = await table.view();
+    const json = await view.to_json();
+    await view.delete();
+    await table.delete();
+    return json;
+}
+
+async function make_views(table) {
+    const views = [];
+    for (const config of CONFIGS) {
+        const view = await table.view(config);
+        const deltas = [];
+        await view.on_update((updated) => deltas.push(updated.delta), {
+            mode: "row",
+        });
+
+        views.push({ view, deltas });
+    }
+
+    return views;
+}
+
+/**
+ * Create two tables of `schema`, queue each batch of `steps` on both, with
+ * `general_update` on the second, and expect the same views after each step.
+ * Steps which are functions are called with each table and its update
+ * function, and are processed as one batch when they make no reads.
+ */
+async function expect_same_paths(
+    steps,
+    general_update,
+    schema = SCHEMA,
+    options = { index: "id" },
+) {
+    const table = await perspective.table(schema, options);
+    const general_table = await perspective.table(schema, options);
+    const views = await make_views(table);
+    const general_views = await make_views(general_table);
+    const update = (table, data) => table.update(data);
+    for (const step of Object.values(steps)) {
+        if (typeof step === "function") {
+            await step(table, update);
+            await step(general_table, general_update);
+        } else {
+            await update(table, step);
+            await general_update(general_table, step);
+        }
+
+        for (let i = 0; i < views.length; i++) {
+            expect(await views[i].view.to_columns()).toEqual(
+                await general_views[i].view.to_columns(),
+            );
+        }
+    }
+
+    for (let i = 0; i < views.length; i++) {
+        const { view, deltas } = views[i];
+        const general = general_views[i];
+        await expect.poll(() => deltas.length).toBe(general.deltas.length);
+        for (let j = 0; j < deltas.length; j++) {
+            expect(await delta_to_json(deltas[j])).toEqual(
+                await delta_to_json(general.deltas[j]),
+            );
+        }
+
+        await view.delete();
+        await general.view.delete();
+    }
+
+    await table.delete();
+    await general_table.delete();
+}
+
+test.describe("Insert batches", () => {
+    // The state table is empty for the first batch.
+    test("match the general path from an empty table", async () => {
+        await expect_same_paths(INSERT_STEPS, update_with_remove);
+    });
+
+    test("match the general path on a table with rows", async () => {
+        const { insert, ...steps } = INSERT_STEPS;
+        await expect_same_paths(
+            { load: (table) => table.update(insert), ...steps },
+            update_with_remove,
+        );
+    });
+
+    test("match the general path after removes", async () => {
+        const { insert, ...steps } = INSERT_STEPS;
+        await expect_same_paths(
+            {
+                load: (table) => table.update(insert),
+                remove: (table) => table.remove([2, 4]),
+                ...steps,
+            },
+            update_with_remove,
+        );
+    });
+});
+
+// Each step's removes are queued with its update, so they are one batch.
+const UNIQUE_STEPS = {
+    ...INSERT_STEPS,
+    remove_before: async (table, update) => {
+        await table.remove([1]);
+        await update(table, { id: [5, 6], i: [50, 60], s: ["c", "d"] });
+    },
+    remove_after: async (table, update) => {
+        await table.remove([6, 3]);
+        await update(table, { id: [2, 4], f: [2.25, null] });
+    },
+    remove_missing: async (table, update) => {
+        await table.remove([MISSING + 1]);
+        await update(table, { id: [7], i: [7], b: [false] });
+    },
+    unsorted: { id: [7, 2, 8], i: [70, 2, 80], s: ["e", null, "f"] },
+    null_key: { id: [null, 9], i: [-1, 9], f: [-1.5, 9.5] },
+    update_null_key: { id: [9, null], i: [90, -10] },
+};
+
+test.describe("Unique batches", () => {
+    // The state table is empty for the first batch.
+    test("match flatten() from an empty table", async () => {
+        await expect_same_paths(UNIQUE_STEPS, update_twice);
+    });
+
+    test("match flatten() with string keys", async () => {
+        const schema = { k: "string", ...SCHEMA };
+        await expect_same_paths(
+            {
+                insert: {
+                    k: ["m", "c", "x", "a"],
+                    id: [1, 2, 3, 4],
+                    i: [1, 2, 3, 4],
+                },
+                update: { k: ["x", "m"], f: [3.5, 1.5], s: ["a", "b"] },
+                remove: async (table, update) => {
+                    await table.remove(["c"]);
+                    await update(table, { k: ["q", "b"], i: [5, 6] });
+                },
+                reinsert: { k: ["c", "z", "a"], i: [20, 30, 40] },
+                null_key: { k: [null, "n"], i: [-1, 7] },
+            },
+            update_twice,
+            schema,
+            { index: "k" },
+        );
+    });
+});
+
+// Keys in `[min, max)` from a fixed xorshift sequence, with repeats.
+function make_keys(count, min, max) {
+    let state = 0x2545f491;
+    const keys = [];
+    for (let idx = 0; idx < count; idx++) {
+        state ^= state << 13;
+        state ^= state >>> 17;
+        state ^= state << 5;
+        keys.push(min + ((state >>> 0) % (max - min)));
+    }
+
+    return keys;
+}
+
+/**
+ * Update a table of `type` keys with each of `batches` of keys in turn, the
+ * value of each row being its position over all batches, and expect each key
+ * to have the value of its last row, in key order.
+ */
+async function expect_last_writes(type, batches) {
+    const table = await perspective.table(
+        { id: type, v: "integer" },
+        { index: "id" },
+    );
+
+    const view = await table.view();
+    const rows = new Map();
+    let value = 0;
+    for (const keys of batches) {
+        const values = keys.map(() => value++);
+        keys.forEach((key, idx) => rows.set(key, values[idx]));
+        await table.update({ id: keys, v: values });
+        const sorted = [...rows.keys()].sort((a, b) => a - b);
+        expect(await view.to_columns()).toEqual({
+            id: sorted,
+            v: sorted.map((key) => rows.get(key)),
+        });
+    }
+
+    await view.delete();
+    await table.delete();
+}
+
+// Batches with repeated keys are flattened, which sorts integer, date and
+// datetime keys with a radix sort, and does so in parallel chunks for
+// batches of 65536 rows or more.
+test.describe("Flattened batches", () => {
+    test("keep the last write to each signed integer key", async () => {
+        await expect_last_writes("integer", [
+            [2147483647, -2147483648, -1, 0, 1, -1, 0, 256, -256, 2147483647],
+            [-2147483648, 255, -255, 1, -1, 65536, -65536],
+            make_keys(1000, -600, 600),
+        ]);
+    });
+
+    test("keep the last write to each datetime key", async () => {
+        const day = 24 * 60 * 60 * 1000;
+        await expect_last_writes("datetime", [
+            [-day, 0, day, -day, -1, 1, 0],
+            make_keys(1000, -500, 500).map((key) => key * day),
+        ]);
+    });
+
+    test("keep the last write to each key of a large batch", async () => {
+        await expect_last_writes("integer", [
+            make_keys(70000, -20000, 20000),
+            make_keys(140000, -100000, 100000),
+        ]);
+    });
+});
@@ -875,6 +875,158 @@ async function match_delta(perspective, delta, expected) {
         });
     });
 
+    test.describe("Row-oriented JSON updates", function () {
+        // Row-oriented JSON and NDJSON are parsed by the same streaming
+        // handler, so each case runs against both.
+        const FORMATS = {
+            json: (rows) => JSON.stringify(rows),
+            ndjson: (rows) => rows.map((row) => JSON.stringify(row)).join("\n"),
+        };
+
+        for (const [format, serialize] of Object.entries(FORMATS)) {
+            test.describe(format, function () {
+                test("ignores unknown keys and nested values under them", async function () {
+                    const table = await perspective.table({
+                        x: "integer",
+                        y: "string",
+                    });
+
+                    await table.update(
+                        serialize([
+                            { x: 1, z: { a: [1, { b: 2 }] }, y: "a" },
+                            { w: [1, [2]], x: 2, y: "b", q: null },
+                        ]),
+                        { format },
+                    );
+
+                    const view = await table.view();
+                    expect(await view.to_json()).toEqual([
+                        { x: 1, y: "a" },
+                        { x: 2, y: "b" },
+                    ]);
+
+                    await view.delete();
+                    await table.delete();
+                });
+
+                test("rejects nested values under a column key", async function () {
+                    const table = await perspective.table({ x: "integer" });
+                    await expect(
+                        table.update(serialize([{ x: { a: 1 } }]), { format }),
+                    ).rejects.toThrow();
+
+                    await expect(
+                        table.update(serialize([{ x: [1] }]), { format }),
+                    ).rejects.toThrow();
+
+                    expect(await table.size()).toEqual(0);
+                    await table.delete();
+                });
+
+                test("`__INDEX__` updates rows of an implicit index", async function () {
+                    const table = await perspective.table({
+                        x: [1, 2, 3],
+                        y: ["a", "b", "c"],
+                    });
+
+                    await table.update(
+                        serialize([
+                            { __INDEX__: 1, x: 20 },
+                            { y: "z", __INDEX__: 2 },
+                        ]),
+                        { format },
+                    );
+
+                    const view = await table.view();
+                    expect(await view.to_columns()).toEqual({
+                        x: [1, 20, 3],
+                        y: ["a", "b", "z"],
+                    });
+
+                    await view.delete();
+                    await table.delete();
+                });
+
+                test("updates rows of an explicit index", async function () {
+                    const table = await perspective.table(
+                        { k: ["a", "b"], v: [1.5, 2.5] },
+                        { index: "k" },
+                    );
+
+                    await table.update(
+                        serialize([
+                            { v: 3.5, k: "b" },
+                            { k: "c", v: null },
+                        ]),
+                        { format },
+                    );
+
+                    const view = await table.view();
+                    expect(await view.to_columns()).toEqual({
+                        k: ["a", "b", "c"],
+                        v: [1.5, 3.5, null],
+                    });
+
+                    await view.delete();
+                    await table.delete();
+                });
+
+                test("coerces values to the column types", async function () {
+                    const table = await perspective.table({
+                        i: "integer",
+                        f: "float",
+                        s: "string",
+                        b: "boolean",
+                        d: "datetime",
+                    });
+
+                    await table.update(
+                        serialize([
+                            { i: 2.7, f: 3, s: 5, b: "true", d: 1700000000000 },
+                            { i: "4", f: 2 ** 40, s: true, b: 1, d: null },
+                            { i: null, f: "1.5", s: 1.5, b: false },
+                        ]),
+                        { format },
+                    );
+
+                    const view = await table.view();
+                    expect(await view.to_columns()).toEqual({
+                        i: [2, 4, null],
+                        f: [3, 2 ** 40, 1.5],
+                        s: ["5", "true", "1.500000"],
+                        b: [true, true, false],
+                        d: [1700000000000, null, null],
+                    });
+
+                    await view.delete();
+                    await table.delete();
+                });
+
+                test("rejects values which can't be coerced", async function () {
+                    const table = await perspective.table({ x: "integer" });
+                    await expect(
+                        table.update(serialize([{ x: 1 }, { x: "abc" }]), {
+                            format,
+                        }),
+                    ).rejects.toThrow();
+
+                    expect(await table.size()).toEqual(0);
+                    await table.delete();
+                });
+
+                test("rejects malformed input", async function () {
+                    const table = await perspective.table({ x: "integer" });
+                    await expect(
+                        table.update(`{"x": 1, "y"`, { format }),
+                    ).rejects.toThrow();
+
+                    expect(await table.size()).toEqual(0);
+                    await table.delete();
+                });
+            });
+        }
+    });
+
     test.describe("Arrow Updates", function () {
         test("arrow contructor then arrow `update()`", async function () {
             const arrow = arrows.test_arrow;
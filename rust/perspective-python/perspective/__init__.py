@@ -17,6 +17,7 @@ __all__ = [
     "Client",
     "Table",
     "View",
+    "ViewStream",
     "PerspectiveError",
     "ProxySession",
     "AsyncClient",
@@ -355,6 +356,7 @@ from .perspective import (
     # so we import them just for type hinting
     Table,  # noqa: F401
     View,  # noqa: F401
+    ViewStream,  # noqa: F401
     num_cpus,
     set_num_cpus,
 )
@@ -81,3 +81,76 @@ async def test_async_client_kitchen_sink(client):
     view_deleted.assert_called_once()
     await table.delete()
     table_deleted.assert_called_once()
+
+
+@pytest.mark.asyncio
+async def test_async_view_set_sort(client):
+    table = await client.table({"a": [1, 3, 2], "b": ["x", "z", "y"]})
+    view = await table.view(sort=[["a", "desc"]])
+    view_updated = Mock()
+    await view.on_update(view_updated)
+    assert await view.set_sort([["b", "asc"]])
+    assert await view.to_columns() == {"a": [1, 2, 3], "b": ["x", "y", "z"]}
+    await table.update({"a": [0], "b": ["w"]})
+    await table.size()
+    assert view_updated.call_count == 1
+    assert await view.to_columns() == {"a": [0, 1, 2, 3], "b": ["w", "x", "y", "z"]}
+    await view.delete()
+    await table.delete()
+
+
+@pytest.mark.asyncio
+async def test_async_view_to_arrow_stream(client):
+    table = await client.table({"a": list(range(5))})
+    view = await table.view()
+    stream = await view.to_arrow_stream(2)
+    sizes = []
+    while (chunk := await stream.next()) is not None:
+        chunk_table = await client.table(chunk)
+        sizes.append(await chunk_table.size())
+        await chunk_table.delete()
+    assert sizes == [2, 2, 1]
+
+    csv_stream = await view.to_csv_stream(0)
+    assert await csv_stream.next() == await view.to_csv()
+    assert await csv_stream.next() is None
+    await view.delete()
+    await table.delete()
+
+
+@pytest.mark.asyncio
+async def test_async_view_stream_closed_client(server):
+    def connect():
+        async def send_request(msg):
+            await sess.handle_request(msg)
+
+        async def send_response(msg):
+            await client.handle_response(msg)
+
+        sess = server.new_session(send_response)
+        client = AsyncClient(send_request)
+        return client, sess
+
+    owner, _ = connect()
+    other, other_sess = connect()
+    table = await owner.table({"a": list(range(5))}, name="streamed")
+    view = await table.view()
+    stream = await view.to_arrow_stream(2)
+    await stream.next()
+
+    other_table = await other.open_table("streamed")
+    other_view = await other_table.view()
+    other_stream = await other_view.to_arrow_stream(2)
+    await other_stream.next()
+    await other_sess.close()
+
+    # The owner's stream is unaffected, and the closed client's view (with
+    # its stream) is gone, so the table can be deleted.
+    sizes = []
+    while (chunk := await stream.next()) is not None:
+        chunk_table = await owner.table(chunk)
+        sizes.append(await chunk_table.size())
+        await chunk_table.delete()
+    assert sizes == [2, 1]
+    await view.delete()
+    await table.delete()
@@ -198,3 +198,39 @@ class TestServer(object):
         thread2.start()
         thread1.join()
         thread2.join()
+
+    def test_concurrent_reads_never_observe_a_partial_update(self):
+        s = Server()
+        c = s.new_local_client()
+        t = c.table({"index": list(range(100)), "a": [0] * 100}, index="index")
+        view = t.view()
+        grouped = t.view(group_by=["a"], aggregates={"index": "count"})
+        running = True
+        results = []
+
+        def feed():
+            for k in range(1, 500):
+                t.update({"index": list(range(100)), "a": [k] * 100})
+
+        def read():
+            while running:
+                results.append(
+                    (view.to_columns()["a"], grouped.to_columns()["index"])
+                )
+
+        readers = [Thread(target=read, daemon=True) for _ in range(4)]
+        for reader in readers:
+            reader.start()
+
+        feed()
+        running = False
+        for reader in readers:
+            reader.join()
+
+        assert len(results) > 0
+        for values, counts in results:
+            # Every update replaces all 100 rows at once, so a read must see
+            # all of them from the same update.
+            assert len(values) == 100
+            assert len(set(values)) == 1
+            assert counts == [100, 100]
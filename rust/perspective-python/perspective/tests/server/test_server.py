@@ -1014,3 +1014,40 @@ class TestServer(object):
 
         table.update({"a": [7, 8, 9]})
         assert s.get() == 7
+
+    def test_server_set_num_poll_threads_matches_serial(self):
+        def run(num_threads):
+            server = Server(on_poll_request=lambda server: None)
+            server.set_num_poll_threads(num_threads)
+            client = Client.from_server(server)
+            tables = [
+                client.table({"x": [0], "y": [0.0]}, index="x", name=f"t{i}")
+                for i in range(8)
+            ]
+
+            server.poll()
+            order = []
+            views = []
+            for i, table in enumerate(tables):
+                view = table.view(
+                    group_by=["x"],
+                    expressions={"r": "random() <= 1"},
+                )
+
+                view.on_update(lambda *args, i=i: order.append(i))
+                views.append(view)
+
+            for i, table in enumerate(tables):
+                table.update(
+                    {"x": list(range(1000)), "y": [float(i * j) for j in range(1000)]}
+                )
+
+            server.poll()
+            return order, [view.to_columns() for view in views]
+
+        serial_order, serial_results = run(1)
+        assert serial_order == list(range(8))
+        for _ in range(5):
+            order, results = run(4)
+            assert order == serial_order
+            assert results == serial_results
@@ -543,3 +543,31 @@ class TestUpdate(object):
             [{"__INDEX__": 1, "a": 1, "b": 3}]
         )  # should ignore re-specification of pkey
         assert view.to_records() == [{"a": 1, "b": 3}, {"a": 2, "b": 3}]
+
+    def test_update_large_batch_matches_fresh_table(self):
+        # Updates of more than 65536 rows build each tree's strand table in
+        # row chunks, in parallel with the other trees being updated.
+        n = 200_000
+
+        def data(rows, offset):
+            return {
+                "id": list(rows),
+                "g": [str((i + offset) % 17) for i in rows],
+                "h": [str((i + offset) % 3) for i in rows],
+                "v": [float((i * 7 + offset) % 101) for i in rows],
+            }
+
+        configs = [
+            {"group_by": ["g"], "aggregates": {"v": "sum"}},
+            {"group_by": ["g", "h"], "aggregates": {"v": "max"}},
+            {"group_by": ["g"], "split_by": ["h"], "aggregates": {"v": "count"}},
+        ]
+
+        tbl = Table(data(range(0, n, 2), 0), index="id")
+        views = [tbl.view(columns=["v"], **config) for config in configs]
+        tbl.update(data(range(n), 5))
+        expected = Table(data(range(n), 5), index="id")
+        assert tbl.size() == n
+        for config, view in zip(configs, views):
+            fresh = expected.view(columns=["v"], **config)
+            assert view.to_columns() == fresh.to_columns()
@@ -14,6 +14,7 @@ import pandas as pd
 import numpy as np
 from perspective import PerspectiveError
 from datetime import date, datetime
+import time
 from pytest import approx, mark, raises
 
 import perspective as psp
@@ -1543,6 +1544,48 @@ class TestView(object):
         tbl.update(data)
         assert s.get() == 0
 
+    def test_view_on_update_min_interval_ms(self):
+        deltas = []
+
+        def callback(port_id, delta):
+            deltas.append(delta)
+
+        server = psp.Server()
+        tbl = server.new_local_client().table({"a": [1, 2]}, index="a")
+        view = tbl.view()
+        view.on_update(callback, mode="row", min_interval_ms=200)
+        tbl.update({"a": [3]})
+        tbl.update({"a": [4]})
+        tbl.update({"a": [5]})
+        assert len(deltas) == 1
+
+        # The held update is sent by the first `poll()` after it is due.
+        timeout = server.poll_timeout()
+        assert 0 <= timeout <= 0.2
+        time.sleep(timeout)
+        server.poll()
+        assert len(deltas) == 2
+        assert server.poll_timeout() is None
+        assert Table(deltas[0]).view().to_columns() == {"a": [3]}
+        assert Table(deltas[1]).view().to_columns() == {"a": [4, 5]}
+
+    def test_view_on_update_conflate(self):
+        deltas = []
+
+        def callback(port_id, delta):
+            deltas.append(delta)
+
+        tbl = Table({"a": [1, 2]}, index="a")
+        view = tbl.view()
+        view.on_update(callback, mode="row", conflate=True)
+        for a in range(3, 6):
+            tbl.update({"a": [a]})
+        assert [Table(x).view().to_columns() for x in deltas] == [
+            {"a": [3]},
+            {"a": [4]},
+            {"a": [5]},
+        ]
+
     # on_delete
 
     def test_view_on_delete(self, sentinel):
@@ -2114,6 +2157,123 @@ class TestView(object):
         view = tbl.view(split_by=["c"])
         assert view.expand(0) == 0
 
+    # set_sort
+
+    def test_view_set_sort_zero(self):
+        data = {"a": [1, 3, 2], "b": ["x", "z", "y"]}
+        tbl = Table(data)
+        view = tbl.view(sort=[["a", "desc"]])
+        assert view.set_sort([["b", "asc"]])
+        assert view.get_config()["sort"] == [["b", "asc"]]
+        assert view.to_columns() == {"a": [1, 2, 3], "b": ["x", "y", "z"]}
+
+    def test_view_set_sort_one_keeps_on_update(self):
+        data = {"a": [1, 2, 3, 4], "b": ["x", "y", "x", "y"]}
+        tbl = Table(data)
+        view = tbl.view(group_by=["b"], sort=[["a", "desc"]])
+        updates = []
+        view.on_update(lambda port_id: updates.append(port_id))
+        assert view.set_sort([["a", "asc"]])
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "a": [10, 4, 6],
+            "b": [4, 2, 2],
+        }
+
+        tbl.update({"a": [10], "b": ["x"]})
+        assert len(updates) == 1
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["y"], ["x"]],
+            "a": [20, 6, 14],
+            "b": [5, 2, 3],
+        }
+
+    def test_view_set_sort_two(self):
+        data = {"a": [1, 2, 3, 4], "b": ["x", "y", "x", "y"], "c": ["p", "p", "q", "q"]}
+        tbl = Table(data)
+        config = {"group_by": ["b"], "split_by": ["c"], "sort": [["a", "desc"]]}
+        view = tbl.view(**config)
+        assert view.set_sort([["a", "asc"]])
+        expected = tbl.view(**{**config, "sort": [["a", "asc"]]})
+        assert view.to_columns() == expected.to_columns()
+
+    def test_view_set_sort_rejects_hidden_column(self):
+        data = {"a": [1, 2, 3, 4], "b": ["x", "y", "x", "y"], "c": [4, 3, 2, 1]}
+        tbl = Table(data)
+        view = tbl.view(group_by=["b"], columns=["a"], sort=[["a", "desc"]])
+        before = view.to_columns()
+        assert not view.set_sort([["c", "asc"]])
+        assert not view.set_sort([])
+        assert view.get_config()["sort"] == [["a", "desc"]]
+        assert view.to_columns() == before
+
+    # to_arrow_stream
+
+    def _stream_ids(self, stream):
+        return [Table(chunk).view().to_columns()["id"] for chunk in stream]
+
+    def test_view_to_arrow_stream_chunk_boundaries(self):
+        tbl = Table({"id": list(range(10))}, index="id")
+        view = tbl.view()
+        assert self._stream_ids(view.to_arrow_stream(4)) == [
+            [0, 1, 2, 3],
+            [4, 5, 6, 7],
+            [8, 9],
+        ]
+        assert len(self._stream_ids(view.to_arrow_stream(5))) == 2
+        ids = self._stream_ids(view.to_arrow_stream(2, start_row=3, end_row=8))
+        assert ids == [[3, 4], [5, 6], [7]]
+
+    def test_view_to_arrow_stream_zero_chunk_rows(self):
+        tbl = Table({"id": list(range(10))}, index="id")
+        view = tbl.view()
+        assert self._stream_ids(view.to_arrow_stream()) == [list(range(10))]
+        assert self._stream_ids(view.to_arrow_stream(0)) == [list(range(10))]
+
+    def test_view_to_arrow_stream_empty_view(self):
+        tbl = Table({"id": list(range(10))}, index="id")
+        view = tbl.view(filter=[["id", ">", 100]])
+        stream = view.to_arrow_stream(4)
+        assert Table(stream.next()).size() == 0
+        assert stream.next() is None
+
+    def test_view_to_arrow_stream_view_changes(self):
+        tbl = Table({"id": list(range(10))}, index="id")
+        view = tbl.view()
+        stream = view.to_arrow_stream(4)
+        stream.next()
+        tbl.update({"id": [10, 11]})
+        assert self._stream_ids(stream) == [[4, 5, 6, 7], [8, 9, 10, 11]]
+
+        stream = view.to_arrow_stream(4)
+        stream.next()
+        tbl.remove(list(range(4, 12)))
+        assert stream.next() is None
+
+        stream = view.to_arrow_stream(2)
+        stream.next()
+        view.delete()
+        assert stream.next() is None
+
+    def test_view_to_arrow_stream_cancel(self):
+        tbl = Table({"id": list(range(10))}, index="id")
+        view = tbl.view()
+        stream = view.to_arrow_stream(4)
+        stream.next()
+        stream.cancel()
+        assert stream.next() is None
+        stream.cancel()
+        assert sum(self._stream_ids(view.to_arrow_stream(4)), []) == list(range(10))
+
+    def test_view_to_csv_stream(self):
+        tbl = Table({"id": list(range(10))}, index="id")
+        view = tbl.view()
+        chunks = list(view.to_csv_stream(3))
+        assert len(chunks) == 4
+        assert chunks[0].startswith('"id"')
+        assert not any('"id"' in chunk for chunk in chunks[1:])
+        assert "".join(chunks) == view.to_csv()
+
     # view config validation
 
     def test_invalid_column_should_throw(self):
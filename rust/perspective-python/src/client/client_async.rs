@@ -18,8 +18,8 @@ use std::sync::Arc;
 use futures::FutureExt;
 use perspective_client::{
     Client, ColumnWindow, DeleteOptions, OnUpdateData, OnUpdateMode, OnUpdateOptions, Table,
-    TableData, TableInitOptions, TableReadFormat, UpdateData, UpdateOptions, View, ViewWindow,
-    assert_table_api, assert_view_api, asyncfn,
+    TableData, TableInitOptions, TableReadFormat, UpdateData, UpdateOptions, View, ViewStream,
+    ViewWindow, assert_table_api, assert_view_api, asyncfn,
 };
 use pyo3::exceptions::PyValueError;
 use pyo3::prelude::*;
@@ -611,6 +611,41 @@ impl AsyncTable {
     }
 }
 
+/// A chunked export of an [`AsyncView`], from [`AsyncView::to_arrow_stream`]
+/// or [`AsyncView::to_csv_stream`]. Each chunk is read from the server when
+/// [`AsyncViewStream::next`] is called.
+#[pyclass]
+#[derive(Clone)]
+pub struct AsyncViewStream {
+    stream: Arc<async_lock::Mutex<ViewStream>>,
+    is_csv: bool,
+}
+
+#[pymethods]
+impl AsyncViewStream {
+    /// The next chunk of this export, as `bytes` of Arrow (or a CSV `str`),
+    /// or `None` once it is complete.
+    pub async fn next(&self) -> PyResult<Option<Py<PyAny>>> {
+        let chunk = self.stream.lock().await.next().await.into_pyerr()?;
+        Ok(chunk.map(|chunk| {
+            Python::with_gil(|py| {
+                if self.is_csv {
+                    PyString::new(py, &String::from_utf8_lossy(&chunk))
+                        .into_any()
+                        .unbind()
+                } else {
+                    PyBytes::new(py, &chunk).into_any().unbind()
+                }
+            })
+        }))
+    }
+
+    /// Stop this export before it is complete.
+    pub async fn cancel(&self) -> PyResult<()> {
+        self.stream.lock().await.cancel().await.into_pyerr()
+    }
+}
+
 /// The [`View`] struct is Perspective's query and serialization interface. It
 /// represents a query on the `Table`'s dataset and is always created from an
 /// existing `Table` instance via the [`Table::view`] method.
@@ -677,6 +712,19 @@ impl AsyncView {
         Python::with_gil(|py| Ok(pythonize::pythonize(py, &dim)?.unbind()))
     }
 
+    pub async fn profile(&self) -> PyResult<Py<PyAny>> {
+        let profile = self.view.profile().await.into_pyerr()?;
+        Python::with_gil(|py| Ok(pythonize::pythonize(py, &profile)?.unbind()))
+    }
+
+    /// Replace this [`View`]'s `sort` in place, returning `False` if it
+    /// could not be applied without creating a new [`View`]. See
+    /// [`perspective_client::View::set_sort`] for details.
+    pub async fn set_sort(&self, sort: Py<PyAny>) -> PyResult<bool> {
+        let sort = Python::with_gil(|py| depythonize(sort.bind(py)))?;
+        self.view.set_sort(sort).await.into_pyerr()
+    }
+
     pub async fn expand(&self, index: u32) -> PyResult<u32> {
         self.view.expand(index).await.into_pyerr()
     }
@@ -779,8 +827,18 @@ impl AsyncView {
     /// - `options` - If this is provided as `OnUpdateOptions { mode:
     ///   Some(OnUpdateMode::Row) }`, then `delta` is an Arrow of the updated
     ///   rows. Otherwise `delta` will be [`Option::None`].
-    #[pyo3(signature=(callback, mode=None))]
-    pub async fn on_update(&self, callback: Py<PyAny>, mode: Option<String>) -> PyResult<u32> {
+    /// - `conflate` - Don't send an update until `callback` has returned from
+    ///   the previous one, merging the updates in between into one.
+    /// - `min_interval_ms` - Don't send updates more often than this, merging
+    ///   the updates in between into one.
+    #[pyo3(signature=(callback, mode=None, conflate=None, min_interval_ms=None))]
+    pub async fn on_update(
+        &self,
+        callback: Py<PyAny>,
+        mode: Option<String>,
+        conflate: Option<bool>,
+        min_interval_ms: Option<u32>,
+    ) -> PyResult<u32> {
         let callback = move |x: OnUpdateData| {
             let callback = Python::with_gil(|py| Py::clone_ref(&callback, py));
             async move {
@@ -811,7 +869,12 @@ impl AsyncView {
             .into_pyerr()?;
 
         self.view
-            .on_update(Box::new(callback), OnUpdateOptions { mode })
+            .on_update(Box::new(callback), OnUpdateOptions {
+                mode,
+                conflate,
+                min_interval_ms,
+                ..OnUpdateOptions::default()
+            })
             .await
             .into_pyerr()
     }
@@ -854,6 +917,31 @@ impl AsyncView {
         Ok(Python::with_gil(|py| PyBytes::new(py, &arrow).into()))
     }
 
+    /// Serializes a [`View`] to the Apache Arrow data format, in chunks of
+    /// `chunk_rows` rows (or one chunk if `0`), each a complete Arrow IPC
+    /// stream. See [`View::to_arrow_stream`] for details.
+    #[pyo3(signature=(chunk_rows=0, **window))]
+    pub async fn to_arrow_stream(
+        &self,
+        chunk_rows: u32,
+        window: Option<Py<PyDict>>,
+    ) -> PyResult<AsyncViewStream> {
+        let window: ViewWindow = Python::with_gil(|py| window.map(|x| depythonize(x.bind(py))))
+            .transpose()?
+            .unwrap_or_default();
+
+        let stream = self
+            .view
+            .to_arrow_stream(window, chunk_rows)
+            .await
+            .into_pyerr()?;
+
+        Ok(AsyncViewStream {
+            stream: Arc::new(async_lock::Mutex::new(stream)),
+            is_csv: false,
+        })
+    }
+
     /// Serializes this [`View`] to CSV data in a standard format.
     #[pyo3(signature=(**window))]
     pub async fn to_csv(&self, window: Option<Py<PyDict>>) -> PyResult<String> {
@@ -864,6 +952,31 @@ impl AsyncView {
         self.view.to_csv(window).await.into_pyerr()
     }
 
+    /// Serializes this [`View`] to CSV data in a standard format, in chunks
+    /// of `chunk_rows` rows (or one chunk if `0`). Only the first chunk has
+    /// a header row.
+    #[pyo3(signature=(chunk_rows=0, **window))]
+    pub async fn to_csv_stream(
+        &self,
+        chunk_rows: u32,
+        window: Option<Py<PyDict>>,
+    ) -> PyResult<AsyncViewStream> {
+        let window: ViewWindow = Python::with_gil(|py| window.map(|x| depythonize(x.bind(py))))
+            .transpose()?
+            .unwrap_or_default();
+
+        let stream = self
+            .view
+            .to_csv_stream(window, chunk_rows)
+            .await
+            .into_pyerr()?;
+
+        Ok(AsyncViewStream {
+            stream: Arc::new(async_lock::Mutex::new(stream)),
+            is_csv: true,
+        })
+    }
+
     /// Serializes this [`View`] to a string of JSON data. Useful if you want to
     /// save additional round trip serialize/deserialize cycles.
     #[pyo3(signature=(**window))]
@@ -450,6 +450,42 @@ impl Table {
     }
 }
 
+/// A chunked export of a [`View`], from [`View::to_arrow_stream`] or
+/// [`View::to_csv_stream`]. Each chunk is read from the server when
+/// [`ViewStream::next`] is called, or when iterating the [`ViewStream`].
+#[pyclass(name = "ViewStream", module = "perspective")]
+pub struct ViewStream(AsyncViewStream);
+
+#[pymethods]
+impl ViewStream {
+    #[new]
+    fn new() -> PyResult<Self> {
+        Err(PyTypeError::new_err(
+            "Do not call ViewStream's constructor directly, construct from View.to_arrow_stream() \
+             or View.to_csv_stream() instead.",
+        ))
+    }
+
+    /// The next chunk of this export, as `bytes` of Arrow (or a CSV `str`),
+    /// or `None` once it is complete.
+    pub fn next(&self, py: Python<'_>) -> PyResult<Option<Py<PyAny>>> {
+        self.0.next().py_block_on(py)
+    }
+
+    /// Stop this export before it is complete.
+    pub fn cancel(&self, py: Python<'_>) -> PyResult<()> {
+        self.0.cancel().py_block_on(py)
+    }
+
+    fn __iter__(slf: PyRef<'_, Self>) -> PyRef<'_, Self> {
+        slf
+    }
+
+    fn __next__(&self, py: Python<'_>) -> PyResult<Option<Py<PyAny>>> {
+        self.next(py)
+    }
+}
+
 /// The [`View`] struct is Perspective's query and serialization interface. It
 /// represents a query on the `Table`'s dataset and is always created from an
 /// existing `Table` instance via the [`Table::view`] method.
@@ -560,6 +596,21 @@ impl View {
         self.0.to_csv(window).py_block_on(py)
     }
 
+    /// Renders this [`View`] as CSV in a standard format, in chunks of
+    /// `chunk_rows` rows (or one chunk if `0`). Only the first chunk has a
+    /// header row. See [`View::to_arrow_stream`] for details.
+    #[pyo3(signature = (chunk_rows=0, **window))]
+    pub fn to_csv_stream(
+        &self,
+        py: Python<'_>,
+        chunk_rows: u32,
+        window: Option<Py<PyDict>>,
+    ) -> PyResult<ViewStream> {
+        Ok(ViewStream(
+            self.0.to_csv_stream(chunk_rows, window).py_block_on(py)?,
+        ))
+    }
+
     /// Renders this [`View`] as a `pandas.DataFrame`.
     #[pyo3(signature = (**window))]
     // #[deprecated(since="3.2.0", note="Please use `View::to_pandas`")]
@@ -589,6 +640,27 @@ impl View {
         self.0.to_arrow(window).py_block_on(py)
     }
 
+    /// Renders this [`View`] as the Apache Arrow data format, in chunks of
+    /// `chunk_rows` rows (or one chunk if `0`), each a complete Arrow IPC
+    /// stream. Memory use is proportional to `chunk_rows` rather than to
+    /// `window`, and each chunk reflects the [`View`] when it is read.
+    ///
+    /// # Arguments
+    ///
+    /// - `chunk_rows` - The number of rows per chunk.
+    /// - `window` - a [`ViewWindow`]
+    #[pyo3(signature = (chunk_rows=0, **window))]
+    pub fn to_arrow_stream(
+        &self,
+        py: Python<'_>,
+        chunk_rows: u32,
+        window: Option<Py<PyDict>>,
+    ) -> PyResult<ViewStream> {
+        Ok(ViewStream(
+            self.0.to_arrow_stream(chunk_rows, window).py_block_on(py)?,
+        ))
+    }
+
     /// Delete this [`View`] and clean up all resources associated with it.
     /// [`View`] objects do not stop consuming resources or processing
     /// updates when they are garbage collected - you must call this method
@@ -597,6 +669,13 @@ impl View {
         self.0.delete().py_block_on(py)
     }
 
+    /// Replace this [`View`]'s `sort` in place, returning `False` if it
+    /// could not be applied without creating a new [`View`]. See
+    /// [`perspective_client::View::set_sort`] for details.
+    pub fn set_sort(&self, py: Python<'_>, sort: Py<PyAny>) -> PyResult<bool> {
+        self.0.set_sort(sort).py_block_on(py)
+    }
+
     pub fn expand(&self, py: Python<'_>, index: u32) -> PyResult<u32> {
         self.0.expand(index).py_block_on(py)
     }
@@ -624,6 +703,13 @@ impl View {
         self.0.dimensions().py_block_on(py)
     }
 
+    /// A report of the work this [`View`] does to build and update itself,
+    /// for finding which part of its config makes it slow. See
+    /// [`perspective_client::View::profile`] for details.
+    pub fn profile(&self, py: Python<'_>) -> PyResult<Py<PyAny>> {
+        self.0.profile().py_block_on(py)
+    }
+
     /// The expression schema of this [`View`], which contains only the
     /// expressions created on this [`View`]. See [`View::schema`] for
     /// details.
@@ -694,14 +780,22 @@ impl View {
     /// - `options` - If this is provided as `OnUpdateOptions { mode:
     ///   Some(OnUpdateMode::Row) }`, then `delta` is an Arrow of the updated
     ///   rows. Otherwise `delta` will be [`Option::None`].
-    #[pyo3(signature = (callback, mode=None))]
+    /// - `conflate` - Don't send an update until `callback` has returned from
+    ///   the previous one, merging the updates in between into one.
+    /// - `min_interval_ms` - Don't send updates more often than this, merging
+    ///   the updates in between into one.
+    #[pyo3(signature = (callback, mode=None, conflate=None, min_interval_ms=None))]
     pub fn on_update(
         &self,
         py: Python<'_>,
         callback: Py<PyAny>,
         mode: Option<String>,
+        conflate: Option<bool>,
+        min_interval_ms: Option<u32>,
     ) -> PyResult<u32> {
-        self.0.on_update(callback, mode).py_block_on(py)
+        self.0
+            .on_update(callback, mode, conflate, min_interval_ms)
+            .py_block_on(py)
     }
 
     /// Unregister a previously registered update callback with this [`View`].
@@ -67,9 +67,11 @@ fn perspective(py: Python, m: &Bound<PyModule>) -> PyResult<()> {
     m.add_class::<server::PyAsyncSession>()?;
     m.add_class::<client::client_sync::Table>()?;
     m.add_class::<client::client_sync::View>()?;
+    m.add_class::<client::client_sync::ViewStream>()?;
     m.add_class::<client::client_async::AsyncClient>()?;
     m.add_class::<client::client_async::AsyncTable>()?;
     m.add_class::<client::client_async::AsyncView>()?;
+    m.add_class::<client::client_async::AsyncViewStream>()?;
     m.add_class::<client::proxy_session::ProxySession>()?;
     m.add("PerspectiveError", py.get_type::<PyPerspectiveError>())?;
     m.add_function(wrap_pyfunction!(num_cpus, m)?)?;
@@ -92,4 +92,13 @@ impl AsyncServer {
         }))
         .await
     }
+
+    /// The number of seconds until [`AsyncServer::poll`] has deferred work to
+    /// do which no request will trigger (a coalescing window which closes,
+    /// or an `on_update` held back by `min_interval_ms`), or `None`. Hosts
+    /// which use either should schedule a `poll()` this far in the future,
+    /// e.g. with `loop.call_later`.
+    pub fn poll_timeout(&self) -> Option<f64> {
+        self.server.poll_timeout().map(|x| x.as_secs_f64())
+    }
 }
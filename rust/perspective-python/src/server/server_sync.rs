@@ -67,6 +67,18 @@ impl Server {
         }
     }
 
+    /// Set the number of threads [`Server::poll`] may use to process updated
+    /// [`Table`]s concurrently. Responses (and `on_update` callbacks) are
+    /// emitted in the same order regardless of thread count.
+    ///
+    /// # Arguments
+    ///
+    /// - `num_threads` - `0` uses every thread in the shared CPU pool, `1` (the
+    ///   default) processes tables serially.
+    pub fn set_num_poll_threads(&self, num_threads: u32) {
+        self.server.set_num_poll_threads(num_threads)
+    }
+
     /// Create a new [`Client`] instance bound to this [`Server`] directly.
     pub fn new_local_client(&self) -> PyResult<crate::client::client_sync::Client> {
         let client = crate::client::client_sync::Client(AsyncClient::new_from_client(
@@ -123,4 +135,12 @@ impl Server {
                 .map_err(|e| PyValueError::new_err(format!("{e}")))
         })
     }
+
+    /// The number of seconds until [`Server::poll`] has deferred work to do
+    /// which no request will trigger (a coalescing window which closes, or an
+    /// `on_update` held back by `min_interval_ms`), or `None`. Hosts which
+    /// use either should schedule a `poll()` this far in the future.
+    pub fn poll_timeout(&self) -> Option<f64> {
+        self.server.poll_timeout().map(|x| x.as_secs_f64())
+    }
 }
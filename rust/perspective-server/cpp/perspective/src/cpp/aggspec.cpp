@@ -287,6 +287,13 @@ get_simple_accumulator_type(t_dtype coltype) {
     return DTYPE_NONE;
 }
 
+t_aggspec
+t_aggspec::with_name(const std::string& name) const {
+    t_aggspec rval(*this);
+    rval.m_name = name;
+    return rval;
+}
+
 t_sorttype
 t_aggspec::get_sort_type() const {
     return m_sort_type;
@@ -260,7 +260,7 @@ ArrowLoader::fill_table(
                 fill_column(
                     tbl, pkey_col_sptr, name, cidx, type, raw_type, is_update
                 );
-                tbl.clone_column("psp_pkey", "psp_okey");
+                tbl.alias_column("psp_pkey", "psp_okey");
                 // continue;
             } else {
                 auto col = tbl.get_column(name);
@@ -290,8 +290,8 @@ ArrowLoader::fill_table(
                 PSP_COMPLAIN_AND_ABORT(ss.str());
             }
 
-            tbl.clone_column(index, "psp_pkey");
-            tbl.clone_column(index, "psp_okey");
+            tbl.alias_column(index, "psp_pkey");
+            tbl.alias_column(index, "psp_okey");
         }
     }
 }
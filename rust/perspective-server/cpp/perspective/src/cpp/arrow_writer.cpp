@@ -72,6 +72,123 @@ get_scalar<bool>(t_tscalar& t) {
     return t.get<bool>();
 }
 
+// The end-of-stream marker: a continuation token and a zero metadata length.
+static const char END_OF_STREAM[8] = {
+    '\xff', '\xff', '\xff', '\xff', '\0', '\0', '\0', '\0'
+};
+
+/**
+ * @brief Wrap `stream` in a `BufferReader` without copying it; the reader
+ * must not outlive `stream`.
+ */
+static std::shared_ptr<arrow::io::BufferReader>
+wrap_stream(const std::string& stream) {
+    auto buffer = std::make_shared<arrow::Buffer>(
+        reinterpret_cast<const std::uint8_t*>(stream.data()),
+        static_cast<std::int64_t>(stream.size())
+    );
+
+    return std::make_shared<arrow::io::BufferReader>(buffer);
+}
+
+/**
+ * @brief Read the schema message at the start of `stream`, setting `size` to
+ * its length in bytes.
+ */
+static std::unique_ptr<arrow::ipc::Message>
+read_schema_message(const std::string& stream, std::int64_t& size) {
+    auto reader = wrap_stream(stream);
+    auto message = arrow::ipc::ReadMessage(reader.get());
+    PSP_CHECK_ARROW_STATUS(message.status());
+    auto position = reader->Tell();
+    PSP_CHECK_ARROW_STATUS(position.status());
+    size = *position;
+    return std::move(*message);
+}
+
+/**
+ * @brief Rewrite `head` as a stream of its own batches followed by those of
+ * `tail`; used when the two schemas are equal but not serialized alike.
+ */
+static void
+reencode_stream(
+    std::string& head,
+    const std::string& tail,
+    const std::shared_ptr<arrow::Schema>& schema
+) {
+    auto head_reader = arrow::ipc::RecordBatchStreamReader::Open(
+        wrap_stream(head)
+    );
+    PSP_CHECK_ARROW_STATUS(head_reader.status());
+    auto tail_reader = arrow::ipc::RecordBatchStreamReader::Open(
+        wrap_stream(tail)
+    );
+    PSP_CHECK_ARROW_STATUS(tail_reader.status());
+
+    auto allocated = arrow::AllocateResizableBuffer(0);
+    PSP_CHECK_ARROW_STATUS(allocated.status());
+    std::shared_ptr<arrow::ResizableBuffer> buffer = std::move(*allocated);
+    arrow::io::BufferOutputStream sink(buffer);
+
+    // The streams' dictionaries differ, so the writer emits a replacement
+    // dictionary before the first batch of `tail`.
+    auto options = arrow::ipc::IpcWriteOptions::Defaults();
+    options.use_threads = false;
+    auto writer = arrow::ipc::MakeStreamWriter(&sink, schema, options);
+    PSP_CHECK_ARROW_STATUS(writer.status());
+    for (auto* reader : {head_reader->get(), tail_reader->get()}) {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        PSP_CHECK_ARROW_STATUS(reader->ReadNext(&batch));
+        while (batch != nullptr) {
+            PSP_CHECK_ARROW_STATUS((*writer)->WriteRecordBatch(*batch));
+            PSP_CHECK_ARROW_STATUS(reader->ReadNext(&batch));
+        }
+    }
+
+    PSP_CHECK_ARROW_STATUS((*writer)->Close());
+    PSP_CHECK_ARROW_STATUS(sink.Close());
+    head = buffer->ToString();
+}
+
+bool
+append_stream(std::string& head, const std::string& tail) {
+    std::int64_t head_schema_size = 0;
+    std::int64_t tail_schema_size = 0;
+    auto head_schema = read_schema_message(head, head_schema_size);
+    auto tail_schema = read_schema_message(tail, tail_schema_size);
+    if (head_schema == nullptr || tail_schema == nullptr) {
+        return false;
+    }
+
+    // Streams written for the same view begin with the same schema message
+    // and number their dictionaries alike, so the messages of `tail` after
+    // its schema replace `head`'s end-of-stream marker as they are, without
+    // decoding `head`. A dictionary batch of `tail` then replaces the one in
+    // `head` for the batches which follow it.
+    const auto eos_size = sizeof(END_OF_STREAM);
+    if (head_schema->Equals(*tail_schema) && head.size() >= eos_size
+        && head.compare(
+               head.size() - eos_size, eos_size, END_OF_STREAM, eos_size
+           ) == 0) {
+        head.resize(head.size() - eos_size);
+        head.append(tail, static_cast<std::size_t>(tail_schema_size));
+        return true;
+    }
+
+    arrow::ipc::DictionaryMemo head_memo;
+    arrow::ipc::DictionaryMemo tail_memo;
+    auto head_result = arrow::ipc::ReadSchema(*head_schema, &head_memo);
+    PSP_CHECK_ARROW_STATUS(head_result.status());
+    auto tail_result = arrow::ipc::ReadSchema(*tail_schema, &tail_memo);
+    PSP_CHECK_ARROW_STATUS(tail_result.status());
+    if (!(*head_result)->Equals(**tail_result)) {
+        return false;
+    }
+
+    reencode_stream(head, tail, *head_result);
+    return true;
+}
+
 // std::int32_t
 // get_idx(std::int32_t cidx, std::int32_t ridx, std::int32_t stride,
 //     t_get_data_extents extents) {
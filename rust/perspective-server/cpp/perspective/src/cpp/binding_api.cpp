@@ -16,6 +16,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <string>
+#include <string_view>
 #include <tsl/hopscotch_map.h>
 #include <arrow/util/thread_pool.h>
 
@@ -46,18 +47,23 @@ struct EncodedApiEntries {
 
 void
 encode_api_response(
-    const ProtoServerResp<std::string>& msg, EncodedApiResp* encoded
+    const ProtoServerResp<ProtoServer::Response>& msg, EncodedApiResp* encoded
 ) {
-    auto* data = static_cast<char*>(UNINSTRUMENTED_MALLOC(msg.data.size()));
-    std::copy(msg.data.begin(), msg.data.end(), data);
+    // Serialize directly into the buffer handed to the caller, rather than
+    // into a `std::string` which would then need to be copied.
+    const auto size = msg.data.ByteSizeLong();
+    auto* data = static_cast<std::uint8_t*>(UNINSTRUMENTED_MALLOC(size));
+    msg.data.SerializeWithCachedSizesToArray(data);
 
     encoded->data = data;
-    encoded->size = msg.data.size();
+    encoded->size = size;
     encoded->client_id = msg.client_id;
 }
 
 EncodedApiEntries*
-encode_api_responses(const std::vector<ProtoServerResp<std::string>>& msgs) {
+encode_api_responses(
+    const std::vector<ProtoServerResp<ProtoServer::Response>>& msgs
+) {
     auto* encoded = static_cast<EncodedApiEntries*>(
         UNINSTRUMENTED_MALLOC(sizeof(EncodedApiEntries))
     );
@@ -82,6 +88,31 @@ psp_new_server(bool realtime_mode) {
     return new ProtoServer(realtime_mode);
 }
 
+PERSPECTIVE_EXPORT
+void
+psp_set_num_poll_threads(ProtoServer* server, std::uint32_t num_threads) {
+    server->set_num_poll_threads(num_threads);
+}
+
+PERSPECTIVE_EXPORT
+void
+psp_set_table_coalesce_policy(
+    ProtoServer* server,
+    char* table_id_ptr,
+    std::size_t table_id_len,
+    std::uint32_t max_latency_ms,
+    std::uint64_t max_rows
+) {
+    std::string table_id(table_id_ptr, table_id_len);
+    server->set_table_coalesce_policy(table_id, max_latency_ms, max_rows);
+}
+
+PERSPECTIVE_EXPORT
+void
+psp_set_lazy_views(ProtoServer* server, bool lazy) {
+    server->set_lazy_views(lazy);
+}
+
 PERSPECTIVE_EXPORT
 EncodedApiEntries*
 psp_handle_request(
@@ -90,18 +121,25 @@ psp_handle_request(
     char* msg_ptr,
     std::size_t msg_len
 ) {
-    std::string msg(msg_ptr, msg_len);
-    auto msgs = server->handle_request(client_id, msg);
+    // Parsed straight from the caller's buffer, which outlives this call.
+    std::string_view msg(msg_ptr, msg_len);
+    auto msgs = server->handle_request_messages(client_id, msg);
     return encode_api_responses(msgs);
 }
 
 PERSPECTIVE_EXPORT
 EncodedApiEntries*
 psp_poll(ProtoServer* server) {
-    auto responses = server->poll();
+    auto responses = server->poll_messages();
     return encode_api_responses(responses);
 }
 
+PERSPECTIVE_EXPORT
+std::int32_t
+psp_poll_timeout(ProtoServer* server) {
+    return server->get_poll_timeout_ms();
+}
+
 PERSPECTIVE_EXPORT
 std::uint32_t
 psp_new_session(ProtoServer* server) {
@@ -158,4 +196,20 @@ psp_set_num_cpus(std::int32_t num_cpus) {
     arrow::SetCpuThreadPoolCapacity(num_cpus);
 }
 
+PERSPECTIVE_EXPORT
+bool
+psp_set_table_tree_options(
+    ProtoServer* server,
+    char* table_id_ptr,
+    std::size_t table_id_len,
+    std::uint32_t strand_direct_apply_max_cost,
+    std::uint32_t index_max_entries
+) {
+    std::string table_id(table_id_ptr, table_id_len);
+    perspective::t_stree_options options;
+    options.m_strand_direct_apply_max_cost = strand_direct_apply_max_cost;
+    options.m_index_max_entries = index_max_entries;
+    return server->set_table_tree_options(table_id, options);
+}
+
 } // end extern "C"
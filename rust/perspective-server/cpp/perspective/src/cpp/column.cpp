@@ -558,6 +558,13 @@ t_column::get_nth_status(t_uindex idx) const {
     return status;
 }
 
+t_status*
+t_column::get_nth_status(t_uindex idx) {
+    PSP_VERBOSE_ASSERT(is_status_enabled(), "Status not available for column");
+    COLUMN_CHECK_ACCESS(idx);
+    return m_status->get_nth<t_status>(idx);
+}
+
 bool
 t_column::is_valid(t_uindex idx) const {
     PSP_VERBOSE_ASSERT(is_status_enabled(), "Status not available for column");
@@ -94,7 +94,60 @@ t_computed_expression::t_computed_expression(
     m_expression_string(std::move(expression_string)),
     m_parsed_expression_string(std::move(parsed_expression_string)),
     m_column_ids(column_ids),
-    m_dtype(dtype) {}
+    m_dtype(dtype),
+    m_is_row_local(true) {
+    // Functions whose result depends on other rows, on columns not named in
+    // `m_column_ids`, or on something other than the row's values.
+    static const tsl::hopscotch_set<std::string> NON_ROW_LOCAL_FUNCTIONS = {
+        "order", "index", "col", "vlookup", "random", "today", "now"
+    };
+
+    const std::string& expr = m_parsed_expression_string;
+    bool in_string = false;
+    for (t_uindex idx = 0; idx < expr.size(); ++idx) {
+        char c = expr[idx];
+        if (in_string) {
+            if (c == '\\') {
+                ++idx;
+            } else if (c == '\'') {
+                in_string = false;
+            }
+
+            continue;
+        }
+
+        if (c == '\'') {
+            in_string = true;
+            continue;
+        }
+
+        if (std::isalpha(static_cast<unsigned char>(c)) == 0 && c != '_') {
+            continue;
+        }
+
+        t_uindex end = idx;
+        while (end < expr.size()
+               && (std::isalnum(static_cast<unsigned char>(expr[end])) != 0
+                   || expr[end] == '_')) {
+            ++end;
+        }
+
+        std::string identifier = expr.substr(idx, end - idx);
+        idx = end - 1;
+
+        t_uindex next = end;
+        while (next < expr.size()
+               && std::isspace(static_cast<unsigned char>(expr[next])) != 0) {
+            ++next;
+        }
+
+        if (next < expr.size() && expr[next] == '('
+            && NON_ROW_LOCAL_FUNCTIONS.count(identifier) != 0) {
+            m_is_row_local = false;
+            break;
+        }
+    }
+}
 
 void
 t_computed_expression::compute(
@@ -103,6 +156,48 @@ t_computed_expression::compute(
     const std::shared_ptr<t_data_table>& destination_table,
     t_expression_vocab& vocab,
     t_regex_mapping& regex_mapping
+) const {
+    compute_rows(
+        source_table,
+        pkey_map,
+        destination_table,
+        nullptr,
+        vocab,
+        regex_mapping
+    );
+}
+
+void
+t_computed_expression::compute(
+    const std::shared_ptr<t_data_table>& source_table,
+    const t_gstate::t_mapping& pkey_map,
+    const std::shared_ptr<t_data_table>& destination_table,
+    const std::vector<t_uindex>& row_indices,
+    t_expression_vocab& vocab,
+    t_regex_mapping& regex_mapping
+) const {
+    PSP_VERBOSE_ASSERT(
+        m_is_row_local, "Cannot compute a subset of a non row-local expression"
+    );
+
+    compute_rows(
+        source_table,
+        pkey_map,
+        destination_table,
+        &row_indices,
+        vocab,
+        regex_mapping
+    );
+}
+
+void
+t_computed_expression::compute_rows(
+    const std::shared_ptr<t_data_table>& source_table,
+    const t_gstate::t_mapping& pkey_map,
+    const std::shared_ptr<t_data_table>& destination_table,
+    const std::vector<t_uindex>* row_indices,
+    t_expression_vocab& vocab,
+    t_regex_mapping& regex_mapping
 ) const {
     // TODO: share symtables across pre/re/compute
     exprtk::symbol_table<t_tscalar> sym_table;
@@ -159,7 +254,12 @@ t_computed_expression::compute(
     auto num_rows = source_table->size();
     output_column->reserve(num_rows);
 
-    for (t_uindex ridx = 0; ridx < num_rows; ++ridx) {
+    if (row_indices != nullptr) {
+        num_rows = row_indices->size();
+    }
+
+    for (t_uindex idx = 0; idx < num_rows; ++idx) {
+        t_uindex ridx = row_indices != nullptr ? (*row_indices)[idx] : idx;
         for (t_uindex cidx = 0; cidx < num_input_columns; ++cidx) {
             const std::string& column_id = m_column_ids[cidx].first;
             values[cidx].second.set(columns[column_id]->get_scalar(ridx));
@@ -204,6 +304,11 @@ t_computed_expression::get_dtype() const {
     return m_dtype;
 }
 
+bool
+t_computed_expression::is_row_local() const {
+    return m_is_row_local;
+}
+
 /******************************************************************************
  *
  * t_computed_expression_parser
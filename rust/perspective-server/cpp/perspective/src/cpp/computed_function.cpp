@@ -2337,8 +2337,9 @@ vlookup::operator()(t_parameter_list parameters) {
 }
 
 // Set up random number generator
-std::default_random_engine random::RANDOM_ENGINE = std::default_random_engine();
-std::uniform_real_distribution<double> random::DISTRIBUTION =
+thread_local std::default_random_engine random::RANDOM_ENGINE =
+    std::default_random_engine();
+thread_local std::uniform_real_distribution<double> random::DISTRIBUTION =
     std::uniform_real_distribution<double>(0, 1);
 
 random::random() : exprtk::igeneric_function<t_tscalar>("Z") {}
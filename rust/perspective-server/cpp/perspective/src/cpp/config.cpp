@@ -12,6 +12,7 @@
 
 #include <perspective/first.h>
 #include <perspective/config.h>
+#include <set>
 
 namespace perspective {
 
@@ -285,6 +286,44 @@ t_config::repr() const {
     return ss.str();
 }
 
+std::string
+t_config::get_tree_key() const {
+    std::stringstream ss;
+    ss << "rpivots:";
+    for (const auto& pivot : m_row_pivots) {
+        ss << pivot.colname() << ",";
+    }
+
+    ss << "|cpivots:";
+    for (const auto& pivot : m_col_pivots) {
+        ss << pivot.colname() << ",";
+    }
+
+    ss << "|sortby:";
+    for (const auto& iter : m_sortby) {
+        ss << iter.first << "=" << iter.second << ",";
+    }
+
+    ss << "|filters:" << m_fmode << "/" << m_combiner << "(";
+    for (const auto& fterm : m_fterms) {
+        ss << fterm.m_colname << " " << fterm.m_op << " " << fterm.m_negated
+           << " " << fterm.m_threshold.get_dtype() << ":"
+           << fterm.m_threshold.to_string(true) << " [";
+        for (const auto& value : fterm.m_bag) {
+            ss << value.get_dtype() << ":" << value.to_string(true) << ",";
+        }
+        ss << "],";
+    }
+
+    ss << ")|expressions:";
+    for (const auto& expression : m_expressions) {
+        ss << expression->get_expression_alias() << "="
+           << expression->get_expression_string() << ",";
+    }
+
+    return ss.str();
+}
+
 t_uindex
 t_config::get_num_aggregates() const {
     return m_aggregates.size();
@@ -349,6 +388,43 @@ t_config::get_column_names() const {
     return m_detail_columns;
 }
 
+std::vector<std::string>
+t_config::get_dependency_columns() const {
+    std::vector<std::string> rval{"psp_pkey", "psp_op"};
+    std::set<std::string> seen(rval.begin(), rval.end());
+
+    auto add_column = [&rval, &seen](const std::string& colname) {
+        if (!colname.empty() && seen.insert(colname).second) {
+            rval.push_back(colname);
+        }
+    };
+
+    for (const auto& pivot : get_pivots()) {
+        add_column(pivot.colname());
+        add_column(get_sort_by(pivot.colname()));
+    }
+
+    for (const auto& aggspec : m_aggregates) {
+        for (const auto& dep : aggspec.get_dependencies()) {
+            if (dep.type() == DEPTYPE_COLUMN) {
+                add_column(dep.name());
+            }
+        }
+    }
+
+    for (const auto& fterm : m_fterms) {
+        add_column(fterm.m_colname);
+    }
+
+    if (!m_child_pkey_column.empty()) {
+        add_column(m_child_pkey_column);
+        add_column(m_parent_pkey_column);
+        add_column(get_sort_by(m_child_pkey_column));
+    }
+
+    return rval;
+}
+
 t_uindex
 t_config::get_num_rpivots() const {
     return m_row_pivots.size();
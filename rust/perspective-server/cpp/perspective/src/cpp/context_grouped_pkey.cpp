@@ -214,7 +214,151 @@ t_ctx_grouped_pkey::notify(
 ) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    rebuild();
+
+    if (!update_in_place(flattened, prev, current, transitions, existed)) {
+        rebuild();
+    }
+}
+
+bool
+t_ctx_grouped_pkey::update_in_place(
+    const t_data_table& flattened,
+    const t_data_table& prev,
+    const t_data_table& current,
+    const t_data_table& transitions,
+    const t_data_table& existed
+) {
+    if (m_pkey_nidx.empty()) {
+        return false;
+    }
+
+    t_uindex nrecs = flattened.size();
+    std::shared_ptr<const t_column> pkey_sptr =
+        flattened.get_const_column("psp_pkey");
+    std::shared_ptr<const t_column> op_sptr =
+        flattened.get_const_column("psp_op");
+    std::shared_ptr<const t_column> existed_sptr =
+        existed.get_const_column("psp_existed");
+
+    const t_column* pkey_col = pkey_sptr.get();
+    const t_column* op_col = op_sptr.get();
+    const t_column* existed_col = existed_sptr.get();
+
+    // A node's position in the tree depends on its parent, its own child
+    // key and its sort value, so a change to any of these moves it.
+    std::string child_col_name = m_config.get_child_pkey_column();
+    std::vector<std::string> structural_colnames{
+        child_col_name,
+        m_config.get_parent_pkey_column(),
+        m_config.get_sort_by(child_col_name)
+    };
+
+    const t_schema& transitions_schema = transitions.get_schema();
+    std::vector<std::shared_ptr<const t_column>> structural_cols;
+    for (const auto& colname : structural_colnames) {
+        if (!transitions_schema.has_column(colname)) {
+            return false;
+        }
+
+        structural_cols.push_back(transitions.get_const_column(colname));
+    }
+
+    for (t_uindex idx = 0; idx < nrecs; ++idx) {
+        std::uint8_t op_ = *(op_col->get_nth<std::uint8_t>(idx));
+        if (static_cast<t_op>(op_) != OP_INSERT
+            || !*(existed_col->get_nth<bool>(idx))) {
+            return false;
+        }
+
+        for (const auto& col : structural_cols) {
+            auto trans = static_cast<t_value_transition>(
+                *(col->get_nth<std::uint8_t>(idx))
+            );
+
+            if (trans != VALUE_TRANSITION_EQ_TT
+                && trans != VALUE_TRANSITION_EQ_FF) {
+                return false;
+            }
+        }
+    }
+
+    if (m_config.has_filters()) {
+        t_mask msk_prev = filter_table_for_config(prev, m_config);
+        t_mask msk_curr = filter_table_for_config(current, m_config);
+
+        for (t_uindex idx = 0; idx < nrecs; ++idx) {
+            if (msk_prev.get(idx) != msk_curr.get(idx)) {
+                return false;
+            }
+        }
+    }
+
+    const t_schema& current_schema = current.get_schema();
+    auto* aggtable = m_tree->_get_aggtable();
+    auto aggspecs = m_config.get_aggregates();
+
+    // Only `AGGTYPE_IDENTITY` values can be written to a node without
+    // reading the rows beneath it.
+    std::vector<std::pair<t_column*, const t_column*>> value_cols;
+    for (const auto& spec : aggspecs) {
+        const std::string& colname = spec.get_first_depname();
+        if (spec.agg() != AGGTYPE_IDENTITY
+            || !current_schema.has_column(colname)) {
+            return false;
+        }
+
+        value_cols.emplace_back(
+            aggtable->get_column(colname).get(),
+            current.get_const_column(colname).get()
+        );
+    }
+
+    // The traversal is sorted by the values of these columns, so it must be
+    // re-sorted if any of them changed.
+    bool sorted_values_changed = false;
+    for (const auto& sortspec : m_sortby) {
+        if (sortspec.m_agg_index < 0
+            || sortspec.m_agg_index >= static_cast<t_index>(aggspecs.size())) {
+            continue;
+        }
+
+        const std::string& colname =
+            aggspecs[sortspec.m_agg_index].get_first_depname();
+        if (!transitions_schema.has_column(colname)) {
+            sorted_values_changed = true;
+            break;
+        }
+
+        const t_column* col = transitions.get_const_column(colname).get();
+        for (t_uindex idx = 0; idx < nrecs && !sorted_values_changed; ++idx) {
+            auto trans = static_cast<t_value_transition>(
+                *(col->get_nth<std::uint8_t>(idx))
+            );
+
+            sorted_values_changed = trans != VALUE_TRANSITION_EQ_TT
+                && trans != VALUE_TRANSITION_EQ_FF;
+        }
+    }
+
+    for (t_uindex idx = 0; idx < nrecs; ++idx) {
+        auto iter = m_pkey_nidx.find(pkey_col->get_scalar(idx));
+
+        // Rows which are filtered out, or unreachable from a root, have no
+        // node.
+        if (iter == m_pkey_nidx.end()) {
+            continue;
+        }
+
+        for (const auto& [dst, src] : value_cols) {
+            dst->set_scalar(iter->second, src->get_scalar(idx));
+        }
+    }
+
+    if (sorted_values_changed) {
+        m_traversal->sort_by(m_config, m_sortby, *this);
+    }
+
+    return true;
 }
 
 void
@@ -438,6 +582,7 @@ t_ctx_grouped_pkey::reset(bool reset_expressions) {
     m_tree->init();
     m_tree->set_deltas_enabled(get_feature_state(CTX_FEAT_DELTA));
     m_traversal = std::make_shared<t_traversal>(m_tree);
+    m_pkey_nidx.clear();
 
     if (reset_expressions) {
         m_expression_tables->reset();
@@ -475,7 +620,8 @@ rebuild_helper(t_column* /*unused*/) {}
 
 void
 t_ctx_grouped_pkey::rebuild() {
-    auto tbl = m_gstate->get_pkeyed_table();
+    auto tbl =
+        m_gstate->get_pkeyed_table(m_config.get_dependency_columns());
 
     if (m_config.has_filters()) {
         auto mask = filter_table_for_config(*tbl, m_config);
@@ -617,8 +763,10 @@ t_ctx_grouped_pkey::rebuild() {
             nidx, pidx, value, pnode.m_depth + 1, sortby_value, 1, nidx
         );
 
+        auto pkey = m_symtable.get_interned_tscalar(rec.m_pkey);
         m_tree->insert_node(node);
-        m_tree->add_pkey(nidx, m_symtable.get_interned_tscalar(rec.m_pkey));
+        m_tree->add_pkey(nidx, pkey);
+        m_pkey_nidx[pkey] = nidx;
 
         auto riter = p_range_map.find(rec.m_child);
 
@@ -714,117 +862,6 @@ t_ctx_grouped_pkey::get_column_dtype(t_uindex idx) const {
     return aggtable->get_const_column(idx - 1)->get_dtype();
 }
 
-void
-t_ctx_grouped_pkey::compute_expressions(
-    const std::shared_ptr<t_data_table>& master,
-    const t_gstate::t_mapping& pkey_map,
-    t_expression_vocab& expression_vocab,
-    t_regex_mapping& regex_mapping
-) {
-    // Clear the transitional expression tables on the context so they are
-    // ready for the next update.
-    m_expression_tables->clear_transitional_tables();
-
-    std::shared_ptr<t_data_table> master_expression_table =
-        m_expression_tables->m_master;
-
-    // Set the master table to the right size.
-    t_uindex num_rows = master->size();
-    master_expression_table->reserve(num_rows);
-    master_expression_table->set_size(num_rows);
-
-    const auto& expressions = m_config.get_expressions();
-    for (const auto& expr : expressions) {
-        // Compute the expressions on the master table.
-        expr->compute(
-            master,
-            pkey_map,
-            master_expression_table,
-            expression_vocab,
-            regex_mapping
-        );
-    }
-}
-
-void
-t_ctx_grouped_pkey::compute_expressions(
-    const std::shared_ptr<t_data_table>& master,
-    const t_gstate::t_mapping& pkey_map,
-    const std::shared_ptr<t_data_table>& flattened,
-    const std::shared_ptr<t_data_table>& delta,
-    const std::shared_ptr<t_data_table>& prev,
-    const std::shared_ptr<t_data_table>& current,
-    const std::shared_ptr<t_data_table>& transitions,
-    const std::shared_ptr<t_data_table>& existed,
-    t_expression_vocab& expression_vocab,
-    t_regex_mapping& regex_mapping
-) {
-    // Clear the tables so they are ready for this round of updates
-    m_expression_tables->clear_transitional_tables();
-
-    // All tables are the same size
-    t_uindex flattened_num_rows = flattened->size();
-    m_expression_tables->reserve_transitional_table_size(flattened_num_rows);
-    m_expression_tables->set_transitional_table_size(flattened_num_rows);
-
-    // Update the master expression table's size
-    t_uindex master_num_rows = master->size();
-    m_expression_tables->m_master->reserve(master_num_rows);
-    m_expression_tables->m_master->set_size(master_num_rows);
-
-    const auto& expressions = m_config.get_expressions();
-    for (const auto& expr : expressions) {
-        // master: compute based on latest state of the gnode state table
-        expr->compute(
-            master,
-            pkey_map,
-            m_expression_tables->m_master,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // flattened: compute based on the latest update dataset
-        expr->compute(
-            flattened,
-            pkey_map,
-            m_expression_tables->m_flattened,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // delta: for each numerical column, the numerical delta between the
-        // previous value and the current value in the row.
-        expr->compute(
-            delta,
-            pkey_map,
-            m_expression_tables->m_delta,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // prev: the values of the updated rows before this update was applied
-        expr->compute(
-            prev,
-            pkey_map,
-            m_expression_tables->m_prev,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // current: the current values of the updated rows
-        expr->compute(
-            current,
-            pkey_map,
-            m_expression_tables->m_current,
-            expression_vocab,
-            regex_mapping
-        );
-    }
-
-    // Calculate the transitions now that the intermediate tables are computed
-    m_expression_tables->calculate_transitions(existed);
-}
-
 t_uindex
 t_ctx_grouped_pkey::num_expressions() const {
     const auto& expressions = m_config.get_expressions();
@@ -31,7 +31,12 @@ namespace perspective {
 t_ctx1::t_ctx1(const t_schema& schema, const t_config& pivot_config) :
     t_ctxbase<t_ctx1>(schema, pivot_config),
     m_depth(0),
-    m_depth_set(false) {}
+    m_depth_set(false),
+    m_trees_shared(false),
+    m_tree_aggregates(pivot_config.get_aggregates()),
+    m_tree_aggidx(get_tree_aggregate_indices(
+        m_tree_aggregates, pivot_config.get_aggregates()
+    )) {}
 
 t_ctx1::~t_ctx1() = default;
 
@@ -39,7 +44,7 @@ void
 t_ctx1::init() {
     auto pivots = m_config.get_row_pivots();
     m_tree = std::make_shared<t_stree>(
-        pivots, m_config.get_aggregates(), m_schema, m_config
+        pivots, m_tree_aggregates, m_schema, m_config
     );
     m_tree->init();
     m_traversal = std::make_shared<t_traversal>(m_tree);
@@ -93,7 +98,9 @@ t_ctx1::open(t_index idx) {
         return 0;
     }
 
-    t_index retval = m_traversal->expand_node(m_sortby, idx);
+    t_index retval = m_traversal->expand_node(
+        get_tree_sortby(m_sortby, m_tree_aggidx), idx
+    );
     m_rows_changed = (retval > 0);
     return retval;
 }
@@ -118,12 +125,23 @@ t_ctx1::close(t_index idx) {
 std::pair<t_tscalar, t_tscalar>
 t_ctx1::get_min_max(const std::string& colname) const {
     auto rval = std::make_pair(mknone(), mknone());
-    auto* aggtable = m_tree->get_aggtable();
-    t_schema aggschema = aggtable->get_schema();
-    const auto* col = aggtable->get_const_column(colname).get();
-    auto colidx = aggschema.get_colidx(colname);
-    auto depth = m_config.get_num_rpivots();
     const std::vector<t_aggspec>& aggspecs = m_config.get_aggregates();
+    auto spec = std::find_if(
+        aggspecs.begin(),
+        aggspecs.end(),
+        [&colname](const t_aggspec& aggspec) {
+            return aggspec.name() == colname;
+        }
+    );
+
+    if (spec == aggspecs.end()) {
+        PSP_COMPLAIN_AND_ABORT("No aggregate column `" + colname + "`");
+    }
+
+    auto colidx = std::distance(aggspecs.begin(), spec);
+    const auto* col =
+        m_tree->get_aggtable()->get_const_column(m_tree_aggidx[colidx]).get();
+    auto depth = m_config.get_num_rpivots();
     bool is_finished = false;
     while (!is_finished && depth > 0) {
         for (std::size_t i = 0; i < m_traversal->size(); i++) {
@@ -186,7 +204,8 @@ t_ctx1::get_data(
 
     for (t_uindex aggidx = 0, loop_end = aggcols.size(); aggidx < loop_end;
          ++aggidx) {
-        const std::string& aggname = aggschema.m_columns[aggidx];
+        const std::string& aggname =
+            aggschema.m_columns[m_tree_aggidx[aggidx]];
         aggcols[aggidx] = aggtable->get_const_column(aggname).get();
     }
 
@@ -243,7 +262,8 @@ t_ctx1::get_data(const std::vector<t_uindex>& rows) const {
 
     for (t_uindex aggidx = 0, loop_end = aggcols.size(); aggidx < loop_end;
          ++aggidx) {
-        const std::string& aggname = aggschema.m_columns[aggidx];
+        const std::string& aggname =
+            aggschema.m_columns[m_tree_aggidx[aggidx]];
         aggcols[aggidx] = aggtable->get_const_column(aggname).get();
     }
 
@@ -294,9 +314,9 @@ t_ctx1::notify(const t_data_table& flattened) {
         m_tree,
         m_traversal,
         true,
-        m_config.get_aggregates(),
+        m_tree_aggregates,
         m_config.get_sortby_pairs(),
-        m_sortby,
+        get_tree_sortby(m_sortby, m_tree_aggidx),
         flattened,
         m_config,
         *m_gstate,
@@ -320,9 +340,9 @@ t_ctx1::notify(
         m_tree,
         m_traversal,
         true,
-        m_config.get_aggregates(),
+        m_tree_aggregates,
         m_config.get_sortby_pairs(),
-        m_sortby,
+        get_tree_sortby(m_sortby, m_tree_aggidx),
         flattened,
         delta,
         prev,
@@ -335,6 +355,78 @@ t_ctx1::notify(
     );
 }
 
+bool
+t_ctx1::shares_trees_with(const t_ctx1& ctx) const {
+    return m_tree == ctx.m_tree;
+}
+
+/**
+ * @brief Replace this context's tree with `ctx`'s, which computes at least
+ * this context's aggregates, and rebuild the traversal from the shared
+ * tree, keeping the rows expanded in the old one. Sort order and depth are
+ * re-applied by `step_end()`.
+ *
+ * @param ctx
+ */
+void
+t_ctx1::share_trees(const t_ctx1& ctx) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::vector<t_path> expanded;
+    if (!m_depth_set) {
+        expanded = ctx_get_expansion_state(m_tree, m_traversal);
+    }
+
+    m_tree = ctx.m_tree;
+    set_tree_aggregates(ctx.m_tree_aggregates);
+    if (get_feature_state(CTX_FEAT_DELTA)) {
+        m_tree->set_deltas_enabled(true);
+    }
+
+    m_traversal = std::make_shared<t_traversal>(m_tree);
+    ctx_set_expansion_state(*this, HEADER_ROW, m_tree, m_traversal, expanded);
+}
+
+/**
+ * @brief Update the traversal after another context sharing this
+ * context's tree has applied an update to it.
+ */
+void
+t_ctx1::notify_shared_trees() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    notify_sparse_traversal(
+        m_tree, m_traversal, get_tree_sortby(m_sortby, m_tree_aggidx)
+    );
+}
+
+void
+t_ctx1::set_trees_shared(bool shared) {
+    m_trees_shared = shared;
+}
+
+bool
+t_ctx1::get_trees_shared() const {
+    return m_trees_shared;
+}
+
+void
+t_ctx1::set_tree_aggregates(const std::vector<t_aggspec>& aggregates) {
+    m_tree_aggregates = aggregates;
+    m_tree_aggidx =
+        get_tree_aggregate_indices(aggregates, m_config.get_aggregates());
+    for (auto tree_aggidx : m_tree_aggidx) {
+        PSP_VERBOSE_ASSERT(
+            tree_aggidx != INVALID_INDEX, "Tree does not compute aggregate"
+        );
+    }
+}
+
+const std::vector<t_aggspec>&
+t_ctx1::get_tree_aggregates() const {
+    return m_tree_aggregates;
+}
+
 void
 t_ctx1::step_begin() {
     PSP_TRACE_SENTINEL();
@@ -406,7 +498,9 @@ t_ctx1::sort_by(const std::vector<t_sortspec>& sortby) {
     if (m_sortby.empty()) {
         return;
     }
-    m_traversal->sort_by(m_config, sortby, *(m_tree));
+    m_traversal->sort_by(
+        m_config, get_tree_sortby(sortby, m_tree_aggidx), *(m_tree)
+    );
 }
 
 void
@@ -418,7 +512,8 @@ t_ctx1::set_depth(t_depth depth) {
     }
     depth = std::min<t_depth>(m_config.get_num_rpivots() - 1, depth);
     t_index retval = 0;
-    retval = m_traversal->set_depth(m_sortby, depth);
+    retval =
+        m_traversal->set_depth(get_tree_sortby(m_sortby, m_tree_aggidx), depth);
     m_rows_changed = (retval > 0);
     m_depth = depth;
     m_depth_set = true;
@@ -465,7 +560,11 @@ t_ctx1::set_alerts_enabled(bool enabled_state) {
 void
 t_ctx1::set_deltas_enabled(bool enabled_state) {
     m_features[CTX_FEAT_DELTA] = enabled_state;
-    m_tree->set_deltas_enabled(enabled_state);
+
+    // Other contexts sharing the tree may still need its deltas.
+    if (enabled_state || !m_trees_shared) {
+        m_tree->set_deltas_enabled(enabled_state);
+    }
 }
 
 /**
@@ -485,7 +584,13 @@ t_ctx1::get_step_delta(t_index bidx, t_index eidx) {
     t_stepdelta rval(
         m_rows_changed, m_columns_changed, get_cell_delta(bidx, eidx)
     );
-    m_tree->clear_deltas();
+
+    // A shared tree's deltas are cleared by the `t_gnode` before each
+    // update instead, as every context sharing it reads the same deltas.
+    if (!m_trees_shared) {
+        m_tree->clear_deltas();
+    }
+
     return rval;
 }
 
@@ -503,7 +608,10 @@ t_ctx1::get_row_delta() {
     std::vector<t_uindex> rows = get_rows_changed();
     std::vector<t_tscalar> data = get_data(rows);
     t_rowdelta rval(m_rows_changed, rows.size(), data);
-    m_tree->clear_deltas();
+    if (!m_trees_shared) {
+        m_tree->clear_deltas();
+    }
+
     return rval;
 }
 
@@ -515,12 +623,18 @@ t_ctx1::get_rows_changed() {
 
     for (t_uindex idx = 0; idx < eidx; ++idx) {
         t_index ptidx = m_traversal->get_tree_index(idx);
-        // Retrieve delta from storage and check if the row has been changed
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(ptidx);
-        bool unique_ridx =
-            std::find(rows.begin(), rows.end(), idx) == rows.end();
-        if ((iterators.first != iterators.second) && unique_ridx) {
-            rows.push_back(idx);
+        // Retrieve delta from storage and check if the row has been changed,
+        // ignoring aggregates of a shared tree which this context does not
+        // show.
+        for (auto tree_aggidx : m_tree_aggidx) {
+            auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(
+                std::make_tuple(ptidx, tree_aggidx)
+            );
+
+            if (iterators.first != iterators.second) {
+                rows.push_back(idx);
+                break;
+            }
         }
     }
 
@@ -537,11 +651,19 @@ t_ctx1::get_cell_delta(t_index bidx, t_index eidx) const {
     const auto& deltas = m_tree->get_deltas();
     for (t_index idx = bidx; idx < eidx; ++idx) {
         t_index ptidx = m_traversal->get_tree_index(idx);
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(ptidx);
-        for (auto iter = iterators.first; iter != iterators.second; ++iter) {
-            rval.emplace_back(
-                idx, iter->m_aggidx + 1, iter->m_old_value, iter->m_new_value
+        for (t_uindex aggidx = 0, loop_end = m_tree_aggidx.size();
+             aggidx < loop_end;
+             ++aggidx) {
+            auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(
+                std::make_tuple(ptidx, m_tree_aggidx[aggidx])
             );
+
+            for (auto iter = iterators.first; iter != iterators.second;
+                 ++iter) {
+                rval.emplace_back(
+                    idx, aggidx + 1, iter->m_old_value, iter->m_new_value
+                );
+            }
         }
     }
     return rval;
@@ -551,7 +673,7 @@ void
 t_ctx1::reset(bool reset_expressions) {
     auto pivots = m_config.get_row_pivots();
     m_tree = std::make_shared<t_stree>(
-        pivots, m_config.get_aggregates(), m_schema, m_config
+        pivots, m_tree_aggregates, m_schema, m_config
     );
     m_tree->init();
     m_tree->set_deltas_enabled(get_feature_state(CTX_FEAT_DELTA));
@@ -606,7 +728,8 @@ t_ctx1::pprint() const {
 
     for (t_uindex aggidx = 0, loop_end = aggcols.size(); aggidx < loop_end;
          ++aggidx) {
-        const std::string& aggname = aggschema.m_columns[aggidx];
+        const std::string& aggname =
+            aggschema.m_columns[m_tree_aggidx[aggidx]];
         aggcols[aggidx] = aggtable->get_const_column(aggname).get();
     }
 
@@ -654,7 +777,9 @@ t_ctx1::get_column_dtype(t_uindex idx) const {
     if (idx == 0 || idx >= static_cast<t_uindex>(get_column_count())) {
         return DTYPE_NONE;
     }
-    return m_tree->get_aggtable()->get_const_column(idx - 1)->get_dtype();
+    return m_tree->get_aggtable()
+        ->get_const_column(m_tree_aggidx[idx - 1])
+        ->get_dtype();
 }
 
 t_depth
@@ -662,117 +787,6 @@ t_ctx1::get_trav_depth(t_index idx) const {
     return m_traversal->get_depth(idx);
 }
 
-void
-t_ctx1::compute_expressions(
-    const std::shared_ptr<t_data_table>& master,
-    const t_gstate::t_mapping& pkey_map,
-    t_expression_vocab& expression_vocab,
-    t_regex_mapping& regex_mapping
-) {
-    // Clear the transitional expression tables on the context so they are
-    // ready for the next update.
-    m_expression_tables->clear_transitional_tables();
-
-    std::shared_ptr<t_data_table> master_expression_table =
-        m_expression_tables->m_master;
-
-    // Set the master table to the right size.
-    t_uindex num_rows = master->size();
-    master_expression_table->reserve(num_rows);
-    master_expression_table->set_size(num_rows);
-
-    const auto& expressions = m_config.get_expressions();
-    for (const auto& expr : expressions) {
-        // Compute the expressions on the master table.
-        expr->compute(
-            master,
-            pkey_map,
-            master_expression_table,
-            expression_vocab,
-            regex_mapping
-        );
-    }
-}
-
-void
-t_ctx1::compute_expressions(
-    const std::shared_ptr<t_data_table>& master,
-    const t_gstate::t_mapping& pkey_map,
-    const std::shared_ptr<t_data_table>& flattened,
-    const std::shared_ptr<t_data_table>& delta,
-    const std::shared_ptr<t_data_table>& prev,
-    const std::shared_ptr<t_data_table>& current,
-    const std::shared_ptr<t_data_table>& transitions,
-    const std::shared_ptr<t_data_table>& existed,
-    t_expression_vocab& expression_vocab,
-    t_regex_mapping& regex_mapping
-) {
-    // Clear the tables so they are ready for this round of updates
-    m_expression_tables->clear_transitional_tables();
-
-    // All tables are the same size
-    t_uindex flattened_num_rows = flattened->size();
-    m_expression_tables->reserve_transitional_table_size(flattened_num_rows);
-    m_expression_tables->set_transitional_table_size(flattened_num_rows);
-
-    // Update the master expression table's size
-    t_uindex master_num_rows = master->size();
-    m_expression_tables->m_master->reserve(master_num_rows);
-    m_expression_tables->m_master->set_size(master_num_rows);
-
-    const auto& expressions = m_config.get_expressions();
-    for (const auto& expr : expressions) {
-        // master: compute based on latest state of the gnode state table
-        expr->compute(
-            master,
-            pkey_map,
-            m_expression_tables->m_master,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // flattened: compute based on the latest update dataset
-        expr->compute(
-            flattened,
-            pkey_map,
-            m_expression_tables->m_flattened,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // delta: for each numerical column, the numerical delta between the
-        // previous value and the current value in the row.
-        expr->compute(
-            delta,
-            pkey_map,
-            m_expression_tables->m_delta,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // prev: the values of the updated rows before this update was applied
-        expr->compute(
-            prev,
-            pkey_map,
-            m_expression_tables->m_prev,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // current: the current values of the updated rows
-        expr->compute(
-            current,
-            pkey_map,
-            m_expression_tables->m_current,
-            expression_vocab,
-            regex_mapping
-        );
-    }
-
-    // Calculate the transitions now that the intermediate tables are computed
-    m_expression_tables->calculate_transitions(existed);
-}
-
 bool
 t_ctx1::is_expression_column(const std::string& colname) const {
     const t_schema& schema = m_expression_tables->m_master->get_schema();
@@ -888,7 +902,16 @@ t_ctx1::unity_init_load_step_end() {}
 
 std::shared_ptr<t_data_table>
 t_ctx1::get_table() const {
-    auto schema = m_tree->get_aggtable()->get_schema();
+    // Only this context's aggregates, of those computed by a shared tree.
+    const auto& aggspecs = m_config.get_aggregates();
+    std::vector<std::string> columns;
+    std::vector<t_dtype> types;
+    for (t_uindex aggidx = 0; aggidx < aggspecs.size(); ++aggidx) {
+        columns.push_back(aggspecs[aggidx].name());
+        types.push_back(get_column_dtype(aggidx + 1));
+    }
+
+    t_schema schema(columns, types);
     auto pivots = m_config.get_row_pivots();
     auto tbl = std::make_shared<t_data_table>(schema, m_tree->size());
     tbl->init();
@@ -913,7 +936,8 @@ t_ctx1::get_table() const {
             pivcols[depth - 1]->set_scalar(idx, m_tree->get_value(nidx));
         }
         for (t_uindex aggnum = 0; aggnum < n_aggs; ++aggnum) {
-            auto aggscalar = m_tree->get_aggregate(nidx, aggnum);
+            auto aggscalar =
+                m_tree->get_aggregate(nidx, m_tree_aggidx[aggnum]);
             aggcols[aggnum]->set_scalar(idx, aggscalar);
         }
         ++idx;
@@ -27,14 +27,20 @@ t_ctx2::t_ctx2() :
     m_row_depth(0),
     m_row_depth_set(false),
     m_column_depth(0),
-    m_column_depth_set(false) {}
+    m_column_depth_set(false),
+    m_trees_shared(false) {}
 
 t_ctx2::t_ctx2(const t_schema& schema, const t_config& pivot_config) :
     t_ctxbase<t_ctx2>(schema, pivot_config),
     m_row_depth(0),
     m_row_depth_set(false),
     m_column_depth(0),
-    m_column_depth_set(false) {}
+    m_column_depth_set(false),
+    m_trees_shared(false),
+    m_tree_aggregates(pivot_config.get_aggregates()),
+    m_tree_aggidx(get_tree_aggregate_indices(
+        m_tree_aggregates, pivot_config.get_aggregates()
+    )) {}
 
 t_ctx2::~t_ctx2() = default;
 
@@ -73,7 +79,7 @@ t_ctx2::init() {
         );
 
         m_trees[treeidx] = std::make_shared<t_stree>(
-            pivots, m_config.get_aggregates(), m_schema, m_config
+            pivots, m_tree_aggregates, m_schema, m_config
         );
 
         m_trees[treeidx]->init();
@@ -103,6 +109,103 @@ t_ctx2::get_expression_tables() const {
     return m_expression_tables;
 }
 
+bool
+t_ctx2::shares_trees_with(const t_ctx2& ctx) const {
+    return m_trees == ctx.m_trees;
+}
+
+void
+t_ctx2::share_trees(const t_ctx2& ctx) {
+    std::vector<t_path> expanded_rows;
+    std::vector<t_path> expanded_columns;
+    if (!m_row_depth_set) {
+        expanded_rows = ctx_get_expansion_state(rtree(), m_rtraversal);
+    }
+
+    if (!m_column_depth_set) {
+        expanded_columns = ctx_get_expansion_state(ctree(), m_ctraversal);
+    }
+
+    m_trees = ctx.m_trees;
+    set_tree_aggregates(ctx.m_tree_aggregates);
+    if (get_feature_state(CTX_FEAT_DELTA)) {
+        for (auto& tr : m_trees) {
+            tr->set_deltas_enabled(true);
+        }
+    }
+
+    m_rtraversal = std::make_shared<t_traversal>(rtree());
+    m_ctraversal = std::make_shared<t_traversal>(ctree());
+    ctx_set_expansion_state(
+        *this, HEADER_ROW, rtree(), m_rtraversal, expanded_rows
+    );
+
+    ctx_set_expansion_state(
+        *this, HEADER_COLUMN, ctree(), m_ctraversal, expanded_columns
+    );
+
+    if (!m_sortby.empty()) {
+        sort_by(m_sortby);
+    }
+
+    if (!m_column_sortby.empty()) {
+        column_sort_by(m_column_sortby);
+    }
+}
+
+void
+t_ctx2::notify_shared_trees() {
+    notify_sparse_traversal(
+        rtree(), m_rtraversal, get_tree_sortby(m_sortby, m_tree_aggidx)
+    );
+
+    notify_sparse_traversal(
+        ctree(),
+        m_ctraversal,
+        get_tree_sortby(m_column_sortby, m_tree_aggidx)
+    );
+
+    if (!m_sortby.empty()) {
+        sort_by(m_sortby);
+    }
+
+    if (!m_column_sortby.empty()) {
+        column_sort_by(m_column_sortby);
+    }
+}
+
+void
+t_ctx2::set_trees_shared(bool shared) {
+    m_trees_shared = shared;
+}
+
+bool
+t_ctx2::get_trees_shared() const {
+    return m_trees_shared;
+}
+
+void
+t_ctx2::set_tree_aggregates(const std::vector<t_aggspec>& aggregates) {
+    m_tree_aggregates = aggregates;
+    m_tree_aggidx =
+        get_tree_aggregate_indices(aggregates, m_config.get_aggregates());
+    for (auto tree_aggidx : m_tree_aggidx) {
+        PSP_VERBOSE_ASSERT(
+            tree_aggidx != INVALID_INDEX, "Tree does not compute aggregate"
+        );
+    }
+}
+
+const std::vector<t_aggspec>&
+t_ctx2::get_tree_aggregates() const {
+    return m_tree_aggregates;
+}
+
+t_index
+t_ctx2::get_tree_aggidx(t_index aggidx) const {
+    return m_tree_aggidx[aggidx % m_tree_aggidx.size()];
+}
+
 void
 t_ctx2::step_begin() {
     reset_step_state();
@@ -141,7 +244,9 @@ t_ctx2::open(t_header header, t_index idx) {
         if (m_sortby.empty()) {
             retval = m_rtraversal->expand_node(idx);
         } else {
-            retval = m_rtraversal->expand_node(m_sortby, idx);
+            retval = m_rtraversal->expand_node(
+                get_tree_sortby(m_sortby, m_tree_aggidx), idx
+            );
         }
         m_rows_changed = (retval > 0);
     } else {
@@ -233,8 +338,20 @@ t_ctx2::get_min_max(const std::string& colname) const {
     t_uindex ctx_nrows = get_row_count();
     t_uindex ctx_ncols = get_column_count();
     auto rval = std::make_pair(mknone(), mknone());
-    t_uindex scol =
-        m_trees[0]->get_aggtable()->get_schema().get_colidx(colname);
+    const std::vector<t_aggspec>& aggspecs = m_config.get_aggregates();
+    auto spec = std::find_if(
+        aggspecs.begin(),
+        aggspecs.end(),
+        [&colname](const t_aggspec& aggspec) {
+            return aggspec.name() == colname;
+        }
+    );
+
+    if (spec == aggspecs.end()) {
+        PSP_COMPLAIN_AND_ABORT("No aggregate column `" + colname + "`");
+    }
+
+    t_uindex scol = std::distance(aggspecs.begin(), spec);
     std::vector<std::pair<t_uindex, t_uindex>> cells;
     for (t_index ridx = 0; ridx < ctx_nrows; ++ridx) {
         for (t_index cidx = 0; cidx < ctx_ncols; ++cidx) {
@@ -253,13 +370,13 @@ t_ctx2::get_min_max(const std::string& colname) const {
         t_schema aggschema = aggtable->get_schema();
         for (t_uindex aggidx = 0, agg_loop_end = n_aggs; aggidx < agg_loop_end;
              ++aggidx) {
-            const std::string& aggname = aggschema.m_columns[aggidx];
+            const std::string& aggname =
+                aggschema.m_columns[m_tree_aggidx[aggidx]];
             aggmap[t_aggpair(treeidx, aggidx)] =
                 aggtable->get_const_column(aggname).get();
         }
     }
 
-    const std::vector<t_aggspec>& aggspecs = m_config.get_aggregates();
     bool is_finished = false;
     t_uindex row_depth = m_row_depth + 1;
     while (!is_finished && row_depth > 0) {
@@ -350,7 +467,8 @@ t_ctx2::get_data(
         for (t_uindex aggidx = 0, agg_loop_end = m_config.get_num_aggregates();
              aggidx < agg_loop_end;
              ++aggidx) {
-            const std::string& aggname = aggschema.m_columns[aggidx];
+            const std::string& aggname =
+                aggschema.m_columns[m_tree_aggidx[aggidx]];
 
             aggmap[t_aggpair(treeidx, aggidx)] =
                 aggtable->get_const_column(aggname).get();
@@ -455,7 +573,8 @@ t_ctx2::get_data(const std::vector<t_uindex>& rows) const {
         for (t_uindex aggidx = 0, agg_loop_end = m_config.get_num_aggregates();
              aggidx < agg_loop_end;
              ++aggidx) {
-            const std::string& aggname = aggschema.m_columns[aggidx];
+            const std::string& aggname =
+                aggschema.m_columns[m_tree_aggidx[aggidx]];
 
             aggmap[t_aggpair(treeidx, aggidx)] =
                 aggtable->get_const_column(aggname).get();
@@ -509,7 +628,9 @@ t_ctx2::column_sort_by(const std::vector<t_sortspec>& sortby) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     m_column_sortby = sortby;
-    m_ctraversal->sort_by(m_config, sortby, *(ctree()));
+    m_ctraversal->sort_by(
+        m_config, get_tree_sortby(sortby, m_tree_aggidx), *(ctree())
+    );
 }
 
 void
@@ -539,9 +660,9 @@ t_ctx2::notify(const t_data_table& flattened) {
                 rtree(),
                 m_rtraversal,
                 true,
-                m_config.get_aggregates(),
+                m_tree_aggregates,
                 m_config.get_sortby_pairs(),
-                m_sortby,
+                get_tree_sortby(m_sortby, m_tree_aggidx),
                 flattened,
                 m_config,
                 *m_gstate,
@@ -552,9 +673,9 @@ t_ctx2::notify(const t_data_table& flattened) {
                 ctree(),
                 m_ctraversal,
                 true,
-                m_config.get_aggregates(),
+                m_tree_aggregates,
                 m_config.get_sortby_pairs(),
-                m_column_sortby,
+                get_tree_sortby(m_column_sortby, m_tree_aggidx),
                 flattened,
                 m_config,
                 *m_gstate,
@@ -565,7 +686,7 @@ t_ctx2::notify(const t_data_table& flattened) {
                 m_trees[tree_idx],
                 std::shared_ptr<t_traversal>(nullptr),
                 false,
-                m_config.get_aggregates(),
+                m_tree_aggregates,
                 m_config.get_sortby_pairs(),
                 std::vector<t_sortspec>(),
                 flattened,
@@ -601,9 +722,9 @@ t_ctx2::notify(
                 rtree(),
                 m_rtraversal,
                 true,
-                m_config.get_aggregates(),
+                m_tree_aggregates,
                 m_config.get_sortby_pairs(),
-                m_sortby,
+                get_tree_sortby(m_sortby, m_tree_aggidx),
                 flattened,
                 delta,
                 prev,
@@ -619,9 +740,9 @@ t_ctx2::notify(
                 ctree(),
                 m_ctraversal,
                 true,
-                m_config.get_aggregates(),
+                m_tree_aggregates,
                 m_config.get_sortby_pairs(),
-                m_column_sortby,
+                get_tree_sortby(m_column_sortby, m_tree_aggidx),
                 flattened,
                 delta,
                 prev,
@@ -637,7 +758,7 @@ t_ctx2::notify(
                 m_trees[tree_idx],
                 std::shared_ptr<t_traversal>(nullptr),
                 false,
-                m_config.get_aggregates(),
+                m_tree_aggregates,
                 m_config.get_sortby_pairs(),
                 std::vector<t_sortspec>(),
                 flattened,
@@ -915,7 +1036,9 @@ t_ctx2::set_depth(t_header header, t_depth depth) {
             }
             new_depth =
                 std::min<t_depth>(m_config.get_num_rpivots() - 1, depth);
-            m_rtraversal->set_depth(m_sortby, new_depth);
+            m_rtraversal->set_depth(
+                get_tree_sortby(m_sortby, m_tree_aggidx), new_depth
+            );
             m_row_depth = new_depth;
             m_row_depth_set = true;
         } break;
@@ -925,7 +1048,9 @@ t_ctx2::set_depth(t_header header, t_depth depth) {
             }
             new_depth =
                 std::min<t_depth>(m_config.get_num_cpivots() - 1, depth);
-            m_ctraversal->set_depth(m_column_sortby, new_depth);
+            m_ctraversal->set_depth(
+                get_tree_sortby(m_column_sortby, m_tree_aggidx), new_depth
+            );
             m_column_depth = new_depth;
             m_column_depth_set = true;
         } break;
@@ -967,14 +1092,29 @@ t_ctx2::get_pkeys(const std::vector<std::pair<t_uindex, t_uindex>>& cells
  */
 t_stepdelta
 t_ctx2::get_step_delta(t_index bidx, t_index eidx) {
+    t_stepdelta rval(true, true, get_cell_delta(bidx, eidx));
+    if (!m_trees_shared) {
+        clear_deltas();
+    }
+
+    return rval;
+}
+
+/**
+ * @brief Returns the updated cells in rows `[bidx, eidx)`, without clearing
+ * the trees' deltas.
+ *
+ * @param bidx
+ * @param eidx
+ * @return std::vector<t_cellupd>
+ */
+std::vector<t_cellupd>
+t_ctx2::get_cell_delta(t_index bidx, t_index eidx) const {
     t_uindex start_row = bidx;
     t_uindex end_row = eidx;
     t_uindex start_col = 1;
     t_uindex end_col = get_num_view_columns();
-    t_stepdelta rval;
-    rval.rows_changed = true;
-    rval.columns_changed = true;
-    std::vector<t_cellupd>& updvec = rval.cells;
+    std::vector<t_cellupd> updvec;
 
     t_uindex ctx_nrows = get_row_count();
     t_uindex ctx_ncols = get_column_count();
@@ -997,9 +1137,11 @@ t_ctx2::get_step_delta(t_index bidx, t_index eidx) {
             continue;
         }
 
+        // Only the cell's own aggregate, of those computed by its tree.
         const auto& deltas = m_trees[c.m_treenum]->get_deltas();
-
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(c.m_idx);
+        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(
+            std::make_tuple(c.m_idx, m_tree_aggidx[c.m_agg_index])
+        );
 
         for (auto iter = iterators.first; iter != iterators.second; ++iter) {
             updvec.emplace_back(
@@ -1008,8 +1150,7 @@ t_ctx2::get_step_delta(t_index bidx, t_index eidx) {
         }
     }
 
-    clear_deltas();
-    return rval;
+    return updvec;
 }
 
 /**
@@ -1022,7 +1163,10 @@ t_ctx2::get_row_delta() {
     std::vector<t_uindex> rows = get_rows_changed();
     std::vector<t_tscalar> data = get_data(rows);
     t_rowdelta rval(true, rows.size(), data);
-    clear_deltas();
+    if (!m_trees_shared) {
+        clear_deltas();
+    }
+
     return rval;
 }
 
@@ -1047,7 +1191,10 @@ t_ctx2::get_rows_changed() {
             continue;
         }
         const auto& deltas = m_trees[c.m_treenum]->get_deltas();
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(c.m_idx);
+        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(
+            std::make_tuple(c.m_idx, m_tree_aggidx[c.m_agg_index])
+        );
+
         auto ridx = c.m_ridx;
         bool unique_ridx =
             std::find(rows.begin(), rows.end(), ridx) == rows.end();
@@ -1081,7 +1228,7 @@ t_ctx2::reset(bool reset_expressions) {
         );
 
         m_trees[treeidx] = std::make_shared<t_stree>(
-            pivots, m_config.get_aggregates(), m_schema, m_config
+            pivots, m_tree_aggregates, m_schema, m_config
         );
         m_trees[treeidx]->init();
         m_trees[treeidx]->set_deltas_enabled(get_feature_state(CTX_FEAT_DELTA));
@@ -1129,6 +1276,10 @@ t_ctx2::set_alerts_enabled(bool enabled_state) {
 void
 t_ctx2::set_deltas_enabled(bool enabled_state) {
     m_features[CTX_FEAT_DELTA] = enabled_state;
+    if (!enabled_state && m_trees_shared) {
+        return;
+    }
+
     for (auto& tr : m_trees) {
         tr->set_deltas_enabled(enabled_state);
     }
@@ -1167,121 +1318,10 @@ t_ctx2::get_column_dtype(t_uindex idx) const {
 
     return rtree()
         ->get_aggtable()
-        ->get_const_column((idx - 1) % naggs)
+        ->get_const_column(m_tree_aggidx[(idx - 1) % naggs])
         ->get_dtype();
 }
 
-void
-t_ctx2::compute_expressions(
-    const std::shared_ptr<t_data_table>& master,
-    const t_gstate::t_mapping& pkey_map,
-    t_expression_vocab& expression_vocab,
-    t_regex_mapping& regex_mapping
-) {
-    // Clear the transitional expression tables on the context so they are
-    // ready for the next update.
-    m_expression_tables->clear_transitional_tables();
-
-    std::shared_ptr<t_data_table> master_expression_table =
-        m_expression_tables->m_master;
-
-    // Set the master table to the right size.
-    t_uindex num_rows = master->size();
-    master_expression_table->reserve(num_rows);
-    master_expression_table->set_size(num_rows);
-
-    const auto& expressions = m_config.get_expressions();
-    for (const auto& expr : expressions) {
-        // Compute the expressions on the master table.
-        expr->compute(
-            master,
-            pkey_map,
-            master_expression_table,
-            expression_vocab,
-            regex_mapping
-        );
-    }
-}
-
-void
-t_ctx2::compute_expressions(
-    const std::shared_ptr<t_data_table>& master,
-    const t_gstate::t_mapping& pkey_map,
-    const std::shared_ptr<t_data_table>& flattened,
-    const std::shared_ptr<t_data_table>& delta,
-    const std::shared_ptr<t_data_table>& prev,
-    const std::shared_ptr<t_data_table>& current,
-    const std::shared_ptr<t_data_table>& transitions,
-    const std::shared_ptr<t_data_table>& existed,
-    t_expression_vocab& expression_vocab,
-    t_regex_mapping& regex_mapping
-) {
-    // Clear the tables so they are ready for this round of updates
-    m_expression_tables->clear_transitional_tables();
-
-    // All tables are the same size
-    t_uindex flattened_num_rows = flattened->size();
-    m_expression_tables->reserve_transitional_table_size(flattened_num_rows);
-    m_expression_tables->set_transitional_table_size(flattened_num_rows);
-
-    // Update the master expression table's size
-    t_uindex master_num_rows = master->size();
-    m_expression_tables->m_master->reserve(master_num_rows);
-    m_expression_tables->m_master->set_size(master_num_rows);
-
-    const auto& expressions = m_config.get_expressions();
-    for (const auto& expr : expressions) {
-        // master: compute based on latest state of the gnode state table
-        expr->compute(
-            master,
-            pkey_map,
-            m_expression_tables->m_master,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // flattened: compute based on the latest update dataset
-        expr->compute(
-            flattened,
-            pkey_map,
-            m_expression_tables->m_flattened,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // delta: for each numerical column, the numerical delta between the
-        // previous value and the current value in the row.
-        expr->compute(
-            delta,
-            pkey_map,
-            m_expression_tables->m_delta,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // prev: the values of the updated rows before this update was applied
-        expr->compute(
-            prev,
-            pkey_map,
-            m_expression_tables->m_prev,
-            expression_vocab,
-            regex_mapping
-        );
-
-        // current: the current values of the updated rows
-        expr->compute(
-            current,
-            pkey_map,
-            m_expression_tables->m_current,
-            expression_vocab,
-            regex_mapping
-        );
-    }
-
-    // Calculate the transitions now that the intermediate tables are computed
-    m_expression_tables->calculate_transitions(existed);
-}
-
 bool
 t_ctx2::is_expression_column(const std::string& colname) const {
     const t_schema& schema = m_expression_tables->m_master->get_schema();
@@ -331,6 +331,82 @@ t_data_table::flatten() const {
     return flattened;
 }
 
+bool
+t_data_table::has_sorted_unique_pkeys() const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(is_pkey_table(), "Not a pkeyed table");
+
+    t_dtype pkey_dtype = get_const_column("psp_pkey")->get_dtype();
+    switch (pkey_dtype) {
+        case DTYPE_INT64:
+        case DTYPE_TIME: {
+            return has_sorted_unique_pkeys_helper<std::int64_t>();
+        }
+        case DTYPE_INT32: {
+            return has_sorted_unique_pkeys_helper<std::int32_t>();
+        }
+        case DTYPE_INT16: {
+            return has_sorted_unique_pkeys_helper<std::int16_t>();
+        }
+        case DTYPE_INT8: {
+            return has_sorted_unique_pkeys_helper<std::int8_t>();
+        }
+        case DTYPE_UINT64: {
+            return has_sorted_unique_pkeys_helper<std::uint64_t>();
+        }
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            return has_sorted_unique_pkeys_helper<std::uint32_t>();
+        }
+        case DTYPE_UINT16: {
+            return has_sorted_unique_pkeys_helper<std::uint16_t>();
+        }
+        case DTYPE_UINT8: {
+            return has_sorted_unique_pkeys_helper<std::uint8_t>();
+        }
+        case DTYPE_STR: {
+            // `flatten()` sorts string pkeys by vocab index, which is unique
+            // per string within the column.
+            return has_sorted_unique_pkeys_helper<t_uindex>();
+        }
+        default: {
+            // Leave anything else, i.e. floating point pkeys, to `flatten()`.
+            return false;
+        }
+    }
+}
+
+void
+t_data_table::clear_deleted_rows() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(is_pkey_table(), "Not a pkeyed table");
+
+    const t_column* op_col = get_const_column("psp_op").get();
+    std::vector<t_uindex> deleted;
+    for (t_uindex idx = 0, loop_end = size(); idx < loop_end; ++idx) {
+        if (*(op_col->get_nth<std::uint8_t>(idx)) == OP_DELETE) {
+            deleted.push_back(idx);
+        }
+    }
+
+    if (deleted.empty()) {
+        return;
+    }
+
+    for (const auto& colname : m_schema.m_columns) {
+        if (colname == "psp_pkey" || colname == "psp_op") {
+            continue;
+        }
+
+        t_column* col = get_column(colname).get();
+        for (auto idx : deleted) {
+            col->clear(idx);
+        }
+    }
+}
+
 bool
 t_data_table::is_pkey_table() const {
     PSP_TRACE_SENTINEL();
@@ -826,6 +902,26 @@ t_data_table::clone_column(
     return m_columns.back().get();
 }
 
+t_column*
+t_data_table::alias_column(
+    const std::string& existing_col, const std::string& new_colname
+) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    if (!m_schema.has_column(existing_col)) {
+        std::cout << "Cannot alias non existing column: " << existing_col
+                  << '\n';
+        return nullptr;
+    }
+
+    t_uindex idx = m_schema.get_colidx(existing_col);
+
+    m_schema.add_column(new_colname, m_columns[idx]->get_dtype());
+    m_columns.push_back(m_columns[idx]);
+    return m_columns.back().get();
+}
+
 std::string
 t_data_table::repr() const {
     std::stringstream ss;
@@ -11,6 +11,8 @@
 // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
 
 #include <perspective/expression_tables.h>
+#include <cctype>
+#include <sstream>
 
 namespace perspective {
 
@@ -44,6 +46,9 @@ t_expression_tables::t_expression_tables(
     m_transitions = std::make_shared<t_data_table>(
         "", "", transitions_schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY
     );
+    m_pkeyed = std::make_shared<t_data_table>(
+        "", "", schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY
+    );
 
     m_master->init();
     m_flattened->init();
@@ -51,6 +56,7 @@ t_expression_tables::t_expression_tables(
     m_current->init();
     m_delta->init();
     m_transitions->init();
+    m_pkeyed->init();
 }
 
 t_data_table*
@@ -59,19 +65,15 @@ t_expression_tables::get_table() const {
 }
 
 void
-t_expression_tables::set_flattened(
-    const std::shared_ptr<t_data_table>& flattened
+t_expression_tables::set_pkeyed(const std::shared_ptr<t_data_table>& pkeyed
 ) const {
-    t_uindex flattened_num_rows = flattened->size();
-    reserve_transitional_table_size(flattened_num_rows);
-    set_transitional_table_size(flattened_num_rows);
-    const t_schema& schema = m_flattened->get_schema();
+    const t_schema& schema = m_pkeyed->get_schema();
     const std::vector<std::string>& column_names = schema.m_columns;
     for (const auto& colname : column_names) {
-        m_flattened->set_column(
-            colname, flattened->get_column(colname)->clone()
-        );
+        m_pkeyed->set_column(colname, pkeyed->get_column(colname)->clone());
     }
+
+    m_pkeyed->set_table_size(pkeyed->size());
 }
 
 void
@@ -174,6 +176,398 @@ t_expression_tables::reset() const {
     m_current->reset();
     m_delta->reset();
     m_transitions->reset();
+    m_pkeyed->reset();
+}
+
+t_expression_cache::t_expression_cache() = default;
+
+std::string
+t_expression_cache::get_expression_key(const t_computed_expression& expression
+) {
+    const std::string& parsed = expression.get_parsed_expression_string();
+    std::string key;
+    key.reserve(parsed.size());
+
+    // Collapse runs of whitespace outside of string literals, so that
+    // expressions which differ only in formatting share an entry. A run
+    // containing a line break collapses to a line break, as `//` and `#`
+    // comments end at one.
+    bool in_string = false;
+    char pending_space = '\0';
+    for (t_uindex idx = 0; idx < parsed.size(); ++idx) {
+        char c = parsed[idx];
+        if (!in_string && std::isspace(static_cast<unsigned char>(c)) != 0) {
+            if (key.empty()) {
+                continue;
+            }
+
+            if (c == '\n' || c == '\r') {
+                pending_space = '\n';
+            } else if (pending_space == '\0') {
+                pending_space = ' ';
+            }
+
+            continue;
+        }
+
+        if (pending_space != '\0') {
+            key.push_back(pending_space);
+            pending_space = '\0';
+        }
+
+        key.push_back(c);
+        if (c == '\\' && in_string && idx + 1 < parsed.size()) {
+            key.push_back(parsed[++idx]);
+        } else if (c == '\'') {
+            in_string = !in_string;
+        }
+    }
+
+    std::stringstream ss;
+    ss << key << '\0' << expression.get_dtype();
+    for (const auto& column_id : expression.get_column_ids()) {
+        ss << '\0' << column_id.first << '=' << column_id.second;
+    }
+
+    return ss.str();
+}
+
+void
+t_expression_cache::acquire(
+    const std::vector<std::shared_ptr<t_computed_expression>>& expressions
+) {
+    for (const auto& expr : expressions) {
+        std::string key = get_expression_key(*expr);
+        auto iter = m_entries.find(key);
+        if (iter != m_entries.end()) {
+            iter->second.m_refcount++;
+            continue;
+        }
+
+        t_expression_cache_entry entry;
+        entry.m_expression = expr;
+        entry.m_tables = std::make_shared<t_expression_tables>(
+            std::vector<std::shared_ptr<t_computed_expression>>{expr}
+        );
+        entry.m_refcount = 1;
+        entry.m_pending_refcount = 0;
+        entry.m_computed = false;
+        entry.m_pkeyed_computed = false;
+        m_entries[key] = entry;
+    }
+}
+
+void
+t_expression_cache::release(
+    const std::vector<std::shared_ptr<t_computed_expression>>& expressions
+) {
+    for (const auto& expr : expressions) {
+        auto iter = m_entries.find(get_expression_key(*expr));
+        if (iter == m_entries.end()) {
+            continue;
+        }
+
+        // Contexts still holding the entry's columns keep them alive until
+        // the contexts themselves are destroyed.
+        iter->second.m_refcount--;
+        if (iter->second.m_refcount == 0) {
+            m_entries.erase(iter);
+        }
+    }
+}
+
+void
+t_expression_cache::set_pending(
+    const std::vector<std::shared_ptr<t_computed_expression>>& expressions,
+    bool pending
+) {
+    for (const auto& expr : expressions) {
+        auto iter = m_entries.find(get_expression_key(*expr));
+        if (iter == m_entries.end()) {
+            continue;
+        }
+
+        if (pending) {
+            iter->second.m_pending_refcount++;
+        } else if (iter->second.m_pending_refcount > 0) {
+            iter->second.m_pending_refcount--;
+        }
+    }
+}
+
+void
+t_expression_cache::compute(
+    const t_gstate& gstate,
+    t_expression_vocab& expression_vocab,
+    t_regex_mapping& regex_mapping,
+    bool recompute
+) {
+    std::shared_ptr<t_data_table> master = gstate.get_table();
+    const t_gstate::t_mapping& pkey_map = gstate.get_pkey_map();
+    t_uindex num_rows = master->size();
+
+    for (auto& iter : m_entries) {
+        t_expression_cache_entry& entry = iter.second;
+        const t_expression_tables& tables = *(entry.m_tables);
+        if (entry.m_pending_refcount == entry.m_refcount) {
+            entry.m_computed = false;
+            continue;
+        }
+
+        if (!entry.m_computed || recompute) {
+            tables.clear_transitional_tables();
+            tables.m_master->reserve(num_rows);
+            tables.m_master->set_size(num_rows);
+
+            entry.m_expression->compute(
+                master,
+                pkey_map,
+                tables.m_master,
+                expression_vocab,
+                regex_mapping
+            );
+
+            entry.m_computed = true;
+            entry.m_pkeyed_computed = false;
+            entry.m_stats.m_last_rows_evaluated = num_rows;
+            entry.m_stats.m_rows_evaluated += num_rows;
+
+            // The computed columns own copies of their strings, so the
+            // strings interned while computing them can be freed.
+            expression_vocab.clear();
+        }
+
+        // A master table computed by an update is current, but the update
+        // left its rows in `m_flattened`, so the pkeyed rows which contexts
+        // are built from are rebuilt from the master.
+        if (!entry.m_pkeyed_computed) {
+            tables.set_pkeyed(gstate.get_pkeyed_table(
+                tables.m_master->get_schema(), tables.m_master
+            ));
+
+            entry.m_pkeyed_computed = true;
+        }
+    }
+}
+
+void
+t_expression_cache::compute(
+    const std::shared_ptr<t_data_table>& master,
+    const t_gstate::t_mapping& pkey_map,
+    const std::shared_ptr<t_data_table>& flattened,
+    const std::shared_ptr<t_data_table>& delta,
+    const std::shared_ptr<t_data_table>& prev,
+    const std::shared_ptr<t_data_table>& current,
+    const std::shared_ptr<t_data_table>& transitions,
+    const std::shared_ptr<t_data_table>& existed,
+    t_expression_vocab& expression_vocab,
+    t_regex_mapping& regex_mapping
+) {
+    // All transitional tables are the same size
+    t_uindex flattened_num_rows = flattened->size();
+    t_uindex master_num_rows = master->size();
+
+    for (auto& iter : m_entries) {
+        t_expression_cache_entry& entry = iter.second;
+        t_expression_tables& tables = *(entry.m_tables);
+        const t_computed_expression& expr = *(entry.m_expression);
+
+        // No built context reads this entry, so it is left stale until one
+        // does, which recomputes it from the master table in full.
+        if (entry.m_pending_refcount == entry.m_refcount) {
+            entry.m_computed = false;
+            continue;
+        }
+
+        tables.clear_transitional_tables();
+        tables.reserve_transitional_table_size(flattened_num_rows);
+        tables.set_transitional_table_size(flattened_num_rows);
+        tables.m_master->reserve(master_num_rows);
+        tables.m_master->set_size(master_num_rows);
+
+        // master: compute based on latest state of the gnode state table. The
+        // rows of a row-local expression are only stale if the update
+        // touched one of its inputs.
+        // The master rows computed, plus `flattened`, `delta`, `prev` and
+        // `current`.
+        t_uindex rows_evaluated = master_num_rows + 4 * flattened_num_rows;
+        if (entry.m_computed && expr.is_row_local()) {
+            std::vector<t_uindex> changed_rows = get_changed_rows(
+                expr, pkey_map, flattened, transitions, existed
+            );
+
+            rows_evaluated = changed_rows.size() + 4 * flattened_num_rows;
+
+            expr.compute(
+                master,
+                pkey_map,
+                tables.m_master,
+                changed_rows,
+                expression_vocab,
+                regex_mapping
+            );
+        } else {
+            expr.compute(
+                master,
+                pkey_map,
+                tables.m_master,
+                expression_vocab,
+                regex_mapping
+            );
+        }
+
+        // flattened: compute based on the latest update dataset
+        expr.compute(
+            flattened,
+            pkey_map,
+            tables.m_flattened,
+            expression_vocab,
+            regex_mapping
+        );
+
+        // delta: for each numerical column, the numerical delta between the
+        // previous value and the current value in the row.
+        expr.compute(
+            delta, pkey_map, tables.m_delta, expression_vocab, regex_mapping
+        );
+
+        // prev: the values of the updated rows before this update was applied
+        expr.compute(
+            prev, pkey_map, tables.m_prev, expression_vocab, regex_mapping
+        );
+
+        // current: the current values of the updated rows
+        expr.compute(
+            current, pkey_map, tables.m_current, expression_vocab, regex_mapping
+        );
+
+        tables.calculate_transitions(existed);
+        entry.m_computed = true;
+        entry.m_pkeyed_computed = false;
+        entry.m_stats.m_last_rows_evaluated = rows_evaluated;
+        entry.m_stats.m_rows_evaluated += rows_evaluated;
+        expression_vocab.clear();
+    }
+}
+
+std::vector<t_uindex>
+t_expression_cache::get_changed_rows(
+    const t_computed_expression& expression,
+    const t_gstate::t_mapping& pkey_map,
+    const std::shared_ptr<t_data_table>& flattened,
+    const std::shared_ptr<t_data_table>& transitions,
+    const std::shared_ptr<t_data_table>& existed
+) {
+    const t_column& pkey_column = *(flattened->get_const_column("psp_pkey"));
+    const t_column& existed_column =
+        *(existed->get_const_column("psp_existed"));
+    const t_schema& transitions_schema = transitions->get_schema();
+
+    // Inputs without a transitions column are treated as always changed.
+    bool inputs_changed = false;
+    std::vector<const t_column*> transition_columns;
+    for (const auto& column_id : expression.get_column_ids()) {
+        const std::string& column_name = column_id.second;
+        if (!transitions_schema.has_column(column_name)) {
+            inputs_changed = true;
+            break;
+        }
+
+        transition_columns.push_back(
+            transitions->get_const_column(column_name).get()
+        );
+    }
+
+    std::vector<t_uindex> changed_rows;
+    t_uindex num_rows = flattened->size();
+    changed_rows.reserve(num_rows);
+
+    for (t_uindex ridx = 0; ridx < num_rows; ++ridx) {
+        // Removed rows are no longer in the master table.
+        auto iter = pkey_map.find(pkey_column.get_scalar(ridx));
+        if (iter == pkey_map.end()) {
+            continue;
+        }
+
+        bool changed =
+            inputs_changed || !*(existed_column.get_nth<bool>(ridx));
+        for (t_uindex cidx = 0;
+             !changed && cidx < transition_columns.size();
+             ++cidx) {
+            std::uint8_t transition =
+                *(transition_columns[cidx]->get_nth<std::uint8_t>(ridx));
+            changed = transition != VALUE_TRANSITION_EQ_TT
+                && transition != VALUE_TRANSITION_EQ_FF;
+        }
+
+        if (changed) {
+            changed_rows.push_back(iter->second);
+        }
+    }
+
+    return changed_rows;
+}
+
+void
+t_expression_cache::bind(
+    const std::vector<std::shared_ptr<t_computed_expression>>& expressions,
+    const t_expression_tables& tables
+) const {
+    for (const auto& expr : expressions) {
+        auto iter = m_entries.find(get_expression_key(*expr));
+        if (iter == m_entries.end()) {
+            std::stringstream ss;
+            ss << "[t_expression_cache::bind] Expression `"
+               << expr->get_expression_alias() << "` is not in the cache."
+               << '\n';
+            PSP_COMPLAIN_AND_ABORT(ss.str());
+        }
+
+        const std::string& alias = expr->get_expression_alias();
+        const std::string& cached_alias =
+            iter->second.m_expression->get_expression_alias();
+        const t_expression_tables& cached = *(iter->second.m_tables);
+
+        auto bind_table = [&alias, &cached_alias](
+                              const std::shared_ptr<t_data_table>& table,
+                              const std::shared_ptr<t_data_table>& source
+                          ) {
+            table->set_column(alias, source->get_column(cached_alias));
+            table->set_table_size(source->size());
+        };
+
+        bind_table(tables.m_master, cached.m_master);
+        bind_table(tables.m_flattened, cached.m_flattened);
+        bind_table(tables.m_prev, cached.m_prev);
+        bind_table(tables.m_current, cached.m_current);
+        bind_table(tables.m_delta, cached.m_delta);
+        bind_table(tables.m_transitions, cached.m_transitions);
+        bind_table(tables.m_pkeyed, cached.m_pkeyed);
+    }
+}
+
+void
+t_expression_cache::reset() {
+    for (auto& iter : m_entries) {
+        iter.second.m_tables->reset();
+        iter.second.m_computed = false;
+        iter.second.m_pkeyed_computed = false;
+    }
+}
+
+t_uindex
+t_expression_cache::size() const {
+    return m_entries.size();
+}
+
+t_expression_stats
+t_expression_cache::get_stats(const t_computed_expression& expression) const {
+    auto iter = m_entries.find(get_expression_key(expression));
+    if (iter == m_entries.end()) {
+        return {};
+    }
+
+    return iter->second.m_stats;
 }
 
 } // end namespace perspective
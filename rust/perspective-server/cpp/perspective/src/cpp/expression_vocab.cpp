@@ -12,6 +12,8 @@
 
 #include <perspective/expression_vocab.h>
 
+#include <algorithm>
+
 namespace perspective {
 
 t_expression_vocab::t_expression_vocab() {
@@ -19,20 +21,25 @@ t_expression_vocab::t_expression_vocab() {
     m_max_vocab_size = 64 * 64;
 
     // Always start with one vocab
-    allocate_new_vocab();
+    allocate_new_vocab(0);
 }
 
 const char*
 t_expression_vocab::intern(const char* str) {
+    t_uindex interned_idx;
+    if (m_vocabs.back().string_exists(str, interned_idx)) {
+        return m_vocabs.back().unintern_c(interned_idx);
+    }
+
     std::size_t bytelength = strlen(str);
 
     if (m_current_vocab_size + bytelength + 1 > m_max_vocab_size) {
-        allocate_new_vocab();
+        allocate_new_vocab(bytelength + 1);
     }
 
     m_current_vocab_size += bytelength + 1;
-    t_vocab& current_vocab = m_vocabs[0];
-    t_uindex interned_idx = current_vocab.get_interned(str);
+    t_vocab& current_vocab = m_vocabs.back();
+    interned_idx = current_vocab.get_interned(str);
     return current_vocab.unintern_c(interned_idx);
 }
 
@@ -43,8 +50,13 @@ t_expression_vocab::intern(const std::string& str) {
 
 void
 t_expression_vocab::clear() {
+    // Nothing has been interned since the last clear, so keep the page.
+    if (m_vocabs.size() == 1 && m_current_vocab_size == 0) {
+        return;
+    }
+
     m_vocabs.clear();
-    allocate_new_vocab();
+    allocate_new_vocab(0);
 }
 
 const char*
@@ -60,11 +72,11 @@ t_expression_vocab::pprint() const {
 }
 
 void
-t_expression_vocab::allocate_new_vocab() {
+t_expression_vocab::allocate_new_vocab(std::size_t min_size) {
     t_vocab vocab;
     vocab.init(false);
-    vocab.reserve(m_max_vocab_size, 64);
-    m_vocabs.insert(m_vocabs.begin(), std::move(vocab));
+    vocab.reserve(std::max(m_max_vocab_size, min_size), 64);
+    m_vocabs.push_back(std::move(vocab));
     m_current_vocab_size = 0;
 }
 
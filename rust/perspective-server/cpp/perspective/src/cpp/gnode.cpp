@@ -48,7 +48,9 @@ calc_negate(t_tscalar val) {
     return val.negate();
 }
 
-t_gnode::t_gnode(t_schema input_schema, t_schema output_schema) :
+t_gnode::t_gnode(
+    t_schema input_schema, t_schema output_schema, std::string index
+) :
     m_mode(NODE_PROCESSING_SIMPLE_DATAFLOW)
 #ifdef PSP_PARALLEL_FOR
     ,
@@ -58,10 +60,12 @@ t_gnode::t_gnode(t_schema input_schema, t_schema output_schema) :
     m_gnode_type(GNODE_TYPE_PKEYED),
     m_input_schema(std::move(input_schema)),
     m_output_schema(std::move(output_schema)),
+    m_index(std::move(index)),
     m_init(false),
     m_id(0),
     m_last_input_port_id(0),
-    m_pool_cleanup([]() {}) {
+    m_pool_cleanup([]() {}),
+    m_lazy_contexts(false) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_gnode");
 
@@ -97,7 +101,9 @@ void
 t_gnode::init() {
     PSP_TRACE_SENTINEL();
 
-    m_gstate = std::make_shared<t_gstate>(m_input_schema, m_output_schema);
+    m_gstate = std::make_shared<t_gstate>(
+        m_input_schema, m_output_schema, m_index
+    );
     m_gstate->init();
 
     // Create and store the main input port, which is always port 0. The next
@@ -129,6 +135,7 @@ t_gnode::init() {
     // Initialize expression-related state
     m_expression_vocab = std::make_shared<t_expression_vocab>();
     m_expression_regex_mapping = std::make_shared<t_regex_mapping>();
+    m_expression_cache = std::make_shared<t_expression_cache>();
 
     m_init = true;
 }
@@ -232,6 +239,8 @@ t_gnode::_process_mask_existed_rows(t_process_state& process_state) {
     t_column* existed_column =
         process_state.m_existed_data_table->get_column("psp_existed").get();
 
+    bool inserts_only = true;
+
     for (t_uindex idx = 0; idx < flattened_num_rows; ++idx) {
         t_tscalar pkey = pkey_col->get_scalar(idx);
         std::uint8_t op_ = process_state.m_op_base[idx];
@@ -246,6 +255,9 @@ t_gnode::_process_mask_existed_rows(t_process_state& process_state) {
 
         process_state.m_added_offset[idx] = added_count;
 
+        inserts_only = inserts_only && op == OP_INSERT
+            && !process_state.m_prev_pkey_eq_vec[idx];
+
         switch (op) {
             case OP_INSERT: {
                 row_pre_existed =
@@ -272,38 +284,74 @@ t_gnode::_process_mask_existed_rows(t_process_state& process_state) {
     }
 
     PSP_VERBOSE_ASSERT(mask.count() == added_count, "Expected equality");
+
+    // Resolve `calc_transition` once for every combination of flags an
+    // inserted cell can have, so the insert kernels can look it up per cell.
+    process_state.m_inserts_only = inserts_only;
+    for (std::uint8_t key = 0; key < 16; ++key) {
+        bool row_pre_existed = (key & 8) != 0;
+        bool prev_valid = (key & 4) != 0;
+        bool cur_valid = (key & 2) != 0;
+        bool prev_cur_eq = (key & 1) != 0;
+        process_state.m_insert_transitions[key] = calc_transition(
+            row_pre_existed && prev_valid,
+            row_pre_existed,
+            cur_valid,
+            prev_valid,
+            cur_valid,
+            prev_cur_eq,
+            false
+        );
+    }
+
     return mask;
 }
 
 t_process_table_result
 t_gnode::_process_table(t_uindex port_id) {
-    m_was_updated = false;
+    return _commit_table(_prepare_table(port_id));
+}
 
-    t_process_table_result result;
-    result.m_flattened_data_table = nullptr;
-    result.m_should_notify_userspace = false;
+t_process_table_prepared
+t_gnode::_prepare_table(t_uindex port_id) {
+    t_process_table_prepared prepared;
+    prepared.m_flattened_data_table = nullptr;
+    prepared.m_is_first_update = false;
 
     std::shared_ptr<t_data_table> flattened = nullptr;
 
     if (m_input_ports.count(port_id) == 0) {
         std::cerr << "Cannot process table on port `" << port_id
                   << "` as it does not exist." << '\n';
-        return result;
+        return prepared;
     }
 
     std::shared_ptr<t_port>& input_port = m_input_ports[port_id];
 
     if (input_port->get_table()->size() == 0) {
-        return result;
+        return prepared;
     }
 
-    m_was_updated = true;
-    flattened = input_port->get_table()->flatten();
+    prepared.m_stats.m_input_rows = input_port->get_table()->size();
+
+    // A batch whose pkeys are unique and already sorted is flat once its
+    // removed rows are cleared, so the port's table is taken as-is rather
+    // than copied by `flatten()`.
+    bool is_flat = input_port->get_table()->has_sorted_unique_pkeys();
+    if (is_flat) {
+        flattened = input_port->get_table();
+        input_port->release();
+        flattened->clear_deleted_rows();
+    } else {
+        flattened = input_port->get_table()->flatten();
+    }
 
     PSP_GNODE_VERIFY_TABLE(flattened);
     PSP_GNODE_VERIFY_TABLE(get_table());
 
     t_uindex flattened_num_rows = flattened->num_rows();
+    prepared.m_stats.m_flattened_rows = flattened_num_rows;
+    prepared.m_stats.m_applied_rows = flattened_num_rows;
 
     std::vector<t_rlookup> row_lookup(flattened_num_rows);
     t_column* pkey_col = flattened->get_column("psp_pkey").get();
@@ -314,29 +362,21 @@ t_gnode::_process_table(t_uindex port_id) {
         row_lookup[idx] = m_gstate->lookup(pkey);
     }
 
-    // first update - master table is empty
+    // first update - master table is empty, so there is nothing to diff
+    // against and the flattened table is applied as-is on commit.
     if (m_gstate->mapping_size() == 0) {
-        m_gstate->update_master_table(flattened.get());
-        m_oports[PSP_PORT_FLATTENED]->set_table(flattened);
-
-        _compute_expressions(flattened);
-
-        // Update all contexts registered with the gnode with data.
-        _update_contexts_from_state(m_gstate->get_pkeyed_table());
-
-        input_port->release();
-        release_outputs();
+        if (!is_flat) {
+            input_port->release();
+        }
 
-#ifdef PSP_GNODE_VERIFY
-        auto state_table = get_table();
-        PSP_GNODE_VERIFY_TABLE(state_table);
-#endif
-        // Make sure user is notified after first update.
-        result.m_should_notify_userspace = true;
-        return result;
+        prepared.m_flattened_data_table = flattened;
+        prepared.m_is_first_update = true;
+        return prepared;
     }
 
-    input_port->release_or_clear();
+    if (!is_flat) {
+        input_port->release_or_clear();
+    }
 
     // Use `t_process_state` to manage intermediate structures
     t_process_state _process_state;
@@ -363,6 +403,7 @@ t_gnode::_process_table(t_uindex port_id) {
 
     t_mask existed_mask = _process_mask_existed_rows(_process_state);
     auto mask_count = existed_mask.count();
+    prepared.m_stats.m_applied_rows = mask_count;
 
     // mask_count = flattened_num_rows - number of rows that were removed
     _process_state.set_size_transitional_data_tables(mask_count);
@@ -576,6 +617,47 @@ t_gnode::_process_table(t_uindex port_id) {
 
     PSP_GNODE_VERIFY_TABLE(flattened_masked);
 
+    prepared.m_flattened_data_table = flattened_masked;
+    return prepared;
+}
+
+t_process_table_result
+t_gnode::_commit_table(const t_process_table_prepared& prepared) {
+    t_process_table_result result;
+    result.m_flattened_data_table = nullptr;
+    result.m_should_notify_userspace = false;
+
+    const auto& flattened_masked = prepared.m_flattened_data_table;
+    m_was_updated = flattened_masked != nullptr;
+    if (!m_was_updated) {
+        return result;
+    }
+
+    m_last_update_stats = prepared.m_stats;
+
+    if (prepared.m_is_first_update) {
+        m_gstate->update_master_table(flattened_masked.get());
+        m_oports[PSP_PORT_FLATTENED]->set_table(flattened_masked);
+
+        // Every context is built from the new state here, including
+        // deferred ones, so their expressions are computed too.
+        _clear_pending_contexts();
+        _compute_expressions(flattened_masked);
+
+        // Update all contexts registered with the gnode with data.
+        _update_contexts_from_state(m_gstate->get_pkeyed_table());
+
+        release_outputs();
+
+#ifdef PSP_GNODE_VERIFY
+        auto state_table = get_table();
+        PSP_GNODE_VERIFY_TABLE(state_table);
+#endif
+        // Make sure user is notified after first update.
+        result.m_should_notify_userspace = true;
+        return result;
+    }
+
 #ifdef PSP_GNODE_VERIFY
     {
         auto updated_table = get_table();
@@ -868,25 +950,49 @@ t_gnode::_update_contexts_from_state(std::shared_ptr<t_data_table> tbl) {
         count++;
     }
 
+    auto groups = get_context_groups(context_handles);
+
     auto update_contexts_helper = [this,
                                    &context_names,
                                    &context_handles,
-                                   &tbl](t_index ctx_idx) {
-        const std::string& name = context_names[ctx_idx];
-        const t_ctx_handle& ctxh = context_handles[ctx_idx];
+                                   &groups,
+                                   &tbl](t_index group_idx) {
+        const std::vector<t_index>& group = groups[group_idx];
+        const std::string& name = context_names[group[0]];
+        const t_ctx_handle& ctxh = context_handles[group[0]];
 
         switch (ctxh.get_type()) {
             case TWO_SIDED_CONTEXT: {
                 auto* ctx = static_cast<t_ctx2*>(ctxh.m_ctx);
+                // The group's trees only compute the aggregates of its
+                // current members.
+                ctx->set_tree_aggregates(
+                    get_group_aggregates<t_ctx2>(context_handles, group)
+                );
+
                 // Do not reset the expression tables on the context,
                 // as they've already been computed.
                 ctx->reset(false);
                 update_context_from_state<t_ctx2>(ctx, name, tbl);
+                for (t_uindex idx = 1; idx < group.size(); ++idx) {
+                    const t_ctx_handle& shared = context_handles[group[idx]];
+                    shared.get<t_ctx2>()->reset(false);
+                    share_context_trees<t_ctx2>(ctxh, shared);
+                }
             } break;
             case ONE_SIDED_CONTEXT: {
                 auto* ctx = static_cast<t_ctx1*>(ctxh.m_ctx);
+                ctx->set_tree_aggregates(
+                    get_group_aggregates<t_ctx1>(context_handles, group)
+                );
+
                 ctx->reset(false);
                 update_context_from_state<t_ctx1>(ctx, name, tbl);
+                for (t_uindex idx = 1; idx < group.size(); ++idx) {
+                    const t_ctx_handle& shared = context_handles[group[idx]];
+                    shared.get<t_ctx1>()->reset(false);
+                    share_context_trees<t_ctx1>(ctxh, shared);
+                }
             } break;
             case ZERO_SIDED_CONTEXT: {
                 auto* ctx = static_cast<t_ctx0*>(ctxh.m_ctx);
@@ -909,8 +1015,8 @@ t_gnode::_update_contexts_from_state(std::shared_ptr<t_data_table> tbl) {
         }
     };
 
-    parallel_for(int(num_contexts), [&update_contexts_helper](int ctx_idx) {
-        update_contexts_helper(ctx_idx);
+    parallel_for(int(groups.size()), [&update_contexts_helper](int group_idx) {
+        update_contexts_helper(group_idx);
     });
 }
 
@@ -1003,116 +1109,193 @@ t_gnode::_register_context(
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     void* ptr_ = reinterpret_cast<void*>(ptr);
     t_ctx_handle ch(ptr_, type);
+
+    if (m_contexts.count(name) != 0) {
+        _clear_pending_context(name);
+        m_expression_cache->release(get_context_expressions(m_contexts[name]));
+    }
+
     m_contexts[name] = ch;
+    m_expression_cache->acquire(get_context_expressions(ch));
 
-    bool should_update = m_gstate->mapping_size() > 0;
-    std::shared_ptr<t_data_table> pkeyed_table;
+    switch (type) {
+        case TWO_SIDED_CONTEXT: {
+            set_ctx_state<t_ctx2>(ptr_);
+            static_cast<t_ctx2*>(ptr_)->reset();
+        } break;
+        case ONE_SIDED_CONTEXT: {
+            set_ctx_state<t_ctx1>(ptr_);
+            static_cast<t_ctx1*>(ptr_)->reset();
+        } break;
+        case ZERO_SIDED_CONTEXT: {
+            set_ctx_state<t_ctx0>(ptr_);
+            static_cast<t_ctx0*>(ptr_)->reset();
+        } break;
+        case UNIT_CONTEXT: {
+            set_ctx_state<t_ctxunit>(ptr_);
+            static_cast<t_ctxunit*>(ptr_)->reset();
+        } break;
+        case GROUPED_PKEY_CONTEXT: {
+            set_ctx_state<t_ctx0>(ptr_);
+            static_cast<t_ctx_grouped_pkey*>(ptr_)->reset();
+        } break;
+        default: {
+            PSP_COMPLAIN_AND_ABORT("Unexpected context type");
+        } break;
+    }
+
+    if (m_gstate->mapping_size() == 0) {
+        return;
+    }
+
+    // Sharing a peer's trees is cheap, so only contexts which would build
+    // their own from `m_gstate` are deferred.
+    if (m_lazy_contexts && !find_tree_peer(name, ch).has_value()) {
+        m_pending_contexts.insert(name);
+        m_expression_cache->set_pending(get_context_expressions(ch), true);
+        return;
+    }
 
-    if (should_update) {
-        pkeyed_table = m_gstate->get_pkeyed_table();
+    _build_context(name, ch);
+}
+
+void
+t_gnode::_build_context(const std::string& name) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    auto iter = m_contexts.find(name);
+    if (iter == m_contexts.end() || !is_context_pending(name)) {
+        return;
     }
 
+    _clear_pending_context(name);
+    _build_context(name, iter->second);
+}
+
+void
+t_gnode::_clear_pending_context(const std::string& name) {
+    auto iter = m_contexts.find(name);
+    if (iter != m_contexts.end() && m_pending_contexts.erase(name) != 0) {
+        m_expression_cache->set_pending(
+            get_context_expressions(iter->second), false
+        );
+    }
+}
+
+void
+t_gnode::_clear_pending_contexts() {
+    for (const auto& name : m_pending_contexts) {
+        m_expression_cache->set_pending(
+            get_context_expressions(m_contexts.at(name)), false
+        );
+    }
+
+    m_pending_contexts.clear();
+}
+
+bool
+t_gnode::is_context_pending(const std::string& name) const {
+    return m_pending_contexts.count(name) != 0;
+}
+
+void
+t_gnode::set_lazy_contexts(bool lazy) {
+    m_lazy_contexts = lazy;
+}
+
+std::optional<t_ctx_handle>
+t_gnode::find_tree_peer(const std::string& name, const t_ctx_handle& ch)
+    const {
+    std::string tree_key = get_tree_key(ch);
+    if (tree_key.empty()) {
+        return std::nullopt;
+    }
+
+    for (const auto& iter : m_contexts) {
+        if (iter.first != name && iter.second.get_type() == ch.get_type()
+            && !is_context_pending(iter.first)
+            && get_tree_key(iter.second) == tree_key) {
+            return iter.second;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void
+t_gnode::_build_context(const std::string& name, const t_ctx_handle& ch) {
     t_expression_vocab& expression_vocab = *(m_expression_vocab);
     t_regex_mapping& expression_regex_mapping = *(m_expression_regex_mapping);
 
-    switch (type) {
+    if (ch.get_type() != UNIT_CONTEXT) {
+        m_expression_cache->compute(
+            *m_gstate, expression_vocab, expression_regex_mapping, false
+        );
+        bind_context_expressions(ch);
+    }
+
+    // A context with the same tree shape as one already registered shares
+    // its trees rather than building its own from `m_gstate`.
+    auto peer = find_tree_peer(name, ch);
+
+    switch (ch.get_type()) {
         case TWO_SIDED_CONTEXT: {
-            set_ctx_state<t_ctx2>(ptr_);
-            auto* ctx = static_cast<t_ctx2*>(ptr_);
-            ctx->reset();
-
-            if (should_update) {
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
+            auto* ctx = ch.get<t_ctx2>();
+            if (peer.has_value()) {
+                join_context_trees<t_ctx2>(*peer, name, ch);
+            } else {
+                update_context_from_state<t_ctx2>(
+                    ctx,
+                    name,
                     m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
+                        ctx->get_config().get_dependency_columns()
                     )
                 );
-
-                update_context_from_state<t_ctx2>(ctx, name, pkeyed_table);
             }
         } break;
         case ONE_SIDED_CONTEXT: {
-            set_ctx_state<t_ctx1>(ptr_);
-            auto* ctx = static_cast<t_ctx1*>(ptr_);
-            ctx->reset();
-            if (should_update) {
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
+            auto* ctx = ch.get<t_ctx1>();
+            if (peer.has_value()) {
+                join_context_trees<t_ctx1>(*peer, name, ch);
+            } else {
+                update_context_from_state<t_ctx1>(
+                    ctx,
+                    name,
                     m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
+                        ctx->get_config().get_dependency_columns()
                     )
                 );
-
-                update_context_from_state<t_ctx1>(ctx, name, pkeyed_table);
             }
         } break;
         case ZERO_SIDED_CONTEXT: {
-            set_ctx_state<t_ctx0>(ptr_);
-            auto* ctx = static_cast<t_ctx0*>(ptr_);
-            ctx->reset();
-            if (should_update) {
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
-                    m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
-                    )
-                );
-
-                update_context_from_state<t_ctx0>(ctx, name, pkeyed_table);
-            }
+            auto* ctx = ch.get<t_ctx0>();
+            update_context_from_state<t_ctx0>(
+                ctx,
+                name,
+                m_gstate->get_pkeyed_table(
+                    ctx->get_config().get_dependency_columns()
+                )
+            );
         } break;
         case UNIT_CONTEXT: {
-            set_ctx_state<t_ctxunit>(ptr_);
-            auto* ctx = static_cast<t_ctxunit*>(ptr_);
-            ctx->reset();
-
-            // No expressions here to deal with
-            if (should_update) {
-                update_context_from_state<t_ctxunit>(ctx, name, pkeyed_table);
-            }
+            auto* ctx = ch.get<t_ctxunit>();
+            update_context_from_state<t_ctxunit>(
+                ctx,
+                name,
+                m_gstate->get_pkeyed_table(
+                    ctx->get_config().get_dependency_columns()
+                )
+            );
         } break;
         case GROUPED_PKEY_CONTEXT: {
-            set_ctx_state<t_ctx0>(ptr_);
-            auto* ctx = static_cast<t_ctx_grouped_pkey*>(ptr_);
-            ctx->reset();
-
-            if (should_update) {
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
-                    m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
-                    )
-                );
-
-                update_context_from_state<t_ctx_grouped_pkey>(
-                    ctx, name, pkeyed_table
-                );
-            }
+            auto* ctx = ch.get<t_ctx_grouped_pkey>();
+            update_context_from_state<t_ctx_grouped_pkey>(
+                ctx,
+                name,
+                m_gstate->get_pkeyed_table(
+                    ctx->get_config().get_dependency_columns()
+                )
+            );
         } break;
         default: {
             PSP_COMPLAIN_AND_ABORT("Unexpected context type");
@@ -1120,12 +1303,56 @@ t_gnode::_register_context(
     }
 }
 
+std::string
+t_gnode::get_tree_key(const t_ctx_handle& ctxh) const {
+    switch (ctxh.get_type()) {
+        case TWO_SIDED_CONTEXT: {
+            return ctxh.get<t_ctx2>()->get_config().get_tree_key();
+        }
+        case ONE_SIDED_CONTEXT: {
+            return ctxh.get<t_ctx1>()->get_config().get_tree_key();
+        }
+        default: {
+            return "";
+        }
+    }
+}
+
+std::vector<std::vector<t_index>>
+t_gnode::get_context_groups(const std::vector<t_ctx_handle>& ctxhvec) const {
+    std::vector<std::vector<t_index>> groups;
+    std::map<std::pair<t_ctx_type, std::string>, t_uindex> group_indices;
+
+    for (t_index idx = 0, loop_end = ctxhvec.size(); idx < loop_end; ++idx) {
+        const t_ctx_handle& ctxh = ctxhvec[idx];
+        std::string tree_key = get_tree_key(ctxh);
+        if (tree_key.empty()) {
+            groups.push_back({idx});
+            continue;
+        }
+
+        auto key = std::make_pair(ctxh.get_type(), tree_key);
+        auto iter = group_indices.find(key);
+        if (iter == group_indices.end()) {
+            group_indices[key] = groups.size();
+            groups.push_back({idx});
+        } else {
+            groups[iter->second].push_back(idx);
+        }
+    }
+
+    return groups;
+}
+
 void
 t_gnode::_unregister_context(const std::string& name) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    if (m_contexts.count(name) != 0) {
-        m_contexts.erase(name);
+    auto iter = m_contexts.find(name);
+    if (iter != m_contexts.end()) {
+        _clear_pending_context(name);
+        m_expression_cache->release(get_context_expressions(iter->second));
+        m_contexts.erase(iter);
     }
 }
 
@@ -1134,29 +1361,42 @@ t_gnode::notify_contexts(std::shared_ptr<t_data_table> flattened) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
 
-    t_index num_contexts = m_contexts.size();
-    std::vector<std::string> context_names(num_contexts);
-    std::vector<t_ctx_handle> ctxhvec(num_contexts);
-
-    t_index ctxh_count = 0;
+    std::vector<std::string> context_names;
+    std::vector<t_ctx_handle> ctxhvec;
+    context_names.reserve(m_contexts.size());
+    ctxhvec.reserve(m_contexts.size());
 
     for (const auto& iter : m_contexts) {
-        context_names[ctxh_count] = iter.first;
-        ctxhvec[ctxh_count] = iter.second;
-        ctxh_count++;
+        if (is_context_pending(iter.first)) {
+            continue;
+        }
+
+        context_names.push_back(iter.first);
+        ctxhvec.push_back(iter.second);
     }
 
+    // Contexts with identical trees are notified together, one group per
+    // task, as the members of a group share mutable state.
+    auto groups = get_context_groups(ctxhvec);
+
     auto notify_context_helper =
-        [this, &context_names, &ctxhvec, &flattened](t_index ctx_idx) {
-            const std::string& name = context_names[ctx_idx];
-            const t_ctx_handle& ctxh = ctxhvec[ctx_idx];
+        [this, &context_names, &ctxhvec, &groups, &flattened](
+            t_index group_idx
+        ) {
+            const std::vector<t_index>& group = groups[group_idx];
+            const std::string& name = context_names[group[0]];
+            const t_ctx_handle& ctxh = ctxhvec[group[0]];
 
             switch (ctxh.get_type()) {
                 case TWO_SIDED_CONTEXT: {
-                    notify_context<t_ctx2>(flattened, ctxh, name);
+                    notify_context_group<t_ctx2>(
+                        flattened, ctxhvec, context_names, group
+                    );
                 } break;
                 case ONE_SIDED_CONTEXT: {
-                    notify_context<t_ctx1>(flattened, ctxh, name);
+                    notify_context_group<t_ctx1>(
+                        flattened, ctxhvec, context_names, group
+                    );
                 } break;
                 case ZERO_SIDED_CONTEXT: {
                     notify_context<t_ctx0>(flattened, ctxh, name);
@@ -1173,8 +1413,8 @@ t_gnode::notify_contexts(std::shared_ptr<t_data_table> flattened) {
             }
         };
 
-    parallel_for(int(num_contexts), [&notify_context_helper](int ctx_idx) {
-        notify_context_helper(ctx_idx);
+    parallel_for(int(groups.size()), [&notify_context_helper](int group_idx) {
+        notify_context_helper(group_idx);
     });
 }
 
@@ -1190,75 +1430,12 @@ t_gnode::_compute_expressions(
     t_expression_vocab& expression_vocab = *(m_expression_vocab);
     t_regex_mapping& expression_regex_mapping = *(m_expression_regex_mapping);
 
+    m_expression_cache->compute(
+        *m_gstate, expression_vocab, expression_regex_mapping, true
+    );
+
     for (const auto& iter : m_contexts) {
-        const t_ctx_handle& ctxh = iter.second;
-        switch (ctxh.get_type()) {
-            case TWO_SIDED_CONTEXT: {
-                auto* ctx = static_cast<t_ctx2*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
-                    m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
-                    )
-                );
-            } break;
-            case ONE_SIDED_CONTEXT: {
-                auto* ctx = static_cast<t_ctx1*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
-                    m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
-                    )
-                );
-            } break;
-            case ZERO_SIDED_CONTEXT: {
-                auto* ctx = static_cast<t_ctx0*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
-                    m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
-                    )
-                );
-            } break;
-            case GROUPED_PKEY_CONTEXT: {
-                auto* ctx = static_cast<t_ctx_grouped_pkey*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    m_gstate->get_table(),
-                    m_gstate->get_pkey_map(),
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-                ctx->get_expression_tables()->set_flattened(
-                    m_gstate->get_pkeyed_table(
-                        ctx->get_expression_tables()->m_master->get_schema(),
-                        ctx->get_expression_tables()->m_master
-                    )
-                );
-            } break;
-            case UNIT_CONTEXT:
-                break;
-            default: {
-                PSP_COMPLAIN_AND_ABORT("Unexpected context type");
-            } break;
-        }
+        bind_context_expressions(iter.second);
     }
 }
 
@@ -1279,79 +1456,73 @@ t_gnode::_compute_expressions(
     t_expression_vocab& expression_vocab = *(m_expression_vocab);
     t_regex_mapping& expression_regex_mapping = *(m_expression_regex_mapping);
 
+    // Each distinct expression is computed once, however many contexts
+    // reference it.
+    m_expression_cache->compute(
+        master,
+        m_gstate->get_pkey_map(),
+        flattened,
+        delta,
+        prev,
+        current,
+        transitions,
+        existed,
+        expression_vocab,
+        expression_regex_mapping
+    );
+
     for (const auto& iter : m_contexts) {
-        const t_ctx_handle& ctxh = iter.second;
+        bind_context_expressions(iter.second);
+    }
+}
 
-        switch (ctxh.get_type()) {
-            case TWO_SIDED_CONTEXT: {
-                auto* ctx = static_cast<t_ctx2*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    master,
-                    m_gstate->get_pkey_map(),
-                    flattened,
-                    delta,
-                    prev,
-                    current,
-                    transitions,
-                    existed,
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-            } break;
-            case ONE_SIDED_CONTEXT: {
-                auto* ctx = static_cast<t_ctx1*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    master,
-                    m_gstate->get_pkey_map(),
-                    flattened,
-                    delta,
-                    prev,
-                    current,
-                    transitions,
-                    existed,
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-            } break;
-            case ZERO_SIDED_CONTEXT: {
-                auto* ctx = static_cast<t_ctx0*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    master,
-                    m_gstate->get_pkey_map(),
-                    flattened,
-                    delta,
-                    prev,
-                    current,
-                    transitions,
-                    existed,
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-            } break;
-            case GROUPED_PKEY_CONTEXT: {
-                auto* ctx = static_cast<t_ctx_grouped_pkey*>(ctxh.m_ctx);
-                ctx->compute_expressions(
-                    master,
-                    m_gstate->get_pkey_map(),
-                    flattened,
-                    delta,
-                    prev,
-                    current,
-                    transitions,
-                    existed,
-                    expression_vocab,
-                    expression_regex_mapping
-                );
-            } break;
-            case UNIT_CONTEXT:
-                break;
-            default: {
-                PSP_COMPLAIN_AND_ABORT("Unexpected context type");
-            } break;
+std::vector<std::shared_ptr<t_computed_expression>>
+t_gnode::get_context_expressions(const t_ctx_handle& ctxh) const {
+    switch (ctxh.get_type()) {
+        case TWO_SIDED_CONTEXT: {
+            return ctxh.get<t_ctx2>()->get_config().get_expressions();
+        }
+        case ONE_SIDED_CONTEXT: {
+            return ctxh.get<t_ctx1>()->get_config().get_expressions();
+        }
+        case ZERO_SIDED_CONTEXT: {
+            return ctxh.get<t_ctx0>()->get_config().get_expressions();
+        }
+        case GROUPED_PKEY_CONTEXT: {
+            return ctxh.get<t_ctx_grouped_pkey>()
+                ->get_config()
+                .get_expressions();
+        }
+        default: {
+            return {};
         }
     }
 }
 
+void
+t_gnode::bind_context_expressions(const t_ctx_handle& ctxh) const {
+    std::shared_ptr<t_expression_tables> tables;
+    switch (ctxh.get_type()) {
+        case TWO_SIDED_CONTEXT: {
+            tables = ctxh.get<t_ctx2>()->get_expression_tables();
+        } break;
+        case ONE_SIDED_CONTEXT: {
+            tables = ctxh.get<t_ctx1>()->get_expression_tables();
+        } break;
+        case ZERO_SIDED_CONTEXT: {
+            tables = ctxh.get<t_ctx0>()->get_expression_tables();
+        } break;
+        case GROUPED_PKEY_CONTEXT: {
+            tables = ctxh.get<t_ctx_grouped_pkey>()->get_expression_tables();
+        } break;
+        default: {
+            return;
+        }
+    }
+
+    m_expression_cache->bind(get_context_expressions(ctxh), *tables);
+}
+
 /******************************************************************************
  *
  * Getters
@@ -1482,6 +1653,27 @@ t_gnode::num_output_ports() const {
     return m_oports.size();
 }
 
+t_uindex
+t_gnode::get_num_pending_rows() const {
+    PSP_READ_LOCK(*m_lock);
+    t_uindex num_rows = 0;
+    for (const auto& iter : m_input_ports) {
+        num_rows += iter.second->get_table()->size();
+    }
+
+    return num_rows;
+}
+
+const t_gnode_update_stats&
+t_gnode::get_last_update_stats() const {
+    return m_last_update_stats;
+}
+
+t_expression_stats
+t_gnode::get_expression_stats(const t_computed_expression& expression) const {
+    return m_expression_cache->get_stats(expression);
+}
+
 void
 t_gnode::release_inputs() {
     for (const auto& iter : m_input_ports) {
@@ -1593,6 +1785,7 @@ t_gnode::reset() {
     // Clear expression-related state
     m_expression_vocab->clear();
     m_expression_regex_mapping->clear();
+    m_expression_cache->reset();
 }
 
 void
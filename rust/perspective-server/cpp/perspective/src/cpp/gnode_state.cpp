@@ -20,13 +20,18 @@
 #include <perspective/sym_table.h>
 #include <perspective/parallel_for.h>
 
+#include <algorithm>
+#include <set>
 #include <utility>
 
 namespace perspective {
 
-t_gstate::t_gstate(t_schema input_schema, t_schema output_schema) :
+t_gstate::t_gstate(
+    t_schema input_schema, t_schema output_schema, std::string index
+) :
     m_input_schema(std::move(input_schema)),
     m_output_schema(std::move(output_schema)),
+    m_index(std::move(index)),
     m_init(false) {
     LOG_CONSTRUCTOR("t_gstate");
 }
@@ -41,9 +46,29 @@ t_gstate::init() {
     m_table->init();
     m_pkcol = m_table->get_column("psp_pkey");
     m_opcol = m_table->get_column("psp_op");
+    alias_okey_column();
     m_init = true;
 }
 
+void
+t_gstate::alias_okey_column() {
+    m_key_aliases.clear();
+    t_dtype pkey_dtype = m_input_schema.get_dtype("psp_pkey");
+    for (const auto& column_name : {std::string("psp_okey"), m_index}) {
+        if (!column_name.empty() && m_input_schema.has_column(column_name)
+            && m_input_schema.get_dtype(column_name) == pkey_dtype) {
+            m_table->set_column(column_name, m_table->get_column("psp_pkey"));
+            m_key_aliases.push_back(column_name);
+        }
+    }
+}
+
+bool
+t_gstate::is_key_alias(const std::string& column_name) const {
+    return std::find(m_key_aliases.begin(), m_key_aliases.end(), column_name)
+        != m_key_aliases.end();
+}
+
 t_rlookup
 t_gstate::lookup(t_tscalar pkey) const {
     t_rlookup rval(0, false);
@@ -136,9 +161,13 @@ t_gstate::fill_master_table(const t_data_table* flattened) {
 
     parallel_for(
         int(ncols),
-        [&master_table, &master_table_schema, &flattened](int idx) {
+        [&master_table, &master_table_schema, &flattened, this](int idx) {
             // Clone each column from flattened into `m_table`
             const std::string& column_name = master_table_schema.m_columns[idx];
+            if (is_key_alias(column_name)) {
+                return;
+            }
+
             // No need for safe lookup as master_table schema == flattened
             // schema
             auto flattened_column =
@@ -152,6 +181,7 @@ t_gstate::fill_master_table(const t_data_table* flattened) {
 
     m_pkcol = master_table->get_column("psp_pkey");
     m_opcol = master_table->get_column("psp_op");
+    alias_okey_column();
 
     master_table->set_capacity(flattened->get_capacity());
     master_table->set_size(flattened->size());
@@ -239,6 +269,10 @@ t_gstate::update_master_table(const t_data_table* flattened) {
          &master_table_indexes,
          this](int idx) {
             const std::string& column_name = master_schema.m_columns[idx];
+            if (is_key_alias(column_name)) {
+                return;
+            }
+
             t_column* master_column =
                 master_table->get_column(column_name).get();
             auto flattened_column =
@@ -668,6 +702,27 @@ t_gstate::get_pkeyed_table(
     return rval;
 }
 
+std::shared_ptr<t_data_table>
+t_gstate::get_pkeyed_table(const std::vector<std::string>& columns) const {
+    std::vector<std::string> names;
+    std::vector<t_dtype> dtypes;
+    std::set<std::string> seen;
+
+    for (const auto& colname : columns) {
+        if (m_input_schema.has_column(colname)
+            && seen.insert(colname).second) {
+            names.push_back(colname);
+            dtypes.push_back(m_input_schema.get_dtype(colname));
+        }
+    }
+
+    if (m_mapping.size() == m_table->size()) {
+        return m_table->borrow(names);
+    }
+
+    return get_pkeyed_table(t_schema(names, dtypes), m_table);
+}
+
 t_uindex
 t_gstate::num_rows() const {
     return m_table->num_rows();
@@ -775,6 +830,7 @@ t_gstate::mapping_size() const {
 void
 t_gstate::reset() {
     m_table->reset();
+    alias_okey_column();
     m_mapping.clear();
     m_free.clear();
 }
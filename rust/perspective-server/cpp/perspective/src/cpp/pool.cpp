@@ -228,6 +228,31 @@ t_pool::unregister_context(t_uindex gnode_id, const std::string& name) {
     m_gnodes[gnode_id]->_unregister_context(name);
 }
 
+void
+t_pool::build_context(t_uindex gnode_id, const std::string& name) {
+    // Most reads are of contexts which are already built, so check under
+    // the shared lock before taking the exclusive one.
+    {
+#ifdef PSP_PARALLEL_FOR
+        PSP_READ_LOCK(*m_lock)
+#endif
+        if (!validate_gnode_id(gnode_id)
+            || !m_gnodes[gnode_id]->is_context_pending(name)) {
+            return;
+        }
+    }
+
+#ifdef PSP_PARALLEL_FOR
+    PSP_WRITE_LOCK(*m_lock)
+#endif
+
+    if (!validate_gnode_id(gnode_id)) {
+        return;
+    }
+
+    m_gnodes[gnode_id]->_build_context(name);
+}
+
 bool
 t_pool::get_data_remaining() const {
     auto data = m_data_remaining.load();
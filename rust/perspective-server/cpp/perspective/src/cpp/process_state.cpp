@@ -14,7 +14,10 @@
 
 namespace perspective {
 
-t_process_state::t_process_state() = default;
+t_process_state::t_process_state() :
+    m_op_base(nullptr),
+    m_inserts_only(false),
+    m_insert_transitions() {}
 
 void
 t_process_state::clear_transitional_data_tables() const {
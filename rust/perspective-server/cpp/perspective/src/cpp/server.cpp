@@ -13,6 +13,7 @@
 #include "google/protobuf/repeated_ptr_field.h"
 #include "google/protobuf/struct.pb.h"
 #include "perspective.pb.h"
+#include "perspective/arrow_writer.h"
 #include "perspective/base.h"
 #include "perspective/computed_expression.h"
 #include "perspective/exception.h"
@@ -25,11 +26,13 @@
 #include "perspective/view.h"
 #include "perspective/view_config.h"
 #include "re2/re2.h"
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <perspective/server.h>
 #include <re2/stringpiece.h>
 #include <string>
@@ -46,6 +49,10 @@
 #include <sys/resource.h>
 #endif
 
+#ifdef PSP_PARALLEL_FOR
+#include "perspective/parallel_for.h"
+#endif
+
 namespace perspective {
 std::uint32_t server::ProtoServer::m_client_id = 1;
 
@@ -123,6 +130,7 @@ make_context(
     auto expressions = view_config->get_used_expressions();
 
     auto cfg = t_config(row_pivots, aggspecs, fterm, filter_op, expressions);
+    cfg.set_tree_options(table->get_tree_options());
     auto ctx1 = std::make_shared<t_ctx1>(*schema, cfg);
 
     ctx1->init();
@@ -178,6 +186,7 @@ make_context(
         expressions,
         column_only
     );
+    cfg.set_tree_options(table->get_tree_options());
     auto ctx2 = std::make_shared<t_ctx2>(*schema, cfg);
 
     ctx2->init();
@@ -499,6 +508,7 @@ ServerResources::delete_view(const std::uint32_t& client_id, const t_id& id) {
 
     drop_view_on_update_sub(id);
     drop_view_on_delete_sub(id);
+    drop_view_streams(id);
 }
 
 void
@@ -508,6 +518,7 @@ ServerResources::delete_table(const t_id& id) {
         if (m_table_to_view.find(id) == m_table_to_view.end()) {
             m_tables.erase(id);
             m_dirty_tables.erase(id);
+            m_coalesce_windows.erase(id);
             m_deleted_tables.erase(id);
         } else {
             PSP_COMPLAIN_AND_ABORT("Cannot delete table with views");
@@ -519,18 +530,122 @@ void
 ServerResources::mark_table_dirty(const t_id& id) {
     PSP_WRITE_LOCK(m_write_lock);
     m_dirty_tables.insert(id);
+    if (m_coalesce_policies.contains(id)) {
+        const auto now = std::chrono::steady_clock::now();
+        auto window =
+            m_coalesce_windows.try_emplace(id, CoalesceWindow{now, now}).first;
+        window.value().last_update = now;
+    }
 }
 
 void
 ServerResources::mark_table_clean(const t_id& id) {
     PSP_WRITE_LOCK(m_write_lock);
     m_dirty_tables.erase(id);
+    m_coalesce_windows.erase(id);
 }
 
 void
 ServerResources::mark_all_tables_clean() {
     PSP_WRITE_LOCK(m_write_lock);
     m_dirty_tables.clear();
+    m_coalesce_windows.clear();
+}
+
+void
+ServerResources::set_table_coalesce_policy(
+    const t_id& id, CoalescePolicy policy
+) {
+    PSP_WRITE_LOCK(m_write_lock);
+    if (policy.max_latency_ms == 0 && policy.max_rows == 0) {
+        m_coalesce_policies.erase(id);
+        m_coalesce_windows.erase(id);
+    } else {
+        m_coalesce_policies[id] = policy;
+        if (m_dirty_tables.contains(id)) {
+            const auto now = std::chrono::steady_clock::now();
+            m_coalesce_windows.try_emplace(id, CoalesceWindow{now, now});
+        }
+    }
+}
+
+bool
+ServerResources::is_table_coalescing(
+    const t_id& id, const std::shared_ptr<Table>& table
+) {
+    CoalescePolicy policy;
+    CoalesceWindow window;
+    {
+        PSP_READ_LOCK(m_write_lock);
+        if (!m_coalesce_policies.contains(id)
+            || !m_coalesce_windows.contains(id)) {
+            return false;
+        }
+
+        policy = m_coalesce_policies.at(id);
+        window = m_coalesce_windows.at(id);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (policy.max_latency_ms > 0) {
+        if (now - window.opened
+            >= std::chrono::milliseconds(policy.max_latency_ms)) {
+            return false;
+        }
+    } else if (now - window.last_update
+               >= std::chrono::milliseconds(COALESCE_MAX_IDLE_MS)) {
+        return false;
+    }
+
+    if (policy.max_rows > 0
+        && table->get_gnode()->get_num_pending_rows() >= policy.max_rows) {
+        return false;
+    }
+
+    return true;
+}
+
+bool
+ServerResources::set_table_tree_options(
+    const t_id& id, const t_stree_options& options
+) {
+    PSP_WRITE_LOCK(m_write_lock);
+    auto table = m_tables.find(id);
+    if (table == m_tables.end() || m_deleted_tables.contains(id)) {
+        return false;
+    }
+
+    table->second->set_tree_options(options);
+    return true;
+}
+
+bool
+ServerResources::has_table_coalesce_policy(const t_id& id) {
+    PSP_READ_LOCK(m_write_lock);
+    return m_coalesce_policies.contains(id);
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+ServerResources::get_coalesce_deadline() {
+    PSP_READ_LOCK(m_write_lock);
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    for (const auto& [id, window] : m_coalesce_windows) {
+        auto policy = m_coalesce_policies.find(id);
+        if (policy == m_coalesce_policies.end()) {
+            continue;
+        }
+
+        const auto max_latency_ms = policy->second.max_latency_ms;
+        auto expires = max_latency_ms > 0
+            ? window.opened + std::chrono::milliseconds(max_latency_ms)
+            : window.last_update
+                + std::chrono::milliseconds(COALESCE_MAX_IDLE_MS);
+        if (!deadline.has_value() || expires < *deadline) {
+            deadline = expires;
+        }
+    }
+
+    return deadline;
 }
 
 void
@@ -650,12 +765,74 @@ ServerResources::get_view_on_update_sub(const t_id& view_id) {
     return m_view_on_update_subs.at(view_id);
 }
 
+std::vector<Subscription>
+ServerResources::get_conflated_view_on_update_subs() {
+    PSP_READ_LOCK(m_write_lock);
+    std::vector<Subscription> out;
+    for (const auto& [view_id, subs] : m_view_on_update_subs) {
+        for (const auto& sub : subs) {
+            if (sub.conflation != nullptr) {
+                out.push_back(sub);
+            }
+        }
+    }
+
+    return out;
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+ServerResources::get_conflation_deadline() {
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    for (const auto& sub : get_conflated_view_on_update_subs()) {
+        auto& conflation = *sub.conflation;
+        PSP_READ_LOCK(conflation.lock);
+
+        // An update awaiting an ack is sent when the ack arrives.
+        if (!conflation.pending.has_value() || conflation.awaiting_ack) {
+            continue;
+        }
+
+        auto due = conflation.last_sent
+            + std::chrono::milliseconds(conflation.min_interval_ms);
+        if (!deadline.has_value() || due < *deadline) {
+            deadline = due;
+        }
+    }
+
+    return deadline;
+}
+
 void
 ServerResources::drop_view_on_update_sub(const t_id& view_id) {
     PSP_WRITE_LOCK(m_write_lock);
     m_view_on_update_subs.erase(view_id);
 }
 
+bool
+ServerResources::set_view_on_update_viewport(
+    const t_id& view_id,
+    std::uint32_t sub_id,
+    std::uint32_t client_id,
+    const proto::ViewPort& viewport,
+    std::shared_ptr<t_viewport_keys> keys
+) {
+    PSP_WRITE_LOCK(m_write_lock);
+    if (!m_view_on_update_subs.contains(view_id)) {
+        return false;
+    }
+
+    for (auto& sub : m_view_on_update_subs[view_id]) {
+        if (sub.id == sub_id && sub.client_id == client_id
+            && sub.viewport.has_value()) {
+            sub.viewport = viewport;
+            sub.viewport_keys = std::move(keys);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void
 ServerResources::remove_view_on_update_sub(
     const t_id& view_id, std::uint32_t sub_id, std::uint32_t client_id
@@ -675,6 +852,40 @@ ServerResources::remove_view_on_update_sub(
     }
 }
 
+void
+ServerResources::create_view_stream(const t_id& view_id, ViewStream stream) {
+    PSP_WRITE_LOCK(m_write_lock);
+    m_view_streams[view_id].push_back(std::move(stream));
+}
+
+std::optional<ViewStream>
+ServerResources::take_view_stream(
+    const t_id& view_id, std::uint32_t stream_id, std::uint32_t client_id
+) {
+    PSP_WRITE_LOCK(m_write_lock);
+    auto iter = m_view_streams.find(view_id);
+    if (iter == m_view_streams.end()) {
+        return std::nullopt;
+    }
+
+    auto& streams = iter.value();
+    for (auto stream = streams.begin(); stream != streams.end(); ++stream) {
+        if (stream->id == stream_id && stream->client_id == client_id) {
+            ViewStream out = std::move(*stream);
+            streams.erase(stream);
+            return out;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void
+ServerResources::drop_view_streams(const t_id& view_id) {
+    PSP_WRITE_LOCK(m_write_lock);
+    m_view_streams.erase(view_id);
+}
+
 void
 ServerResources::create_on_hosted_tables_update_sub(Subscription sub) {
     PSP_WRITE_LOCK(m_write_lock);
@@ -741,6 +952,22 @@ ServerResources::drop_client(std::uint32_t client_id) {
     );
 
     m_on_hosted_tables_update_subs = subs;
+
+    // Streams of views owned by other clients.
+    for (auto iter = m_view_streams.begin(); iter != m_view_streams.end();
+         ++iter) {
+        auto& streams = iter.value();
+        streams.erase(
+            std::remove_if(
+                streams.begin(),
+                streams.end(),
+                [&client_id](const ViewStream& stream) {
+                    return stream.client_id == client_id;
+                }
+            ),
+            streams.end()
+        );
+    }
 }
 
 std::uint32_t
@@ -786,119 +1013,103 @@ ProtoServer::close_session(const std::uint32_t client_id) {
             .count();
 }
 
-std::vector<ProtoServerResp<std::string>>
-ProtoServer::handle_request(
-    std::uint32_t client_id, const std::string_view& data
-) {
-    const auto start = std::chrono::high_resolution_clock::now();
-    proto::Request req_env;
-    req_env.ParseFromString(data);
-    std::vector<ProtoServerResp<std::string>> serialized_responses;
-    std::vector<proto::Response> responses;
-
-    auto msg_id = req_env.msg_id();
-    auto entity_id = req_env.entity_id();
+/**
+ * @brief Wrap an exception caught while handling a request (or poll) in a
+ * `server_error` `Response`.
+ */
+static proto::Response
+error_response(const std::exception_ptr& error) {
+    proto::Response resp;
     try {
-        auto resp_msg = _handle_request(client_id, std::move(req_env));
-        for (auto& resp : resp_msg) {
-            ProtoServerResp<std::string> str_resp;
-            str_resp.data = resp.data.SerializeAsString();
-            str_resp.client_id = resp.client_id;
-            serialized_responses.emplace_back(std::move(str_resp));
-        }
+        std::rethrow_exception(error);
     } catch (const PerspectiveException& e) {
-        proto::Response resp;
         auto* err = resp.mutable_server_error()->mutable_message();
         *err = std::string(e.what());
-        responses.emplace_back(std::move(resp));
     } catch (const PerspectiveViewNotFoundException& e) {
-        proto::Response resp;
         auto* err = resp.mutable_server_error();
         err->set_status_code(proto::StatusCode::VIEW_NOT_FOUND);
         auto* msg = err->mutable_message();
         *msg = std::string(e.what());
-        responses.emplace_back(std::move(resp));
     } catch (const std::exception& e) {
-        proto::Response resp;
         auto* err = resp.mutable_server_error()->mutable_message();
         *err = std::string(e.what());
-        responses.emplace_back(std::move(resp));
     } catch (...) {
-        proto::Response resp;
         auto* err = resp.mutable_server_error()->mutable_message();
-        std::exception_ptr p = std::current_exception();
         *err = "Unknown exception";
-        responses.emplace_back(std::move(resp));
     }
 
-    // proto::Response resp_env;
-    serialized_responses.reserve(responses.size());
-    for (auto& resp : responses) {
-        resp.set_msg_id(msg_id);
-        resp.set_entity_id(entity_id);
+    return resp;
+}
 
+static std::vector<ProtoServerResp<std::string>>
+serialize_responses(std::vector<ProtoServerResp<proto::Response>>&& msgs) {
+    std::vector<ProtoServerResp<std::string>> serialized_responses;
+    serialized_responses.reserve(msgs.size());
+    for (auto& resp : msgs) {
         ProtoServerResp<std::string> str_resp;
-        str_resp.data = resp.SerializeAsString();
-        str_resp.client_id = client_id;
+        str_resp.data = resp.data.SerializeAsString();
+        str_resp.client_id = resp.client_id;
         serialized_responses.emplace_back(std::move(str_resp));
     }
 
+    return serialized_responses;
+}
+
+std::vector<ProtoServerResp<std::string>>
+ProtoServer::handle_request(
+    std::uint32_t client_id, const std::string_view& data
+) {
+    return serialize_responses(handle_request_messages(client_id, data));
+}
+
+std::vector<ProtoServerResp<ProtoServer::Response>>
+ProtoServer::handle_request_messages(
+    std::uint32_t client_id, const std::string_view& data
+) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    proto::Request req_env;
+    req_env.ParseFromArray(data.data(), static_cast<int>(data.size()));
+    std::vector<ProtoServerResp<Response>> responses;
+
+    auto msg_id = req_env.msg_id();
+    auto entity_id = req_env.entity_id();
+    try {
+        responses = _handle_request(client_id, std::move(req_env));
+    } catch (...) {
+        auto resp = error_response(std::current_exception());
+        resp.set_msg_id(msg_id);
+        resp.set_entity_id(entity_id);
+
+        ProtoServerResp<Response> err_resp;
+        err_resp.data = std::move(resp);
+        err_resp.client_id = client_id;
+        responses.emplace_back(std::move(err_resp));
+    }
+
     const auto end = std::chrono::high_resolution_clock::now();
     m_cpu_time +=
         std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
             .count();
 
-    return serialized_responses;
+    return responses;
 }
 
 std::vector<ProtoServerResp<std::string>>
 ProtoServer::poll() {
+    return serialize_responses(poll_messages());
+}
+
+std::vector<ProtoServerResp<ProtoServer::Response>>
+ProtoServer::poll_messages() {
     const auto start = std::chrono::high_resolution_clock::now();
-    std::vector<ProtoServerResp<std::string>> out;
+    std::vector<ProtoServerResp<Response>> out;
     try {
-        const auto& responses = _poll();
-        for (const auto& resp : responses) {
-            ProtoServerResp<std::string> str_resp;
-            str_resp.data = resp.data.SerializeAsString();
-            str_resp.client_id = resp.client_id;
-            out.emplace_back(str_resp);
-        }
-
-    } catch (const PerspectiveException& e) {
-        proto::Response resp;
-        auto* err = resp.mutable_server_error()->mutable_message();
-        *err = std::string(e.what());
-        ProtoServerResp<std::string> str_resp;
-        str_resp.data = resp.SerializeAsString();
-        str_resp.client_id = 0;
-        out.emplace_back(std::move(str_resp));
-    } catch (const PerspectiveViewNotFoundException& e) {
-        proto::Response resp;
-        auto* err = resp.mutable_server_error();
-        err->set_status_code(proto::StatusCode::VIEW_NOT_FOUND);
-        auto* msg = err->mutable_message();
-        *msg = std::string(e.what());
-        ProtoServerResp<std::string> str_resp;
-        str_resp.data = resp.SerializeAsString();
-        str_resp.client_id = 0;
-        out.emplace_back(std::move(str_resp));
-    } catch (const std::exception& e) {
-        proto::Response resp;
-        auto* err = resp.mutable_server_error()->mutable_message();
-        *err = std::string(e.what());
-        ProtoServerResp<std::string> str_resp;
-        str_resp.data = resp.SerializeAsString();
-        str_resp.client_id = 0;
-        out.emplace_back(std::move(str_resp));
+        out = _poll();
     } catch (...) {
-        proto::Response resp;
-        auto* err = resp.mutable_server_error()->mutable_message();
-        std::exception_ptr p = std::current_exception();
-        *err = "Unknown exception";
-        ProtoServerResp<std::string> str_resp;
-        str_resp.data = resp.SerializeAsString();
-        str_resp.client_id = 0;
-        out.emplace_back(std::move(str_resp));
+        ProtoServerResp<Response> err_resp;
+        err_resp.data = error_response(std::current_exception());
+        err_resp.client_id = 0;
+        out.emplace_back(std::move(err_resp));
     }
 
     const auto end = std::chrono::high_resolution_clock::now();
@@ -1032,6 +1243,11 @@ needs_poll(const proto::Request::ClientReqCase proto_case) {
         case ReqCase::kViewCollapseReq:
         case ReqCase::kViewExpandReq:
         case ReqCase::kViewSetDepthReq:
+        case ReqCase::kViewSetSortReq:
+        case ReqCase::kViewSetOnUpdateViewportReq:
+        case ReqCase::kViewProfileReq:
+        case ReqCase::kViewStreamReq:
+        case ReqCase::kViewStreamNextReq:
             return true;
         case ReqCase::kTableOnDeleteReq:
         case ReqCase::kViewOnDeleteReq:
@@ -1047,6 +1263,7 @@ needs_poll(const proto::Request::ClientReqCase proto_case) {
         case ReqCase::kViewDeleteReq:
         case ReqCase::kViewExpressionSchemaReq:
         case ReqCase::kViewRemoveOnUpdateReq:
+        case ReqCase::kViewOnUpdateAckReq:
         case ReqCase::kServerSystemInfoReq:
         case ReqCase::kGetFeaturesReq:
             return false;
@@ -1091,11 +1308,17 @@ entity_type_is_table(const proto::Request::ClientReqCase proto_case) {
         case ReqCase::kViewCollapseReq:
         case ReqCase::kViewExpandReq:
         case ReqCase::kViewSetDepthReq:
+        case ReqCase::kViewSetSortReq:
+        case ReqCase::kViewSetOnUpdateViewportReq:
+        case ReqCase::kViewProfileReq:
+        case ReqCase::kViewStreamReq:
+        case ReqCase::kViewStreamNextReq:
         case ReqCase::kViewGetConfigReq:
         case ReqCase::kViewColumnPathsReq:
         case ReqCase::kViewDeleteReq:
         case ReqCase::kViewExpressionSchemaReq:
         case ReqCase::kViewRemoveOnUpdateReq:
+        case ReqCase::kViewOnUpdateAckReq:
         case ReqCase::kRemoveHostedTablesUpdateReq:
             return false;
         case proto::Request::CLIENT_REQ_NOT_SET:
@@ -1104,25 +1327,50 @@ entity_type_is_table(const proto::Request::ClientReqCase proto_case) {
     throw std::runtime_error("Unhandled request type");
 }
 
+/**
+ * @brief Whether a view request reads the view's context, and so must build
+ * it if its construction was deferred by `ProtoServer::set_lazy_views`. An
+ * `on_update` without a `mode` is only told that the view changed, so it
+ * leaves the context pending until something reads it.
+ */
+static bool
+reads_view_context(const proto::Request& req) {
+    using ReqCase = proto::Request::ClientReqCase;
+    const auto proto_case = req.client_req_case();
+    if (entity_type_is_table(proto_case)) {
+        return false;
+    }
+
+    if (proto_case == ReqCase::kViewOnUpdateReq) {
+        return req.view_on_update_req().has_mode();
+    }
+
+    return needs_poll(proto_case) || proto_case == ReqCase::kViewColumnPathsReq;
+}
+
 void
 ProtoServer::handle_process_table(
     const Request& req,
     std::vector<ProtoServerResp<ProtoServer::Response>>& proto_resp
 ) {
-    if (!m_realtime_mode && needs_poll(req.client_req_case())) {
-        if (entity_type_is_table(req.client_req_case())) {
-            if (m_resources.is_table_dirty(req.entity_id())) {
-                auto table = m_resources.get_table(req.entity_id());
-                const auto& table_id = req.entity_id();
-                _process_table(table, table_id, proto_resp);
-            }
-        } else {
-            auto table_id = m_resources.get_table_id_for_view(req.entity_id());
-            if (m_resources.is_table_dirty(table_id)) {
-                auto table = m_resources.get_table(table_id);
-                _process_table(table, table_id, proto_resp);
-            }
-        }
+    if (!needs_poll(req.client_req_case())) {
+        return;
+    }
+
+    auto table_id = entity_type_is_table(req.client_req_case())
+        ? req.entity_id()
+        : m_resources.get_table_id_for_view(req.entity_id());
+
+    // In realtime mode a dirty table is processed by the `poll()` which
+    // follows `on_poll_request`, unless it is inside a coalescing window,
+    // which that `poll()` skips.
+    if (m_realtime_mode && !m_resources.has_table_coalesce_policy(table_id)) {
+        return;
+    }
+
+    if (m_resources.is_table_dirty(table_id)) {
+        auto table = m_resources.get_table(table_id);
+        _process_table(table, table_id, proto_resp);
     }
 }
 
@@ -1176,6 +1424,164 @@ calculate_num_hidden(const ErasedView& view, const t_view_config& config) {
     return num_hidden;
 }
 
+/**
+ * @brief The extents of `viewport` in `view`, as `kViewToArrowReq` reads
+ * them.
+ */
+static ValidViewPort
+view_viewport_dims(const ErasedView& view, const proto::ViewPort& viewport) {
+    auto config = view.get_view_config();
+    return parse_format_options(
+        viewport,
+        view.num_columns(),
+        view.num_rows(),
+        view.sides(),
+        config->is_column_only(),
+        calculate_num_hidden(view, *config)
+    );
+}
+
+/**
+ * @brief Read the next chunk of `stream` from `view`, advancing `stream`.
+ * The view may have changed since the last chunk was read, so the end of the
+ * export is clamped to the view's current size.
+ */
+static void
+read_view_stream_chunk(
+    const ErasedView& view, ViewStream& stream, proto::ViewStreamResp& resp
+) {
+    const auto& r = stream.req;
+    if (!stream.started) {
+        stream.next_row = r.viewport().start_row();
+    }
+
+    auto end_row = view_viewport_dims(view, r.viewport()).end_row;
+    if (stream.started && stream.next_row >= end_row) {
+        resp.set_done(true);
+        return;
+    }
+
+    proto::ViewPort viewport = r.viewport();
+    viewport.set_start_row(stream.next_row);
+    if (r.chunk_rows() > 0) {
+        viewport.set_end_row(
+            std::min(end_row, stream.next_row + r.chunk_rows())
+        );
+    }
+
+    auto dims = view_viewport_dims(view, viewport);
+    if (r.format() == proto::ViewStreamReq_Format_CSV) {
+        *resp.mutable_chunk() = std::move(*view.to_csv(
+            dims.start_row,
+            dims.end_row,
+            dims.start_col,
+            dims.end_col,
+            !stream.started
+        ));
+    } else {
+        *resp.mutable_chunk() = std::move(*view.to_arrow(
+            dims.start_row,
+            dims.end_row,
+            dims.start_col,
+            dims.end_col,
+            true,
+            r.compression() == "lz4"
+        ));
+    }
+
+    stream.started = true;
+    stream.next_row = std::max(dims.start_row, dims.end_row);
+    resp.set_done(stream.next_row >= end_row);
+}
+
+/**
+ * @brief Merge the `on_update` response `next` into the held back response
+ * `pending`, by appending the batches of its `delta`.
+ *
+ * @return bool `false` if the deltas' schemas differ, so cannot be merged.
+ */
+static bool
+merge_on_update(proto::Response& pending, const proto::Response& next) {
+    auto* pending_resp = pending.mutable_view_on_update_resp();
+    const auto& next_resp = next.view_on_update_resp();
+    if (next_resp.has_delta()) {
+        if (!pending_resp->has_delta()) {
+            pending_resp->set_delta(next_resp.delta());
+        } else if (!apachearrow::append_stream(
+                       *pending_resp->mutable_delta(), next_resp.delta()
+                   )) {
+            return false;
+        }
+    }
+
+    pending_resp->set_port_id(next_resp.port_id());
+    return true;
+}
+
+/**
+ * @brief Send `conflation`'s pending update, if any, unless it is still held
+ * back. The caller must hold `conflation.lock`.
+ */
+static void
+flush_conflation(
+    Conflation& conflation,
+    std::uint32_t client_id,
+    std::vector<ProtoServerResp<proto::Response>>& outs
+) {
+    const auto now = std::chrono::steady_clock::now();
+    if (!conflation.pending.has_value() || conflation.awaiting_ack
+        || now - conflation.last_sent
+            < std::chrono::milliseconds(conflation.min_interval_ms)) {
+        return;
+    }
+
+    ProtoServerResp<proto::Response> resp;
+    resp.data = std::move(*conflation.pending);
+    resp.client_id = client_id;
+    outs.emplace_back(std::move(resp));
+    conflation.pending.reset();
+    conflation.last_sent = now;
+    conflation.awaiting_ack = conflation.ack;
+}
+
+/**
+ * @brief Send the `on_update` response `out` to `sub`, or if `sub` is
+ * conflated, merge it into its pending update first.
+ */
+static void
+notify_on_update(
+    const Subscription& sub,
+    proto::Response&& out,
+    std::vector<ProtoServerResp<proto::Response>>& outs
+) {
+    if (sub.conflation == nullptr) {
+        ProtoServerResp<proto::Response> resp;
+        resp.data = std::move(out);
+        resp.client_id = sub.client_id;
+        outs.emplace_back(std::move(resp));
+        return;
+    }
+
+    auto& conflation = *sub.conflation;
+    PSP_WRITE_LOCK(conflation.lock);
+    if (!conflation.pending.has_value()) {
+        conflation.pending = std::move(out);
+    } else if (!merge_on_update(*conflation.pending, out)) {
+        // The view's schema changed, so the pending update is sent early
+        // rather than dropped.
+        ProtoServerResp<proto::Response> resp;
+        resp.data = std::move(*conflation.pending);
+        resp.client_id = sub.client_id;
+        outs.emplace_back(std::move(resp));
+        conflation.pending = std::move(out);
+        conflation.last_sent = std::chrono::steady_clock::now();
+        conflation.awaiting_ack = conflation.ack;
+        return;
+    }
+
+    flush_conflation(conflation, sub.client_id, outs);
+}
+
 template <typename A>
 static t_tscalar
 coerce_to(const t_dtype dtype, const A& val) {
@@ -1332,8 +1738,14 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
         proto_resp.emplace_back(std::move(resp2));
     };
 
-    if (!m_realtime_mode) {
-        handle_process_table(req, proto_resp);
+    handle_process_table(req, proto_resp);
+
+    if (m_lazy_views && reads_view_context(req)
+        && m_resources.has_view(req.entity_id())) {
+        auto table = m_resources.get_table_for_view(req.entity_id());
+        table->get_pool()->build_context(
+            table->get_gnode()->get_id(), req.entity_id()
+        );
     }
 
     switch (req.client_req_case()) {
@@ -1557,35 +1969,55 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
                     break;
                 }
                 case proto::MakeTableData::kFromArrow: {
-                    std::string data = r.data().from_arrow();
+                    std::string data = std::move(
+                        *req.mutable_make_table_req()
+                             ->mutable_data()
+                             ->mutable_from_arrow()
+                    );
                     { auto _ = std::move(req); }
 
                     table = Table::from_arrow(index, std::move(data), limit);
                     break;
                 }
                 case proto::MakeTableData::kFromCsv: {
-                    std::string data = r.data().from_csv();
+                    std::string data = std::move(
+                        *req.mutable_make_table_req()
+                             ->mutable_data()
+                             ->mutable_from_csv()
+                    );
                     { auto _ = std::move(req); }
 
                     table = Table::from_csv(index, std::move(data), limit);
                     break;
                 }
                 case proto::MakeTableData::kFromCols: {
-                    std::string data = r.data().from_cols();
+                    std::string data = std::move(
+                        *req.mutable_make_table_req()
+                             ->mutable_data()
+                             ->mutable_from_cols()
+                    );
                     { auto _ = std::move(req); }
 
                     table = Table::from_cols(index, std::move(data), limit);
                     break;
                 }
                 case proto::MakeTableData::kFromRows: {
-                    std::string data = r.data().from_rows();
+                    std::string data = std::move(
+                        *req.mutable_make_table_req()
+                             ->mutable_data()
+                             ->mutable_from_rows()
+                    );
                     { auto _ = std::move(req); }
 
                     table = Table::from_rows(index, std::move(data), limit);
                     break;
                 }
                 case proto::MakeTableData::kFromNdjson: {
-                    std::string data = r.data().from_ndjson();
+                    std::string data = std::move(
+                        *req.mutable_make_table_req()
+                             ->mutable_data()
+                             ->mutable_from_ndjson()
+                    );
                     { auto _ = std::move(req); }
 
                     table = Table::from_ndjson(index, std::move(data), limit);
@@ -2113,6 +2545,7 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
                 && cfg.expressions().empty();
 
             std::shared_ptr<ErasedView> erased_view;
+            table->get_gnode()->set_lazy_contexts(m_lazy_views);
 
             if (is_unit_context) {
                 auto ctx =
@@ -2231,6 +2664,62 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
             push_resp(std::move(resp));
             break;
         }
+        case proto::Request::kViewProfileReq: {
+            auto view = m_resources.get_view(req.entity_id());
+            auto profile = view->get_profile();
+
+            proto::Response resp;
+            auto* view_profile = resp.mutable_view_profile_resp();
+            view_profile->set_context_type(profile.m_context_type);
+            for (const auto& tree : profile.m_trees) {
+                auto* tree_proto = view_profile->add_trees();
+                for (auto num_nodes : tree.m_nodes_per_depth) {
+                    tree_proto->add_nodes_per_depth(num_nodes);
+                }
+
+                tree_proto->set_last_nodes_changed(tree.m_last_nodes_changed);
+                tree_proto->set_last_nodes_removed(tree.m_last_nodes_removed);
+                tree_proto->set_last_applied_directly(
+                    tree.m_last_applied_directly
+                );
+                tree_proto->set_indexed(tree.m_indexed);
+            }
+
+            for (const auto& agg : profile.m_aggregates) {
+                auto* agg_proto = view_profile->add_aggregates();
+                agg_proto->set_column(agg.m_column);
+                agg_proto->set_aggregate(agg.m_aggregate);
+                agg_proto->set_incremental(agg.m_incremental);
+            }
+
+            for (const auto& expr : profile.m_expressions) {
+                auto* expr_proto = view_profile->add_expressions();
+                expr_proto->set_alias(expr.m_alias);
+                expr_proto->set_rows_evaluated(expr.m_stats.m_rows_evaluated);
+                expr_proto->set_last_rows_evaluated(
+                    expr.m_stats.m_last_rows_evaluated
+                );
+            }
+
+            for (const auto& column : profile.m_hidden_sort) {
+                view_profile->add_hidden_sort(column);
+            }
+
+            view_profile->set_num_table_rows(profile.m_num_table_rows);
+            view_profile->set_num_filtered_rows(profile.m_num_filtered_rows);
+            view_profile->set_traversal_rows(profile.m_traversal_rows);
+            view_profile->set_traversal_columns(profile.m_traversal_columns);
+
+            auto* last_update = view_profile->mutable_last_update();
+            last_update->set_input_rows(profile.m_last_update.m_input_rows);
+            last_update->set_flattened_rows(
+                profile.m_last_update.m_flattened_rows
+            );
+            last_update->set_applied_rows(profile.m_last_update.m_applied_rows);
+
+            push_resp(std::move(resp));
+            break;
+        }
         case proto::Request::kViewGetConfigReq: {
             auto view = m_resources.get_view(req.entity_id());
             auto view_config = view->get_view_config();
@@ -2482,7 +2971,7 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
 
             proto::Response resp;
             auto* view_cols_str = resp.mutable_view_to_ndjson_string_resp();
-            view_cols_str->set_ndjson_string(json_str);
+            view_cols_str->set_ndjson_string(std::move(json_str));
             push_resp(std::move(resp));
             break;
         }
@@ -2521,7 +3010,7 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
 
             proto::Response resp;
             auto* view_cols_str = resp.mutable_view_to_rows_string_resp();
-            view_cols_str->set_json_string(json_str);
+            view_cols_str->set_json_string(std::move(json_str));
             push_resp(std::move(resp));
             break;
         }
@@ -2561,7 +3050,7 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
 
             proto::Response resp;
             auto* view_cols_str = resp.mutable_view_to_columns_string_resp();
-            view_cols_str->set_json_string(json_str);
+            view_cols_str->set_json_string(std::move(json_str));
             push_resp(std::move(resp));
             break;
         }
@@ -2708,14 +3197,14 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
 
             proto::Response resp;
             auto* arrow = resp.mutable_view_to_arrow_resp()->mutable_arrow();
-            *arrow = *view->to_arrow(
+            *arrow = std::move(*view->to_arrow(
                 dims.start_row,
                 dims.end_row,
                 dims.start_col,
                 dims.end_col,
                 true,
                 r.compression() == "lz4"
-            );
+            ));
 
             push_resp(std::move(resp));
             break;
@@ -2737,24 +3226,132 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
 
             proto::Response resp;
             auto* csv = resp.mutable_view_to_csv_resp()->mutable_csv();
-            *csv = *view->to_csv(
+            *csv = std::move(*view->to_csv(
                 dims.start_row, dims.end_row, dims.start_col, dims.end_col
+            ));
+
+            push_resp(std::move(resp));
+            break;
+        }
+        case proto::Request::kViewStreamReq: {
+            auto view = m_resources.get_view(req.entity_id());
+            ViewStream stream;
+            stream.id = req.msg_id();
+            stream.client_id = client_id;
+            stream.req = req.view_stream_req();
+
+            proto::Response resp;
+            auto* chunk = resp.mutable_view_stream_resp();
+            read_view_stream_chunk(*view, stream, *chunk);
+            if (!chunk->done()) {
+                m_resources.create_view_stream(
+                    req.entity_id(), std::move(stream)
+                );
+            }
+
+            push_resp(std::move(resp));
+            break;
+        }
+        case proto::Request::kViewStreamNextReq: {
+            const auto& r = req.view_stream_next_req();
+            auto stream = m_resources.take_view_stream(
+                req.entity_id(), r.id(), client_id
             );
 
+            proto::Response resp;
+            auto* chunk = resp.mutable_view_stream_resp();
+            if (!stream.has_value() || r.cancel()) {
+                chunk->set_done(true);
+                push_resp(std::move(resp));
+                break;
+            }
+
+            auto view = m_resources.get_view(req.entity_id());
+            read_view_stream_chunk(*view, *stream, *chunk);
+            if (!chunk->done()) {
+                m_resources.create_view_stream(
+                    req.entity_id(), std::move(*stream)
+                );
+            }
+
             push_resp(std::move(resp));
             break;
         }
         case proto::Request::kViewOnUpdateReq: {
+            const auto& r = req.view_on_update_req();
             Subscription sub_info;
             sub_info.id = req.msg_id();
             sub_info.client_id = client_id;
-            m_resources.create_view_on_update_sub(req.entity_id(), sub_info);
-            if (req.view_on_update_req().has_mode()
-                && req.view_on_update_req().mode()
-                    == proto::ViewOnUpdateReq_Mode::ViewOnUpdateReq_Mode_ROW) {
+            if (r.ack() || r.min_interval_ms() > 0) {
+                sub_info.conflation = std::make_shared<Conflation>();
+                sub_info.conflation->ack = r.ack();
+                sub_info.conflation->min_interval_ms = r.min_interval_ms();
+            }
+
+            if (r.has_mode()) {
                 auto view = m_resources.get_view(req.entity_id());
                 view->set_deltas_enabled(true);
+                if (r.mode() == proto::ViewOnUpdateReq_Mode_VIEWPORT) {
+                    auto dims = view_viewport_dims(*view, r.viewport());
+                    sub_info.viewport = r.viewport();
+                    sub_info.viewport_keys =
+                        std::make_shared<t_viewport_keys>();
+                    view->update_viewport_keys(
+                        dims.start_row,
+                        dims.end_row,
+                        dims.start_col,
+                        dims.end_col,
+                        *sub_info.viewport_keys
+                    );
+                } else {
+                    sub_info.row_delta = true;
+                }
+            }
+
+            m_resources.create_view_on_update_sub(req.entity_id(), sub_info);
+            break;
+        }
+        case proto::Request::kViewOnUpdateAckReq: {
+            auto sub_id = req.view_on_update_ack_req().id();
+            proto::Response resp;
+            resp.mutable_view_on_update_ack_resp();
+            push_resp(std::move(resp));
+            for (const auto& sub :
+                 m_resources.get_view_on_update_sub(req.entity_id())) {
+                if (sub.id == sub_id && sub.client_id == client_id
+                    && sub.conflation != nullptr) {
+                    PSP_WRITE_LOCK(sub.conflation->lock);
+                    sub.conflation->awaiting_ack = false;
+                    flush_conflation(*sub.conflation, client_id, proto_resp);
+                }
+            }
+
+            break;
+        }
+        case proto::Request::kViewSetOnUpdateViewportReq: {
+            const auto& r = req.view_set_on_update_viewport_req();
+            auto view = m_resources.get_view(req.entity_id());
+            auto dims = view_viewport_dims(*view, r.viewport());
+            auto keys = std::make_shared<t_viewport_keys>();
+            view->update_viewport_keys(
+                dims.start_row,
+                dims.end_row,
+                dims.start_col,
+                dims.end_col,
+                *keys
+            );
+
+            if (!m_resources.set_view_on_update_viewport(
+                    req.entity_id(), r.id(), client_id, r.viewport(), keys
+                )) {
+                PSP_COMPLAIN_AND_ABORT(
+                    "No `VIEWPORT` mode `on_update` subscription found"
+                );
             }
+
+            proto::Response resp;
+            resp.mutable_view_set_on_update_viewport_resp();
+            push_resp(std::move(resp));
             break;
         }
         case proto::Request::kViewGetMinMaxReq: {
@@ -2803,6 +3400,34 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
             push_resp(std::move(resp));
             break;
         }
+        case proto::Request::kViewSetSortReq: {
+            const auto& r = req.view_set_sort_req();
+            auto view = m_resources.get_view(req.entity_id());
+            auto table = m_resources.get_table_for_view(req.entity_id());
+            auto schema = std::make_shared<t_schema>(
+                table->get_gnode()->get_output_schema()
+            );
+
+            auto view_config = view->get_view_config();
+            for (const auto& expr : view_config->get_expressions()) {
+                schema->add_column(
+                    expr->get_expression_alias(), expr->get_dtype()
+                );
+            }
+
+            std::vector<std::vector<std::string>> sort;
+            sort.reserve(r.sort().size());
+            for (const auto& s : r.sort()) {
+                sort.push_back({s.column(), sort_op_str_from_proto(s.op())});
+            }
+
+            proto::Response resp;
+            resp.mutable_view_set_sort_resp()->set_applied(
+                view->set_sort(sort, schema)
+            );
+            push_resp(std::move(resp));
+            break;
+        }
         case proto::Request::kServerSystemInfoReq: {
             proto::Response resp;
             auto* sys_info = resp.mutable_server_system_info_resp();
@@ -2843,18 +3468,173 @@ ProtoServer::_handle_request(std::uint32_t client_id, Request&& req) {
     return proto_resp;
 }
 
+/**
+ * @brief The order in which dirty tables' responses are emitted from `poll()`,
+ * sorted by table id so that it does not depend on the iteration order of the
+ * dirty set nor on which thread finishes first.
+ */
+static std::vector<std::size_t>
+dirty_table_order(
+    const std::vector<
+        std::pair<std::shared_ptr<Table>, const ServerResources::t_id>>& tables
+) {
+    std::vector<std::size_t> order(tables.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&tables](auto a, auto b) {
+        return tables[a].second < tables[b].second;
+    });
+
+    return order;
+}
+
+void
+ProtoServer::set_num_poll_threads(std::uint32_t num_threads) {
+    m_num_poll_threads = num_threads;
+}
+
+std::uint32_t
+ProtoServer::get_num_poll_threads() const {
+    return m_num_poll_threads;
+}
+
+void
+ProtoServer::set_table_coalesce_policy(
+    const std::string& table_id,
+    std::uint32_t max_latency_ms,
+    std::uint64_t max_rows
+) {
+    m_resources.set_table_coalesce_policy(
+        table_id, CoalescePolicy{max_latency_ms, max_rows}
+    );
+}
+
+std::int32_t
+ProtoServer::get_poll_timeout_ms() {
+    auto deadline = m_resources.get_coalesce_deadline();
+    auto conflation_deadline = m_resources.get_conflation_deadline();
+    if (conflation_deadline.has_value()
+        && (!deadline.has_value() || *conflation_deadline < *deadline)) {
+        deadline = conflation_deadline;
+    }
+
+    if (!deadline.has_value()) {
+        return -1;
+    }
+
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        *deadline - std::chrono::steady_clock::now()
+    );
+
+    return static_cast<std::int32_t>(std::clamp<std::int64_t>(
+        remaining.count(), 0, std::numeric_limits<std::int32_t>::max()
+    ));
+}
+
+void
+ProtoServer::set_lazy_views(bool lazy) {
+    m_lazy_views = lazy;
+}
+
+bool
+ProtoServer::set_table_tree_options(
+    const std::string& table_id, const t_stree_options& options
+) {
+    return m_resources.set_table_tree_options(table_id, options);
+}
+
 std::vector<ProtoServerResp<ProtoServer::Response>>
 ProtoServer::_poll() {
     std::vector<ProtoServerResp<Response>> resp_envs;
-    auto tables = m_resources.get_dirty_tables();
-    for (auto& [table, table_id] : tables) {
+
+    // Tables inside an open coalescing window stay dirty, and keep
+    // accumulating updates until a later `poll()`.
+    std::vector<std::pair<std::shared_ptr<Table>, const ServerResources::t_id>>
+        tables;
+    for (const auto& [table, table_id] : m_resources.get_dirty_tables()) {
+        if (!m_resources.is_table_coalescing(table_id, table)) {
+            tables.emplace_back(table, table_id);
+        }
+    }
+
+#ifdef PSP_PARALLEL_FOR
+    if (m_num_poll_threads != 1 && tables.size() > 1) {
+        _poll_parallel(tables, resp_envs);
+        for (const auto& dirty : tables) {
+            m_resources.mark_table_clean(dirty.second);
+        }
+
+        _flush_conflated_updates(resp_envs);
+        return resp_envs;
+    }
+#endif
+
+    for (auto idx : dirty_table_order(tables)) {
+        auto& [table, table_id] = tables[idx];
         _process_table_unchecked(table, table_id, resp_envs);
+        m_resources.mark_table_clean(table_id);
     }
 
-    m_resources.mark_all_tables_clean();
+    _flush_conflated_updates(resp_envs);
     return resp_envs;
 }
 
+void
+ProtoServer::_flush_conflated_updates(
+    std::vector<ProtoServerResp<Response>>& outs
+) {
+    for (const auto& sub : m_resources.get_conflated_view_on_update_subs()) {
+        PSP_WRITE_LOCK(sub.conflation->lock);
+        flush_conflation(*sub.conflation, sub.client_id, outs);
+    }
+}
+
+#ifdef PSP_PARALLEL_FOR
+void
+ProtoServer::_poll_parallel(
+    std::vector<
+        std::pair<std::shared_ptr<Table>, const ServerResources::t_id>>& tables,
+    std::vector<ProtoServerResp<Response>>& outs
+) {
+    const auto order = dirty_table_order(tables);
+
+    // Each table writes into its own output slot, so responses can be
+    // concatenated in `order` after all tasks have finished, no matter which
+    // thread finished first.
+    const std::size_t num_tables = order.size();
+    std::vector<std::vector<ProtoServerResp<Response>>> table_outs(num_tables);
+    std::vector<std::exception_ptr> errors(num_tables);
+
+    // Tables are isolated by their own `t_pool`/`t_gnode` lock, and
+    // `ServerResources` is guarded by `m_write_lock`. Tables run on Arrow's
+    // CPU pool via `parallel_for`, which also schedules the nested
+    // `parallel_for` calls inside `t_gnode::process` on the same pool, so
+    // the two levels share one set of threads rather than oversubscribing.
+    // `0` uses the pool's full capacity.
+    parallel_for(
+        static_cast<int>(num_tables),
+        [&](int task) {
+            auto& [table, table_id] = tables[order[task]];
+            try {
+                _process_table_unchecked(table, table_id, table_outs[task]);
+            } catch (...) {
+                errors[task] = std::current_exception();
+            }
+        },
+        static_cast<int>(m_num_poll_threads)
+    );
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (auto& table_out : table_outs) {
+        std::move(table_out.begin(), table_out.end(), std::back_inserter(outs));
+    }
+}
+#endif
+
 void
 ProtoServer::_process_table_unchecked(
     std::shared_ptr<Table>& table,
@@ -2871,20 +3651,60 @@ ProtoServer::_process_table_unchecked(
 
             auto view = m_resources.get_view(view_id);
             auto subscriptions = m_resources.get_view_on_update_sub(view_id);
-            for (auto& subscription : subscriptions) {
+
+            // Viewport deltas do not clear the context's deltas, so they are
+            // read first, and the deltas are then cleared once per view.
+            std::vector<std::shared_ptr<std::string>> deltas(
+                subscriptions.size()
+            );
+
+            bool has_row_delta = false;
+            for (std::size_t i = 0; i < subscriptions.size(); ++i) {
+                const auto& subscription = subscriptions[i];
+                if (subscription.viewport.has_value()) {
+                    auto dims =
+                        view_viewport_dims(*view, *subscription.viewport);
+                    deltas[i] = view->get_viewport_delta_as_arrow(
+                        dims.start_row,
+                        dims.end_row,
+                        dims.start_col,
+                        dims.end_col,
+                        *subscription.viewport_keys
+                    );
+                } else {
+                    has_row_delta = has_row_delta || subscription.row_delta;
+                }
+            }
+
+            std::shared_ptr<std::string> row_delta;
+            if (has_row_delta && view->get_deltas_enabled()) {
+                row_delta = view->get_row_delta_as_arrow();
+            } else if (view->get_deltas_enabled()) {
+                view->clear_deltas();
+            }
+
+            for (std::size_t i = 0; i < subscriptions.size(); ++i) {
+                const auto& subscription = subscriptions[i];
+                if (subscription.viewport.has_value() && deltas[i] == nullptr) {
+                    continue;
+                }
+
                 Response out;
                 out.set_msg_id(subscription.id);
                 out.set_entity_id(view_id);
                 auto* r = out.mutable_view_on_update_resp();
                 r->set_port_id(port_id);
-                if (view->get_deltas_enabled()) {
-                    *r->mutable_delta() = *view->get_row_delta_as_arrow();
+                // As before `VIEWPORT` mode, a subscription without a mode is
+                // sent the row delta too, whenever a `ROW` subscription to the
+                // same view has one read.
+                if (deltas[i] != nullptr) {
+                    *r->mutable_delta() = std::move(*deltas[i]);
+                } else if (!subscription.viewport.has_value()
+                           && row_delta != nullptr) {
+                    *r->mutable_delta() = *row_delta;
                 }
 
-                ProtoServerResp<proto::Response> resp2;
-                resp2.data = std::move(out);
-                resp2.client_id = subscription.client_id;
-                outs.emplace_back(std::move(resp2));
+                notify_on_update(subscription, std::move(out), outs);
             }
         }
     });
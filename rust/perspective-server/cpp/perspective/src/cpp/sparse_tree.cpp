@@ -30,6 +30,7 @@
 #include <perspective/data_table.h>
 #include <perspective/filter_utils.h>
 #include <perspective/context_two.h>
+#include <tsl/hopscotch_map.h>
 #include <set>
 #include <utility>
 
@@ -38,6 +39,182 @@ namespace perspective {
 // Tweet length
 const t_uindex MAX_JOIN_SIZE = 280;
 
+// Rows per task when building strand tables for large updates in parallel.
+const t_uindex STRAND_TABLE_CHUNK_SIZE = 65536;
+
+t_tscalar
+t_stree_index_strings::acquire(const t_tscalar& value) {
+#ifdef PSP_SSO_SCALAR
+    if (!value.is_str() || value.is_inplace()) {
+        return value;
+    }
+#else
+    if (!value.is_str()) {
+        return value;
+    }
+#endif
+    auto iter = m_strings.try_emplace(value.get_char_ptr(), 0).first;
+    ++iter->second;
+    t_tscalar rval;
+    rval.set(iter->first.c_str());
+    rval.m_status = value.m_status;
+    return rval;
+}
+
+void
+t_stree_index_strings::release(const t_tscalar& value) {
+#ifdef PSP_SSO_SCALAR
+    if (!value.is_str() || value.is_inplace()) {
+        return;
+    }
+#else
+    if (!value.is_str()) {
+        return;
+    }
+#endif
+    auto iter = m_strings.find(value.get_char_ptr());
+    if (iter != m_strings.end() && --iter->second == 0) {
+        m_strings.erase(iter);
+    }
+}
+
+void
+t_stree_index_strings::clear() {
+    m_strings.clear();
+}
+
+// Blocks are carved from slabs of this many bytes.
+static constexpr std::size_t STREE_INDEX_SLAB_SIZE = 64 * 1024;
+
+t_stree_index_pool::t_size_class&
+t_stree_index_pool::get_size_class(std::size_t block_size) {
+    for (auto& size_class : m_size_classes) {
+        if (size_class.m_block_size == block_size) {
+            return size_class;
+        }
+    }
+
+    auto& size_class = m_size_classes.emplace_back();
+    size_class.m_block_size = block_size;
+    return size_class;
+}
+
+static std::size_t
+get_block_size(std::size_t size) {
+    constexpr std::size_t align = alignof(std::max_align_t);
+    size = std::max(size, sizeof(void*));
+    return (size + align - 1) / align * align;
+}
+
+void*
+t_stree_index_pool::allocate(std::size_t size) {
+    auto block_size = get_block_size(size);
+    PSP_VERBOSE_ASSERT(
+        block_size <= STREE_INDEX_SLAB_SIZE, "Block larger than a slab"
+    );
+
+    auto& size_class = get_size_class(block_size);
+    ++m_size;
+    if (size_class.m_free != nullptr) {
+        auto* block = size_class.m_free;
+        size_class.m_free = block->m_next;
+        return block;
+    }
+
+    if (size_class.m_slabs.empty()
+        || size_class.m_slab_used + block_size > STREE_INDEX_SLAB_SIZE) {
+        size_class.m_slabs.emplace_back(new std::byte[STREE_INDEX_SLAB_SIZE]);
+        size_class.m_slab_used = 0;
+    }
+
+    void* block = size_class.m_slabs.back().get() + size_class.m_slab_used;
+    size_class.m_slab_used += block_size;
+    return block;
+}
+
+void
+t_stree_index_pool::deallocate(void* ptr, std::size_t size) {
+    auto& size_class = get_size_class(get_block_size(size));
+    auto* block = static_cast<t_free_block*>(ptr);
+    block->m_next = size_class.m_free;
+    size_class.m_free = block;
+    --m_size;
+}
+
+void
+t_stree_index_pool::release() {
+    PSP_VERBOSE_ASSERT(m_size == 0, "Releasing a pool with live blocks");
+    m_size_classes.clear();
+}
+
+t_uindex
+t_stree_index_pool::size() const {
+    return m_size;
+}
+
+t_stree_value_counts::t_stree_value_counts(t_stree_index_pool* pool) :
+    m_counts(decltype(m_counts)::allocator_type(pool)),
+    m_by_count(decltype(m_by_count)::allocator_type(pool)) {}
+
+bool
+t_stree_ordered_key_less::operator()(
+    const t_stree_ordered_key& a, const t_stree_ordered_key& b
+) const {
+    if (a.m_sort_value < b.m_sort_value) {
+        return true;
+    }
+
+    if (b.m_sort_value < a.m_sort_value) {
+        return false;
+    }
+
+    if (a.m_leaf != b.m_leaf) {
+        return a.m_leaf < b.m_leaf;
+    }
+
+    return a.m_pkey < b.m_pkey;
+}
+
+t_stree_ordered_values::t_stree_ordered_values(t_stree_index_pool* pool) :
+    m_values(decltype(m_values)::allocator_type(pool)) {}
+
+t_uindex
+t_stree_index_strings::size() const {
+    return m_strings.size();
+}
+
+/**
+ * @brief Concatenate strand table segments built from consecutive row
+ * ranges, in order, into the first segment. Columns are independent, so
+ * they are appended in parallel.
+ *
+ * @param segments
+ * @return std::shared_ptr<t_data_table>
+ */
+static std::shared_ptr<t_data_table>
+concat_strand_segments(
+    const std::vector<std::shared_ptr<t_data_table>>& segments
+) {
+    std::shared_ptr<t_data_table> out = segments[0];
+    t_uindex size = 0;
+    for (const auto& segment : segments) {
+        size += segment->size();
+    }
+
+    const auto& columns = out->get_schema().m_columns;
+    parallel_for(int(columns.size()), [&](int colidx) {
+        const std::string& colname = columns[colidx];
+        t_column* dst = out->get_column(colname).get();
+        for (t_uindex sidx = 1; sidx < segments.size(); ++sidx) {
+            dst->append(*(segments[sidx]->get_const_column(colname)));
+        }
+    });
+
+    out->reserve(size);
+    out->set_size(size);
+    return out;
+}
+
 t_tscalar
 get_dominant(std::vector<t_tscalar>& values) {
     if (values.empty()) {
@@ -71,6 +248,13 @@ get_dominant(std::vector<t_tscalar>& values) {
     return delem;
 }
 
+// The weight of `count` copies of `value` in `get_dominant`, which only
+// counts repeats of valid values.
+static t_index
+get_dominant_count(const t_tscalar& value, t_uindex count) {
+    return value.is_valid() ? static_cast<t_index>(count) : 1;
+}
+
 t_tree_unify_rec::t_tree_unify_rec(
     t_uindex sptidx, t_uindex daggidx, t_uindex saggidx, t_uindex nstrands
 ) :
@@ -91,7 +275,8 @@ t_stree::t_stree(
     m_aggspecs(aggspecs),
     m_schema(std::move(schema)),
     m_cur_aggidx(1),
-    m_has_delta(false) {
+    m_has_delta(false),
+    m_options(cfg.get_tree_options()) {
     const auto& g_agg_str = cfg.get_grand_agg_str();
     m_grand_agg_str = g_agg_str.empty() ? "Grand Aggregate" : g_agg_str;
 }
@@ -151,9 +336,52 @@ t_stree::init() {
 
     m_deltas = std::make_shared<t_tcdeltas>();
     m_features = std::vector<bool>(CTX_FEAT_LAST_FEATURE);
+
+    create_indices();
+
+    // A map node per primary key for each node of its ancestry, and another
+    // for the DOMINANT order of a value index.
+    m_index_nodes_per_key = m_value_indices.size() + m_ordered_indices.size();
+    for (const auto& iter : m_value_indices) {
+        if (iter.second.m_track_dominant) {
+            ++m_index_nodes_per_key;
+        }
+    }
+
     m_init = true;
 }
 
+/**
+ * @brief Create an empty value or ordered index for each aggregate which is
+ * maintained by one.
+ */
+void
+t_stree::create_indices() {
+    for (const auto& spec : m_aggspecs) {
+        switch (spec.agg()) {
+            case AGGTYPE_MIN:
+            case AGGTYPE_MAX:
+            case AGGTYPE_UNIQUE: {
+                m_value_indices[spec.get_first_depname()];
+            } break;
+            case AGGTYPE_DOMINANT: {
+                m_value_indices[spec.get_first_depname()].m_track_dominant =
+                    true;
+            } break;
+            case AGGTYPE_FIRST:
+            case AGGTYPE_LAST_BY_INDEX:
+            case AGGTYPE_LAST_MINUS_FIRST: {
+                const auto& deps = spec.get_dependencies();
+                m_ordered_indices[std::make_pair(
+                    deps[0].name(), deps[1].name()
+                )];
+            } break;
+            default:
+                break;
+        }
+    }
+}
+
 t_tscalar
 t_stree::get_value(t_index idx) const {
     iter_by_idx iter = m_nodes->get<by_idx>().find(idx);
@@ -404,16 +632,6 @@ t_stree::build_strand_table(
 
     auto metadata = build_strand_table_metadata(flattened, aggspecs, config);
 
-    // strand table
-    std::shared_ptr<t_data_table> strands =
-        std::make_shared<t_data_table>(metadata.m_strand_schema);
-    strands->init();
-
-    // strand table
-    std::shared_ptr<t_data_table> aggs =
-        std::make_shared<t_data_table>(metadata.m_aggschema);
-    aggs->init();
-
     std::shared_ptr<const t_column> pkey_col =
         flattened.get_const_column("psp_pkey");
     std::shared_ptr<const t_column> op_col =
@@ -423,9 +641,6 @@ t_stree::build_strand_table(
     std::vector<const t_column*> piv_pcols(npivotlike);
     std::vector<const t_column*> piv_ccols(npivotlike);
     std::vector<const t_column*> piv_tcols(npivotlike);
-    std::vector<t_column*> piv_scols(npivotlike);
-
-    t_uindex insert_count = 0;
 
     // Get each intermediate column, including columns aggregated by
     // last, high, and low as they were added to m_strand_schema in
@@ -435,14 +650,12 @@ t_stree::build_strand_table(
         piv_pcols[pidx] = prev.get_const_column(piv).get();
         piv_ccols[pidx] = current.get_const_column(piv).get();
         piv_tcols[pidx] = transitions.get_const_column(piv).get();
-        piv_scols[pidx] = strands->get_column(piv).get();
     }
 
     t_uindex aggcolsize = metadata.m_aggschema.m_columns.size();
     std::vector<const t_column*> agg_ccols(aggcolsize);
     std::vector<const t_column*> agg_pcols(aggcolsize);
     std::vector<const t_column*> agg_dcols(aggcolsize);
-    std::vector<t_column*> agg_acols(aggcolsize);
 
     t_uindex strand_count_idx = 0;
 
@@ -458,14 +671,8 @@ t_stree::build_strand_table(
             agg_ccols[aggidx] = current.get_const_column(aggcol).get();
             agg_pcols[aggidx] = prev.get_const_column(aggcol).get();
         }
-
-        agg_acols[aggidx] = aggs->get_column(aggcol).get();
     }
 
-    t_column* agg_scount = aggs->get_column("psp_strand_count").get();
-
-    t_column* spkey = strands->get_column("psp_pkey").get();
-
     t_mask msk_prev;
     t_mask msk_curr;
 
@@ -476,21 +683,48 @@ t_stree::build_strand_table(
 
     bool has_filters = config.has_filters();
 
-    if (has_filters) {
-        for (t_uindex idx = 0, loop_end = flattened.size(); idx < loop_end;
-             ++idx) {
-            bool filter_prev = msk_prev.get(idx);
-            bool filter_curr = msk_curr.get(idx);
+    // Builds the strands for rows `[bidx, eidx)` of `flattened` into a new
+    // pair of strand and aggregate tables. The inputs are only read, so
+    // disjoint row ranges can be built concurrently.
+    auto build_rows = [&](t_uindex bidx, t_uindex eidx) {
+        std::shared_ptr<t_data_table> strands =
+            std::make_shared<t_data_table>(metadata.m_strand_schema);
+        strands->init();
+
+        std::shared_ptr<t_data_table> aggs =
+            std::make_shared<t_data_table>(metadata.m_aggschema);
+        aggs->init();
+
+        std::vector<t_column*> piv_scols(npivotlike);
+        for (t_uindex pidx = 0; pidx < npivotlike; ++pidx) {
+            const std::string& piv = metadata.m_strand_schema.m_columns[pidx];
+            piv_scols[pidx] = strands->get_column(piv).get();
+        }
+
+        std::vector<t_column*> agg_acols(aggcolsize);
+        for (t_uindex aggidx = 0; aggidx < aggcolsize; ++aggidx) {
+            const std::string& aggcol = metadata.m_aggschema.m_columns[aggidx];
+            agg_acols[aggidx] = aggs->get_column(aggcol).get();
+        }
 
+        t_column* agg_scount = aggs->get_column("psp_strand_count").get();
+        t_column* spkey = strands->get_column("psp_pkey").get();
+        t_uindex insert_count = 0;
+
+        for (t_uindex idx = bidx; idx < eidx; ++idx) {
             t_tscalar pkey = pkey_col->get_scalar(idx);
             std::uint8_t op_ = *(op_col->get_nth<std::uint8_t>(idx));
             t_op op = static_cast<t_op>(op_);
             bool pivots_neq;
 
+            bool filter_prev = !has_filters || msk_prev.get(idx);
+            bool filter_curr = !has_filters || msk_curr.get(idx);
+
             if (!filter_prev && !filter_curr) {
                 // nothing to do
                 continue;
             }
+
             if (!filter_prev && filter_curr) {
                 // apply current row
                 build_strand_table_phase_1(
@@ -513,50 +747,12 @@ t_stree::build_strand_table(
                     pivots_neq,
                     metadata.m_pivot_like_columns
                 );
-            } else if (filter_prev && !filter_curr) {
-                // reverse prev row
-                build_strand_table_phase_2(
-                    pkey,
-                    idx,
-                    metadata.m_pivsize,
-                    strand_count_idx,
-                    aggcolsize,
-                    piv_pcols,
-                    agg_pcols,
-                    piv_scols,
-                    agg_acols,
-                    agg_scount,
-                    spkey,
-                    insert_count,
-                    metadata.m_pivot_like_columns
-                );
-            } else if (filter_prev && filter_curr) {
-                // should be handled as normal
-                build_strand_table_phase_1(
-                    pkey,
-                    op,
-                    idx,
-                    metadata.m_pivsize,
-                    strand_count_idx,
-                    aggcolsize,
-                    false,
-                    piv_ccols,
-                    piv_tcols,
-                    agg_ccols,
-                    agg_dcols,
-                    piv_scols,
-                    agg_acols,
-                    agg_scount,
-                    spkey,
-                    insert_count,
-                    pivots_neq,
-                    metadata.m_pivot_like_columns
-                );
 
-                if (op == OP_DELETE || !pivots_neq) {
-                    continue;
-                }
+                continue;
+            }
 
+            if (filter_prev && !filter_curr) {
+                // reverse prev row
                 build_strand_table_phase_2(
                     pkey,
                     idx,
@@ -572,16 +768,9 @@ t_stree::build_strand_table(
                     insert_count,
                     metadata.m_pivot_like_columns
                 );
-            }
-        }
-    } else {
-        for (t_uindex idx = 0, loop_end = flattened.size(); idx < loop_end;
-             ++idx) {
 
-            t_tscalar pkey = pkey_col->get_scalar(idx);
-            std::uint8_t op_ = *(op_col->get_nth<std::uint8_t>(idx));
-            t_op op = static_cast<t_op>(op_);
-            bool pivots_neq;
+                continue;
+            }
 
             // FOR EVERY ROW,
             // piv_ccols: current strand col, piv_tcols: current transition
@@ -629,16 +818,47 @@ t_stree::build_strand_table(
                 metadata.m_pivot_like_columns
             );
         }
-    }
 
-    strands->reserve(insert_count);
-    strands->set_size(insert_count);
-    aggs->reserve(insert_count);
-    aggs->set_size(insert_count);
-    agg_scount->valid_raw_fill();
+        strands->reserve(insert_count);
+        strands->set_size(insert_count);
+        aggs->reserve(insert_count);
+        aggs->set_size(insert_count);
+        agg_scount->valid_raw_fill();
+        return std::make_pair(strands, aggs);
+    };
+
+    // Split the rows into fixed size chunks, so parallelism scales with the
+    // size of the update rather than the number of aggregates. Each chunk
+    // writes to its own segment, and segments are concatenated in row order
+    // so the output is identical to a serial build. This runs within
+    // `t_gnode::notify_contexts`' own `parallel_for`, whose workers help run
+    // the chunks of every tree being updated (see `parallel_for`).
+    const t_uindex nrows = flattened.size();
+    t_uindex chunk_size = std::max(nrows, t_uindex(1));
+#ifdef PSP_PARALLEL_FOR
+    chunk_size = std::min(chunk_size, STRAND_TABLE_CHUNK_SIZE);
+#endif
+    const t_uindex nchunks = (nrows + chunk_size - 1) / chunk_size;
+    if (nchunks <= 1) {
+        return build_rows(0, nrows);
+    }
+
+    std::vector<std::shared_ptr<t_data_table>> strand_segments(nchunks);
+    std::vector<std::shared_ptr<t_data_table>> agg_segments(nchunks);
+    parallel_for(int(nchunks), [&](int chunk) {
+        t_uindex bidx = chunk * chunk_size;
+        t_uindex eidx = std::min(nrows, bidx + chunk_size);
+        auto segment = build_rows(bidx, eidx);
+        strand_segments[chunk] = segment.first;
+        agg_segments[chunk] = segment.second;
+    });
+
     return std::pair<
         std::shared_ptr<t_data_table>,
-        std::shared_ptr<t_data_table>>(strands, aggs);
+        std::shared_ptr<t_data_table>>(
+        concat_strand_segments(strand_segments),
+        concat_strand_segments(agg_segments)
+    );
 }
 
 /**
@@ -779,52 +999,153 @@ t_stree::pivots_changed(t_value_transition t) const {
 
 void
 t_stree::populate_pkey_idx(
-    const t_dtree_ctx& ctx,
-    const t_dtree& dtree,
-    t_uindex dptidx,
+    const t_column& pkey_col,
+    const t_column& strand_count_col,
+    const t_uindex* bleaf,
+    const t_uindex* eleaf,
     t_uindex sptidx,
-    t_uindex ndepth,
     t_idxpkey& new_idx_pkey
 ) {
-    if (ndepth == dtree.last_level()) {
-        auto pkey_col = ctx.get_pkey_col();
-        auto strand_count_col = ctx.get_strand_count_col();
-        auto liters = ctx.get_leaf_iterators(dptidx);
-
-        for (const auto* lfiter = liters.first; lfiter != liters.second;
-             ++lfiter) {
-
-            auto lfidx = *lfiter;
-            auto pkey =
-                m_symtable.get_interned_tscalar(pkey_col->get_scalar(lfidx));
-            auto strand_count =
-                *(strand_count_col->get_nth<std::int8_t>(lfidx));
-
-            // Checks the strand count and adds a new primary key if it's
-            // increased.
-            if (strand_count > 0) {
-                t_stpkey s(sptidx, pkey);
-                new_idx_pkey.insert(s);
-            }
+    for (const auto* lfiter = bleaf; lfiter != eleaf; ++lfiter) {
+        auto lfidx = *lfiter;
+        auto pkey = m_symtable.get_interned_tscalar(pkey_col.get_scalar(lfidx));
+        auto strand_count = *(strand_count_col.get_nth<std::int8_t>(lfidx));
+
+        // Checks the strand count and adds a new primary key if it's
+        // increased.
+        if (strand_count > 0) {
+            t_stpkey s(sptidx, pkey);
+            new_idx_pkey.insert(s);
+        }
+
+        if (strand_count < 0) {
+            remove_pkey(sptidx, pkey);
+        }
 
-            if (strand_count < 0) {
-                remove_pkey(sptidx, pkey);
+        // Every strand for a primary key removes its previous value from
+        // the indices, and the value is re-added from the `t_gstate` once
+        // the tree's shape is final, if the key is still in the tree.
+        if (!m_value_indices.empty() || !m_ordered_indices.empty()) {
+            remove_indexed_values(pkey);
+            if (strand_count >= 0) {
+                m_index_pending.emplace_back(sptidx, pkey);
             }
         }
     }
 }
 
 void
-t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
-
+t_stree::begin_shape_update(t_index root_nstrands) {
     m_newids.clear();
     m_newleaves.clear();
     m_tree_unification_records.clear();
 
+    // update root
+    auto root_iter = m_nodes->get<by_idx>().find(0);
+    auto root_node = *root_iter;
+
+    // root_nstrands = summed strand count
+    root_nstrands += root_node.m_nstrands;
+    root_node.set_nstrands(std::max(root_nstrands, (t_index)1));
+    m_nodes->get<by_idx>().replace(root_iter, root_node);
+
+    t_tree_unify_rec unif_rec(0, 0, 0, root_nstrands);
+    m_tree_unification_records.push_back(unif_rec);
+}
+
+bool
+t_stree::unify_node(
+    t_uindex p_sptidx,
+    t_tscalar value,
+    t_tscalar sortby_value,
+    t_depth ndepth,
+    t_uindex src_ridx,
+    t_index nstrands,
+    t_uindex& sptidx
+) {
+    auto iter =
+        m_nodes->get<by_pidx_hash>().find(std::make_tuple(p_sptidx, value));
+
+    if (iter == m_nodes->get<by_pidx_hash>().end() && nstrands < 0) {
+        return false;
+    }
+
+    if (iter == m_nodes->get<by_pidx_hash>().end()) {
+        // create node and enqueue
+        sptidx = genidx();
+        t_uindex aggsize = m_aggregates->size();
+        if (sptidx == aggsize) {
+            double scale = 1.3;
+            t_uindex new_size = scale * aggsize;
+            m_aggregates->extend(new_size);
+        }
+
+        t_uindex dst_ridx = gen_aggidx();
+
+        t_tnode node(
+            sptidx, p_sptidx, value, ndepth, sortby_value, nstrands, dst_ridx
+        );
+
+        m_newids.insert(sptidx);
+
+        if (ndepth == last_level()) {
+            m_newleaves.insert(sptidx);
+        }
+
+        auto insert_pair = m_nodes->insert(node);
+        if (!insert_pair.second) {
+            auto failed_because = *(insert_pair.first);
+            std::cout << "failed because of " << failed_because << '\n';
+        }
+        PSP_VERBOSE_ASSERT(insert_pair.second, "Failed to insert node");
+        t_tree_unify_rec unif_rec(sptidx, src_ridx, dst_ridx, nstrands);
+        m_tree_unification_records.push_back(unif_rec);
+    } else {
+        sptidx = iter->m_idx;
+
+        // update node
+        t_tnode node = *iter;
+        node.set_sort_value(sortby_value);
+
+        t_uindex dst_ridx = node.m_aggidx;
+
+        nstrands = node.m_nstrands + nstrands;
+
+        t_tree_unify_rec unif_rec(sptidx, src_ridx, dst_ridx, nstrands);
+        m_tree_unification_records.push_back(unif_rec);
+
+        node.set_nstrands(nstrands);
+        PSP_VERBOSE_ASSERT(
+            m_nodes->get<by_pidx_hash>().replace(iter, node),
+            ,
+            "Failed to replace"
+        ); // middle argument ignored
+    }
+
+    return true;
+}
+
+void
+t_stree::end_shape_update(const t_idxpkey& new_idx_pkey) {
+    auto biter = new_idx_pkey.get<by_idx_pkey>().begin();
+    auto eiter = new_idx_pkey.get<by_idx_pkey>().end();
+
+    for (auto iter = biter; iter != eiter; ++iter) {
+        t_stpkey s(iter->m_idx, iter->m_pkey);
+        m_idxpkey->insert(s);
+    }
+
+    mark_zero_desc();
+}
+
+void
+t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
     const std::shared_ptr<const t_column> scount =
         ctx.get_aggtable().get_const_column("psp_strand_count_sum");
 
     const t_dtree& dtree = ctx.get_tree();
+    const t_column& pkey_col = *(ctx.get_pkey_col());
+    const t_column& strand_count_col = *(ctx.get_strand_count_col());
 
     // map dptidx to sptidx
     std::map<t_uindex, t_uindex> nmap;
@@ -832,18 +1153,7 @@ t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
 
     t_filter filter;
 
-    // update root
-    auto root_iter = m_nodes->get<by_idx>().find(0);
-    auto root_node = *root_iter;
-
-    // scount = summed strand count
-    t_index root_nstrands =
-        *(scount->get_nth<t_index>(0)) + root_node.m_nstrands;
-    root_node.set_nstrands(std::max(root_nstrands, (t_index)1));
-    m_nodes->get<by_idx>().replace(root_iter, root_node);
-
-    t_tree_unify_rec unif_rec(0, 0, 0, root_nstrands);
-    m_tree_unification_records.push_back(unif_rec);
+    begin_shape_update(*(scount->get_nth<t_index>(0)));
 
     t_idxpkey new_idx_pkey;
 
@@ -851,104 +1161,264 @@ t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
         t_uindex sptidx = 0;
         t_depth ndepth = dtree.get_depth(dptidx);
 
-        if (dptidx == 0) {
-            populate_pkey_idx(ctx, dtree, dptidx, sptidx, ndepth, new_idx_pkey);
-            continue;
-        }
+        if (dptidx != 0) {
+            t_uindex p_dptidx = dtree.get_parent(dptidx);
+            t_uindex p_sptidx = nmap[p_dptidx];
 
-        t_uindex p_dptidx = dtree.get_parent(dptidx);
-        t_uindex p_sptidx = nmap[p_dptidx];
+            t_tscalar value = m_symtable.get_interned_tscalar(
+                dtree.get_value(filter, dptidx)
+            );
 
-        t_tscalar value =
-            m_symtable.get_interned_tscalar(dtree.get_value(filter, dptidx));
+            t_tscalar sortby_value = m_symtable.get_interned_tscalar(
+                dtree.get_sortby_value(filter, dptidx)
+            );
 
-        t_tscalar sortby_value = m_symtable.get_interned_tscalar(
-            dtree.get_sortby_value(filter, dptidx)
-        );
+            auto nstrands = *(scount->get_nth<std::int64_t>(dptidx));
+            if (!unify_node(
+                    p_sptidx,
+                    value,
+                    sortby_value,
+                    ndepth,
+                    dptidx,
+                    nstrands,
+                    sptidx
+                )) {
+                continue;
+            }
 
-        t_uindex src_ridx = dptidx;
+            nmap[dptidx] = sptidx;
+        }
 
-        auto iter =
-            m_nodes->get<by_pidx_hash>().find(std::make_tuple(p_sptidx, value));
+        if (ndepth == dtree.last_level()) {
+            auto liters = ctx.get_leaf_iterators(dptidx);
+            populate_pkey_idx(
+                pkey_col,
+                strand_count_col,
+                liters.first,
+                liters.second,
+                sptidx,
+                new_idx_pkey
+            );
+        }
+    }
 
-        auto nstrands = *(scount->get_nth<std::int64_t>(dptidx));
+    end_shape_update(new_idx_pkey);
+}
 
-        if (iter == m_nodes->get<by_pidx_hash>().end() && nstrands < 0) {
-            continue;
-        }
+bool
+t_stree::should_apply_strands_directly(const t_data_table& strands) const {
+    auto max_cost = m_options.m_strand_direct_apply_max_cost;
+    return max_cost > 0 && strands.size() * (m_pivots.size() + 1) <= max_cost;
+}
 
-        if (iter == m_nodes->get<by_pidx_hash>().end()) {
-            // create node and enqueue
-            sptidx = genidx();
-            t_uindex aggsize = m_aggregates->size();
-            if (sptidx == aggsize) {
-                double scale = 1.3;
-                t_uindex new_size = scale * aggsize;
-                m_aggregates->extend(new_size);
+/**
+ * @brief Group a strand table by this tree's pivots, by hashing each
+ * strand's path of pivot values, and compute the per-node aggregates which
+ * `update_agg_table` reads from its source. Other aggregates are recomputed
+ * from the `t_gstate`, so their columns are allocated but left unset.
+ *
+ * @param strands
+ * @param strand_deltas
+ * @param aggspecs
+ * @param tree_sortby
+ * @return t_strand_tree
+ */
+t_strand_tree
+t_stree::build_strand_tree(
+    std::shared_ptr<const t_data_table> strands,
+    std::shared_ptr<const t_data_table> strand_deltas,
+    const std::vector<t_aggspec>& aggspecs,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby
+) const {
+    t_strand_tree stree;
+    stree.m_strands = std::move(strands);
+    stree.m_strand_deltas = std::move(strand_deltas);
+
+    std::map<std::string, std::string> sortby_columns;
+    for (const auto& sortby : tree_sortby) {
+        sortby_columns[sortby.first] = sortby.second;
+    }
+
+    t_uindex npivots = m_pivots.size();
+    std::vector<const t_column*> piv_cols(npivots);
+    std::vector<const t_column*> sortby_cols(npivots);
+    for (t_uindex pidx = 0; pidx < npivots; ++pidx) {
+        const std::string& colname = m_pivots[pidx].colname();
+        auto siter = sortby_columns.find(colname);
+        const std::string& sortby_colname =
+            siter == sortby_columns.end() ? colname : siter->second;
+
+        piv_cols[pidx] = stree.m_strands->get_const_column(colname).get();
+        sortby_cols[pidx] =
+            stree.m_strands->get_const_column(sortby_colname).get();
+    }
+
+    // A node's sort value is read from its first strand, which matches the
+    // stable grouping of `t_dtree`.
+    t_uindex nrows = stree.m_strands->size();
+    stree.m_nodes.emplace_back();
+    stree.m_nodes[0].m_pidx = 0;
+    stree.m_nodes[0].m_depth = 0;
+    stree.m_nodes[0].m_rows.reserve(nrows);
+
+    tsl::hopscotch_map<
+        std::pair<t_uindex, t_tscalar>,
+        t_uindex,
+        boost::hash<std::pair<t_uindex, t_tscalar>>>
+        children;
+
+    for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+        t_uindex nidx = 0;
+        stree.m_nodes[0].m_rows.push_back(ridx);
+        for (t_uindex pidx = 0; pidx < npivots; ++pidx) {
+            auto key = std::make_pair(nidx, piv_cols[pidx]->get_scalar(ridx));
+            auto iter = children.find(key);
+            if (iter == children.end()) {
+                t_strand_node node;
+                node.m_pidx = nidx;
+                node.m_depth = pidx + 1;
+                node.m_value = key.second;
+                node.m_sortby_value = sortby_cols[pidx]->get_scalar(ridx);
+                iter = children.insert({key, stree.m_nodes.size()}).first;
+                stree.m_nodes.push_back(std::move(node));
             }
 
-            t_uindex dst_ridx = gen_aggidx();
+            nidx = iter->second;
+            stree.m_nodes[nidx].m_rows.push_back(ridx);
+        }
+    }
 
-            t_tnode node(
-                sptidx,
-                p_sptidx,
-                value,
-                ndepth,
-                sortby_value,
-                nstrands,
-                dst_ridx
-            );
+    stree.m_aggspecs = aggspecs;
+    std::vector<t_dep> depvec = {t_dep("psp_strand_count", DEPTYPE_COLUMN)};
+    stree.m_aggspecs.emplace_back("psp_strand_count_sum", AGGTYPE_SUM, depvec);
+
+    std::vector<std::string> columns;
+    std::vector<t_dtype> dtypes;
+    t_schema delta_schema = stree.m_strand_deltas->get_schema();
+    for (const auto& spec : stree.m_aggspecs) {
+        for (const auto& ci : spec.get_output_specs(delta_schema)) {
+            columns.push_back(ci.m_name);
+            dtypes.push_back(ci.m_type);
+        }
+    }
 
-            m_newids.insert(sptidx);
+    t_uindex nnodes = stree.m_nodes.size();
+    stree.m_aggregates = std::make_shared<t_data_table>(
+        t_schema(columns, dtypes), nnodes
+    );
+    stree.m_aggregates->init();
+    stree.m_aggregates->set_size(nnodes);
 
-            if (ndepth == dtree.last_level()) {
-                m_newleaves.insert(sptidx);
+    for (const auto& spec : stree.m_aggspecs) {
+        bool is_sum = false;
+        switch (spec.agg()) {
+            case AGGTYPE_SUM:
+            case AGGTYPE_PCT_SUM_PARENT:
+            case AGGTYPE_PCT_SUM_GRAND_TOTAL: {
+                is_sum = true;
+            } break;
+            case AGGTYPE_HIGH_WATER_MARK:
+            case AGGTYPE_LOW_WATER_MARK: {
+            } break;
+            default: {
+                continue;
             }
+        }
 
-            auto insert_pair = m_nodes->insert(node);
-            if (!insert_pair.second) {
-                auto failed_because = *(insert_pair.first);
-                std::cout << "failed because of " << failed_because << '\n';
+        const t_data_table& itable =
+            spec.is_non_delta() ? *stree.m_strands : *stree.m_strand_deltas;
+        const t_column* icol =
+            itable.get_const_column(spec.get_dependencies()[0].name()).get();
+        t_column* ocol = stree.m_aggregates->get_column(spec.name()).get();
+        t_dtype dtype = ocol->get_dtype();
+        bool is_hwm = spec.agg() == AGGTYPE_HIGH_WATER_MARK;
+
+        for (t_uindex nidx = 0; nidx < nnodes; ++nidx) {
+            t_tscalar rval;
+            rval.set(std::uint64_t(0));
+            rval.m_type = dtype;
+
+            const auto& rows = stree.m_nodes[nidx].m_rows;
+            for (t_uindex idx = 0, loop_end = rows.size(); idx < loop_end;
+                 ++idx) {
+                // Like `t_aggregate`, reduce the raw column data regardless
+                // of validity.
+                t_tscalar value = icol->get_scalar(rows[idx]);
+                value.m_status = STATUS_VALID;
+                value = value.coerce_numeric_dtype(dtype);
+                if (is_sum) {
+                    rval = rval.add(value);
+                } else if (idx == 0) {
+                    rval = value;
+                } else if (is_hwm) {
+                    rval = std::max(rval, value);
+                } else {
+                    rval = std::min(rval, value);
+                }
             }
-            PSP_VERBOSE_ASSERT(insert_pair.second, "Failed to insert node");
-            t_tree_unify_rec unif_rec(sptidx, src_ridx, dst_ridx, nstrands);
-            m_tree_unification_records.push_back(unif_rec);
-        } else {
-            sptidx = iter->m_idx;
 
-            // update node
-            t_tnode node = *iter;
-            node.set_sort_value(sortby_value);
+            ocol->set_scalar(nidx, rval);
+        }
+    }
 
-            t_uindex dst_ridx = node.m_aggidx;
+    return stree;
+}
 
-            nstrands = node.m_nstrands + nstrands;
+void
+t_stree::update_shape_from_strands(const t_strand_tree& stree) {
+    const t_column* scount =
+        stree.m_aggregates->get_const_column("psp_strand_count_sum").get();
 
-            t_tree_unify_rec unif_rec(sptidx, src_ridx, dst_ridx, nstrands);
-            m_tree_unification_records.push_back(unif_rec);
+    const t_column& pkey_col = *(stree.m_strands->get_const_column("psp_pkey"));
+    const t_column& strand_count_col =
+        *(stree.m_strand_deltas->get_const_column("psp_strand_count"));
 
-            sptidx = iter->m_idx;
-            node.set_nstrands(nstrands);
-            PSP_VERBOSE_ASSERT(
-                m_nodes->get<by_pidx_hash>().replace(iter, node),
-                ,
-                "Failed to replace"
-            ); // middle argument ignored
-        }
+    begin_shape_update(*(scount->get_nth<t_index>(0)));
 
-        populate_pkey_idx(ctx, dtree, dptidx, sptidx, ndepth, new_idx_pkey);
-        nmap[dptidx] = sptidx;
-    }
+    t_idxpkey new_idx_pkey;
 
-    auto biter = new_idx_pkey.get<by_idx_pkey>().begin();
-    auto eiter = new_idx_pkey.get<by_idx_pkey>().end();
+    // map strand tree node to sptidx
+    std::vector<t_uindex> nmap(stree.m_nodes.size(), 0);
 
-    for (auto iter = biter; iter != eiter; ++iter) {
-        t_stpkey s(iter->m_idx, iter->m_pkey);
-        m_idxpkey->insert(s);
+    for (t_uindex nidx = 0, loop_end = stree.m_nodes.size(); nidx < loop_end;
+         ++nidx) {
+        const t_strand_node& node = stree.m_nodes[nidx];
+        t_uindex sptidx = 0;
+
+        if (nidx != 0) {
+            t_tscalar value = m_symtable.get_interned_tscalar(node.m_value);
+            t_tscalar sortby_value =
+                m_symtable.get_interned_tscalar(node.m_sortby_value);
+
+            auto nstrands = *(scount->get_nth<std::int64_t>(nidx));
+            if (!unify_node(
+                    nmap[node.m_pidx],
+                    value,
+                    sortby_value,
+                    node.m_depth,
+                    nidx,
+                    nstrands,
+                    sptidx
+                )) {
+                continue;
+            }
+
+            nmap[nidx] = sptidx;
+        }
+
+        if (node.m_depth == last_level()) {
+            populate_pkey_idx(
+                pkey_col,
+                strand_count_col,
+                node.m_rows.data(),
+                node.m_rows.data() + node.m_rows.size(),
+                sptidx,
+                new_idx_pkey
+            );
+        }
     }
 
-    mark_zero_desc();
+    end_shape_update(new_idx_pkey);
 }
 
 void
@@ -975,18 +1445,50 @@ t_stree::update_aggs_from_static(
     const t_gstate& gstate,
     const t_data_table& expression_master_table
 ) {
-    const t_data_table& src_aggtable = ctx.get_aggtable();
+    update_aggs(
+        ctx.get_aggtable(),
+        ctx.get_aggspecs(),
+        gstate,
+        expression_master_table
+    );
+}
+
+void
+t_stree::update_aggs_from_strands(
+    const t_strand_tree& stree,
+    const t_gstate& gstate,
+    const t_data_table& expression_master_table
+) {
+    update_aggs(
+        *stree.m_aggregates, stree.m_aggspecs, gstate, expression_master_table
+    );
+}
+
+void
+t_stree::update_aggs(
+    const t_data_table& src_aggtable,
+    const std::vector<t_aggspec>& src_aggspecs,
+    const t_gstate& gstate,
+    const t_data_table& expression_master_table
+) {
+    std::map<std::string, t_uindex> aggspecmap;
+    for (t_uindex aggidx = 0; aggidx < src_aggspecs.size(); ++aggidx) {
+        aggspecmap[src_aggspecs[aggidx].name()] = aggidx;
+    }
 
     t_agg_update_info agg_update_info;
     t_schema aggschema = m_aggregates->get_schema();
 
     for (const auto& colname : aggschema.m_columns) {
+        auto iter = aggspecmap.find(colname);
+        PSP_VERBOSE_ASSERT(iter != aggspecmap.end(), "Failed to find aggspec");
+
         agg_update_info.m_src.push_back(
             src_aggtable.get_const_column(colname).get()
         );
         agg_update_info.m_dst.push_back(m_aggregates->get_column(colname).get()
         );
-        agg_update_info.m_aggspecs.push_back(ctx.get_aggspec(colname));
+        agg_update_info.m_aggspecs.push_back(src_aggspecs[iter->second]);
     }
 
     auto is_col_scaled_aggregate = [&](int col_idx) -> bool {
@@ -1037,6 +1539,8 @@ t_stree::update_aggs_from_static(
         }
     }
 
+    apply_index_updates(gstate, expression_master_table);
+
     for (const auto& r : m_tree_unification_records) {
         if (!node_exists(r.m_sptidx)) {
             continue;
@@ -1054,6 +1558,438 @@ t_stree::update_aggs_from_static(
     }
 }
 
+void
+t_stree::remove_indexed_values(const t_tscalar& pkey) {
+    for (auto& iter : m_value_indices) {
+        t_stree_value_index& index = iter.second;
+        auto piter = index.m_pkeys.find(pkey);
+        if (piter == index.m_pkeys.end()) {
+            continue;
+        }
+
+        update_value_counts(
+            index, piter->second.first, piter->second.second, false
+        );
+
+        m_index_strings.release(piter->second.second);
+        index.m_pkeys.erase(piter);
+    }
+
+    for (auto& iter : m_ordered_indices) {
+        t_stree_ordered_index& index = iter.second;
+        auto piter = index.m_pkeys.find(pkey);
+        if (piter == index.m_pkeys.end()) {
+            continue;
+        }
+
+        update_ordered_values(
+            index,
+            std::get<0>(piter->second),
+            pkey,
+            std::get<1>(piter->second),
+            std::get<2>(piter->second),
+            false
+        );
+
+        m_index_strings.release(std::get<1>(piter->second));
+        m_index_strings.release(std::get<2>(piter->second));
+        index.m_pkeys.erase(piter);
+    }
+}
+
+/**
+ * @brief The most map nodes the indices hold once every primary key in the
+ * tree is indexed, one per key for each index (two for DOMINANT) and node of
+ * the key's ancestry. A value index shares a node between the keys with the
+ * same value beneath a node, so it may hold fewer. Every key in the tree is
+ * counted once, however many strands updated it.
+ *
+ * @return t_uindex
+ */
+t_uindex
+t_stree::get_num_index_entries() const {
+    return m_idxpkey->size() * m_index_nodes_per_key * (m_pivots.size() + 1);
+}
+
+bool
+t_stree::has_indices() const {
+    return m_index_nodes_per_key > 0 && !m_indices_dropped;
+}
+
+/**
+ * @brief Discard the indices of a tree which would outgrow
+ * `t_stree_options::m_index_max_entries`. Its aggregates then read the rows
+ * beneath each changed node from the `t_gstate`, as they would for a column
+ * which is not indexed, until `rebuild_indices` restores them.
+ */
+void
+t_stree::drop_indices() {
+    m_value_indices.clear();
+    m_ordered_indices.clear();
+    m_index_pool.release();
+    m_index_strings.clear();
+    m_index_pending.clear();
+    m_indices_dropped = true;
+}
+
+/**
+ * @brief Recreate the indices dropped by `drop_indices`, queueing every
+ * primary key in the tree to be indexed at its current leaf.
+ */
+void
+t_stree::rebuild_indices() {
+    create_indices();
+    m_indices_dropped = false;
+    m_index_pending.clear();
+    m_index_pending.reserve(m_idxpkey->size());
+    for (const auto& s : *m_idxpkey) {
+        m_index_pending.emplace_back(s.m_idx, s.m_pkey);
+    }
+}
+
+/**
+ * @brief The nodes whose indexed values include a row of `leaf`, from the
+ * leaf up to and including the root.
+ *
+ * @param leaf
+ * @return std::vector<t_uindex>
+ */
+std::vector<t_uindex>
+t_stree::get_indexed_ancestry(t_uindex leaf) const {
+    std::vector<t_uindex> rval;
+    t_uindex nidx = leaf;
+    while (nidx != root_pidx()) {
+        auto iter = m_nodes->get<by_idx>().find(nidx);
+        if (iter == m_nodes->get<by_idx>().end()) {
+            break;
+        }
+
+        rval.push_back(nidx);
+        nidx = iter->m_pidx;
+    }
+
+    return rval;
+}
+
+void
+t_stree::update_value_counts(
+    t_stree_value_index& index,
+    t_uindex leaf,
+    const t_tscalar& value,
+    bool insert
+) {
+    bool is_nan = value.is_nan();
+    for (t_uindex nidx : get_indexed_ancestry(leaf)) {
+        t_stree_value_counts& counts =
+            index.m_nodes.try_emplace(nidx, &m_index_pool).first.value();
+        if (is_nan) {
+            counts.m_nan_count =
+                insert ? counts.m_nan_count + 1 : counts.m_nan_count - 1;
+        } else {
+            auto citer = counts.m_counts.find(value);
+            t_uindex count = 0;
+            if (citer != counts.m_counts.end()) {
+                count = citer->second;
+            }
+
+            if (insert || count > 0) {
+                t_uindex new_count = insert ? count + 1 : count - 1;
+                if (index.m_track_dominant) {
+                    if (count > 0) {
+                        counts.m_by_count.erase(std::make_pair(
+                            -get_dominant_count(value, count), value
+                        ));
+                    }
+
+                    if (new_count > 0) {
+                        counts.m_by_count.emplace(
+                            -get_dominant_count(value, new_count), value
+                        );
+                    }
+                }
+
+                if (new_count == 0) {
+                    counts.m_counts.erase(citer);
+                } else {
+                    counts.m_counts[value] = new_count;
+                }
+            }
+        }
+
+        if (counts.m_counts.empty() && counts.m_nan_count == 0) {
+            index.m_nodes.erase(nidx);
+        }
+    }
+}
+
+void
+t_stree::update_ordered_values(
+    t_stree_ordered_index& index,
+    t_uindex leaf,
+    const t_tscalar& pkey,
+    const t_tscalar& sort_value,
+    const t_tscalar& value,
+    bool insert
+) {
+    bool is_nan = sort_value.is_nan();
+    t_stree_ordered_key key{sort_value, leaf, pkey};
+    for (t_uindex nidx : get_indexed_ancestry(leaf)) {
+        t_stree_ordered_values& values =
+            index.m_nodes.try_emplace(nidx, &m_index_pool).first.value();
+        if (is_nan) {
+            values.m_nan_count =
+                insert ? values.m_nan_count + 1 : values.m_nan_count - 1;
+        } else if (insert) {
+            values.m_values.insert_or_assign(key, value);
+        } else {
+            values.m_values.erase(key);
+        }
+
+        if (values.m_values.empty() && values.m_nan_count == 0) {
+            index.m_nodes.erase(nidx);
+        }
+    }
+}
+
+/**
+ * @brief Add the current values of each primary key which was inserted or
+ * updated by the last strand table to the indices of its new leaf and all
+ * of the leaf's ancestors.
+ *
+ * @param gstate
+ * @param expression_master_table
+ */
+void
+t_stree::apply_index_updates(
+    const t_gstate& gstate, const t_data_table& expression_master_table
+) {
+    // The tree's shape is final, so its primary keys are exactly those the
+    // indices will hold. Dropped indices are rebuilt once they would fit in
+    // half the budget, so a tree near the limit does not rebuild them on
+    // every other update.
+    auto max_entries = m_options.m_index_max_entries;
+    if (m_indices_dropped) {
+        if (get_num_index_entries() <= max_entries / 2) {
+            rebuild_indices();
+        }
+    } else if ((!m_value_indices.empty() || !m_ordered_indices.empty())
+               && get_num_index_entries() > max_entries) {
+        drop_indices();
+    }
+
+    for (const auto& pending : m_index_pending) {
+        t_uindex leaf = pending.first;
+        t_tscalar pkey = pending.second;
+        if (!node_exists(leaf)) {
+            continue;
+        }
+
+        for (auto& iter : m_value_indices) {
+            t_stree_value_index& index = iter.second;
+            if (index.m_pkeys.count(pkey) > 0) {
+                continue;
+            }
+
+            t_tscalar value = m_index_strings.acquire(read_by_pkey_from_gstate(
+                gstate, expression_master_table, iter.first, pkey
+            ));
+
+            update_value_counts(index, leaf, value, true);
+            index.m_pkeys[pkey] = std::make_pair(leaf, value);
+        }
+
+        for (auto& iter : m_ordered_indices) {
+            t_stree_ordered_index& index = iter.second;
+            if (index.m_pkeys.count(pkey) > 0) {
+                continue;
+            }
+
+            t_tscalar value = m_index_strings.acquire(read_by_pkey_from_gstate(
+                gstate, expression_master_table, iter.first.first, pkey
+            ));
+
+            t_tscalar sort_value =
+                m_index_strings.acquire(read_by_pkey_from_gstate(
+                    gstate, expression_master_table, iter.first.second, pkey
+                ));
+
+            update_ordered_values(index, leaf, pkey, sort_value, value, true);
+            index.m_pkeys[pkey] = std::make_tuple(leaf, sort_value, value);
+        }
+    }
+
+    m_index_pending.clear();
+}
+
+/**
+ * @brief Read the minimum or maximum of `colname` beneath a node from the
+ * maintained value index.
+ *
+ * @param colname
+ * @param nidx
+ * @param is_max
+ * @param value set to the extremum, or `none` if the node has no values.
+ * @return true if `value` was set, false if the column is not indexed or
+ * the node contains a NaN, in which case the caller must scan the node.
+ */
+bool
+t_stree::get_extremum(
+    const std::string& colname, t_uindex nidx, bool is_max, t_tscalar& value
+) const {
+    auto iter = m_value_indices.find(colname);
+    if (iter == m_value_indices.end()) {
+        return false;
+    }
+
+    auto niter = iter->second.m_nodes.find(nidx);
+    if (niter == iter->second.m_nodes.end()) {
+        value = mknone();
+        return true;
+    }
+
+    const t_stree_value_counts& counts = niter->second;
+    if (counts.m_nan_count > 0) {
+        return false;
+    }
+
+    value = is_max ? counts.m_counts.rbegin()->first
+                   : counts.m_counts.begin()->first;
+    return true;
+}
+
+/**
+ * @brief Read the most frequent value of `colname` beneath a node, with
+ * ties broken toward the smallest value as `get_dominant` does.
+ *
+ * @param colname
+ * @param nidx
+ * @param value set to the dominant value, or `none` if the node has no
+ * values.
+ * @return true if `value` was set, false if the column is not indexed for
+ * DOMINANT or the node contains a NaN.
+ */
+bool
+t_stree::get_dominant_value(
+    const std::string& colname, t_uindex nidx, t_tscalar& value
+) const {
+    auto iter = m_value_indices.find(colname);
+    if (iter == m_value_indices.end() || !iter->second.m_track_dominant) {
+        return false;
+    }
+
+    auto niter = iter->second.m_nodes.find(nidx);
+    if (niter == iter->second.m_nodes.end()) {
+        value = mknone();
+        return true;
+    }
+
+    const t_stree_value_counts& counts = niter->second;
+    if (counts.m_nan_count > 0) {
+        return false;
+    }
+
+    value = counts.m_by_count.begin()->second;
+    return true;
+}
+
+/**
+ * @brief Read whether every value of `colname` beneath a node is equal, as
+ * `t_gstate::is_unique` does.
+ *
+ * @param colname
+ * @param nidx
+ * @param is_unique
+ * @param value set to the unique value, or to a value of the column's type
+ * if the node is not unique.
+ * @return true if `is_unique` and `value` were set, false if the column is
+ * not indexed or the node contains a NaN or `none`.
+ */
+bool
+t_stree::get_unique_value(
+    const std::string& colname,
+    t_uindex nidx,
+    bool& is_unique,
+    t_tscalar& value
+) const {
+    auto iter = m_value_indices.find(colname);
+    if (iter == m_value_indices.end()) {
+        return false;
+    }
+
+    auto niter = iter->second.m_nodes.find(nidx);
+    if (niter == iter->second.m_nodes.end()) {
+        is_unique = true;
+        value = mknone();
+        return true;
+    }
+
+    const t_stree_value_counts& counts = niter->second;
+    if (counts.m_nan_count > 0 || counts.m_counts.begin()->first.is_none()) {
+        return false;
+    }
+
+    is_unique = counts.m_counts.size() == 1;
+    value = counts.m_counts.begin()->first;
+    return true;
+}
+
+/**
+ * @brief Read the first and last values of a FIRST, LAST_BY_INDEX or
+ * LAST_MINUS_FIRST aggregate beneath a node, matching `first_last_helper`,
+ * which takes the last row in `get_pkeys` order among equal sort values.
+ *
+ * @param nidx
+ * @param spec
+ * @param value
+ * @return true if `value` was set, false if the sort type is by absolute
+ * value, the columns are not indexed, or the node has a NaN sort value.
+ */
+bool
+t_stree::get_first_last_value(
+    t_uindex nidx,
+    const t_aggspec& spec,
+    std::pair<t_tscalar, t_tscalar>& value
+) const {
+    t_sorttype sort_type = spec.get_sort_type();
+    if (sort_type != SORTTYPE_ASCENDING && sort_type != SORTTYPE_DESCENDING) {
+        return false;
+    }
+
+    const auto& deps = spec.get_dependencies();
+    auto iter = m_ordered_indices.find(
+        std::make_pair(deps[0].name(), deps[1].name())
+    );
+
+    if (iter == m_ordered_indices.end()) {
+        return false;
+    }
+
+    auto niter = iter->second.m_nodes.find(nidx);
+    if (niter == iter->second.m_nodes.end()) {
+        value = std::make_pair(mknone(), mknone());
+        return true;
+    }
+
+    const t_stree_ordered_values& values = niter->second;
+    if (values.m_nan_count > 0) {
+        return false;
+    }
+
+    // The last key of the lowest and of the highest sort value.
+    const auto& first_sort_value = values.m_values.begin()->first.m_sort_value;
+    const t_tscalar& min_value =
+        std::prev(values.m_values.upper_bound(first_sort_value))->second;
+    const t_tscalar& max_value = values.m_values.rbegin()->second;
+
+    if (sort_type == SORTTYPE_ASCENDING) {
+        value = std::make_pair(min_value, max_value);
+    } else {
+        value = std::make_pair(max_value, min_value);
+    }
+
+    return true;
+}
+
 t_uindex
 t_stree::genidx() {
     return m_curidx++;
@@ -1136,6 +2072,9 @@ t_stree::update_agg_table(
         auto is_expr =
             expression_schema.has_column(spec.get_dependencies()[0].name());
 
+        // Whether this aggregate may take its incremental path below; the
+        // same classification is reported by `View::profile`.
+        const bool incremental = is_incremental(spec, is_expr);
         switch (spec.agg()) {
             case AGGTYPE_PCT_SUM_PARENT:
             case AGGTYPE_PCT_SUM_GRAND_TOTAL:
@@ -1145,7 +2084,7 @@ t_stree::update_agg_table(
                 old_value.set(dst_scalar);
 
                 // is_nan returns false for non-float types
-                if (is_expr || old_value.is_nan()) {
+                if (!incremental || old_value.is_nan()) {
 
                     // if we previously had a NaN, add can't make it finite
                     // again; recalculate entire sum in case it is now finite
@@ -1271,16 +2210,22 @@ t_stree::update_agg_table(
                 new_value.set(nr / dr);
             } break;
             case AGGTYPE_UNIQUE: {
-                auto pkeys = get_pkeys(nidx);
                 old_value.set(dst->get_scalar(dst_ridx));
 
-                bool is_unique = is_unique_from_gstate(
-                    gstate,
-                    expression_master_table,
-                    spec.get_dependencies()[0].name(),
-                    pkeys,
-                    new_value
-                );
+                bool is_unique = false;
+                if (!incremental
+                    || !get_unique_value(
+                        spec.get_first_depname(), nidx, is_unique, new_value
+                    )) {
+                    auto pkeys = get_pkeys(nidx);
+                    is_unique = is_unique_from_gstate(
+                        gstate,
+                        expression_master_table,
+                        spec.get_dependencies()[0].name(),
+                        pkeys,
+                        new_value
+                    );
+                }
 
                 if (new_value.m_type == DTYPE_STR) {
                     if (is_unique) {
@@ -1474,6 +2419,14 @@ t_stree::update_agg_table(
             } break;
             case AGGTYPE_DOMINANT: {
                 old_value.set(dst->get_scalar(dst_ridx));
+                if (incremental
+                    && get_dominant_value(
+                        spec.get_first_depname(), nidx, new_value
+                    )) {
+                    dst->set_scalar(dst_ridx, new_value);
+                    break;
+                }
+
                 auto pkeys = get_pkeys(nidx);
 
                 new_value.set(
@@ -1493,25 +2446,34 @@ t_stree::update_agg_table(
             } break;
             case AGGTYPE_FIRST: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pair = first_last_helper(
-                    nidx, spec, gstate, expression_master_table
-                );
+                std::pair<t_tscalar, t_tscalar> pair;
+                if (!incremental || !get_first_last_value(nidx, spec, pair)) {
+                    pair = first_last_helper(
+                        nidx, spec, gstate, expression_master_table
+                    );
+                }
                 new_value.set(pair.first);
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_LAST_BY_INDEX: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pair = first_last_helper(
-                    nidx, spec, gstate, expression_master_table
-                );
+                std::pair<t_tscalar, t_tscalar> pair;
+                if (!incremental || !get_first_last_value(nidx, spec, pair)) {
+                    pair = first_last_helper(
+                        nidx, spec, gstate, expression_master_table
+                    );
+                }
                 new_value.set(pair.second);
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_LAST_MINUS_FIRST: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pair = (first_last_helper(
-                    nidx, spec, gstate, expression_master_table
-                ));
+                std::pair<t_tscalar, t_tscalar> pair;
+                if (!incremental || !get_first_last_value(nidx, spec, pair)) {
+                    pair = first_last_helper(
+                        nidx, spec, gstate, expression_master_table
+                    );
+                }
                 new_value.set(pair.second.sub_typesafe(pair.first));
                 dst->set_scalar(dst_ridx, new_value);
             } break;
@@ -1579,6 +2541,14 @@ t_stree::update_agg_table(
             case AGGTYPE_MAX: {
                 t_tscalar dst_scalar = dst->get_scalar(dst_ridx);
                 old_value.set(dst_scalar);
+                if (incremental
+                    && get_extremum(
+                        spec.get_first_depname(), nidx, true, new_value
+                    )) {
+                    dst->set_scalar(dst_ridx, new_value);
+                    break;
+                }
+
                 auto pkeys = get_pkeys(nidx);
                 if (pkeys.empty()) {
                     dst->set_scalar(dst_ridx, new_value);
@@ -1634,6 +2604,14 @@ t_stree::update_agg_table(
             case AGGTYPE_MIN: {
                 t_tscalar dst_scalar = dst->get_scalar(dst_ridx);
                 old_value.set(dst_scalar);
+                if (incremental
+                    && get_extremum(
+                        spec.get_first_depname(), nidx, false, new_value
+                    )) {
+                    dst->set_scalar(dst_ridx, new_value);
+                    break;
+                }
+
                 auto pkeys = get_pkeys(nidx);
                 if (pkeys.empty()) {
                     dst->set_scalar(dst_ridx, new_value);
@@ -2128,6 +3106,13 @@ t_stree::drop_zero_strands() {
             leaves.push_back(iter->m_idx);
         }
         node_ids.push_back(iter->m_aggidx);
+        for (auto& index : m_value_indices) {
+            index.second.m_nodes.erase(iter->m_idx);
+        }
+
+        for (auto& index : m_ordered_indices) {
+            index.second.m_nodes.erase(iter->m_idx);
+        }
     }
 
     clear_aggregates(node_ids);
@@ -2378,9 +3363,13 @@ t_stree::get_aggregates_for_sorting(
         } else if ((ctx2 != nullptr) || (size_t(which_agg) >= m_aggcols.size())) {
             aggregates[idx].set(t_none());
             if (ctx2 != nullptr) {
+                // `which_agg` indexes `ctx2`'s aggregates, which are a subset
+                // of this tree's when it is shared.
+                auto tree_agg = ctx2->get_tree_aggidx(which_agg);
                 if ((ctx2->get_config().get_totals() == TOTALS_BEFORE)
-                    && (size_t(which_agg) < m_aggcols.size())) {
-                    aggregates[idx] = m_aggcols[which_agg]->get_scalar(aggidx);
+                    && (size_t(which_agg)
+                        < ctx2->get_config().get_num_aggregates())) {
+                    aggregates[idx] = m_aggcols[tree_agg]->get_scalar(aggidx);
                     continue;
                 }
 
@@ -2394,9 +3383,7 @@ t_stree::get_aggregates_for_sorting(
                 if (col_path.empty()) {
                     if (ctx2->get_config().get_totals() == TOTALS_AFTER) {
                         aggregates[idx] =
-                            m_aggcols[which_agg % m_aggcols.size()]->get_scalar(
-                                aggidx
-                            );
+                            m_aggcols[tree_agg]->get_scalar(aggidx);
                     }
                     continue;
                 }
@@ -2410,9 +3397,8 @@ t_stree::get_aggregates_for_sorting(
                     target = target_tree->resolve_path(target, col_path);
                 }
                 if (target != INVALID_INDEX) {
-                    aggregates[idx] = target_tree->get_aggregate(
-                        target, which_agg % m_aggcols.size()
-                    );
+                    aggregates[idx] =
+                        target_tree->get_aggregate(target, tree_agg);
                 }
             }
         } else {
@@ -2492,6 +3478,20 @@ t_stree::clear_deltas() {
 void
 t_stree::clear() {
     m_nodes->clear();
+    for (auto& index : m_value_indices) {
+        index.second.m_nodes.clear();
+        index.second.m_pkeys.clear();
+    }
+
+    for (auto& index : m_ordered_indices) {
+        index.second.m_nodes.clear();
+        index.second.m_pkeys.clear();
+    }
+
+    m_index_pool.release();
+    m_index_strings.clear();
+
+    m_index_pending.clear();
     clear_deltas();
 }
 
@@ -2632,6 +3632,65 @@ t_stree::set_has_deltas(bool v) {
     m_has_delta = v;
 }
 
+const t_stree_step&
+t_stree::get_last_step() const {
+    return m_last_step;
+}
+
+void
+t_stree::set_last_step(t_stree_step step) {
+    m_last_step = std::move(step);
+}
+
+std::vector<t_uindex>
+t_stree::get_num_nodes_by_depth() const {
+    std::vector<t_uindex> rval;
+    for (const auto& node : m_nodes->get<by_idx>()) {
+        if (node.m_depth >= rval.size()) {
+            rval.resize(node.m_depth + 1, 0);
+        }
+
+        ++rval[node.m_depth];
+    }
+
+    return rval;
+}
+
+t_uindex
+t_stree::get_num_pkeys() const {
+    return m_idxpkey->size();
+}
+
+bool
+t_stree::is_incremental(const t_aggspec& spec, bool is_expression) {
+    switch (spec.agg()) {
+        case AGGTYPE_SUM:
+        case AGGTYPE_PCT_SUM_PARENT:
+        case AGGTYPE_PCT_SUM_GRAND_TOTAL: {
+            // Sums of expressions are recalculated; so is a sum which is
+            // NaN, which `update_agg_table` checks per node.
+            return !is_expression;
+        }
+        case AGGTYPE_COUNT:
+        case AGGTYPE_HIGH_WATER_MARK:
+        case AGGTYPE_LOW_WATER_MARK:
+        case AGGTYPE_LAST_VALUE:
+        case AGGTYPE_SCALED_DIV:
+        case AGGTYPE_SCALED_ADD:
+        case AGGTYPE_SCALED_MUL:
+        case AGGTYPE_MIN:
+        case AGGTYPE_MAX:
+        case AGGTYPE_UNIQUE:
+        case AGGTYPE_DOMINANT:
+        case AGGTYPE_FIRST:
+        case AGGTYPE_LAST_BY_INDEX:
+        case AGGTYPE_LAST_MINUS_FIRST:
+            return true;
+        default:
+            return false;
+    }
+}
+
 t_bfs_iter<t_stree>
 t_stree::bfs() const {
     return {this};
@@ -18,7 +18,11 @@
 #include "perspective/raw_types.h"
 #include "perspective/schema.h"
 #include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/reader.h"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <memory>
 #include <optional>
@@ -184,7 +188,7 @@ Table::validate_expressions(
 std::shared_ptr<t_gnode>
 Table::make_gnode(const t_schema& in_schema) {
     t_schema out_schema = in_schema.drop({"psp_pkey", "psp_op"});
-    auto gnode = std::make_shared<t_gnode>(in_schema, out_schema);
+    auto gnode = std::make_shared<t_gnode>(in_schema, out_schema, m_index);
     gnode->init();
     return gnode;
 }
@@ -289,6 +293,16 @@ Table::set_data_types(const std::vector<t_dtype>& data_types) {
     m_data_types = data_types;
 }
 
+const t_stree_options&
+Table::get_tree_options() const {
+    return m_tree_options;
+}
+
+void
+Table::set_tree_options(const t_stree_options& options) {
+    m_tree_options = options;
+}
+
 std::unordered_map<std::string, std::shared_ptr<arrow::DataType>>
 schema_to_arrow_map(const t_schema& gnode_output_schema) {
     auto map =
@@ -727,7 +741,7 @@ fill_column_json(
         }
         case t_dtype::DTYPE_INT64: {
             if (value.IsInt64()) [[likely]] {
-                col->set_nth<std::int64_t>(i, value.GetInt());
+                col->set_nth<std::int64_t>(i, value.GetInt64());
             } else if (value.IsDouble()) {
                 return {DTYPE_FLOAT64};
             } else if (value.IsString()) {
@@ -785,6 +799,389 @@ fill_column_json(
     }
 }
 
+/**
+ * @brief Resolves JSON object keys to column slots with a collision-free
+ * (perfect) hash table built once over the column names, so per-cell key
+ * lookup is a single hash and `memcmp` rather than a schema scan and a
+ * `std::string` construction.
+ */
+class t_json_column_index {
+public:
+    explicit t_json_column_index(std::vector<std::string> names) :
+        m_names(std::move(names)),
+        m_seed(0) {
+        t_uindex nbuckets = 8;
+        while (nbuckets < 2 * m_names.size()) {
+            nbuckets *= 2;
+        }
+
+        // Schema column names are unique, so some seed/size is always
+        // collision-free; in practice the first or second seed is.
+        while (!try_build(nbuckets)) {
+            if (++m_seed % 16 == 0) {
+                nbuckets *= 2;
+            }
+        }
+    }
+
+    /**
+     * @brief The slot of `key`, or `-1` if it is not a column name.
+     */
+    std::int64_t
+    find(const char* key, std::size_t len) const {
+        const auto slot = m_buckets[hash(key, len, m_seed) & m_mask];
+        if (slot < 0) {
+            return -1;
+        }
+
+        const auto& name = m_names[slot];
+        if (name.size() != len || std::memcmp(name.data(), key, len) != 0) {
+            return -1;
+        }
+
+        return slot;
+    }
+
+private:
+    static std::uint32_t
+    hash(const char* key, std::size_t len, std::uint32_t seed) {
+        // FNV-1a
+        std::uint32_t h = 2166136261U ^ seed;
+        for (std::size_t i = 0; i < len; ++i) {
+            h ^= static_cast<std::uint8_t>(key[i]);
+            h *= 16777619U;
+        }
+
+        return h;
+    }
+
+    bool
+    try_build(t_uindex nbuckets) {
+        m_mask = nbuckets - 1;
+        m_buckets.assign(nbuckets, -1);
+        for (t_uindex slot = 0; slot < m_names.size(); ++slot) {
+            const auto& name = m_names[slot];
+            auto& bucket =
+                m_buckets[hash(name.data(), name.size(), m_seed) & m_mask];
+            if (bucket >= 0) {
+                return false;
+            }
+
+            bucket = static_cast<std::int64_t>(slot);
+        }
+
+        return true;
+    }
+
+    std::vector<std::string> m_names;
+    std::vector<std::int64_t> m_buckets;
+    std::uint32_t m_seed;
+    t_uindex m_mask;
+};
+
+/**
+ * @brief A rapidjson SAX handler which writes row-oriented JSON, either an
+ * array of row objects or a stream of (newline-delimited) row objects,
+ * straight into the columns of `data_table` without building a DOM. Each key
+ * is resolved to its column via `t_json_column_index`, and each scalar whose
+ * JSON type matches its column is written as-is. Anything else is handed to
+ * `fill_column_json`, so coercion matches the DOM-based loaders.
+ */
+class t_json_row_handler
+    : public rapidjson::
+          BaseReaderHandler<rapidjson::UTF8<>, t_json_row_handler> {
+public:
+    t_json_row_handler(
+        t_data_table& data_table,
+        const std::string& index,
+        std::uint32_t offset,
+        bool is_array
+    ) :
+        m_data_table(data_table),
+        m_index(make_index(data_table.get_schema())),
+        m_is_implicit(index.empty()),
+        m_offset(offset),
+        m_row_depth(is_array ? 2 : 1),
+        m_depth(0),
+        m_num_rows(0),
+        m_slot(-1),
+        m_index_slot(-1) {
+        const auto& names = data_table.get_schema().m_columns;
+        m_columns.reserve(names.size() + 1);
+        for (const auto& name : names) {
+            if (name != "__INDEX__") {
+                m_columns.push_back(data_table.get_column(name));
+            }
+        }
+
+        m_psp_pkey = data_table.get_column("psp_pkey");
+        m_columns.push_back(m_psp_pkey);
+        if (!m_is_implicit) {
+            m_index_slot = m_index.find(index.data(), index.size());
+        }
+    }
+
+    bool
+    Null() {
+        return value([this](const std::shared_ptr<t_column>& col) {
+            col->unset(m_num_rows);
+        });
+    }
+
+    bool
+    Bool(bool b) {
+        return value([this, b](const std::shared_ptr<t_column>& col) {
+            if (col->get_dtype() == DTYPE_BOOL) [[likely]] {
+                col->set_nth<bool>(m_num_rows, b);
+            } else {
+                fill(col, rapidjson::Value(b));
+            }
+        });
+    }
+
+    bool
+    Int(int i) {
+        return integer(i);
+    }
+
+    bool
+    Uint(unsigned u) {
+        return integer(u);
+    }
+
+    bool
+    Int64(std::int64_t i) {
+        return integer(i);
+    }
+
+    bool
+    Uint64(std::uint64_t u) {
+        if (u > static_cast<std::uint64_t>(
+                std::numeric_limits<std::int64_t>::max()
+            )) {
+            return value([this, u](const std::shared_ptr<t_column>& col) {
+                fill(col, rapidjson::Value(u));
+            });
+        }
+
+        return integer(static_cast<std::int64_t>(u));
+    }
+
+    bool
+    Double(double d) {
+        return value([this, d](const std::shared_ptr<t_column>& col) {
+            switch (col->get_dtype()) {
+                case DTYPE_FLOAT64:
+                    col->set_nth<double>(m_num_rows, d);
+                    break;
+                case DTYPE_INT32:
+                    col->set_nth<std::int32_t>(
+                        m_num_rows, static_cast<std::int32_t>(d)
+                    );
+                    break;
+                default:
+                    fill(col, rapidjson::Value(d));
+            }
+        });
+    }
+
+    bool
+    String(const char* str, rapidjson::SizeType len, bool /* copy */) {
+        // The reader null-terminates `str`, which `set_nth` relies on.
+        return value([this, str, len](const std::shared_ptr<t_column>& col) {
+            if (col->get_dtype() == DTYPE_STR) [[likely]] {
+                col->set_nth(m_num_rows, str);
+            } else {
+                fill(col, rapidjson::Value(rapidjson::StringRef(str, len)));
+            }
+        });
+    }
+
+    bool
+    Key(const char* str, rapidjson::SizeType len, bool /* copy */) {
+        if (m_depth == m_row_depth) {
+            m_slot = m_index.find(str, len);
+        }
+
+        return true;
+    }
+
+    bool
+    StartObject() {
+        if (m_depth + 1 == m_row_depth) {
+            begin_row();
+        } else {
+            start_nested("object");
+        }
+
+        m_depth++;
+        return true;
+    }
+
+    bool
+    EndObject(rapidjson::SizeType /* member_count */) {
+        if (m_depth == m_row_depth) {
+            m_num_rows++;
+        }
+
+        m_depth--;
+        return true;
+    }
+
+    bool
+    StartArray() {
+        if (m_depth != 0 || m_row_depth != 2) {
+            start_nested("array");
+        }
+
+        m_depth++;
+        return true;
+    }
+
+    bool
+    EndArray(rapidjson::SizeType /* element_count */) {
+        m_depth--;
+        return true;
+    }
+
+    t_uindex
+    num_rows() const {
+        return m_num_rows;
+    }
+
+private:
+    static t_json_column_index
+    make_index(const t_schema& schema) {
+        // `__INDEX__` aliases `psp_pkey`, which is always the last slot.
+        std::vector<std::string> names;
+        names.reserve(schema.m_columns.size() + 1);
+        for (const auto& name : schema.m_columns) {
+            if (name != "__INDEX__") {
+                names.push_back(name);
+            }
+        }
+
+        names.emplace_back("__INDEX__");
+        return t_json_column_index(std::move(names));
+    }
+
+    void
+    begin_row() {
+        if (m_num_rows >= m_data_table.get_capacity()) {
+            m_data_table.reserve(2 * m_data_table.get_capacity() + 1);
+        }
+
+        if (m_is_implicit) {
+            m_psp_pkey->set_nth<std::uint32_t>(
+                m_num_rows, m_num_rows + m_offset
+            );
+        }
+
+        m_slot = -1;
+    }
+
+    void
+    start_nested(const char* kind) {
+        if (m_depth < m_row_depth) {
+            // TODO Legacy error message
+            PSP_COMPLAIN_AND_ABORT(
+                "Cannot determine data types without column names!\n"
+            );
+        }
+
+        // Nested values are ignored for unknown keys, as in the DOM loaders.
+        if (m_depth == m_row_depth && m_slot >= 0) {
+            std::stringstream ss;
+            ss << "Cannot coerce " << kind << " to "
+               << dtype_to_str(m_columns[m_slot]->get_dtype());
+            PSP_COMPLAIN_AND_ABORT(ss.str());
+        }
+    }
+
+    /**
+     * @brief Write an integer cell. `Int` and `Int64` events differ only in
+     * range, which `fill_column_json` does not distinguish in update mode.
+     */
+    bool
+    integer(std::int64_t i) {
+        return value([this, i](const std::shared_ptr<t_column>& col) {
+            switch (col->get_dtype()) {
+                case DTYPE_INT32:
+                    col->set_nth<std::int32_t>(
+                        m_num_rows, static_cast<std::int32_t>(i)
+                    );
+                    break;
+                case DTYPE_INT64:
+                    col->set_nth<std::int64_t>(m_num_rows, i);
+                    break;
+                case DTYPE_FLOAT64:
+                    col->set_nth<double>(m_num_rows, static_cast<double>(i));
+                    break;
+                default:
+                    fill(col, rapidjson::Value(i));
+            }
+        });
+    }
+
+    /**
+     * @brief Coerce `cell` into `col` via `fill_column_json`, for JSON types
+     * which don't match the column's.
+     */
+    void
+    fill(const std::shared_ptr<t_column>& col, const rapidjson::Value& cell) {
+        auto promote = fill_column_json(col, m_num_rows, cell, true);
+        if (promote) {
+            std::stringstream ss;
+            ss << "Cannot append value of type " << dtype_to_str(*promote)
+               << " to column of type " << dtype_to_str(col->get_dtype())
+               << std::endl;
+            PSP_COMPLAIN_AND_ABORT(ss.str());
+        }
+    }
+
+    /**
+     * @brief Write the current scalar with `write`, into the column of the
+     * current key (and `psp_pkey`, if the key is the index).
+     */
+    template <typename F>
+    bool
+    value(F&& write) {
+        if (m_depth != m_row_depth) {
+            if (m_depth < m_row_depth) {
+                // TODO Legacy error message
+                PSP_COMPLAIN_AND_ABORT(
+                    "Cannot determine data types without column names!\n"
+                );
+            }
+
+            return true;
+        }
+
+        if (m_slot < 0) {
+            return true;
+        }
+
+        write(m_columns[m_slot]);
+        if (m_slot == m_index_slot) {
+            write(m_psp_pkey);
+        }
+
+        return true;
+    }
+
+    t_data_table& m_data_table;
+    t_json_column_index m_index;
+    std::vector<std::shared_ptr<t_column>> m_columns;
+    std::shared_ptr<t_column> m_psp_pkey;
+    bool m_is_implicit;
+    std::uint32_t m_offset;
+    t_uindex m_row_depth;
+    t_uindex m_depth;
+    t_uindex m_num_rows;
+    std::int64_t m_slot;
+    std::int64_t m_index_slot;
+};
+
 void
 Table::remove_rows(const std::string_view& data) {
     // 1.) Infer schema
@@ -834,7 +1231,7 @@ Table::remove_rows(const std::string_view& data) {
         ii++;
     }
 
-    data_table.clone_column("psp_pkey", "psp_okey");
+    data_table.alias_column("psp_pkey", "psp_okey");
     // calculate_offset(data_table.size());
     process_op_column(data_table, OP_DELETE);
     m_pool->send(get_gnode()->get_id(), 0, data_table);
@@ -983,7 +1380,7 @@ Table::update_cols(const std::string_view& data, std::uint32_t port_id) {
         }
     }
 
-    data_table.clone_column("psp_pkey", "psp_okey");
+    data_table.alias_column("psp_pkey", "psp_okey");
 
     process_op_column(data_table, t_op::OP_INSERT);
     calculate_offset(nrows);
@@ -1116,28 +1513,14 @@ Table::from_cols(
 
 void
 Table::update_rows(const std::string_view& data, std::uint32_t port_id) {
-    // 1.) Infer schema
-    rapidjson::Document document;
-    document.Parse(data.data());
-    if (document.Size() == 0) {
-        return;
-    }
-
-    if (!document[0].IsObject()) {
-        // TODO Legacy error message
-        PSP_COMPLAIN_AND_ABORT(
-            "Cannot determine data types without column names!\n"
-        )
-    }
-
     bool is_implicit = m_index.empty();
     t_schema table_schema = get_schema();
 
-    // 2.) Create table
-    t_uindex size = document.Size();
+    // 1.) Create table. Every row begins with a `{`, so counting them bounds
+    // the row count without parsing.
     t_data_table data_table(table_schema);
     data_table.init();
-    data_table.extend(size);
+    data_table.reserve(std::count(data.begin(), data.end(), '{') + 1);
     if (is_implicit) {
         data_table.add_column("psp_pkey", DTYPE_INT32, true);
     } else {
@@ -1146,64 +1529,24 @@ Table::update_rows(const std::string_view& data, std::uint32_t port_id) {
         );
     }
 
-    t_uindex ii = 0;
-    const auto& psp_pkey_col = data_table.get_column("psp_pkey");
-    auto schema = data_table.get_schema();
-    // t_uindex col_count;
-    // bool supports_partial =
-    //     m_limit == std::numeric_limits<int>::max() && !m_index.empty();
-    bool is_first_row = true;
-    std::vector<std::string> missing_columns = m_column_names;
-
-    // 3.) Fill table
-    for (const auto& row : document.GetArray()) {
-        if (is_implicit) {
-            psp_pkey_col->set_nth<std::uint32_t>(ii, (ii + m_offset));
-        }
-
-        // col_count = m_column_names.size();
-        for (const auto& it : row.GetObj()) {
-            std::shared_ptr<t_column> col;
-            std::string_view col_name = it.name.GetString();
-            if (std::string_view{it.name.GetString()} == "__INDEX__") {
-                col_name = "psp_pkey";
-            }
-
-            if (!schema.has_column(col_name)) {
-                LOG_DEBUG("Ignoring column " << col_name);
-                LOG_DEBUG("Schema:\n" << schema);
-                continue;
-            }
-
-            if (is_first_row) {
-                missing_columns.erase(
-                    std ::remove(
-                        missing_columns.begin(), missing_columns.end(), col_name
-                    ),
-                    missing_columns.end()
-                );
-            }
-
-            col = data_table.get_column(col_name);
-            auto promote = fill_column_json(col, ii, it.value, true);
-            if (promote) {
-                std::stringstream ss;
-                ss << "Cannot append value of type " << dtype_to_str(*promote)
-                   << " to column of type " << dtype_to_str(col->get_dtype())
-                   << std::endl;
-                PSP_COMPLAIN_AND_ABORT(ss.str());
-            }
-
-            if (!is_implicit && m_index == it.name.GetString()) {
-                fill_column_json(psp_pkey_col, ii, it.value, true);
-            }
-        }
+    // 2.) Fill table straight from the parser's SAX events.
+    t_json_row_handler handler(data_table, m_index, m_offset, true);
+    rapidjson::Reader reader;
+    rapidjson::StringStream s(data.data());
+    if (!reader.Parse(s, handler)) {
+        std::stringstream ss;
+        ss << "Failed to parse JSON at offset " << reader.GetErrorOffset()
+           << ": " << rapidjson::GetParseError_En(reader.GetParseErrorCode());
+        PSP_COMPLAIN_AND_ABORT(ss.str());
+    }
 
-        is_first_row = false;
-        ii++;
+    t_uindex size = handler.num_rows();
+    if (size == 0) {
+        return;
     }
 
-    data_table.clone_column("psp_pkey", "psp_okey");
+    data_table.extend(size);
+    data_table.alias_column("psp_pkey", "psp_okey");
     process_op_column(data_table, t_op::OP_INSERT);
     calculate_offset(size);
     m_pool->send(get_gnode()->get_id(), port_id, data_table);
@@ -1344,35 +1687,15 @@ Table::from_rows(
 
 void
 Table::update_ndjson(const std::string_view& data, std::uint32_t port_id) {
-    rapidjson::Document document;
-    rapidjson::StringStream s(data.data());
-    document.ParseStream<rapidjson::kParseStopWhenDoneFlag>(s);
-    if (document.Size() == 0) {
-        return;
-    }
-
-    if (!document.IsObject()) {
-        // TODO Legacy error message
-        PSP_COMPLAIN_AND_ABORT(
-            "Cannot determine data types without column names!\n"
-        )
-    }
-
     bool is_implicit = m_index.empty();
     t_schema table_schema = get_schema();
 
-    // 2.) Create table
+    // 1.) Create table
     t_data_table data_table(table_schema);
     data_table.init();
 
-    // 2a.) Estimate row size to reduce malloc pressure.
-    auto newlines = 0;
-    for (char i : data) {
-        if (i == '\n') {
-            newlines++;
-        }
-    }
-
+    // 1a.) Estimate row size to reduce malloc pressure.
+    auto newlines = std::count(data.begin(), data.end(), '\n');
     data_table.reserve(newlines + 1);
     if (is_implicit) {
         data_table.add_column("psp_pkey", DTYPE_INT32, true);
@@ -1382,70 +1705,36 @@ Table::update_ndjson(const std::string_view& data, std::uint32_t port_id) {
         );
     }
 
-    t_uindex ii = 0;
-    const auto& psp_pkey_col = data_table.get_column("psp_pkey");
-    auto schema = data_table.get_schema();
-    bool is_first_row = true;
-    std::vector<std::string> missing_columns = m_column_names;
-
-    // 3.) Fill table
-    bool is_finished = false;
-    while (!is_finished) {
-        if (is_implicit) {
-            psp_pkey_col->set_nth<std::uint32_t>(ii, (ii + m_offset));
-        }
-
-        for (const auto& it : document.GetObj()) {
-            std::shared_ptr<t_column> col;
-            std::string_view col_name = it.name.GetString();
-            if (std::string_view{it.name.GetString()} == "__INDEX__") {
-                col_name = "psp_pkey";
-            }
-
-            if (!schema.has_column(col_name)) {
-                LOG_DEBUG("Ignoring column " << col_name);
-                LOG_DEBUG("Schema:\n" << schema);
-                continue;
-            }
-
-            if (is_first_row) {
-                missing_columns.erase(
-                    std ::remove(
-                        missing_columns.begin(), missing_columns.end(), col_name
-                    ),
-                    missing_columns.end()
+    // 2.) Fill table straight from the parser's SAX events, one row object
+    // per `Parse` call, until the input is exhausted (or no longer parses).
+    t_json_row_handler handler(data_table, m_index, m_offset, false);
+    rapidjson::Reader reader;
+    rapidjson::StringStream s(data.data());
+    rapidjson::SkipWhitespace(s);
+    while (s.Peek() != '\0') {
+        if (!reader.Parse<rapidjson::kParseStopWhenDoneFlag>(s, handler)) {
+            if (handler.num_rows() == 0) {
+                // TODO Legacy error message
+                PSP_COMPLAIN_AND_ABORT(
+                    "Cannot determine data types without column names!\n"
                 );
             }
 
-            col = data_table.get_column(col_name);
-            auto promote = fill_column_json(col, ii, it.value, true);
-            if (promote) {
-                std::stringstream ss;
-                ss << "Cannot append value of type " << dtype_to_str(*promote)
-                   << " to column of type " << dtype_to_str(col->get_dtype())
-                   << std::endl;
-                PSP_COMPLAIN_AND_ABORT(ss.str());
-            }
-
-            if (!is_implicit && m_index == it.name.GetString()) {
-                fill_column_json(psp_pkey_col, ii, it.value, true);
-            }
+            break;
         }
 
-        is_first_row = false;
-
-        ii++;
+        rapidjson::SkipWhitespace(s);
+    }
 
-        document.ParseStream<rapidjson::kParseStopWhenDoneFlag>(s);
-        if (document.HasParseError()) {
-            is_finished = true;
-        }
+    t_uindex size = handler.num_rows();
+    if (size == 0) {
+        return;
     }
 
-    data_table.extend(ii);
-    data_table.clone_column("psp_pkey", "psp_okey");
+    data_table.extend(size);
+    data_table.alias_column("psp_pkey", "psp_okey");
     process_op_column(data_table, t_op::OP_INSERT);
-    calculate_offset(ii);
+    calculate_offset(size);
     m_pool->send(get_gnode()->get_id(), port_id, data_table);
 }
 
@@ -1617,8 +1906,8 @@ Table::from_schema(
             PSP_COMPLAIN_AND_ABORT(ss.str());
         }
 
-        data_table.clone_column(index, "psp_pkey");
-        data_table.clone_column(index, "psp_okey");
+        data_table.alias_column(index, "psp_pkey");
+        data_table.alias_column(index, "psp_okey");
     }
 
     auto tbl = std::make_shared<Table>(
@@ -1738,7 +2027,7 @@ Table::make_table(
         pkey->set_nth<std::uint64_t>(i, i);
     }
     if (!schema.has_column("psp_okey")) {
-        data_table.clone_column("psp_pkey", "psp_okey");
+        data_table.alias_column("psp_pkey", "psp_okey");
     }
     auto columns = data_table.get_schema().columns();
     auto dtypes = data_table.get_schema().types();
@@ -22,10 +22,61 @@
 #include <perspective/dense_tree_context.h>
 #include <tsl/hopscotch_set.h>
 
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
 #include <utility>
 
 namespace perspective {
 
+void
+notify_sparse_traversal(
+    const std::shared_ptr<t_stree>& tree,
+    const std::shared_ptr<t_traversal>& traversal,
+    const std::vector<t_sortspec>& ctx_sortby
+) {
+    const t_stree_step& step = tree->get_last_step();
+
+    t_uindex t_osize = traversal->size();
+    traversal->drop_tree_indices(step.m_zero_strands);
+    t_uindex t_nsize = traversal->size();
+    if (t_osize != t_nsize) {
+        tree->set_has_deltas(true);
+    }
+
+    if (!step.m_sorted_leaves.empty() && traversal->size() == 1) {
+        if (traversal->get_node(0).m_expanded) {
+            traversal->populate_root_children(tree);
+        }
+
+        return;
+    }
+
+    std::set<t_uindex> visited;
+
+    for (auto lfidx : step.m_sorted_leaves) {
+        auto ancestry = tree->get_ancestry(lfidx);
+
+        t_uindex num_tnodes_existed = 0;
+
+        for (auto nidx : ancestry) {
+            if (step.m_non_zero_ids.find(nidx) == step.m_non_zero_ids.end()
+                || visited.find(nidx) != visited.end()) {
+                ++num_tnodes_existed;
+            } else {
+                break;
+            }
+        }
+
+        traversal->add_node(ctx_sortby, ancestry, num_tnodes_existed);
+
+        for (auto nidx : ancestry) {
+            visited.insert(nidx);
+        }
+    }
+}
+
 void
 notify_sparse_tree_common(
     const std::shared_ptr<t_data_table>& strands,
@@ -52,43 +103,54 @@ notify_sparse_tree_common(
 
     auto pivots = tree->get_pivots();
 
-    t_dtree dtree(strands, pivots, tree_sortby);
-    dtree.init();
+    // Small updates are grouped by hashing each strand's path directly into
+    // the tree, while large ones amortize building a `t_dtree` first.
+    bool apply_directly = tree->should_apply_strands_directly(*strands);
+    t_strand_tree stree;
+    std::unique_ptr<t_dtree> dtree;
+    std::unique_ptr<t_dtree_ctx> dctx;
 
-    dtree.check_pivot(fltr, pivots.size() + 1);
+    if (apply_directly) {
+        stree = tree->build_strand_tree(
+            strands, strand_deltas, aggregates, tree_sortby
+        );
 
-    if (t_env::log_data_nsparse_dtree()) {
-        std::cout << "nsparse_dtree" << '\n';
-        dtree.pprint(fltr);
-    }
+        tree->update_shape_from_strands(stree);
+    } else {
+        dtree = std::make_unique<t_dtree>(strands, pivots, tree_sortby);
+        dtree->init();
 
-    t_dtree_ctx dctx(strands, strand_deltas, dtree, aggregates);
+        dtree->check_pivot(fltr, pivots.size() + 1);
 
-    dctx.init();
+        if (t_env::log_data_nsparse_dtree()) {
+            std::cout << "nsparse_dtree" << '\n';
+            dtree->pprint(fltr);
+        }
 
-    tree->update_shape_from_static(dctx);
+        dctx = std::make_unique<t_dtree_ctx>(
+            strands, strand_deltas, *dtree, aggregates
+        );
 
-    auto zero_strands = tree->zero_strands();
+        dctx->init();
 
-    t_uindex t_osize = process_traversal ? traversal->size() : 0;
-    if (process_traversal) {
-        traversal->drop_tree_indices(zero_strands);
-    }
-    t_uindex t_nsize = process_traversal ? traversal->size() : 0;
-    if (t_osize != t_nsize) {
-        tree->set_has_deltas(true);
+        tree->update_shape_from_static(*dctx);
     }
 
-    auto non_zero_ids = tree->non_zero_ids(zero_strands);
-    auto non_zero_leaves = tree->non_zero_leaves(zero_strands);
+    t_stree_step step;
+    step.m_applied_directly = apply_directly;
+    step.m_zero_strands = tree->zero_strands();
+    step.m_non_zero_ids = tree->non_zero_ids(step.m_zero_strands);
+    auto non_zero_leaves = tree->non_zero_leaves(step.m_zero_strands);
 
     tree->drop_zero_strands();
 
     tree->populate_leaf_index(non_zero_leaves);
 
-    tree->update_aggs_from_static(dctx, gstate, expression_master_table);
-
-    std::set<t_uindex> visited;
+    if (apply_directly) {
+        tree->update_aggs_from_strands(stree, gstate, expression_master_table);
+    } else {
+        tree->update_aggs_from_static(*dctx, gstate, expression_master_table);
+    }
 
     struct t_leaf_path {
         std::vector<t_tscalar> m_path;
@@ -116,35 +178,17 @@ notify_sparse_tree_common(
         }
     );
 
-    if (!leaf_paths.empty() && (traversal != nullptr)
-        && traversal->size() == 1) {
-        if (traversal->get_node(0).m_expanded) {
-            traversal->populate_root_children(tree);
-        }
-    } else {
-        for (const auto& lpath : leaf_paths) {
-            t_uindex lfidx = lpath.m_lfidx;
-            auto ancestry = tree->get_ancestry(lfidx);
-
-            t_uindex num_tnodes_existed = 0;
-
-            for (auto nidx : ancestry) {
-                if (non_zero_ids.find(nidx) == non_zero_ids.end()
-                    || visited.find(nidx) != visited.end()) {
-                    ++num_tnodes_existed;
-                } else {
-                    break;
-                }
-            }
+    step.m_sorted_leaves.reserve(leaf_paths.size());
+    for (const auto& lpath : leaf_paths) {
+        step.m_sorted_leaves.push_back(lpath.m_lfidx);
+    }
 
-            if (process_traversal) {
-                traversal->add_node(ctx_sortby, ancestry, num_tnodes_existed);
-            }
+    // The step is kept on the tree so that other contexts sharing it can
+    // update their own traversals without repeating the work above.
+    tree->set_last_step(std::move(step));
 
-            for (auto nidx : ancestry) {
-                visited.insert(nidx);
-            }
-        }
+    if (process_traversal) {
+        notify_sparse_traversal(tree, traversal, ctx_sortby);
     }
 }
 
@@ -219,6 +263,109 @@ notify_sparse_tree(
     );
 }
 
+/**
+ * @brief Whether `a` and `b` compute the same values, whatever they are
+ * named.
+ */
+static bool
+same_tree_aggregate(const t_aggspec& a, const t_aggspec& b) {
+    if (a.agg() != b.agg()
+        || a.get_input_depnames() != b.get_input_depnames()) {
+        return false;
+    }
+
+    switch (a.agg()) {
+        case AGGTYPE_FIRST:
+        case AGGTYPE_LAST_BY_INDEX:
+        case AGGTYPE_LAST_MINUS_FIRST: {
+            return a.get_sort_type() == b.get_sort_type();
+        }
+        default: {
+            return true;
+        }
+    }
+}
+
+std::vector<t_aggspec>
+union_tree_aggregates(
+    const std::vector<t_aggspec>& tree_aggregates,
+    const std::vector<t_aggspec>& aggregates
+) {
+    std::vector<t_aggspec> rval = tree_aggregates;
+    std::set<std::string> names;
+    for (const auto& spec : rval) {
+        names.insert(spec.name());
+    }
+
+    for (const auto& spec : aggregates) {
+        auto iter = std::find_if(
+            rval.begin(),
+            rval.end(),
+            [&spec](const t_aggspec& tree_spec) {
+                return same_tree_aggregate(tree_spec, spec);
+            }
+        );
+
+        if (iter != rval.end()) {
+            continue;
+        }
+
+        std::string name = spec.name();
+        for (t_uindex suffix = rval.size(); names.count(name) != 0;
+             ++suffix) {
+            name = spec.name() + "#" + std::to_string(suffix);
+        }
+
+        names.insert(name);
+        rval.push_back(spec.with_name(name));
+    }
+
+    return rval;
+}
+
+std::vector<t_index>
+get_tree_aggregate_indices(
+    const std::vector<t_aggspec>& tree_aggregates,
+    const std::vector<t_aggspec>& aggregates
+) {
+    std::vector<t_index> rval(aggregates.size(), INVALID_INDEX);
+    for (t_uindex idx = 0, loop_end = aggregates.size(); idx < loop_end;
+         ++idx) {
+        // Prefer the aggregate of the same name, as a context's own
+        // aggregates may compute the same values under different names.
+        for (t_uindex tidx = 0, tree_end = tree_aggregates.size();
+             tidx < tree_end;
+             ++tidx) {
+            if (!same_tree_aggregate(tree_aggregates[tidx], aggregates[idx])) {
+                continue;
+            }
+
+            if (rval[idx] == INVALID_INDEX
+                || tree_aggregates[tidx].name() == aggregates[idx].name()) {
+                rval[idx] = tidx;
+            }
+        }
+    }
+
+    return rval;
+}
+
+std::vector<t_sortspec>
+get_tree_sortby(
+    const std::vector<t_sortspec>& sortby,
+    const std::vector<t_index>& tree_aggidx
+) {
+    std::vector<t_sortspec> rval = sortby;
+    for (auto& spec : rval) {
+        if (spec.m_agg_index >= 0
+            && t_uindex(spec.m_agg_index) < tree_aggidx.size()) {
+            spec.m_agg_index = tree_aggidx[spec.m_agg_index];
+        }
+    }
+
+    return rval;
+}
+
 std::vector<t_path>
 ctx_get_expansion_state(
     const std::shared_ptr<const t_stree>& tree,
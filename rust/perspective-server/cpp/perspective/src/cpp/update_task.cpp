@@ -19,8 +19,8 @@ t_update_task::t_update_task(t_pool& pool) : m_pool(pool) {}
 
 void
 t_update_task::run(std::optional<std::function<void(std::uint32_t)>> callback) {
-    auto work_to_do = m_pool.m_data_remaining.load();
-    m_pool.m_data_remaining.store(false);
+    // `exchange` so that concurrent callers don't both claim the pending work.
+    auto work_to_do = m_pool.m_data_remaining.exchange(false);
 
     if (work_to_do) {
         for (auto* g : m_pool.m_gnodes) {
@@ -13,11 +13,13 @@
 #include <perspective/first.h>
 #include <perspective/view.h>
 #include <perspective/arrow_writer.h>
+#include <set>
 #include <sstream>
 #include <utility>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 #include <arrow/csv/writer.h>
+#include <arrow/array/concatenate.h>
 #include <perspective/pyutils.h>
 
 namespace perspective {
@@ -768,7 +770,8 @@ View<t_ctx2>::to_csv(
     std::int32_t start_row,
     std::int32_t end_row,
     std::int32_t start_col,
-    std::int32_t end_col
+    std::int32_t end_col,
+    bool include_header
 ) const {
     PSP_GIL_UNLOCK();
     PSP_READ_LOCK(*get_lock());
@@ -780,7 +783,7 @@ View<t_ctx2>::to_csv(
 
     std::shared_ptr<t_data_slice<t_ctx2>> data_slice =
         get_data(start_row, end_row, start_col, end_col);
-    return data_slice_to_csv(data_slice);
+    return data_slice_to_csv(data_slice, include_header);
 };
 
 template <>
@@ -789,13 +792,14 @@ View<t_ctx1>::to_csv(
     std::int32_t start_row,
     std::int32_t end_row,
     std::int32_t start_col,
-    std::int32_t end_col
+    std::int32_t end_col,
+    bool include_header
 ) const {
     PSP_GIL_UNLOCK();
     PSP_READ_LOCK(*get_lock());
     std::shared_ptr<t_data_slice<t_ctx1>> data_slice =
         get_data(start_row, end_row, start_col, end_col);
-    return data_slice_to_csv(data_slice);
+    return data_slice_to_csv(data_slice, include_header);
 };
 
 template <typename CTX_T>
@@ -804,7 +808,8 @@ View<CTX_T>::to_csv(
     std::int32_t start_row,
     std::int32_t end_row,
     std::int32_t start_col,
-    std::int32_t end_col
+    std::int32_t end_col,
+    bool include_header
 ) const {
     PSP_GIL_UNLOCK();
     PSP_READ_LOCK(*get_lock());
@@ -817,7 +822,7 @@ View<CTX_T>::to_csv(
 
     std::shared_ptr<t_data_slice<CTX_T>> data_slice =
         get_data(start_row, end_row, start_col, end_col);
-    return data_slice_to_csv(data_slice);
+    return data_slice_to_csv(data_slice, include_header);
 };
 
 template <typename CTX_T>
@@ -1347,8 +1352,16 @@ View<CTX_T>::data_slice_to_arrow(
         std::shared_ptr<arrow::Schema>,
         std::shared_ptr<arrow::RecordBatch>>
         pairs = data_slice_to_batches(emit_group_by, data_slice);
-    std::shared_ptr<arrow::RecordBatch> batches = pairs.second;
-    std::shared_ptr<arrow::Schema> arrow_schema = pairs.first;
+    return _batch_to_arrow(pairs.first, pairs.second, compress);
+}
+
+template <typename CTX_T>
+std::shared_ptr<std::string>
+View<CTX_T>::_batch_to_arrow(
+    const std::shared_ptr<arrow::Schema>& arrow_schema,
+    const std::shared_ptr<arrow::RecordBatch>& batches,
+    bool compress
+) const {
     arrow::Result<std::shared_ptr<arrow::ResizableBuffer>> allocated =
         arrow::AllocateResizableBuffer(0);
     if (!allocated.ok()) {
@@ -1383,7 +1396,8 @@ View<CTX_T>::data_slice_to_arrow(
 
 template <typename CTX_T>
 std::shared_ptr<std::string>
-View<CTX_T>::data_slice_to_csv(std::shared_ptr<t_data_slice<CTX_T>> data_slice
+View<CTX_T>::data_slice_to_csv(
+    std::shared_ptr<t_data_slice<CTX_T>> data_slice, bool include_header
 ) const {
     std::pair<
         std::shared_ptr<arrow::Schema>,
@@ -1404,6 +1418,7 @@ View<CTX_T>::data_slice_to_csv(std::shared_ptr<t_data_slice<CTX_T>> data_slice
     buffer = *allocated;
     arrow::io::BufferOutputStream sink(buffer);
     auto write_options = arrow::csv::WriteOptions::Defaults();
+    write_options.include_header = include_header;
     auto maybe_writer =
         arrow::csv::MakeCSVWriter(&sink, arrow_schema, write_options);
     std::shared_ptr<arrow::ipc::RecordBatchWriter> writer = *maybe_writer;
@@ -1514,6 +1529,155 @@ View<t_ctx2>::set_depth(std::int32_t depth, std::int32_t row_pivot_length) {
     }
 }
 
+template <typename CTX_T>
+bool
+View<CTX_T>::set_sort(
+    const std::vector<std::vector<std::string>>& sort,
+    const std::shared_ptr<t_schema>& schema
+) {
+    auto prev_sort = m_view_config->get_sort();
+    auto prev_aggspecs = m_view_config->get_aggspecs();
+    auto prev_col_sortspec = m_view_config->get_col_sortspec();
+    auto prev_hidden_sort = m_hidden_sort;
+
+    m_view_config->set_sort(sort, schema);
+    auto sortspec = m_view_config->get_sortspec();
+    m_hidden_sort.clear();
+    _find_hidden_sort(sortspec);
+    if (!m_column_pivots.empty()) {
+        _find_hidden_sort(m_view_config->get_col_sortspec());
+    }
+
+    if (!_can_sort_in_place(
+            prev_aggspecs, prev_hidden_sort, prev_col_sortspec
+        )) {
+        m_view_config->set_sort(prev_sort, schema);
+        m_hidden_sort = prev_hidden_sort;
+        return false;
+    }
+
+    m_sort = sortspec;
+    m_aggregates = m_view_config->get_aggspecs();
+    _sort_in_place();
+    return true;
+}
+
+/**
+ * @brief Whether two aggspec lists would build the same aggregate columns,
+ * as `t_aggspec` has no `operator==`.
+ */
+static bool
+same_aggspecs(
+    const std::vector<t_aggspec>& a, const std::vector<t_aggspec>& b
+) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (t_uindex i = 0; i < a.size(); ++i) {
+        if (a[i].name() != b[i].name() || a[i].agg() != b[i].agg()
+            || a[i].get_input_depnames() != b[i].get_input_depnames()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <>
+bool
+View<t_ctxunit>::_can_sort_in_place(
+    const std::vector<t_aggspec>& prev_aggspecs,
+    const std::vector<std::string>& prev_hidden_sort,
+    const std::vector<t_sortspec>& prev_col_sortspec
+) const {
+    // Unit contexts have no traversal to sort.
+    return false;
+}
+
+template <>
+bool
+View<t_ctx0>::_can_sort_in_place(
+    const std::vector<t_aggspec>& prev_aggspecs,
+    const std::vector<std::string>& prev_hidden_sort,
+    const std::vector<t_sortspec>& prev_col_sortspec
+) const {
+    // Hidden sort columns are part of the context's config, so the sort may
+    // only use columns the context already has.
+    std::set<std::string> prev_hidden(
+        prev_hidden_sort.begin(), prev_hidden_sort.end()
+    );
+    std::set<std::string> hidden(m_hidden_sort.begin(), m_hidden_sort.end());
+    return prev_hidden == hidden;
+}
+
+template <>
+bool
+View<t_ctx1>::_can_sort_in_place(
+    const std::vector<t_aggspec>& prev_aggspecs,
+    const std::vector<std::string>& prev_hidden_sort,
+    const std::vector<t_sortspec>& prev_col_sortspec
+) const {
+    // `t_ctx1::sort_by` cannot restore the unsorted order of the tree.
+    if (!m_sort.empty() && m_view_config->get_sortspec().empty()) {
+        return false;
+    }
+
+    return same_aggspecs(prev_aggspecs, m_view_config->get_aggspecs());
+}
+
+template <>
+bool
+View<t_ctx2>::_can_sort_in_place(
+    const std::vector<t_aggspec>& prev_aggspecs,
+    const std::vector<std::string>& prev_hidden_sort,
+    const std::vector<t_sortspec>& prev_col_sortspec
+) const {
+    // Totals are only computed when the context was built with a row sort,
+    // and neither tree can be restored to its unsorted order.
+    auto sortspec = m_view_config->get_sortspec();
+    if (m_sort.empty() != sortspec.empty()) {
+        return false;
+    }
+
+    if (!prev_col_sortspec.empty()
+        && m_view_config->get_col_sortspec().empty()) {
+        return false;
+    }
+
+    return same_aggspecs(prev_aggspecs, m_view_config->get_aggspecs());
+}
+
+template <>
+void
+View<t_ctxunit>::_sort_in_place() {}
+
+template <>
+void
+View<t_ctx0>::_sort_in_place() {
+    if (m_sort.empty()) {
+        m_ctx->reset_sortby();
+    } else {
+        m_ctx->sort_by(m_sort);
+    }
+}
+
+template <>
+void
+View<t_ctx1>::_sort_in_place() {
+    m_ctx->sort_by(m_sort);
+}
+
+template <>
+void
+View<t_ctx2>::_sort_in_place() {
+    m_ctx->sort_by(m_sort);
+    auto col_sortspec = m_view_config->get_col_sortspec();
+    if (!col_sortspec.empty()) {
+        m_ctx->column_sort_by(col_sortspec);
+    }
+}
+
 // Getters
 template <typename CTX_T>
 std::shared_ptr<CTX_T>
@@ -1622,6 +1786,256 @@ View<CTX_T>::get_row_delta() const {
     );
 }
 
+/**
+ * @brief Flat contexts identify rows by primary key, and track updated rows
+ * (but not cells) by primary key too.
+ */
+template <typename CTX_T>
+static void
+get_flat_viewport_rows(
+    const CTX_T& ctx,
+    t_uindex start_row,
+    t_uindex end_row,
+    std::vector<std::size_t>& row_keys,
+    std::vector<t_uindex>& updated
+) {
+    std::vector<std::pair<t_uindex, t_uindex>> cells;
+    cells.reserve(end_row - start_row);
+    for (t_uindex ridx = start_row; ridx < end_row; ++ridx) {
+        cells.emplace_back(ridx, 0);
+    }
+
+    auto pkeys = ctx.get_pkeys(cells);
+    if (pkeys.size() != cells.size()) {
+        return;
+    }
+
+    const auto& delta_pkeys = ctx.get_delta_pkeys();
+    row_keys.reserve(pkeys.size());
+    for (t_uindex idx = 0; idx < pkeys.size(); ++idx) {
+        row_keys.push_back(hash_value(pkeys[idx]));
+        if (delta_pkeys.contains(pkeys[idx])) {
+            updated.push_back(start_row + idx);
+        }
+    }
+}
+
+template <>
+void
+View<t_ctxunit>::_get_viewport_rows(
+    t_uindex start_row,
+    t_uindex end_row,
+    std::vector<std::size_t>& row_keys,
+    std::vector<t_uindex>& updated
+) const {
+    get_flat_viewport_rows(*m_ctx, start_row, end_row, row_keys, updated);
+}
+
+template <>
+void
+View<t_ctx0>::_get_viewport_rows(
+    t_uindex start_row,
+    t_uindex end_row,
+    std::vector<std::size_t>& row_keys,
+    std::vector<t_uindex>& updated
+) const {
+    get_flat_viewport_rows(*m_ctx, start_row, end_row, row_keys, updated);
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::_get_viewport_rows(
+    t_uindex start_row,
+    t_uindex end_row,
+    std::vector<std::size_t>& row_keys,
+    std::vector<t_uindex>& updated
+) const {
+    row_keys.reserve(end_row - start_row);
+    for (t_uindex ridx = start_row; ridx < end_row; ++ridx) {
+        std::size_t key = 0;
+        for (const auto& scalar :
+             m_ctx->unity_get_row_path(ridx + m_row_offset)) {
+            boost::hash_combine(key, hash_value(scalar));
+        }
+
+        row_keys.push_back(key);
+    }
+
+    auto cells = m_ctx->get_cell_delta(
+        start_row + m_row_offset, end_row + m_row_offset
+    );
+
+    for (const auto& cell : cells) {
+        updated.push_back(cell.row - m_row_offset);
+    }
+}
+
+template <typename CTX_T>
+std::vector<t_uindex>
+View<CTX_T>::_update_viewport_keys(
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    t_viewport_keys& keys
+) const {
+    t_uindex srow = std::max(start_row, 0);
+    t_uindex erow = std::max(std::min(end_row, num_rows()), 0);
+    erow = std::max(srow, erow);
+
+    std::vector<std::size_t> row_keys;
+    std::vector<t_uindex> rows;
+    _get_viewport_rows(srow, erow, row_keys, rows);
+
+    std::size_t column_key = 0;
+    if (start_col < end_col) {
+        for (const auto& path : column_paths_range(start_col, end_col)) {
+            for (const auto& scalar : path) {
+                boost::hash_combine(column_key, hash_value(scalar));
+            }
+        }
+    }
+
+    // Rows whose identity changed, e.g. because a row was inserted above
+    // them, are sent too, as are all rows when the columns change.
+    bool columns_changed = column_key != keys.m_columns;
+    for (t_uindex idx = 0; idx < row_keys.size(); ++idx) {
+        if (columns_changed || idx >= keys.m_rows.size()
+            || keys.m_rows[idx] != row_keys[idx]) {
+            rows.push_back(srow + idx);
+        }
+    }
+
+    keys.m_rows = std::move(row_keys);
+    keys.m_columns = column_key;
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::update_viewport_keys(
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    t_viewport_keys& keys
+) const {
+    _update_viewport_keys(start_row, end_row, start_col, end_col, keys);
+}
+
+template <typename CTX_T>
+std::shared_ptr<std::string>
+View<CTX_T>::get_viewport_delta_as_arrow(
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    t_viewport_keys& keys
+) const {
+    auto rows =
+        _update_viewport_keys(start_row, end_row, start_col, end_col, keys);
+
+    if (rows.empty()) {
+        return nullptr;
+    }
+
+    // Read the span of the viewport between the first and last changed
+    // rows, which is bounded by the viewport rather than the size of the
+    // update, then keep only the changed rows.
+    auto data_slice =
+        get_data(rows.front(), rows.back() + 1, start_col, end_col);
+    auto pairs = data_slice_to_batches(true, data_slice);
+    const auto& batch = pairs.second;
+
+    arrow::Int32Builder row_builder;
+    PSP_CHECK_ARROW_STATUS(row_builder.Reserve(rows.size()));
+    std::vector<std::pair<std::int64_t, std::int64_t>> runs;
+    for (auto ridx : rows) {
+        auto offset = std::int64_t(ridx - rows.front());
+        if (offset >= batch->num_rows()) {
+            break;
+        }
+
+        row_builder.UnsafeAppend(std::int32_t(ridx));
+        if (!runs.empty()
+            && runs.back().first + runs.back().second == offset) {
+            ++runs.back().second;
+        } else {
+            runs.emplace_back(offset, 1);
+        }
+    }
+
+    std::vector<std::shared_ptr<arrow::Field>> fields{
+        arrow::field("__ROW__", arrow::int32())
+    };
+
+    std::vector<std::shared_ptr<arrow::Array>> vectors(1);
+    PSP_CHECK_ARROW_STATUS(row_builder.Finish(&vectors[0]));
+    for (int cidx = 0; cidx < batch->num_columns(); ++cidx) {
+        arrow::ArrayVector chunks;
+        chunks.reserve(runs.size());
+        for (const auto& [offset, length] : runs) {
+            chunks.push_back(batch->column(cidx)->Slice(offset, length));
+        }
+
+        auto column = arrow::Concatenate(chunks);
+        PSP_CHECK_ARROW_STATUS(column.status());
+        fields.push_back(batch->schema()->field(cidx));
+        vectors.push_back(*column);
+    }
+
+    auto arrow_schema = arrow::schema(fields);
+    auto num_rows = vectors[0]->length();
+    return _batch_to_arrow(
+        arrow_schema,
+        arrow::RecordBatch::Make(arrow_schema, num_rows, vectors),
+        false
+    );
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::clear_deltas() {
+    if (!m_ctx->get_trees_shared()) {
+        m_ctx->clear_deltas();
+    }
+}
+
+template <>
+void
+View<t_ctxunit>::clear_deltas() {
+    m_ctx->clear_deltas();
+}
+
+template <>
+void
+View<t_ctx0>::clear_deltas() {
+    m_ctx->clear_deltas();
+}
+
+template <typename CTX_T>
+t_view_profile
+View<CTX_T>::get_profile() const {
+    t_view_profile profile;
+    _get_context_profile(profile);
+
+    auto gnode = m_table->get_gnode();
+    for (const auto& expr : m_expressions) {
+        profile.m_expressions.push_back(
+            {expr->get_expression_alias(), gnode->get_expression_stats(*expr)}
+        );
+    }
+
+    profile.m_hidden_sort = m_hidden_sort;
+    profile.m_num_table_rows = m_table->size();
+    profile.m_traversal_rows = num_rows();
+    profile.m_traversal_columns = num_columns();
+    profile.m_last_update = gnode->get_last_update_stats();
+    return profile;
+}
+
 template <typename CTX_T>
 t_dtype
 View<CTX_T>::get_column_dtype(t_uindex idx) const {
@@ -2768,6 +3182,51 @@ View<t_ctx2>::to_columns(
     return s.GetString();
 }
 
+template <>
+void
+View<t_ctxunit>::_get_context_profile(t_view_profile& profile) const {
+    profile.m_context_type = "unit";
+    profile.m_num_filtered_rows = m_ctx->get_row_count();
+}
+
+template <>
+void
+View<t_ctx0>::_get_context_profile(t_view_profile& profile) const {
+    profile.m_context_type = "flat";
+    profile.m_num_filtered_rows = m_ctx->get_row_count();
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::_get_context_profile(t_view_profile& profile) const {
+    profile.m_context_type = sides() == 1 ? "one_sided" : "two_sided";
+    auto trees = m_ctx->get_trees();
+    for (const t_stree* tree : trees) {
+        const t_stree_step& step = tree->get_last_step();
+        profile.m_trees.push_back(
+            {tree->get_num_nodes_by_depth(),
+             step.m_non_zero_ids.size(),
+             step.m_zero_strands.size(),
+             step.m_applied_directly,
+             tree->has_indices()}
+        );
+    }
+
+    // Every row which passes the filter is beneath the root of the row tree,
+    // which is the last tree of a `t_ctx2`.
+    profile.m_num_filtered_rows = trees.back()->get_num_pkeys();
+    for (const auto& spec : m_aggregates) {
+        bool is_expression = !spec.get_dependencies().empty()
+            && m_ctx->is_expression_column(spec.get_first_depname());
+
+        profile.m_aggregates.push_back(
+            {spec.name(),
+             spec.agg_str(),
+             t_stree::is_incremental(spec, is_expression)}
+        );
+    }
+}
+
 template <typename CTX_T>
 void
 View<CTX_T>::_find_hidden_sort(const std::vector<t_sortspec>& sort) {
@@ -110,14 +110,7 @@ t_view_config::validate(const std::shared_ptr<t_schema>& schema) {
         }
     }
 
-    for (const auto& sort : m_sort) {
-        const std::string& col = sort[0];
-        if (!schema->has_column(col) && expression_aliases.count(col) == 0) {
-            std::stringstream ss;
-            ss << "Invalid column '" << col << "' found in View sorts." << '\n';
-            PSP_COMPLAIN_AND_ABORT(ss.str());
-        }
-    }
+    validate_sort(m_sort, schema, expression_aliases);
 }
 
 std::vector<std::shared_ptr<t_computed_expression>>
@@ -205,6 +198,35 @@ t_view_config::set_column_pivot_depth(std::int32_t depth) {
     m_column_pivot_depth = depth;
 }
 
+void
+t_view_config::set_sort(
+    const std::vector<std::vector<std::string>>& sort,
+    const std::shared_ptr<t_schema>& schema
+) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::unordered_set<std::string> expression_aliases;
+    expression_aliases.reserve(m_expressions.size());
+    for (const auto& expr : m_expressions) {
+        expression_aliases.insert(expr->get_expression_alias());
+    }
+
+    validate_sort(sort, schema, expression_aliases);
+
+    m_sort = sort;
+    m_aggspecs.clear();
+    m_aggregate_names.clear();
+    m_sortspec.clear();
+    m_col_sortspec.clear();
+    fill_aggspecs(schema);
+    fill_sortspec();
+}
+
+std::vector<std::vector<std::string>>
+t_view_config::get_sort() const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_sort;
+}
+
 std::vector<std::string>
 t_view_config::get_row_pivots() const {
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
@@ -364,6 +386,22 @@ t_view_config::fill_aggspecs(const std::shared_ptr<t_schema>& schema) {
     }
 }
 
+void
+t_view_config::validate_sort(
+    const std::vector<std::vector<std::string>>& sort,
+    const std::shared_ptr<t_schema>& schema,
+    const std::unordered_set<std::string>& expression_aliases
+) const {
+    for (const auto& s : sort) {
+        const std::string& col = s[0];
+        if (!schema->has_column(col) && expression_aliases.count(col) == 0) {
+            std::stringstream ss;
+            ss << "Invalid column '" << col << "' found in View sorts." << '\n';
+            PSP_COMPLAIN_AND_ABORT(ss.str());
+        }
+    }
+}
+
 void
 t_view_config::fill_fterm() {
     for (auto filter : m_filter) {
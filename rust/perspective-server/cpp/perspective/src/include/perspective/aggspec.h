@@ -100,6 +100,15 @@ public:
 
     std::string get_first_depname() const;
 
+    /**
+     * @brief A copy of this aggregate which writes to a column named
+     * `name`, and which shows its original name.
+     *
+     * @param name
+     * @return t_aggspec
+     */
+    t_aggspec with_name(const std::string& name) const;
+
 private:
     std::string m_name;
     std::string m_disp_name;
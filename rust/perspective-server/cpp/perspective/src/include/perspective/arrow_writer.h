@@ -23,6 +23,8 @@
 #include <arrow/api.h>
 #include <arrow/util/decimal.h>
 #include <arrow/io/memory.h>
+#include <arrow/ipc/dictionary.h>
+#include <arrow/ipc/message.h>
 #include <arrow/ipc/reader.h>
 #include <arrow/ipc/writer.h>
 
@@ -62,6 +64,18 @@ namespace apachearrow {
         t_get_data_extents extents
     );
 
+    /**
+     * @brief Append the record batches of the Arrow IPC stream `tail` to the
+     * stream `head`, if both have the same schema. `head` is extended in
+     * place, so merging `n` streams in turn costs time linear in their total
+     * size rather than re-encoding `head` on every append.
+     *
+     * @param head
+     * @param tail
+     * @return bool `false` (leaving `head` unchanged) if the schemas differ.
+     */
+    bool append_stream(std::string& head, const std::string& tail);
+
     /**
      * @brief Build an `arrow::Array` from a column typed as `DTYPE_BOOL.`
      *
@@ -109,6 +109,9 @@ public:
     // idx is in items
     const t_status* get_nth_status(t_uindex idx) const;
 
+    // idx is in items
+    t_status* get_nth_status(t_uindex idx);
+
     // idx is in items
     template <typename T>
     void set_nth(t_uindex idx, T v);
@@ -160,6 +160,29 @@ public:
         t_regex_mapping& regex_mapping
     ) const;
 
+    /**
+     * @brief Compute the expression only for the given rows of
+     * `source_table`, writing each result to the same row of
+     * `destination_table`, which must already be large enough. Only valid
+     * for expressions where `is_row_local()` is true.
+     */
+    void compute(
+        const std::shared_ptr<t_data_table>& source_table,
+        const t_gstate::t_mapping& pkey_map,
+        const std::shared_ptr<t_data_table>& destination_table,
+        const std::vector<t_uindex>& row_indices,
+        t_expression_vocab& vocab,
+        t_regex_mapping& regex_mapping
+    ) const;
+
+    /**
+     * @brief Whether each output row depends only on the same row of the
+     * columns in `get_column_ids()`, so rows whose inputs are unchanged
+     * do not need to be recomputed. Expressions that call `order`, `index`,
+     * `col`, `vlookup`, `random`, `today` or `now` are not row-local.
+     */
+    bool is_row_local() const;
+
     const std::string& get_expression_alias() const;
     const std::string& get_expression_string() const;
     const std::string& get_parsed_expression_string() const;
@@ -168,12 +191,22 @@ public:
     t_dtype get_dtype() const;
 
 private:
+    void compute_rows(
+        const std::shared_ptr<t_data_table>& source_table,
+        const t_gstate::t_mapping& pkey_map,
+        const std::shared_ptr<t_data_table>& destination_table,
+        const std::vector<t_uindex>* row_indices,
+        t_expression_vocab& vocab,
+        t_regex_mapping& regex_mapping
+    ) const;
+
     std::string m_expression_alias;
     std::string m_expression_string;
     std::string m_parsed_expression_string;
     t_computed_expression_parser m_computed_expression_parser;
     std::vector<std::pair<std::string, std::string>> m_column_ids;
     t_dtype m_dtype;
+    bool m_is_row_local;
 };
 
 /**
@@ -412,10 +412,10 @@ namespace computed_function {
 
         t_tscalar operator()(t_parameter_list parameters);
 
-        // faster unit lookups, since we are calling this lookup in a tight
-        // loop.
-        static std::default_random_engine RANDOM_ENGINE;
-        static std::uniform_real_distribution<double> DISTRIBUTION;
+        // One engine per thread, as tables may be polled concurrently on the
+        // thread pool.
+        static thread_local std::default_random_engine RANDOM_ENGINE;
+        static thread_local std::uniform_real_distribution<double> DISTRIBUTION;
     };
 
 } // end namespace computed_function
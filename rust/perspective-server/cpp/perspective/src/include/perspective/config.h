@@ -23,6 +23,23 @@
 
 namespace perspective {
 
+/**
+ * @brief Tuning for the sparse trees of a `Table`'s contexts, copied into
+ * each context's `t_config` when it is created. See `Table::set_tree_options`.
+ */
+struct PERSPECTIVE_EXPORT t_stree_options {
+    // Largest strand table, in rows times tree depth, which is applied to a
+    // tree directly rather than through an intermediate `t_dtree`. `0` always
+    // uses the `t_dtree`, which is useful for comparing the two paths.
+    t_uindex m_strand_direct_apply_max_cost = 65536;
+
+    // Most entries, in primary keys times indices times tree depth, which
+    // the MIN/MAX/DOMINANT/UNIQUE/FIRST/LAST indices of one tree may hold.
+    // A tree which outgrows this drops its indices, and rebuilds them once
+    // they would fit in half of it. `0` disables the indices.
+    t_uindex m_index_max_entries = 1 << 22;
+};
+
 /**
  * @brief `t_config` contains metadata for the `View` and `t_ctx*` structures,
  * containing specifications for how pivots, columns, filters, and sorts should
@@ -152,6 +169,17 @@ public:
 
     std::string repr() const;
 
+    /**
+     * @brief A canonical description of everything in this config which
+     * determines the shape of a context's sparse trees: pivots, pivot sort
+     * columns, filters and expressions. Contexts whose configs have equal
+     * keys may share their trees, which then compute the aggregates of all
+     * of them, and differ in aggregates, sort order and expansion state.
+     *
+     * @return std::string
+     */
+    std::string get_tree_key() const;
+
     t_uindex get_num_aggregates() const;
 
     t_uindex get_num_columns() const;
@@ -167,6 +195,16 @@ public:
     bool validate_colidx(t_index idx) const;
 
     std::vector<std::string> get_column_names() const;
+
+    /**
+     * @brief Returns the names of the columns a context with this config
+     * reads from the flattened table it is notified with: `psp_pkey`,
+     * `psp_op`, pivots and their sort columns, aggregate dependencies,
+     * filter columns and the grouped-pkey parent and child columns.
+     *
+     * @return std::vector<std::string>
+     */
+    std::vector<std::string> get_dependency_columns() const;
     t_uindex get_num_rpivots() const;
     t_uindex get_num_cpivots() const;
     bool is_column_only() const;
@@ -205,6 +243,16 @@ public:
         return m_grand_agg_str;
     }
 
+    inline const t_stree_options&
+    get_tree_options() const {
+        return m_tree_options;
+    }
+
+    inline void
+    set_tree_options(const t_stree_options& options) {
+        m_tree_options = options;
+    }
+
 protected:
     void populate_sortby(const std::vector<t_pivot>& pivots);
 
@@ -235,6 +283,7 @@ private:
     std::string m_grand_agg_str;
     t_fmode m_fmode;
     bool m_has_pkey_agg;
+    t_stree_options m_tree_options;
 };
 
 } // end namespace perspective
@@ -22,6 +22,7 @@
 #include <perspective/expression_tables.h>
 #include <perspective/expression_vocab.h>
 #include <perspective/regex.h>
+#include <tsl/hopscotch_map.h>
 
 namespace perspective {
 
@@ -64,6 +65,23 @@ public:
 private:
     void rebuild();
 
+    /**
+     * @brief Apply an update batch to the existing tree in place, by writing
+     * the new values of updated rows into their nodes' aggregate rows, and
+     * re-sorting the traversal if a column it is sorted by changed.
+     * Returns `false` without modifying the tree if the batch inserts or
+     * removes rows, changes any row's parent, child, sort or filter status,
+     * or the config has an aggregate other than `AGGTYPE_IDENTITY`, in which
+     * case the caller must `rebuild()`.
+     */
+    bool update_in_place(
+        const t_data_table& flattened,
+        const t_data_table& prev,
+        const t_data_table& current,
+        const t_data_table& transitions,
+        const t_data_table& existed
+    );
+
     t_tscalar get_value_from_gstate(
         const std::string& colname, const t_tscalar& pkey
     ) const;
@@ -76,6 +94,10 @@ private:
     t_depth m_depth;
     bool m_depth_set;
     std::shared_ptr<t_expression_tables> m_expression_tables;
+
+    // Map from interned pkey to the tree node it was inserted as by the
+    // last `rebuild()`.
+    tsl::hopscotch_map<t_tscalar, t_uindex> m_pkey_nidx;
 };
 
 typedef std::shared_ptr<t_ctx_grouped_pkey> t_ctx_grouped_pkey_sptr;
@@ -51,6 +51,26 @@ public:
     std::pair<t_tscalar, t_tscalar> get_min_max(const std::string& colname
     ) const;
 
+    /**
+     * @brief Contexts whose configs have the same `get_tree_key()` build
+     * sparse trees of the same shape, so the `t_gnode` updates one tree per
+     * group, computing every aggregate of the group, and the rest of the
+     * group only update their own traversals from it.
+     */
+    bool shares_trees_with(const t_ctx1& ctx) const;
+    void share_trees(const t_ctx1& ctx);
+    void notify_shared_trees();
+    void set_trees_shared(bool shared);
+    bool get_trees_shared() const;
+
+    /**
+     * @brief The aggregates computed by this context's tree, which are a
+     * superset of its config's when the tree is shared. Set aggregates are
+     * computed from the next `reset()`.
+     */
+    void set_tree_aggregates(const std::vector<t_aggspec>& aggregates);
+    const std::vector<t_aggspec>& get_tree_aggregates() const;
+
     using t_ctxbase<t_ctx1>::get_data;
 
 private:
@@ -60,6 +80,12 @@ private:
     std::shared_ptr<t_expression_tables> m_expression_tables;
     t_depth m_depth;
     bool m_depth_set;
+    bool m_trees_shared;
+
+    std::vector<t_aggspec> m_tree_aggregates;
+
+    // The index into `m_tree_aggregates` of each of the config's aggregates.
+    std::vector<t_index> m_tree_aggidx;
 };
 
 } // end namespace perspective
@@ -59,6 +59,28 @@ public:
     std::pair<t_tscalar, t_tscalar> get_min_max(const std::string& colname
     ) const;
 
+    // As in `t_ctx1`, but every tree in `m_trees` is shared, and each
+    // context keeps its own row and column traversals.
+    bool shares_trees_with(const t_ctx2& ctx) const;
+    void share_trees(const t_ctx2& ctx);
+    void notify_shared_trees();
+    void set_trees_shared(bool shared);
+    bool get_trees_shared() const;
+
+    // As in `t_ctx1`.
+    void set_tree_aggregates(const std::vector<t_aggspec>& aggregates);
+    const std::vector<t_aggspec>& get_tree_aggregates() const;
+
+    /**
+     * @brief The index of the aggregate of this context's trees which
+     * computes the config's aggregate `aggidx`, modulo the number of the
+     * config's aggregates, as in a column index.
+     *
+     * @param aggidx
+     * @return t_index
+     */
+    t_index get_tree_aggidx(t_index aggidx) const;
+
     using t_ctxbase<t_ctx2>::get_data;
 
 protected:
@@ -92,7 +114,12 @@ private:
     bool m_row_depth_set;
     t_depth m_column_depth;
     bool m_column_depth_set;
+    bool m_trees_shared;
     std::shared_ptr<t_expression_tables> m_expression_tables;
+    std::vector<t_aggspec> m_tree_aggregates;
+
+    // The index into `m_tree_aggregates` of each of the config's aggregates.
+    std::vector<t_index> m_tree_aggidx;
 };
 
 } // end namespace perspective
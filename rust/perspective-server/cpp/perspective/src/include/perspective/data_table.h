@@ -21,7 +21,9 @@
 #include <perspective/filter.h>
 #include <perspective/compat.h>
 #include <perspective/parallel_for.h>
+#include <algorithm>
 #include <tuple>
+#include <type_traits>
 
 namespace perspective {
 
@@ -39,6 +41,100 @@ struct t_flatten_record {
     t_uindex m_eidx;
 };
 
+/**
+ * @brief Sort rowpacks with integral pkeys by pkey, using an LSD radix sort
+ * over one byte of the pkey per pass. Every pass is stable, so rowpacks that
+ * share a pkey stay in row order and the last write to a pkey still wins when
+ * flattening. Large inputs are counted and scattered in parallel chunks.
+ *
+ * @tparam PKEY_T
+ * @param rowpacks
+ */
+template <typename PKEY_T>
+void
+radix_sort_rowpacks(std::vector<t_rowpack<PKEY_T>>& rowpacks) {
+    static_assert(std::is_integral_v<PKEY_T>, "Radix sort needs integral keys");
+
+    using t_key = std::make_unsigned_t<PKEY_T>;
+    constexpr t_uindex RADIX = 256;
+    constexpr t_uindex NUM_PASSES = sizeof(PKEY_T);
+    constexpr t_uindex ROWS_PER_CHUNK = 1 << 16;
+
+    // Flipping the sign bit orders signed keys correctly as unsigned.
+    constexpr t_key SIGN_BIT = std::is_signed_v<PKEY_T>
+        ? static_cast<t_key>(t_key(1) << (NUM_PASSES * 8 - 1))
+        : t_key(0);
+
+    t_uindex num_rows = rowpacks.size();
+    t_uindex num_chunks = std::max<t_uindex>(
+        1, std::min<t_uindex>(64, num_rows / ROWS_PER_CHUNK)
+    );
+    t_uindex chunk_size = (num_rows + num_chunks - 1) / num_chunks;
+
+    std::vector<t_rowpack<PKEY_T>> buffer(num_rows);
+    std::vector<t_uindex> offsets(num_chunks * RADIX);
+    std::vector<t_rowpack<PKEY_T>>* src = &rowpacks;
+    std::vector<t_rowpack<PKEY_T>>* dst = &buffer;
+
+    for (t_uindex pass = 0; pass < NUM_PASSES; ++pass) {
+        t_uindex shift = pass * 8;
+        auto digit = [shift](const t_rowpack<PKEY_T>& rowpack) {
+            t_key key = static_cast<t_key>(rowpack.m_pkey) ^ SIGN_BIT;
+            return static_cast<t_uindex>((key >> shift) & 0xFF);
+        };
+
+        std::fill(offsets.begin(), offsets.end(), 0);
+        parallel_for(int(num_chunks), [&](int chunk) {
+            t_uindex* counts = &offsets[chunk * RADIX];
+            t_uindex bidx = chunk * chunk_size;
+            t_uindex eidx = std::min(num_rows, bidx + chunk_size);
+            for (t_uindex idx = bidx; idx < eidx; ++idx) {
+                ++counts[digit((*src)[idx])];
+            }
+        });
+
+        // Turn the counts into write offsets in (digit, chunk) order, so each
+        // chunk writes after the earlier chunks with the same digit. A pass
+        // where every row has the same digit leaves the order unchanged.
+        bool is_noop = false;
+        t_uindex offset = 0;
+        for (t_uindex d = 0; d < RADIX; ++d) {
+            t_uindex digit_count = 0;
+            for (t_uindex chunk = 0; chunk < num_chunks; ++chunk) {
+                t_uindex count = offsets[chunk * RADIX + d];
+                offsets[chunk * RADIX + d] = offset;
+                offset += count;
+                digit_count += count;
+            }
+
+            if (digit_count == num_rows) {
+                is_noop = true;
+                break;
+            }
+        }
+
+        if (is_noop) {
+            continue;
+        }
+
+        parallel_for(int(num_chunks), [&](int chunk) {
+            t_uindex* chunk_offsets = &offsets[chunk * RADIX];
+            t_uindex bidx = chunk * chunk_size;
+            t_uindex eidx = std::min(num_rows, bidx + chunk_size);
+            for (t_uindex idx = bidx; idx < eidx; ++idx) {
+                const t_rowpack<PKEY_T>& rowpack = (*src)[idx];
+                (*dst)[chunk_offsets[digit(rowpack)]++] = rowpack;
+            }
+        });
+
+        std::swap(src, dst);
+    }
+
+    if (src != &rowpacks) {
+        rowpacks.swap(buffer);
+    }
+}
+
 class t_data_table;
 
 class PERSPECTIVE_EXPORT t_tabular {};
@@ -129,6 +225,23 @@ public:
 
     std::shared_ptr<t_data_table> flatten() const;
 
+    /**
+     * @brief Whether every primary key of this pkeyed table is valid and
+     * greater than the last, so that `flatten()` would copy its rows in
+     * their current order, and the table can be processed as-is once
+     * `clear_deleted_rows()` has been called.
+     *
+     * @return true
+     * @return false
+     */
+    bool has_sorted_unique_pkeys() const;
+
+    /**
+     * @brief Clear every column but `psp_pkey` and `psp_op` in the rows
+     * whose op is `OP_DELETE`, as `flatten()` leaves them.
+     */
+    void clear_deleted_rows();
+
     bool is_pkey_table() const;
     bool is_same_shape(t_data_table& tbl) const;
 
@@ -179,6 +292,21 @@ public:
         const std::string& existing_col, const std::string& new_colname
     );
 
+    /**
+     * @brief Add `new_colname` as another name for `existing_col`, sharing
+     * its storage rather than copying it. Writes through either name are
+     * visible through both, so this is only suitable for columns which hold
+     * the same values, e.g. `psp_pkey` and `psp_okey`, in a table which is
+     * not `append`ed to.
+     *
+     * @param existing_col
+     * @param new_colname
+     * @return t_column*
+     */
+    t_column* alias_column(
+        const std::string& existing_col, const std::string& new_colname
+    );
+
     std::vector<const t_column*> get_const_columns() const;
     std::vector<t_column*> get_columns();
 
@@ -236,6 +364,9 @@ protected:
     template <typename FLATTENED_T, typename PKEY_T>
     void flatten_helper_1(FLATTENED_T flattened) const;
 
+    template <typename PKEY_T>
+    bool has_sorted_unique_pkeys_helper() const;
+
     template <typename DATA_T, typename ROWPACK_VEC_T>
     void flatten_helper_2(
         ROWPACK_VEC_T& sorted,
@@ -319,6 +450,22 @@ t_data_table::flatten_body(FLATTENED_T flattened) const {
     return;
 }
 
+template <typename PKEY_T>
+bool
+t_data_table::has_sorted_unique_pkeys_helper() const {
+    const t_column* pkey_col = get_const_column("psp_pkey").get();
+    for (t_uindex idx = 0, loop_end = size(); idx < loop_end; ++idx) {
+        if (!pkey_col->is_valid(idx)
+            || (idx > 0
+                && !(*(pkey_col->get_nth<PKEY_T>(idx - 1))
+                     < *(pkey_col->get_nth<PKEY_T>(idx))))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 template <typename DATA_T, typename ROWPACK_VEC_T>
 void
 t_data_table::flatten_helper_2(
@@ -398,8 +545,14 @@ t_data_table::flatten_helper_1(FLATTENED_T flattened) const {
         }
     };
 
-    t_packcomp cmp;
-    std::sort(sorted.begin(), sorted.end(), cmp);
+    // `sorted` starts in row order, so a stable sort by pkey alone gives the
+    // same order as `t_packcomp`.
+    if constexpr (std::is_integral_v<PKEY_T>) {
+        radix_sort_rowpacks<PKEY_T>(sorted);
+    } else {
+        t_packcomp cmp;
+        std::sort(sorted.begin(), sorted.end(), cmp);
+    }
 
     std::vector<t_index> edges;
     edges.push_back(0);
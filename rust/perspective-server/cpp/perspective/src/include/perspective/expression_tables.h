@@ -16,6 +16,8 @@
 #include <perspective/computed_expression.h>
 #include <perspective/data_table.h>
 #include <perspective/parallel_for.h>
+#include <perspective/gnode_state.h>
+#include <map>
 
 namespace perspective {
 
@@ -51,7 +53,13 @@ struct t_expression_tables {
     // Calculate the `t_transitions` value for each row.
     void calculate_transitions(const std::shared_ptr<t_data_table>& existed);
 
-    void set_flattened(const std::shared_ptr<t_data_table>& flattened) const;
+    /**
+     * @brief Replace `m_pkeyed` with the columns of `pkeyed`, the master
+     * expression columns in `t_gstate::get_pkeyed_table()` row order.
+     *
+     * @param pkeyed
+     */
+    void set_pkeyed(const std::shared_ptr<t_data_table>& pkeyed) const;
 
     void reset() const;
 
@@ -67,6 +75,177 @@ struct t_expression_tables {
     std::shared_ptr<t_data_table> m_current;
     std::shared_ptr<t_data_table> m_delta;
     std::shared_ptr<t_data_table> m_transitions;
+
+    // master rows in the order of `t_gstate::get_pkeyed_table()`, which
+    // contexts are built from. Unlike `m_flattened`, this is not replaced
+    // by each update's rows.
+    std::shared_ptr<t_data_table> m_pkeyed;
+};
+
+/**
+ * @brief The number of rows an expression in `t_expression_cache` has been
+ * evaluated for, over all of its tables, in total and by the last compute.
+ */
+struct t_expression_stats {
+    t_uindex m_rows_evaluated = 0;
+    t_uindex m_last_rows_evaluated = 0;
+};
+
+/**
+ * @brief An expression in `t_expression_cache`, with its computed columns
+ * and the number of context expressions that reference it.
+ */
+struct t_expression_cache_entry {
+    std::shared_ptr<t_computed_expression> m_expression;
+    std::shared_ptr<t_expression_tables> m_tables;
+    t_uindex m_refcount;
+
+    // How many of `m_refcount` are held by contexts which have not been
+    // built yet. An entry only referenced by such contexts is not computed.
+    t_uindex m_pending_refcount;
+
+    // Whether `m_tables` reflect the current state of the gnode.
+    bool m_computed;
+
+    // Whether `m_tables->m_pkeyed` reflects the current master table, which
+    // it stops doing after each update.
+    bool m_pkeyed_computed;
+
+    t_expression_stats m_stats;
+};
+
+/**
+ * @brief Expression columns for every context registered on a gnode, keyed
+ * by the canonicalized expression. An expression used by many contexts is
+ * computed and stored once per update, and each context's
+ * `t_expression_tables` reference the cached columns under that context's
+ * alias for the expression.
+ */
+class t_expression_cache {
+public:
+    PSP_NON_COPYABLE(t_expression_cache);
+
+    t_expression_cache();
+
+    /**
+     * @brief Returns the key for an expression - its parsed expression
+     * string with whitespace collapsed (keeping line breaks, which end
+     * comments), the columns it references and its output dtype - which is
+     * independent of the expression's alias.
+     *
+     * @param expression
+     * @return std::string
+     */
+    static std::string
+    get_expression_key(const t_computed_expression& expression);
+
+    /**
+     * @brief Add a reference to each expression, creating entries for
+     * expressions not already in the cache. New entries are not computed
+     * until the next call to `compute`.
+     *
+     * @param expressions
+     */
+    void acquire(
+        const std::vector<std::shared_ptr<t_computed_expression>>& expressions
+    );
+
+    /**
+     * @brief Remove a reference to each expression, dropping entries that
+     * are no longer referenced by any context.
+     *
+     * @param expressions
+     */
+    void release(
+        const std::vector<std::shared_ptr<t_computed_expression>>& expressions
+    );
+
+    /**
+     * @brief Mark a reference to each expression as held by a context which
+     * has not been built yet, or unmark it once the context is built or
+     * released. Entries whose every reference is pending are skipped by
+     * `compute`, and recomputed in full by the first `compute` after one of
+     * their contexts is built.
+     *
+     * @param expressions
+     * @param pending
+     */
+    void set_pending(
+        const std::vector<std::shared_ptr<t_computed_expression>>& expressions,
+        bool pending
+    );
+
+    /**
+     * @brief Compute the master table of each entry from the gnode state,
+     * and its pkeyed table from the master. If `recompute` is false, only
+     * entries which have not been computed yet are computed, and only the
+     * pkeyed tables of the others which are stale are rebuilt.
+     * `expression_vocab` is cleared after each entry is computed.
+     */
+    void compute(
+        const t_gstate& gstate,
+        t_expression_vocab& expression_vocab,
+        t_regex_mapping& regex_mapping,
+        bool recompute
+    );
+
+    /**
+     * @brief Compute every entry from the gnode's master table and the
+     * tables on its output ports. The master table of a row-local entry is
+     * only recomputed for the rows whose inputs changed in this update.
+     * `expression_vocab` is cleared after each entry is computed.
+     */
+    void compute(
+        const std::shared_ptr<t_data_table>& master,
+        const t_gstate::t_mapping& pkey_map,
+        const std::shared_ptr<t_data_table>& flattened,
+        const std::shared_ptr<t_data_table>& delta,
+        const std::shared_ptr<t_data_table>& prev,
+        const std::shared_ptr<t_data_table>& current,
+        const std::shared_ptr<t_data_table>& transitions,
+        const std::shared_ptr<t_data_table>& existed,
+        t_expression_vocab& expression_vocab,
+        t_regex_mapping& regex_mapping
+    );
+
+    /**
+     * @brief Point the columns of `tables` at the cached columns for each
+     * expression, and resize `tables` to match. The expressions must have
+     * been acquired.
+     *
+     * @param expressions
+     * @param tables
+     */
+    void bind(
+        const std::vector<std::shared_ptr<t_computed_expression>>& expressions,
+        const t_expression_tables& tables
+    ) const;
+
+    void reset();
+
+    t_uindex size() const;
+
+    /**
+     * @brief Returns the rows evaluated for `expression`, which is shared
+     * with every other context using the same expression.
+     */
+    t_expression_stats get_stats(const t_computed_expression& expression
+    ) const;
+
+private:
+    /**
+     * @brief Returns the rows of the gnode state table that were added by
+     * this update, or where any column referenced by `expression` changed.
+     */
+    static std::vector<t_uindex> get_changed_rows(
+        const t_computed_expression& expression,
+        const t_gstate::t_mapping& pkey_map,
+        const std::shared_ptr<t_data_table>& flattened,
+        const std::shared_ptr<t_data_table>& transitions,
+        const std::shared_ptr<t_data_table>& existed
+    );
+
+    std::map<std::string, t_expression_cache_entry> m_entries;
 };
 
 } // end namespace perspective
\ No newline at end of file
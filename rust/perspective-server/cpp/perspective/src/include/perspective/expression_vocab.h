@@ -25,8 +25,8 @@ public:
     /**
      * @brief Given a const char* to a string, intern it into the current
      * vocab page, and return the pointer to the string that has been
-     * interned into the vocab. The returned pointer is guaranteed to be
-     * valid for the lifetime of the `t_expression_vocab` instance.
+     * interned into the vocab. The returned pointer is valid until the next
+     * call to `clear()`.
      *
      * @param str
      * @return const char*
@@ -34,6 +34,12 @@ public:
     const char* intern(const char* str);
     const char* intern(const std::string& str);
 
+    /**
+     * @brief Free every page, invalidating all interned strings. String
+     * columns copy the strings they are set to into their own vocab, so
+     * this is safe once the expressions that produced them have been
+     * computed.
+     */
     void clear();
 
     /**
@@ -47,18 +53,15 @@ public:
     void pprint() const;
 
 private:
-    void allocate_new_vocab();
+    void allocate_new_vocab(std::size_t min_size);
 
     std::vector<t_vocab> m_vocabs;
 
-    // The number of strings to store in each page of the vocab.
-    // t_vocab::reserve(byte_length, num_strings) takes both the bytelength
-    // of all strings to be reserved, as well as the # of strings to reserve.
-    // Assume that strings are up to 64 bytes, and whenever we reach
-    // EXPRESSION_VOCAB_CAPACITY strings OR go over
-    // EXPRESSION_VOCAB_CAPACITY * 64 bytes, allocate a new page.
-    // TODO: this leaves edge cases where we allocate new pages too eagerly,
-    // or we aren't using the allocated space as efficiently as possible.
+    // The number of bytes to reserve in each page of the vocab. Pages are
+    // never grown, so that interned pointers stay valid; a string that does
+    // not fit in the current page starts a new one, sized to fit it if it is
+    // longer than this. Strings already in the current page are not
+    // interned again, so repeated values do not allocate.
     std::size_t m_max_vocab_size;
 
     std::size_t m_current_vocab_size;
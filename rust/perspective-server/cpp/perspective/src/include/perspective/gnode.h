@@ -27,9 +27,14 @@
 #include <perspective/computed_function.h>
 #include <perspective/expression_tables.h>
 #include <perspective/regex.h>
+#include <perspective/tree_context_common.h>
 #include <tsl/ordered_map.h>
 #include <perspective/parallel_for.h>
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <optional>
+#include <set>
 
 #ifdef PSP_PARALLEL_FOR
 #include <thread>
@@ -73,6 +78,35 @@ struct PERSPECTIVE_EXPORT t_process_table_result {
     std::shared_ptr<t_data_table> m_flattened_data_table;
     bool m_should_notify_userspace;
 };
+
+/**
+ * @brief The number of rows at each stage of an update processed by a
+ * `t_gnode`.
+ */
+struct PERSPECTIVE_EXPORT t_gnode_update_stats {
+    // Rows queued on the input port, including repeated primary keys.
+    t_uindex m_input_rows = 0;
+
+    // Rows left once repeated primary keys were merged by `flatten()`.
+    t_uindex m_flattened_rows = 0;
+
+    // Rows left once removed rows were masked out.
+    t_uindex m_applied_rows = 0;
+};
+
+/**
+ * @brief The struct returned from `_prepare_table`, the first half of
+ * `_process_table`. It contains the flattened, masked update diffed against
+ * the master table, which has not yet been applied to the master table or any
+ * context. `m_flattened_data_table` is `nullptr` if there was nothing to
+ * process.
+ */
+struct PERSPECTIVE_EXPORT t_process_table_prepared {
+    std::shared_ptr<t_data_table> m_flattened_data_table;
+    bool m_is_first_update;
+    t_gnode_update_stats m_stats;
+};
+
 class PERSPECTIVE_EXPORT t_gnode {
 public:
     /**
@@ -90,10 +124,14 @@ public:
      * `output_schema`: the `t_schema` that contains all columns provided
      * by the dataset, excluding `psp_pkey` and `psp_op`.
      *
+     * `index`: the column the `Table` is indexed by, or empty if the `Table`
+     * has an implicit index.
+     *
      * @param input_schema
      * @param output_schema
+     * @param index
      */
-    t_gnode(t_schema input_schema, t_schema output_schema);
+    t_gnode(t_schema input_schema, t_schema output_schema, std::string index);
     ~t_gnode();
 
     void init();
@@ -154,6 +192,35 @@ public:
      */
     void _unregister_context(const std::string& name);
 
+    /**
+     * @brief Build a context whose construction was deferred by
+     * `set_lazy_contexts`, from the current state of the master table. Does
+     * nothing if the context is already built.
+     *
+     * @param name
+     */
+    void _build_context(const std::string& name);
+
+    /**
+     * @brief Whether the context `name` was registered lazily and has not
+     * been built yet.
+     *
+     * @param name
+     */
+    bool is_context_pending(const std::string& name) const;
+
+    /**
+     * @brief When enabled, contexts registered on a gnode which already has
+     * data record their config and return immediately, and are built by
+     * `_build_context` when they are first read. Contexts which are replaced
+     * before they are read never pay for their pivots. Pending contexts are
+     * skipped by `notify_contexts`, as their first build reads the updated
+     * master table anyway.
+     *
+     * @param lazy
+     */
+    void set_lazy_contexts(bool lazy);
+
     const t_data_table* get_table() const;
     t_data_table* get_table();
 
@@ -168,6 +235,30 @@ public:
     t_uindex num_input_ports() const;
     t_uindex num_output_ports() const;
 
+    /**
+     * @brief The number of unprocessed rows queued on all input ports, i.e.
+     * the size of the next `process()` before `flatten()`.
+     *
+     * @return t_uindex
+     */
+    t_uindex get_num_pending_rows() const;
+
+    /**
+     * @brief The row counts of the last `process()` which applied an update.
+     *
+     * @return const t_gnode_update_stats&
+     */
+    const t_gnode_update_stats& get_last_update_stats() const;
+
+    /**
+     * @brief The rows evaluated for `expression`, which must belong to a
+     * context registered on this gnode.
+     *
+     * @return t_expression_stats
+     */
+    t_expression_stats
+    get_expression_stats(const t_computed_expression& expression) const;
+
     std::vector<t_pivot> get_pivots() const;
     std::vector<t_stree*> get_trees();
 
@@ -277,6 +368,69 @@ protected:
         const std::string& name
     );
 
+    /**
+     * @brief Group contexts whose configs build identical sparse trees, in
+     * registration order. The first context of each group updates the
+     * group's shared trees, and the rest only update their traversals.
+     * Contexts which cannot share trees are alone in their group.
+     *
+     * @param ctxhvec
+     * @return std::vector<std::vector<t_index>> indices into `ctxhvec`.
+     */
+    std::vector<std::vector<t_index>>
+    get_context_groups(const std::vector<t_ctx_handle>& ctxhvec) const;
+
+    std::string get_tree_key(const t_ctx_handle& ctxh) const;
+
+    /**
+     * @brief Find a built context, other than `name`, whose trees `ch` can
+     * share.
+     */
+    std::optional<t_ctx_handle>
+    find_tree_peer(const std::string& name, const t_ctx_handle& ch) const;
+
+    void _build_context(const std::string& name, const t_ctx_handle& ch);
+
+    /**
+     * @brief Stop treating the context `name` as pending, and count its
+     * expressions as read by a built context again.
+     */
+    void _clear_pending_context(const std::string& name);
+
+    /**
+     * @brief `_clear_pending_context` for every pending context.
+     */
+    void _clear_pending_contexts();
+
+    template <typename CTX_T>
+    void notify_context_group(
+        std::shared_ptr<t_data_table> flattened,
+        const std::vector<t_ctx_handle>& ctxhvec,
+        const std::vector<std::string>& context_names,
+        const std::vector<t_index>& group
+    );
+
+    template <typename CTX_T>
+    void
+    share_context_trees(const t_ctx_handle& leader, const t_ctx_handle& ctxh);
+
+    template <typename CTX_T>
+    void join_context_trees(
+        const t_ctx_handle& peer,
+        const std::string& name,
+        const t_ctx_handle& ctxh
+    );
+
+    /**
+     * @brief The aggregates of every context of `group`, which the trees
+     * they share compute.
+     */
+    template <typename CTX_T>
+    std::vector<t_aggspec> get_group_aggregates(
+        const std::vector<t_ctx_handle>& ctxhvec,
+        const std::vector<t_index>& group
+    ) const;
+
     /**
      * @brief Given the process state, create a `t_mask` bitset set to true for
      * all rows in `flattened`, UNLESS the row is an `OP_DELETE`.
@@ -312,6 +466,24 @@ protected:
         const t_process_state& process_state
     );
 
+    /**
+     * @brief `_process_column` for a batch where
+     * `process_state.m_inserts_only` is set. Previous values are gathered
+     * from the state column a block at a time, and each block of the
+     * transitional columns is then written with a branch-free loop over raw
+     * value and status buffers.
+     */
+    template <typename DATA_T>
+    void _process_column_inserts(
+        const t_column* fcolumn,
+        const t_column* scolumn,
+        t_column* dcolumn,
+        t_column* pcolumn,
+        t_column* ccolumn,
+        t_column* tcolumn,
+        const t_process_state& process_state
+    );
+
     /**
      * @brief Calculate the transition state for a single cell, which depends
      * on whether the cell is/was valid, existed, or is new.
@@ -341,23 +513,34 @@ protected:
      */
 
     /**
-     * @brief Compute all expressions on each registered context using the
-     * flattened table. This method is called on the first update applied
-     * on an empty gstate master table.
+     * @brief Compute all expressions registered on the gnode using the
+     * flattened table, and bind them to each context. This method is called
+     * on the first update applied on an empty gstate master table.
      */
     void
     _compute_expressions(const std::shared_ptr<t_data_table>& flattened_masked);
 
     /**
-     * @brief Compute all expressions on each registered context using all
-     * data and transition tables. This method is called on all subsequent
-     * updates applied after the first update.
+     * @brief Compute all expressions registered on the gnode using all
+     * data and transition tables, and bind them to each context. This method
+     * is called on all subsequent updates applied after the first update.
      */
     void _compute_expressions(
         const std::shared_ptr<t_data_table>& master,
         const std::shared_ptr<t_data_table>& flattened
     );
 
+    std::vector<std::shared_ptr<t_computed_expression>>
+    get_context_expressions(const t_ctx_handle& ctxh) const;
+
+    /**
+     * @brief Point the expression tables of a context at the columns held in
+     * `m_expression_cache`.
+     *
+     * @param ctxh
+     */
+    void bind_context_expressions(const t_ctx_handle& ctxh) const;
+
 private:
     /**
      * @brief Process the input data table by flattening it, calculating
@@ -367,6 +550,26 @@ private:
      */
     t_process_table_result _process_table(t_uindex port_id);
 
+    /**
+     * @brief Flatten the input port and calculate transitional values against
+     * the master table. Only the input and output ports are written, but the
+     * ports are shared with `send()`, so this requires exclusive access.
+     *
+     * @param port_id
+     * @return t_process_table_prepared
+     */
+    t_process_table_prepared _prepare_table(t_uindex port_id);
+
+    /**
+     * @brief Apply a prepared update to the master table and expression
+     * tables, making it visible to readers. Requires exclusive access.
+     *
+     * @param prepared
+     * @return t_process_table_result
+     */
+    t_process_table_result
+    _commit_table(const t_process_table_prepared& prepared);
+
     t_gnode_processing_mode m_mode;
     t_gnode_type m_gnode_type;
 
@@ -376,6 +579,9 @@ private:
     // A `t_schema` containing all columns (excluding internal columns).
     t_schema m_output_schema;
 
+    // The column the `Table` is indexed by, or empty for an implicit index.
+    std::string m_index;
+
     // A vector of `t_schema`s for each transitional `t_data_table`.
     std::vector<t_schema> m_transitional_schemas;
 
@@ -397,10 +603,19 @@ private:
     std::chrono::high_resolution_clock::time_point m_epoch;
     std::function<void()> m_pool_cleanup;
     bool m_was_updated;
+    t_gnode_update_stats m_last_update_stats;
 
     std::shared_ptr<t_expression_vocab> m_expression_vocab;
     std::shared_ptr<t_regex_mapping> m_expression_regex_mapping;
 
+    // Expression columns shared by all contexts on this gnode.
+    std::shared_ptr<t_expression_cache> m_expression_cache;
+
+    // Contexts registered while `m_lazy_contexts` was set which have not
+    // been read yet.
+    bool m_lazy_contexts;
+    std::set<std::string> m_pending_contexts;
+
 #ifdef PSP_PARALLEL_FOR
     std::shared_mutex* m_lock;
 #endif
@@ -471,6 +686,153 @@ t_gnode::notify_context(
     ctx->step_end();
 }
 
+/**
+ * @brief Notify a group of contexts sharing sparse trees, updating the trees
+ * once through the group's first context. Deltas on shared trees are
+ * cleared here before each update, rather than when a context reads them.
+ *
+ * @tparam CTX_T
+ * @param flattened
+ * @param ctxhvec
+ * @param context_names
+ * @param group
+ */
+template <typename CTX_T>
+void
+t_gnode::notify_context_group(
+    std::shared_ptr<t_data_table> flattened,
+    const std::vector<t_ctx_handle>& ctxhvec,
+    const std::vector<std::string>& context_names,
+    const std::vector<t_index>& group
+) {
+    CTX_T* leader = ctxhvec[group[0]].get<CTX_T>();
+    bool shared = group.size() > 1;
+    leader->set_trees_shared(shared);
+
+    // Contexts which were reset since the last update have their own trees,
+    // and share the leader's again from its state before this update.
+    for (t_uindex idx = 1, loop_end = group.size(); idx < loop_end; ++idx) {
+        CTX_T* ctx = ctxhvec[group[idx]].get<CTX_T>();
+        ctx->set_trees_shared(true);
+        if (!ctx->shares_trees_with(*leader)) {
+            ctx->share_trees(*leader);
+        }
+    }
+
+    if (shared) {
+        leader->clear_deltas();
+    }
+
+    notify_context<CTX_T>(
+        flattened, ctxhvec[group[0]], context_names[group[0]]
+    );
+
+    for (t_uindex idx = 1, loop_end = group.size(); idx < loop_end; ++idx) {
+        CTX_T* ctx = ctxhvec[group[idx]].get<CTX_T>();
+        ctx->step_begin();
+        ctx->notify_shared_trees();
+        ctx->step_end();
+    }
+}
+
+/**
+ * @brief Initialize `ctxh` from the current trees of `leader`, which have
+ * the same config, instead of building its own trees from `m_gstate`.
+ *
+ * @tparam CTX_T
+ * @param leader
+ * @param ctxh
+ */
+template <typename CTX_T>
+void
+t_gnode::share_context_trees(
+    const t_ctx_handle& leader, const t_ctx_handle& ctxh
+) {
+    CTX_T* leader_ctx = leader.get<CTX_T>();
+    CTX_T* ctx = ctxh.get<CTX_T>();
+    leader_ctx->set_trees_shared(true);
+    ctx->set_trees_shared(true);
+    ctx->step_begin();
+    ctx->share_trees(*leader_ctx);
+    ctx->step_end();
+}
+
+/**
+ * @brief Share the trees of `peer` with the context `name`. If they do not
+ * compute all of its aggregates, the context builds its own trees from
+ * `m_gstate` computing those of every context sharing `peer`'s trees as
+ * well, which then share its trees instead.
+ *
+ * @tparam CTX_T
+ * @param peer
+ * @param name
+ * @param ctxh
+ */
+template <typename CTX_T>
+void
+t_gnode::join_context_trees(
+    const t_ctx_handle& peer, const std::string& name, const t_ctx_handle& ctxh
+) {
+    CTX_T* peer_ctx = peer.get<CTX_T>();
+    CTX_T* ctx = ctxh.get<CTX_T>();
+    const auto& config = ctx->get_config();
+    auto aggregates = union_tree_aggregates(
+        peer_ctx->get_tree_aggregates(), config.get_aggregates()
+    );
+
+    if (aggregates.size() == peer_ctx->get_tree_aggregates().size()) {
+        share_context_trees<CTX_T>(peer, ctxh);
+        return;
+    }
+
+    std::vector<t_ctx_handle> group;
+    for (const auto& iter : m_contexts) {
+        if (iter.first != name && iter.second.get_type() == ctxh.get_type()
+            && !is_context_pending(iter.first)
+            && iter.second.get<CTX_T>()->shares_trees_with(*peer_ctx)) {
+            group.push_back(iter.second);
+        }
+    }
+
+    // The peer's pivots and filters are this context's, so only the columns
+    // of aggregates this context does not compute are added.
+    auto columns = config.get_dependency_columns();
+    for (const auto& spec : aggregates) {
+        for (const auto& dep : spec.get_dependencies()) {
+            if (dep.type() == DEPTYPE_COLUMN
+                && std::find(columns.begin(), columns.end(), dep.name())
+                    == columns.end()) {
+                columns.push_back(dep.name());
+            }
+        }
+    }
+
+    ctx->set_tree_aggregates(aggregates);
+    ctx->reset(false);
+    update_context_from_state<CTX_T>(
+        ctx, name, m_gstate->get_pkeyed_table(columns)
+    );
+
+    for (const auto& member : group) {
+        share_context_trees<CTX_T>(ctxh, member);
+    }
+}
+
+template <typename CTX_T>
+std::vector<t_aggspec>
+t_gnode::get_group_aggregates(
+    const std::vector<t_ctx_handle>& ctxhvec, const std::vector<t_index>& group
+) const {
+    std::vector<t_aggspec> rval;
+    for (auto idx : group) {
+        rval = union_tree_aggregates(
+            rval, ctxhvec[idx].get<CTX_T>()->get_config().get_aggregates()
+        );
+    }
+
+    return rval;
+}
+
 /**
  * @brief Given a flattened `t_data_table`, update the context with the table.
  *
@@ -506,13 +868,15 @@ t_gnode::update_context_from_state(
     // 2. when a table created from schema (0 rows) gets data and now needs
     //  to update its registered contexts with the new data.
     if (ctx->num_expressions() > 0) {
-        // If the context has expression columns, it has already been computed
-        // in `process_table` and we can join the "real" and expression columns
-        // together and pass it to the context.
+        // If the context has expression columns, they have already been
+        // computed and bound to its expression tables, and we can join the
+        // "real" and expression columns together and pass it to the context.
+        // `m_pkeyed` has the same rows as `flattened`, whereas `m_flattened`
+        // only has the rows of the last update.
         std::shared_ptr<t_expression_tables> ctx_expression_tables =
             ctx->get_expression_tables();
         std::shared_ptr<t_data_table> joined_flattened =
-            flattened->join(ctx_expression_tables->m_flattened);
+            flattened->join(ctx_expression_tables->m_pkeyed);
         ctx->notify(*joined_flattened);
     } else {
         // Just use the table from the gnode
@@ -544,6 +908,15 @@ t_gnode::_process_column(
     t_column* tcolumn,
     const t_process_state& process_state
 ) {
+    if (process_state.m_inserts_only && fcolumn->is_status_enabled()
+        && scolumn->is_status_enabled() && dcolumn->is_status_enabled()
+        && pcolumn->is_status_enabled() && ccolumn->is_status_enabled()) {
+        _process_column_inserts<DATA_T>(
+            fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, process_state
+        );
+        return;
+    }
+
     for (t_uindex idx = 0, loop_end = fcolumn->size(); idx < loop_end; ++idx) {
         std::uint8_t op_ = process_state.m_op_base[idx];
         t_op op = static_cast<t_op>(op_);
@@ -629,4 +1002,97 @@ t_gnode::_process_column(
     }
 }
 
+template <typename DATA_T>
+void
+t_gnode::_process_column_inserts(
+    const t_column* fcolumn,
+    const t_column* scolumn,
+    t_column* dcolumn,
+    t_column* pcolumn,
+    t_column* ccolumn,
+    t_column* tcolumn,
+    const t_process_state& process_state
+) {
+    constexpr t_uindex BLOCK_SIZE = 256;
+
+    t_uindex num_rows = fcolumn->size();
+    if (num_rows == 0) {
+        return;
+    }
+
+    const std::vector<t_rlookup>& lookup = process_state.m_lookup;
+    const std::array<std::uint8_t, 16>& transitions =
+        process_state.m_insert_transitions;
+
+    const DATA_T* fdata = fcolumn->get_nth<DATA_T>(0);
+    const t_status* fstatus = fcolumn->get_nth_status(0);
+
+    // The state table is empty before the first update.
+    bool has_state = scolumn->size() > 0;
+    const DATA_T* sdata = has_state ? scolumn->get_nth<DATA_T>(0) : nullptr;
+    const t_status* sstatus =
+        has_state ? scolumn->get_nth_status(0) : nullptr;
+
+    DATA_T* ddata = dcolumn->get_nth<DATA_T>(0);
+    DATA_T* pdata = pcolumn->get_nth<DATA_T>(0);
+    DATA_T* cdata = ccolumn->get_nth<DATA_T>(0);
+    t_status* dstatus = dcolumn->get_nth_status(0);
+    t_status* pstatus = pcolumn->get_nth_status(0);
+    t_status* cstatus = ccolumn->get_nth_status(0);
+    std::uint8_t* tdata = tcolumn->get_nth<std::uint8_t>(0);
+    t_status* tstatus =
+        tcolumn->is_status_enabled() ? tcolumn->get_nth_status(0) : nullptr;
+
+    std::array<DATA_T, BLOCK_SIZE> prev_values;
+    std::array<std::uint8_t, BLOCK_SIZE> prev_flags;
+
+    for (t_uindex bidx = 0; bidx < num_rows; bidx += BLOCK_SIZE) {
+        t_uindex block_size = std::min(BLOCK_SIZE, num_rows - bidx);
+
+        // Gather the previous values by state table row, with the
+        // `row_pre_existed` and `prev_valid` bits of the transitions key.
+        for (t_uindex i = 0; i < block_size; ++i) {
+            const t_rlookup& rlookup = lookup[bidx + i];
+            if (rlookup.m_exists) {
+                prev_values[i] = sdata[rlookup.m_idx];
+                prev_flags[i] =
+                    sstatus[rlookup.m_idx] == STATUS_VALID ? 0xC : 0x8;
+            } else {
+                prev_values[i] = DATA_T(0);
+                prev_flags[i] = 0;
+            }
+        }
+
+        const DATA_T* cur_values = fdata + bidx;
+        const t_status* cur_status = fstatus + bidx;
+
+        for (t_uindex i = 0; i < block_size; ++i) {
+            t_uindex idx = bidx + i;
+            DATA_T prev_value = prev_values[i];
+            DATA_T cur_value = cur_values[i];
+            bool prev_valid = (prev_flags[i] & 0x4) != 0;
+            bool cur_valid = cur_status[i] == STATUS_VALID;
+            bool prev_cur_eq = prev_value == cur_value;
+
+            ddata[idx] = cur_valid ? static_cast<DATA_T>(cur_value - prev_value)
+                                   : DATA_T(0);
+            pdata[idx] = prev_value;
+            cdata[idx] = cur_valid ? cur_value : prev_value;
+
+            dstatus[idx] = STATUS_VALID;
+            pstatus[idx] = prev_valid ? STATUS_VALID : STATUS_INVALID;
+            cstatus[idx] =
+                cur_valid || prev_valid ? STATUS_VALID : STATUS_INVALID;
+
+            tdata[idx] = transitions
+                [prev_flags[i] | (std::uint8_t(cur_valid) << 1)
+                 | std::uint8_t(prev_cur_eq)];
+        }
+    }
+
+    if (tstatus != nullptr) {
+        std::fill(tstatus, tstatus + num_rows, STATUS_VALID);
+    }
+}
+
 } // end namespace perspective
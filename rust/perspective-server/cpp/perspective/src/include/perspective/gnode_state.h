@@ -44,10 +44,14 @@ public:
      * contain the *latest* state of the dataset managed by Perspective,
      * after updates/removes/etc. are applied.
      *
+     * `index` is the name of the column `psp_pkey` was made from, or empty
+     * if the `Table` has an implicit index.
+     *
      * @param input_schema
      * @param output_schema
+     * @param index
      */
-    t_gstate(t_schema input_schema, t_schema output_schema);
+    t_gstate(t_schema input_schema, t_schema output_schema, std::string index);
 
     ~t_gstate();
 
@@ -240,6 +244,20 @@ public:
         const t_schema& schema, const std::shared_ptr<t_data_table>& table
     ) const;
 
+    /**
+     * @brief Returns the rows of the master table which have not been
+     * removed, like `get_pkeyed_table()`, but only with `columns`. Columns
+     * are borrowed from the master table when nothing has been removed, and
+     * otherwise only `columns` are copied, so consumers which read a few
+     * columns of a wide table do not pay for a copy of all of it. Names
+     * which are not master table columns (e.g. expressions) are ignored.
+     *
+     * @param columns
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table>
+    get_pkeyed_table(const std::vector<std::string>& columns) const;
+
     const t_schema& get_input_schema() const;
     const t_schema& get_output_schema() const;
     const t_mapping& get_pkey_map() const;
@@ -285,8 +303,22 @@ private:
     std::vector<t_tscalar> has_pkeys(const std::vector<t_tscalar>& pkeys) const;
     std::vector<t_tscalar> get_pkeys() const;
 
+    /**
+     * @brief Point `psp_okey` and the index column in `m_table` at the
+     * `psp_pkey` column, which always holds the same values, rather than
+     * storing them three times.
+     */
+    void alias_okey_column();
+
+    /**
+     * @brief Whether `column_name` shares the storage of `psp_pkey`, and so
+     * is written through `psp_pkey` rather than separately.
+     */
+    bool is_key_alias(const std::string& column_name) const;
+
     t_schema m_input_schema;  // pkeyed
     t_schema m_output_schema; // tblschema
+    std::string m_index;
 
     bool m_init;
     std::shared_ptr<t_data_table> m_table;
@@ -295,6 +327,10 @@ private:
     t_symtable m_symtable;
     std::shared_ptr<t_column> m_pkcol;
     std::shared_ptr<t_column> m_opcol;
+
+    // The columns which share the storage of `psp_pkey`, and so are not
+    // written separately.
+    std::vector<std::string> m_key_aliases;
 };
 
 template <typename FN_T>
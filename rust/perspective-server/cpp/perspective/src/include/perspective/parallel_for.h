@@ -14,8 +14,12 @@
 
 #ifdef PSP_PARALLEL_FOR
 #include "base.h"
-#include <arrow/util/parallel.h>
-#include <arrow/status.h>
+#include <arrow/util/thread_pool.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #else
 #include "raw_types.h"
@@ -23,26 +27,98 @@
 
 namespace perspective {
 
+#ifdef PSP_PARALLEL_FOR
+namespace detail {
+    /**
+     * @brief The state shared by the threads running one `parallel_for`.
+     * Helpers queued on the pool may only start once the loop has returned,
+     * so this is reference counted, but a helper only calls `m_func` for a
+     * task it claimed, and the loop does not return until every claimed task
+     * has finished.
+     */
+    struct t_parallel_for_state {
+        int m_num_tasks = 0;
+        std::function<void(int)> m_func;
+        std::atomic<int> m_next_task{0};
+        int m_num_done = 0;
+        std::exception_ptr m_error;
+        std::mutex m_mtx;
+        std::condition_variable m_done;
+
+        // Claim and run tasks until none are left unclaimed.
+        void
+        run() {
+            for (int task = m_next_task.fetch_add(1); task < m_num_tasks;
+                 task = m_next_task.fetch_add(1)) {
+                std::exception_ptr error;
+                try {
+                    m_func(task);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (error && !m_error) {
+                    m_error = error;
+                }
+
+                if (++m_num_done == m_num_tasks) {
+                    m_done.notify_all();
+                }
+            }
+        }
+    };
+} // namespace detail
+#endif
+
+/**
+ * @brief Call `func(task)` for each task in `[0, num_tasks)`, on Arrow's CPU
+ * thread pool with `PSP_PARALLEL_FOR`, on at most `max_threads` threads (or
+ * the pool's capacity if `0`).
+ *
+ * The calling thread claims tasks alongside the pool's helpers, and then
+ * waits only for tasks which other threads have claimed and are running. A
+ * `parallel_for` nested in the task of another (e.g. a tree's chunked strand
+ * build within `t_gnode::notify_contexts`) therefore runs in parallel too:
+ * it never waits on helpers queued behind blocked workers, which would
+ * deadlock, as its caller runs any task no helper has started.
+ */
 template <class FUNCTION>
 void
-parallel_for(int num_tasks, FUNCTION&& func) {
+parallel_for(int num_tasks, FUNCTION&& func, int max_threads = 0) {
 #ifdef PSP_PARALLEL_FOR
-    std::exception_ptr e;
-    std::mutex e_mtx;
-    const auto rethrow_wrapper = [&](int64_t task) {
-        try {
-            return func(task);
-        } catch (...) {
-            std::lock_guard<std::mutex> lg(e_mtx);
-            e = std::current_exception();
+    auto* pool = arrow::internal::GetCpuThreadPool();
+    int num_threads = std::min(num_tasks, pool->GetCapacity() + 1);
+    if (max_threads > 0) {
+        num_threads = std::min(num_threads, max_threads);
+    }
+
+    if (num_threads <= 1) {
+        for (int task = 0; task < num_tasks; ++task) {
+            func(task);
+        }
+
+        return;
+    }
+
+    auto state = std::make_shared<detail::t_parallel_for_state>();
+    state->m_num_tasks = num_tasks;
+    state->m_func = [&func](int task) { func(task); };
+    for (int helper = 1; helper < num_threads; ++helper) {
+        // A helper which cannot be queued is covered by the calling thread.
+        if (!pool->Spawn([state]() { state->run(); }).ok()) {
+            break;
         }
-    };
-    auto status = arrow::internal::ParallelFor(num_tasks, rethrow_wrapper);
-    if (!status.ok()) {
-        PSP_COMPLAIN_AND_ABORT("ParallelFor failed");
     }
-    if (e) {
-        std::rethrow_exception(e);
+
+    state->run();
+    std::unique_lock<std::mutex> lock(state->m_mtx);
+    state->m_done.wait(lock, [&state]() {
+        return state->m_num_done == state->m_num_tasks;
+    });
+
+    if (state->m_error) {
+        std::rethrow_exception(state->m_error);
     }
 #else
     for (t_uindex aggnum = 0; aggnum < num_tasks; ++aggnum) {
@@ -73,6 +73,16 @@ public:
 
     void unregister_context(t_uindex gnode_id, const std::string& name);
 
+    /**
+     * @brief Build a context registered on a gnode with lazy contexts
+     * enabled, if it has not been built yet. See
+     * `t_gnode::set_lazy_contexts`.
+     *
+     * @param gnode_id
+     * @param name
+     */
+    void build_context(t_uindex gnode_id, const std::string& name);
+
     void send(t_uindex gnode_id, t_uindex port_id, const t_data_table& table);
 
     void _process(
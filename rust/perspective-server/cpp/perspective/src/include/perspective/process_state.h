@@ -16,6 +16,7 @@
 #include <perspective/port.h>
 #include <perspective/schema.h>
 #include <perspective/rlookup.h>
+#include <array>
 
 namespace perspective {
 
@@ -60,6 +61,15 @@ struct t_process_state {
     std::vector<bool> m_prev_pkey_eq_vec;
 
     std::uint8_t* m_op_base;
+
+    // True when every row is an `OP_INSERT` whose pkey differs from the
+    // previous row's, so each row's offset in the transitional tables is its
+    // own index and the typed insert kernels can be used.
+    bool m_inserts_only;
+
+    // The transition for an inserted cell, indexed by `row_pre_existed << 3 |
+    // prev_valid << 2 | cur_valid << 1 | prev_cur_eq`.
+    std::array<std::uint8_t, 16> m_insert_transitions;
 };
 
 } // end namespace perspective
\ No newline at end of file
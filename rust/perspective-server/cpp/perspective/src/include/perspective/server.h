@@ -18,8 +18,10 @@
 #include "perspective/schema.h"
 #include "perspective/view.h"
 #include "perspective/view_config.h"
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <tsl/hopscotch_set.h>
 #include <utility>
 #include <perspective/table.h>
@@ -220,7 +222,8 @@ namespace server {
             t_uindex start_row,
             t_uindex end_row,
             t_uindex start_col,
-            t_uindex end_col
+            t_uindex end_col,
+            bool include_header = true
         ) const = 0;
 
         [[nodiscard]]
@@ -244,6 +247,28 @@ namespace server {
         [[nodiscard]]
         virtual std::shared_ptr<std::string> get_row_delta_as_arrow() const = 0;
 
+        virtual void update_viewport_keys(
+            std::int32_t start_row,
+            std::int32_t end_row,
+            std::int32_t start_col,
+            std::int32_t end_col,
+            t_viewport_keys& keys
+        ) const = 0;
+
+        [[nodiscard]]
+        virtual std::shared_ptr<std::string> get_viewport_delta_as_arrow(
+            std::int32_t start_row,
+            std::int32_t end_row,
+            std::int32_t start_col,
+            std::int32_t end_col,
+            t_viewport_keys& keys
+        ) const = 0;
+
+        virtual void clear_deltas() = 0;
+
+        [[nodiscard]]
+        virtual t_view_profile get_profile() const = 0;
+
         virtual void set_deltas_enabled(bool enabled_state) = 0;
         [[nodiscard]]
         virtual bool get_deltas_enabled() const = 0;
@@ -253,6 +278,11 @@ namespace server {
         virtual t_index expand(std::int32_t row_idx) = 0;
 
         virtual void set_depth(std::int32_t depth) = 0;
+
+        virtual bool set_sort(
+            const std::vector<std::vector<std::string>>& sort,
+            const std::shared_ptr<t_schema>& schema
+        ) = 0;
     };
 
     template <typename CTX_T>
@@ -414,9 +444,12 @@ namespace server {
             t_uindex start_row,
             t_uindex end_row,
             t_uindex start_col,
-            t_uindex end_col
+            t_uindex end_col,
+            bool include_header
         ) const override {
-            return m_view->to_csv(start_row, end_row, start_col, end_col);
+            return m_view->to_csv(
+                start_row, end_row, start_col, end_col, include_header
+            );
         }
 
         [[nodiscard]]
@@ -483,6 +516,44 @@ namespace server {
             return m_view->data_slice_to_arrow(delta, false, false);
         }
 
+        void
+        update_viewport_keys(
+            std::int32_t start_row,
+            std::int32_t end_row,
+            std::int32_t start_col,
+            std::int32_t end_col,
+            t_viewport_keys& keys
+        ) const override {
+            m_view->update_viewport_keys(
+                start_row, end_row, start_col, end_col, keys
+            );
+        }
+
+        [[nodiscard]]
+        std::shared_ptr<std::string>
+        get_viewport_delta_as_arrow(
+            std::int32_t start_row,
+            std::int32_t end_row,
+            std::int32_t start_col,
+            std::int32_t end_col,
+            t_viewport_keys& keys
+        ) const override {
+            return m_view->get_viewport_delta_as_arrow(
+                start_row, end_row, start_col, end_col, keys
+            );
+        }
+
+        void
+        clear_deltas() override {
+            m_view->clear_deltas();
+        }
+
+        [[nodiscard]]
+        t_view_profile
+        get_profile() const override {
+            return m_view->get_profile();
+        }
+
         void
         set_deltas_enabled(bool enabled_state) override {
             m_view->get_context()->set_deltas_enabled(enabled_state);
@@ -513,6 +584,14 @@ namespace server {
             m_view->set_depth(depth, num_pivots);
         }
 
+        bool
+        set_sort(
+            const std::vector<std::vector<std::string>>& sort,
+            const std::shared_ptr<t_schema>& schema
+        ) override {
+            return m_view->set_sort(sort, schema);
+        }
+
     private:
         std::shared_ptr<View<CTX_T>> m_view;
     };
@@ -534,9 +613,77 @@ namespace server {
         using CtxViewBase<t_ctx2>::CtxViewBase;
     };
 
+    /**
+     * @brief The conflation state of a `View::on_update()` subscription
+     * with `ack` or `min_interval_ms` set, shared by the copies of its
+     * `Subscription`. An update is held back while the last one sent is
+     * unacknowledged (with `ack`) or was sent less than `min_interval_ms`
+     * ago, and updates held back are merged into `pending`, which is sent
+     * once neither holds.
+     */
+    struct Conflation {
+        bool ack;
+        std::uint32_t min_interval_ms;
+        bool awaiting_ack = false;
+        std::chrono::steady_clock::time_point last_sent;
+        std::optional<proto::Response> pending;
+#ifdef PSP_PARALLEL_FOR
+        std::shared_mutex lock;
+#endif
+    };
+
     struct Subscription {
         uint32_t id;
         uint32_t client_id;
+
+        // `View::on_update()` only. A subscription with a `viewport` is sent
+        // only the rows of it which changed, compared against
+        // `viewport_keys`, which is shared by copies of the subscription.
+        bool row_delta = false;
+        std::optional<proto::ViewPort> viewport;
+        std::shared_ptr<t_viewport_keys> viewport_keys;
+        std::shared_ptr<Conflation> conflation;
+    };
+
+    /**
+     * @brief The cursor of a chunked `View::to_arrow_stream()` or
+     * `View::to_csv_stream()` export, from which the rows of `req`'s
+     * viewport are read `req.chunk_rows()` at a time, starting at
+     * `next_row`.
+     */
+    struct ViewStream {
+        std::uint32_t id;
+        std::uint32_t client_id;
+        proto::ViewStreamReq req;
+        std::uint32_t next_row = 0;
+        bool started = false;
+    };
+
+    /**
+     * @brief A per-table update coalescing window. While a table's window is
+     * open, its updates accumulate in its input ports (where `flatten()`
+     * merges repeated updates to the same primary key) and `poll()` leaves
+     * the table dirty rather than processing it. The window closes once
+     * `max_latency_ms` has elapsed since the first pending update, or once
+     * `max_rows` rows are pending, whichever comes first. A limit of `0` is
+     * not checked, but a window without a latency limit also closes once no
+     * update has arrived for `COALESCE_MAX_IDLE_MS`, so the tail of a burst
+     * which never reaches `max_rows` is still processed.
+     */
+    struct CoalescePolicy {
+        std::uint32_t max_latency_ms;
+        std::uint64_t max_rows;
+    };
+
+    constexpr std::uint32_t COALESCE_MAX_IDLE_MS = 100;
+
+    /**
+     * @brief The open coalescing window of a dirty table: when its first and
+     * most recent pending updates arrived.
+     */
+    struct CoalesceWindow {
+        std::chrono::steady_clock::time_point opened;
+        std::chrono::steady_clock::time_point last_update;
     };
 
     /**
@@ -574,10 +721,27 @@ namespace server {
         // `on_update()`
         void create_view_on_update_sub(const t_id& view_id, Subscription sub);
         std::vector<Subscription> get_view_on_update_sub(const t_id& view_id);
+        std::vector<Subscription> get_conflated_view_on_update_subs();
         void remove_view_on_update_sub(
             const t_id& view_id, std::uint32_t sub_id, std::uint32_t client_id
         );
         void drop_view_on_update_sub(const t_id& view_id);
+        bool set_view_on_update_viewport(
+            const t_id& view_id,
+            std::uint32_t sub_id,
+            std::uint32_t client_id,
+            const proto::ViewPort& viewport,
+            std::shared_ptr<t_viewport_keys> keys
+        );
+
+        // `View::to_arrow_stream()`, `View::to_csv_stream()`
+        void create_view_stream(const t_id& view_id, ViewStream stream);
+        std::optional<ViewStream> take_view_stream(
+            const t_id& view_id,
+            std::uint32_t stream_id,
+            std::uint32_t client_id
+        );
+        void drop_view_streams(const t_id& view_id);
 
         // `Table::on_delete()`
         void create_table_on_delete_sub(const t_id& table_id, Subscription sub);
@@ -608,6 +772,46 @@ namespace server {
         std::vector<std::pair<std::shared_ptr<Table>, const std::string>>
         get_dirty_tables();
         bool is_table_dirty(const t_id& id);
+
+        /**
+         * @brief Set (or clear, if both limits are `0`) the `CoalescePolicy`
+         * for the table `id`. The table does not need to exist yet.
+         */
+        void set_table_coalesce_policy(const t_id& id, CoalescePolicy policy);
+
+        /**
+         * @brief Whether the dirty table `id` is still inside its coalescing
+         * window and should not be processed yet.
+         */
+        bool is_table_coalescing(
+            const t_id& id, const std::shared_ptr<Table>& table
+        );
+
+        bool has_table_coalesce_policy(const t_id& id);
+
+        /**
+         * @brief Set the `t_stree_options` of the table `id`, returning
+         * `false` if there is no such table.
+         */
+        bool set_table_tree_options(
+            const t_id& id, const t_stree_options& options
+        );
+
+        /**
+         * @brief The earliest time at which an open coalescing window closes
+         * by its latency limit (or idle limit), if any.
+         */
+        std::optional<std::chrono::steady_clock::time_point>
+        get_coalesce_deadline();
+
+        /**
+         * @brief The earliest time at which a conflated `on_update`
+         * subscription's pending update, held back only by its
+         * `min_interval_ms`, becomes due, if any.
+         */
+        std::optional<std::chrono::steady_clock::time_point>
+        get_conflation_deadline();
+
         void drop_client(std::uint32_t);
 
         std::uint32_t get_table_view_count(const t_id& table_id);
@@ -630,12 +834,16 @@ namespace server {
         tsl::hopscotch_map<t_id, std::vector<Subscription>>
             m_view_on_delete_subs;
 
+        tsl::hopscotch_map<t_id, std::vector<ViewStream>> m_view_streams;
+
         tsl::hopscotch_map<t_id, std::vector<Subscription>>
             m_table_on_delete_subs;
 
         std::vector<Subscription> m_on_hosted_tables_update_subs;
 
         tsl::hopscotch_set<t_id> m_dirty_tables;
+        tsl::hopscotch_map<t_id, CoalescePolicy> m_coalesce_policies;
+        tsl::hopscotch_map<t_id, CoalesceWindow> m_coalesce_windows;
         tsl::hopscotch_map<t_id, Subscription> m_deleted_tables;
 
 #ifdef PSP_PARALLEL_FOR
@@ -654,13 +862,108 @@ namespace server {
         using Request = perspective::proto::Request;
         using Response = perspective::proto::Response;
 
-        ProtoServer(bool realtime_mode) : m_realtime_mode(realtime_mode) {}
+        ProtoServer(bool realtime_mode) :
+            m_realtime_mode(realtime_mode),
+            m_num_poll_threads(1),
+            m_lazy_views(false) {}
         std::uint32_t new_session();
         void close_session(std::uint32_t);
         std::vector<ProtoServerResp<std::string>>
         handle_request(std::uint32_t client_id, const std::string_view& data);
         std::vector<ProtoServerResp<std::string>> poll();
 
+        /**
+         * @brief Variants of `handle_request()` and `poll()` which return the
+         * unserialized `Response` messages, so the caller can serialize them
+         * straight into its own buffer (e.g. with `ByteSizeLong()` and
+         * `SerializeWithCachedSizesToArray()`) rather than through an
+         * intermediate `std::string`.
+         *
+         * @param client_id
+         * @param data
+         */
+        std::vector<ProtoServerResp<Response>> handle_request_messages(
+            std::uint32_t client_id, const std::string_view& data
+        );
+        std::vector<ProtoServerResp<Response>> poll_messages();
+
+        /**
+         * @brief Set the number of threads `poll()` may use to process dirty
+         * tables concurrently. Each `Table` owns its own `t_pool` and
+         * `t_gnode` (and their lock), so tables have no data dependencies on
+         * each other. Tables are processed on the shared CPU thread pool;
+         * `0` uses the pool's full capacity, `1` (the default) processes
+         * tables serially on the calling thread. Has no effect in builds
+         * without `PSP_PARALLEL_FOR`.
+         *
+         * Responses are always returned in table id order, regardless of the
+         * order in which tables finish processing.
+         *
+         * @param num_threads
+         */
+        void set_num_poll_threads(std::uint32_t num_threads);
+        std::uint32_t get_num_poll_threads() const;
+
+        /**
+         * @brief Coalesce updates to the hosted table `table_id`, so that
+         * bursts of updates are processed by a single `t_gnode::process`
+         * instead of one per `poll()`. See `CoalescePolicy`. Passing `0` for
+         * both limits disables coalescing, which is the default.
+         *
+         * A deferred table is processed by the first `poll()` after its
+         * window closes, or immediately by any request which reads it (in
+         * realtime mode as well). `get_poll_timeout_ms()` reports when the
+         * next window closes, so the host can schedule that `poll()`. A
+         * window with only a `max_rows` limit closes once its table has had
+         * no update for `COALESCE_MAX_IDLE_MS`.
+         *
+         * @param table_id
+         * @param max_latency_ms
+         * @param max_rows
+         */
+        void set_table_coalesce_policy(
+            const std::string& table_id,
+            std::uint32_t max_latency_ms,
+            std::uint64_t max_rows
+        );
+
+        /**
+         * @brief Defer building the context of each view created after this
+         * call until the view is first read (e.g. its schema, dimensions or
+         * data), so views which are replaced before they are read never
+         * compute their expressions or pivots. An `on_update` without a
+         * `mode` does not read the view. Disabled by default.
+         *
+         * @param lazy
+         */
+        void set_lazy_views(bool lazy);
+
+        /**
+         * @brief Set the `t_stree_options` of views created on the table
+         * `table_id` after this call. Unlike `set_table_coalesce_policy`,
+         * the table must already exist; returns `false` if it does not.
+         *
+         * @param table_id
+         * @param options
+         * @return bool
+         */
+        bool set_table_tree_options(
+            const std::string& table_id, const t_stree_options& options
+        );
+
+        /**
+         * @brief The number of milliseconds until `poll()` has deferred work
+         * to do which no request will trigger, e.g. a coalescing window whose
+         * latency limit expires or an `on_update` held back by
+         * `min_interval_ms`, or `-1` if there is none. Hosts should call
+         * this after each `poll()` and schedule another `poll()` (or, in
+         * realtime mode, their `on_poll_request`) that many milliseconds
+         * later.
+         *
+         * @return std::int32_t
+         */
+        std::int32_t get_poll_timeout_ms();
+
     private:
         void handle_process_table(
             const Request& req,
@@ -672,6 +975,15 @@ namespace server {
 
         std::vector<ProtoServerResp<Response>> _poll();
 
+#ifdef PSP_PARALLEL_FOR
+        void _poll_parallel(
+            std::vector<
+                std::pair<std::shared_ptr<Table>, const ServerResources::t_id>>&
+                tables,
+            std::vector<ProtoServerResp<Response>>& outs
+        );
+#endif
+
         void _process_table(
             std::shared_ptr<Table>& table,
             const ServerResources::t_id& table_id,
@@ -684,8 +996,18 @@ namespace server {
             std::vector<ProtoServerResp<Response>>& outs
         );
 
+        /**
+         * @brief Send the pending updates of conflated `on_update`
+         * subscriptions which are no longer held back, e.g. because their
+         * `min_interval_ms` has elapsed since the last update.
+         */
+        void
+        _flush_conflated_updates(std::vector<ProtoServerResp<Response>>& outs);
+
         static std::uint32_t m_client_id;
         bool m_realtime_mode;
+        std::uint32_t m_num_poll_threads;
+        bool m_lazy_views;
         std::atomic<std::chrono::high_resolution_clock::time_point>
             m_cpu_time_start;
         std::atomic<long long> m_cpu_time;
@@ -26,11 +26,20 @@ SUPPRESS_WARNINGS_VC(4503)
 #include <perspective/sparse_tree_node.h>
 #include <perspective/pivot.h>
 #include <perspective/aggspec.h>
+#include <perspective/config.h>
 #include <perspective/step_delta.h>
 #include <perspective/mask.h>
 #include <perspective/sym_table.h>
 #include <perspective/data_table.h>
 #include <perspective/dense_tree.h>
+#include <tsl/hopscotch_map.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <deque>
@@ -155,6 +164,253 @@ struct t_tree_unify_rec {
 
 typedef std::vector<t_tree_unify_rec> t_tree_unify_rec_vec;
 
+/**
+ * @brief Fixed-size blocks for the nodes of a `t_stree`'s index maps, carved
+ * from large slabs and recycled through a free list per block size. An
+ * index holds a node per primary key for each node of the key's ancestry,
+ * so this saves a heap allocation, and its header, per entry, and frees a
+ * dropped index's slabs at once.
+ */
+class PERSPECTIVE_EXPORT t_stree_index_pool {
+public:
+    t_stree_index_pool() = default;
+    PSP_NON_COPYABLE(t_stree_index_pool);
+
+    void* allocate(std::size_t size);
+    void deallocate(void* ptr, std::size_t size);
+
+    /**
+     * @brief Free every slab. Only valid once every container allocated from
+     * this pool is empty or destroyed.
+     */
+    void release();
+
+    /**
+     * @brief The number of blocks allocated and not yet deallocated.
+     */
+    t_uindex size() const;
+
+private:
+    struct t_free_block {
+        t_free_block* m_next;
+    };
+
+    struct t_size_class {
+        std::size_t m_block_size;
+        t_free_block* m_free = nullptr;
+        std::size_t m_slab_used = 0;
+        std::vector<std::unique_ptr<std::byte[]>> m_slabs;
+    };
+
+    t_size_class& get_size_class(std::size_t block_size);
+
+    std::vector<t_size_class> m_size_classes;
+    t_uindex m_size = 0;
+};
+
+/**
+ * @brief Allocates single container nodes from a `t_stree_index_pool`, and
+ * anything larger from the heap.
+ */
+template <typename T>
+class t_stree_index_allocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit t_stree_index_allocator(t_stree_index_pool* pool) :
+        m_pool(pool) {}
+
+    template <typename U>
+    t_stree_index_allocator(const t_stree_index_allocator<U>& other) :
+        m_pool(other.get_pool()) {}
+
+    T*
+    allocate(std::size_t n) {
+        if (n != 1) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        return static_cast<T*>(m_pool->allocate(sizeof(T)));
+    }
+
+    void
+    deallocate(T* ptr, std::size_t n) {
+        if (n != 1) {
+            ::operator delete(ptr);
+        } else {
+            m_pool->deallocate(ptr, sizeof(T));
+        }
+    }
+
+    t_stree_index_pool*
+    get_pool() const {
+        return m_pool;
+    }
+
+    template <typename U>
+    bool
+    operator==(const t_stree_index_allocator<U>& other) const {
+        return m_pool == other.get_pool();
+    }
+
+    template <typename U>
+    bool
+    operator!=(const t_stree_index_allocator<U>& other) const {
+        return m_pool != other.get_pool();
+    }
+
+private:
+    t_stree_index_pool* m_pool;
+};
+
+template <typename K, typename V, typename C = std::less<K>>
+using t_stree_index_map =
+    std::map<K, V, C, t_stree_index_allocator<std::pair<const K, V>>>;
+
+template <typename T>
+using t_stree_index_set =
+    std::set<T, std::less<T>, t_stree_index_allocator<T>>;
+
+/**
+ * @brief A counted multiset of the values beneath a `t_stree` node. NaN is
+ * unordered, so NaNs are only counted. For columns with a DOMINANT
+ * aggregate, `m_by_count` orders the values by descending count, then by
+ * value, with invalid values counted once as `get_dominant` does.
+ */
+struct t_stree_value_counts {
+    explicit t_stree_value_counts(t_stree_index_pool* pool);
+
+    t_stree_index_map<t_tscalar, t_uindex> m_counts;
+    t_stree_index_set<std::pair<t_index, t_tscalar>> m_by_count;
+    t_uindex m_nan_count = 0;
+};
+
+/**
+ * @brief Reference counted copies of the strings held by the indices of a
+ * `t_stree`, one reference per primary key holding the string. Unlike the
+ * tree's `t_symtable`, a string is freed once no primary key holds it.
+ */
+class PERSPECTIVE_EXPORT t_stree_index_strings {
+public:
+    t_tscalar acquire(const t_tscalar& value);
+    void release(const t_tscalar& value);
+    void clear();
+    t_uindex size() const;
+
+private:
+    // Node based, so the address of each string is stable.
+    std::unordered_map<std::string, t_uindex> m_strings;
+};
+
+/**
+ * @brief The values of a column beneath each node of a `t_stree`, and the
+ * leaf and value of each primary key, so MIN, MAX, DOMINANT and UNIQUE
+ * aggregates over the column are maintained in O(log n) per changed row
+ * rather than by reading every row beneath a node.
+ */
+struct t_stree_value_index {
+    bool m_track_dominant = false;
+    tsl::hopscotch_map<t_uindex, t_stree_value_counts> m_nodes;
+    tsl::hopscotch_map<t_tscalar, std::pair<t_uindex, t_tscalar>> m_pkeys;
+};
+
+struct t_stree_ordered_key {
+    t_tscalar m_sort_value;
+    t_uindex m_leaf;
+    t_tscalar m_pkey;
+};
+
+/**
+ * @brief Orders `t_stree_ordered_key` by sort value, then by leaf and primary
+ * key, and compares it with a bare sort value to find the keys sharing one.
+ */
+struct t_stree_ordered_key_less {
+    using is_transparent = void;
+
+    bool operator()(
+        const t_stree_ordered_key& a, const t_stree_ordered_key& b
+    ) const;
+
+    bool
+    operator()(const t_stree_ordered_key& a, const t_tscalar& b) const {
+        return a.m_sort_value < b;
+    }
+
+    bool
+    operator()(const t_tscalar& a, const t_stree_ordered_key& b) const {
+        return a < b.m_sort_value;
+    }
+};
+
+/**
+ * @brief The values beneath a `t_stree` node keyed by sort value, then by
+ * leaf and primary key, which is the order `get_pkeys` reads them in, one
+ * map node per primary key. NaN sort values are unordered, so they are only
+ * counted.
+ */
+struct t_stree_ordered_values {
+    explicit t_stree_ordered_values(t_stree_index_pool* pool);
+
+    t_stree_index_map<t_stree_ordered_key, t_tscalar, t_stree_ordered_key_less>
+        m_values;
+    t_uindex m_nan_count = 0;
+};
+
+/**
+ * @brief A value column ordered by a sort column beneath each node of a
+ * `t_stree`, and the leaf, sort value and value of each primary key, so
+ * FIRST, LAST_BY_INDEX and LAST_MINUS_FIRST aggregates are maintained in
+ * O(log n) per changed row.
+ */
+struct t_stree_ordered_index {
+    tsl::hopscotch_map<t_uindex, t_stree_ordered_values> m_nodes;
+    tsl::hopscotch_map<
+        t_tscalar,
+        std::tuple<t_uindex, t_tscalar, t_tscalar>>
+        m_pkeys;
+};
+
+/**
+ * @brief The nodes changed by the last update of a `t_stree`, from which
+ * the traversal of each context sharing the tree is updated. Leaves are
+ * ordered by their sort-by paths.
+ */
+struct t_stree_step {
+    std::vector<t_uindex> m_zero_strands;
+    std::set<t_uindex> m_non_zero_ids;
+    std::vector<t_uindex> m_sorted_leaves;
+    bool m_applied_directly = false;
+};
+
+/**
+ * @brief A node of the group-by tree implied by a strand table, with the
+ * strand rows beneath it. `m_pidx` indexes `t_strand_tree::m_nodes`.
+ */
+struct t_strand_node {
+    t_uindex m_pidx;
+    t_depth m_depth;
+    t_tscalar m_value;
+    t_tscalar m_sortby_value;
+    std::vector<t_uindex> m_rows;
+};
+
+/**
+ * @brief The group-by tree of a strand table and its per-node aggregates,
+ * from which small updates are applied to a `t_stree` without building an
+ * intermediate `t_dtree`. Nodes are ordered parents first, with the root at
+ * index 0, and `m_aggregates` has one row per node.
+ */
+struct t_strand_tree {
+    std::vector<t_strand_node> m_nodes;
+    std::shared_ptr<const t_data_table> m_strands;
+    std::shared_ptr<const t_data_table> m_strand_deltas;
+    std::shared_ptr<t_data_table> m_aggregates;
+    std::vector<t_aggspec> m_aggspecs;
+};
+
 class PERSPECTIVE_EXPORT t_stree {
 public:
     typedef const t_stree* t_cptr;
@@ -243,6 +499,28 @@ public:
         const t_data_table& expression_master_table
     );
 
+    /**
+     * @brief Whether `strands` is small enough, per this tree's
+     * `t_stree_options`, to be applied directly rather than through a
+     * `t_dtree`.
+     */
+    bool should_apply_strands_directly(const t_data_table& strands) const;
+
+    t_strand_tree build_strand_tree(
+        std::shared_ptr<const t_data_table> strands,
+        std::shared_ptr<const t_data_table> strand_deltas,
+        const std::vector<t_aggspec>& aggspecs,
+        const std::vector<std::pair<std::string, std::string>>& tree_sortby
+    ) const;
+
+    void update_shape_from_strands(const t_strand_tree& stree);
+
+    void update_aggs_from_strands(
+        const t_strand_tree& stree,
+        const t_gstate& gstate,
+        const t_data_table& expression_master_table
+    );
+
     t_uindex size() const;
 
     t_uindex get_num_children(t_uindex idx) const;
@@ -346,9 +624,38 @@ public:
     bool has_deltas() const;
     void set_has_deltas(bool v);
 
+    const t_stree_step& get_last_step() const;
+    void set_last_step(t_stree_step step);
+
+    /**
+     * @brief Whether this tree maintains aggregate indices, i.e. it has an
+     * indexed aggregate and has not dropped its indices for their budget.
+     */
+    bool has_indices() const;
+
     std::vector<t_uindex> get_descendents(t_uindex nidx) const;
 
     t_uindex get_num_leaves(t_uindex depth) const;
+
+    /**
+     * @brief Returns the number of nodes at each depth, root first.
+     */
+    std::vector<t_uindex> get_num_nodes_by_depth() const;
+
+    /**
+     * @brief Returns the number of primary keys beneath the root.
+     */
+    t_uindex get_num_pkeys() const;
+
+    /**
+     * @brief Whether `spec` is updated from the changed rows of a step (or
+     * from other aggregates), rather than by reading every row beneath each
+     * changed node from the `t_gstate`. `is_expression` is whether the
+     * aggregated column is an expression. `update_agg_table` takes its
+     * incremental path only for aggregates this returns `true` for, falling
+     * back to a rescan where a node's index cannot answer.
+     */
+    static bool is_incremental(const t_aggspec& spec, bool is_expression);
     std::vector<t_index> get_indices_for_depth(t_uindex depth) const;
 
     t_bfs_iter<t_stree> bfs() const;
@@ -383,14 +690,91 @@ protected:
     ) const;
 
     void populate_pkey_idx(
-        const t_dtree_ctx& ctx,
-        const t_dtree& dtree,
-        t_uindex dptidx,
+        const t_column& pkey_col,
+        const t_column& strand_count_col,
+        const t_uindex* bleaf,
+        const t_uindex* eleaf,
         t_uindex sptidx,
-        t_uindex ndepth,
         t_idxpkey& new_idx_pkey
     );
 
+    void begin_shape_update(t_index root_nstrands);
+
+    bool unify_node(
+        t_uindex p_sptidx,
+        t_tscalar value,
+        t_tscalar sortby_value,
+        t_depth ndepth,
+        t_uindex src_ridx,
+        t_index nstrands,
+        t_uindex& sptidx
+    );
+
+    void end_shape_update(const t_idxpkey& new_idx_pkey);
+
+    void update_aggs(
+        const t_data_table& src_aggtable,
+        const std::vector<t_aggspec>& src_aggspecs,
+        const t_gstate& gstate,
+        const t_data_table& expression_master_table
+    );
+
+    void remove_indexed_values(const t_tscalar& pkey);
+
+    void create_indices();
+
+    t_uindex get_num_index_entries() const;
+
+    void drop_indices();
+
+    void rebuild_indices();
+
+    std::vector<t_uindex> get_indexed_ancestry(t_uindex leaf) const;
+
+    void update_value_counts(
+        t_stree_value_index& index,
+        t_uindex leaf,
+        const t_tscalar& value,
+        bool insert
+    );
+
+    void update_ordered_values(
+        t_stree_ordered_index& index,
+        t_uindex leaf,
+        const t_tscalar& pkey,
+        const t_tscalar& sort_value,
+        const t_tscalar& value,
+        bool insert
+    );
+
+    void apply_index_updates(
+        const t_gstate& gstate, const t_data_table& expression_master_table
+    );
+
+    bool get_extremum(
+        const std::string& colname,
+        t_uindex nidx,
+        bool is_max,
+        t_tscalar& value
+    ) const;
+
+    bool get_dominant_value(
+        const std::string& colname, t_uindex nidx, t_tscalar& value
+    ) const;
+
+    bool get_unique_value(
+        const std::string& colname,
+        t_uindex nidx,
+        bool& is_unique,
+        t_tscalar& value
+    ) const;
+
+    bool get_first_last_value(
+        t_uindex nidx,
+        const t_aggspec& spec,
+        std::pair<t_tscalar, t_tscalar>& value
+    ) const;
+
     // Methods that use `t_gstate`'s mapping of primary keys to row indices
     // to extract values from a data table. Because these methods can either
     // extract from the expressions table or the master table of the gnode,
@@ -464,10 +848,20 @@ private:
     std::vector<const t_column*> m_aggcols;
     std::shared_ptr<t_tcdeltas> m_deltas;
     t_tree_unify_rec_vec m_tree_unification_records;
+    t_stree_index_pool m_index_pool;
+    std::map<std::string, t_stree_value_index> m_value_indices;
+    std::map<std::pair<std::string, std::string>, t_stree_ordered_index>
+        m_ordered_indices;
+    std::vector<std::pair<t_uindex, t_tscalar>> m_index_pending;
+    t_uindex m_index_nodes_per_key = 0;
+    bool m_indices_dropped = false;
     std::vector<bool> m_features;
     t_symtable m_symtable;
+    t_stree_index_strings m_index_strings;
     bool m_has_delta;
+    t_stree_step m_last_step;
     std::string m_grand_agg_str;
+    t_stree_options m_options;
 };
 
 } // end namespace perspective
@@ -19,6 +19,7 @@
 #include <perspective/gnode.h>
 #include <perspective/pool.h>
 #include <perspective/data_table.h>
+#include <perspective/config.h>
 
 namespace perspective {
 
@@ -187,11 +188,20 @@ public:
     std::uint32_t get_offset() const;
     std::uint32_t get_limit() const;
     const std::string& get_index() const;
+    const t_stree_options& get_tree_options() const;
 
     // Setters
     void set_column_names(const std::vector<std::string>& column_names);
     void set_data_types(const std::vector<t_dtype>& data_types);
 
+    /**
+     * @brief Set the `t_stree_options` of the sparse trees of views created
+     * on this `Table` after this call. Existing views keep their options.
+     *
+     * @param options
+     */
+    void set_tree_options(const t_stree_options& options);
+
     void remove_cols(const std::string_view& data);
     void remove_rows(const std::string_view& data);
 
@@ -294,6 +304,7 @@ private:
      */
     const std::string m_index;
     bool m_gnode_set;
+    t_stree_options m_tree_options;
 };
 
 } // namespace perspective
\ No newline at end of file
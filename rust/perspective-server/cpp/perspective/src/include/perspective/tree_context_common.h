@@ -15,6 +15,7 @@
 #include <perspective/exports.h>
 #include <perspective/config.h>
 #include <perspective/gnode_state.h>
+#include <perspective/path.h>
 #include <perspective/traversal.h>
 
 namespace perspective {
@@ -32,6 +33,20 @@ PERSPECTIVE_EXPORT void notify_sparse_tree_common(
     const t_data_table& expression_master_table
 );
 
+/**
+ * @brief Update a traversal from the last step applied to its tree, which
+ * may have been applied by another context sharing the tree.
+ *
+ * @param tree
+ * @param traversal
+ * @param ctx_sortby
+ */
+PERSPECTIVE_EXPORT void notify_sparse_traversal(
+    const std::shared_ptr<t_stree>& tree,
+    const std::shared_ptr<t_traversal>& traversal,
+    const std::vector<t_sortspec>& ctx_sortby
+);
+
 PERSPECTIVE_EXPORT void notify_sparse_tree(
     const std::shared_ptr<t_stree>& tree,
     const std::shared_ptr<t_traversal>& traversal,
@@ -63,6 +78,48 @@ PERSPECTIVE_EXPORT void notify_sparse_tree(
     const t_data_table& expression_master_table
 );
 
+/**
+ * @brief The aggregates of a tree shared by contexts whose configs differ
+ * only in their aggregates: `tree_aggregates`, followed by each of
+ * `aggregates` which none of them computes. The tree's aggregate columns
+ * are named after its aggregates, so an added aggregate whose name is taken
+ * is renamed.
+ *
+ * @param tree_aggregates
+ * @param aggregates
+ * @return std::vector<t_aggspec>
+ */
+PERSPECTIVE_EXPORT std::vector<t_aggspec> union_tree_aggregates(
+    const std::vector<t_aggspec>& tree_aggregates,
+    const std::vector<t_aggspec>& aggregates
+);
+
+/**
+ * @brief For each of `aggregates`, the index of the aggregate of
+ * `tree_aggregates` which computes it, or `INVALID_INDEX` if none does.
+ *
+ * @param tree_aggregates
+ * @param aggregates
+ * @return std::vector<t_index>
+ */
+PERSPECTIVE_EXPORT std::vector<t_index> get_tree_aggregate_indices(
+    const std::vector<t_aggspec>& tree_aggregates,
+    const std::vector<t_aggspec>& aggregates
+);
+
+/**
+ * @brief `sortby`, whose aggregate indices index a context's aggregates,
+ * re-indexed to the aggregates of its tree.
+ *
+ * @param sortby
+ * @param tree_aggidx the tree aggregate of each of the context's aggregates.
+ * @return std::vector<t_sortspec>
+ */
+PERSPECTIVE_EXPORT std::vector<t_sortspec> get_tree_sortby(
+    const std::vector<t_sortspec>& sortby,
+    const std::vector<t_index>& tree_aggidx
+);
+
 template <typename CONTEXT_T>
 void
 ctx_expand_path(
@@ -40,6 +40,62 @@ void write_scalar(
     rapidjson::Writer<rapidjson::StringBuffer>& writer
 );
 
+/**
+ * @brief A hash of the identity (primary key or row path) of each row in a
+ * viewport, and of its column paths, when its delta was last computed.
+ */
+struct t_viewport_keys {
+    std::vector<std::size_t> m_rows;
+    std::size_t m_columns = 0;
+};
+
+/**
+ * @brief The shape of one of a `View`'s sparse trees, the nodes changed and
+ * removed by its last update, whether that update was applied without a
+ * `t_dtree`, and whether the tree maintains aggregate indices.
+ */
+struct t_tree_profile {
+    std::vector<t_uindex> m_nodes_per_depth;
+    t_uindex m_last_nodes_changed = 0;
+    t_uindex m_last_nodes_removed = 0;
+    bool m_last_applied_directly = false;
+    bool m_indexed = false;
+};
+
+/**
+ * @brief An aggregate of a `View`, and whether `t_stree::is_incremental`.
+ */
+struct t_aggregate_profile {
+    std::string m_column;
+    std::string m_aggregate;
+    bool m_incremental = false;
+};
+
+/**
+ * @brief An expression of a `View`, and the rows it was evaluated for.
+ */
+struct t_expression_profile {
+    std::string m_alias;
+    t_expression_stats m_stats;
+};
+
+/**
+ * @brief A report of the structures a `View` maintains, their size, and the
+ * rows its last update touched at each stage.
+ */
+struct t_view_profile {
+    std::string m_context_type;
+    std::vector<t_tree_profile> m_trees;
+    std::vector<t_aggregate_profile> m_aggregates;
+    std::vector<t_expression_profile> m_expressions;
+    std::vector<std::string> m_hidden_sort;
+    t_uindex m_num_table_rows = 0;
+    t_uindex m_num_filtered_rows = 0;
+    t_uindex m_traversal_rows = 0;
+    t_uindex m_traversal_columns = 0;
+    t_gnode_update_stats m_last_update;
+};
+
 template <typename CTX_T>
 class PERSPECTIVE_EXPORT View {
 public:
@@ -296,13 +352,16 @@ public:
      * @param end_row
      * @param start_col
      * @param end_col
+     * @param include_header whether to write the header row, which is
+     * omitted from all but the first chunk of a chunked export.
      * @return std::shared_ptr<std::string>
      */
     std::shared_ptr<std::string> to_csv(
         std::int32_t start_row,
         std::int32_t end_row,
         std::int32_t start_col,
-        std::int32_t end_col
+        std::int32_t end_col,
+        bool include_header = true
     ) const;
 
     /**
@@ -333,8 +392,10 @@ public:
      * @param end_col
      * @return std::shared_ptr<std::string>
      */
-    std::shared_ptr<std::string>
-    data_slice_to_csv(std::shared_ptr<t_data_slice<CTX_T>> data_slice) const;
+    std::shared_ptr<std::string> data_slice_to_csv(
+        std::shared_ptr<t_data_slice<CTX_T>> data_slice,
+        bool include_header = true
+    ) const;
 
     // Delta calculation
     bool _get_deltas_enabled() const;
@@ -375,6 +436,22 @@ public:
      */
     void set_depth(std::int32_t depth, std::int32_t row_pivot_length);
 
+    /**
+     * @brief Replace the view's sort, re-sorting the existing context in
+     * place rather than rebuilding it. This is only possible when the new
+     * sort needs no columns or aggregates the context does not already
+     * have; otherwise the config is left unchanged and the caller must
+     * create a new view.
+     *
+     * @param sort
+     * @param schema the `Table` schema plus the view's expression columns.
+     * @return bool whether the sort was applied.
+     */
+    bool set_sort(
+        const std::vector<std::vector<std::string>>& sort,
+        const std::shared_ptr<t_schema>& schema
+    );
+
     /**
      * @brief Returns a data slice that contains the dataset from the rows
      * that have been changed by a call to `update()`.
@@ -383,6 +460,63 @@ public:
      */
     std::shared_ptr<t_data_slice<CTX_T>> get_row_delta() const;
 
+    /**
+     * @brief Record the rows and columns currently in a viewport to `keys`,
+     * which `get_viewport_delta_as_arrow` compares against.
+     *
+     * @param start_row
+     * @param end_row
+     * @param start_col
+     * @param end_col
+     * @param keys
+     */
+    void update_viewport_keys(
+        std::int32_t start_row,
+        std::int32_t end_row,
+        std::int32_t start_col,
+        std::int32_t end_col,
+        t_viewport_keys& keys
+    ) const;
+
+    /**
+     * @brief Serializes the rows of a viewport which were updated by the
+     * last call to `update()`, or which moved into the viewport since
+     * `keys` was last updated, to the Apache Arrow format. The first
+     * column, `__ROW__`, is each row's index in the `View`. Unlike
+     * `get_row_delta`, this does not clear the context's deltas, so many
+     * viewports can be read from the same update.
+     *
+     * @param start_row
+     * @param end_row
+     * @param start_col
+     * @param end_col
+     * @param keys
+     * @return std::shared_ptr<std::string> or `nullptr` if no row in the
+     * viewport changed.
+     */
+    std::shared_ptr<std::string> get_viewport_delta_as_arrow(
+        std::int32_t start_row,
+        std::int32_t end_row,
+        std::int32_t start_col,
+        std::int32_t end_col,
+        t_viewport_keys& keys
+    ) const;
+
+    /**
+     * @brief Clears the context's deltas, unless its trees are shared with
+     * other contexts, in which case the `t_gnode` clears them before the
+     * next update.
+     */
+    void clear_deltas();
+
+    /**
+     * @brief Profile this `View`, for finding which part of its config makes
+     * it slow to build or update.
+     *
+     * @return t_view_profile
+     */
+    t_view_profile get_profile() const;
+
     // Getters
     std::shared_ptr<CTX_T> get_context() const;
     std::vector<std::string> get_row_pivots() const;
@@ -439,6 +573,54 @@ private:
 
     void _find_hidden_sort(const std::vector<t_sortspec>& sort);
 
+    /**
+     * @brief Fill in the parts of `profile` which depend on the context type:
+     * the context type, its trees and aggregates, and the filtered rows.
+     */
+    void _get_context_profile(t_view_profile& profile) const;
+
+    /**
+     * @brief Whether the context can be re-sorted from the previous sort
+     * (`m_sort`, plus the arguments) to the one now in `m_view_config`.
+     */
+    bool _can_sort_in_place(
+        const std::vector<t_aggspec>& prev_aggspecs,
+        const std::vector<std::string>& prev_hidden_sort,
+        const std::vector<t_sortspec>& prev_col_sortspec
+    ) const;
+
+    void _sort_in_place();
+
+    /**
+     * @brief Hash the identity of each row in `[start_row, end_row)` into
+     * `row_keys`, and append the rows among them with updated cells to
+     * `updated`.
+     */
+    void _get_viewport_rows(
+        t_uindex start_row,
+        t_uindex end_row,
+        std::vector<std::size_t>& row_keys,
+        std::vector<t_uindex>& updated
+    ) const;
+
+    /**
+     * @brief Replace `keys` with the viewport's current keys, returning the
+     * sorted rows which were updated or differ from those in `keys`.
+     */
+    std::vector<t_uindex> _update_viewport_keys(
+        std::int32_t start_row,
+        std::int32_t end_row,
+        std::int32_t start_col,
+        std::int32_t end_col,
+        t_viewport_keys& keys
+    ) const;
+
+    std::shared_ptr<std::string> _batch_to_arrow(
+        const std::shared_ptr<arrow::Schema>& arrow_schema,
+        const std::shared_ptr<arrow::RecordBatch>& batches,
+        bool compress
+    ) const;
+
     std::shared_ptr<Table> m_table;
     std::shared_ptr<CTX_T> m_ctx;
     std::string m_name;
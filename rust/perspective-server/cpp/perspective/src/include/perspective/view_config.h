@@ -99,6 +99,21 @@ public:
     void set_row_pivot_depth(std::int32_t depth);
     void set_column_pivot_depth(std::int32_t depth);
 
+    /**
+     * @brief Replace the sort, recomputing the aggspecs (for hidden sorts)
+     * and sortspecs. Other fields are unchanged, so a context built from
+     * the previous config can be re-sorted if its aggspecs still match.
+     *
+     * @param sort
+     * @param schema the `Table` schema plus the view's expression columns.
+     */
+    void set_sort(
+        const std::vector<std::vector<std::string>>& sort,
+        const std::shared_ptr<t_schema>& schema
+    );
+
+    std::vector<std::vector<std::string>> get_sort() const;
+
     std::vector<std::string> get_row_pivots() const;
 
     std::vector<std::string> get_column_pivots() const;
@@ -164,6 +179,16 @@ private:
      */
     void fill_sortspec();
 
+    /**
+     * @brief Abort if any column in `sort` is not in `schema` and is not an
+     * expression alias.
+     */
+    void validate_sort(
+        const std::vector<std::vector<std::string>>& sort,
+        const std::shared_ptr<t_schema>& schema,
+        const std::unordered_set<std::string>& expression_aliases
+    ) const;
+
     /**
      * @brief Given a column name, find its position in `m_aggregate_names`.
      * Used for determining sort specifications.
@@ -10,6 +10,8 @@
 // ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
 // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
 
+use std::time::Duration;
+
 #[repr(C, packed)]
 pub struct CppResponse {
     data_ptr: usize,
@@ -27,6 +29,15 @@ unsafe extern "C" {
     fn psp_alloc(size: usize) -> *mut u8;
     fn psp_free(ptr: *const u8);
     fn psp_new_server(realtime_mode: bool) -> *const u8;
+    fn psp_set_num_poll_threads(server: *const u8, num_threads: u32);
+    fn psp_set_table_coalesce_policy(
+        server: *const u8,
+        table_id_ptr: *const u8,
+        table_id_len: usize,
+        max_latency_ms: u32,
+        max_rows: u64,
+    );
+    fn psp_set_lazy_views(server: *const u8, lazy: bool);
     fn psp_new_session(server: *const u8) -> u32;
     fn psp_delete_server(server: *const u8);
     fn psp_handle_request(
@@ -36,6 +47,7 @@ unsafe extern "C" {
         buffer_len: usize,
     ) -> ResponseBatch;
     fn psp_poll(server: *const u8) -> ResponseBatch;
+    fn psp_poll_timeout(server: *const u8) -> i32;
     fn psp_close_session(server: *const u8, client_id: u32);
     fn psp_num_cpus() -> i32;
     fn psp_set_num_cpus(num_cpus: i32);
@@ -132,6 +144,32 @@ impl Server {
         Server(unsafe { psp_new_server(realtime_mode) })
     }
 
+    /// Set the number of threads `poll()` uses to process independent tables
+    /// concurrently. `0` uses one thread per core, `1` (the default) is
+    /// serial. Only effective in builds with threading support.
+    pub fn set_num_poll_threads(&self, num_threads: u32) {
+        unsafe { psp_set_num_poll_threads(self.0, num_threads) }
+    }
+
+    /// Set the update coalescing window for the table `table_id`. `0` for
+    /// both limits disables coalescing.
+    pub fn set_table_coalesce_policy(&self, table_id: &str, max_latency_ms: u32, max_rows: u64) {
+        unsafe {
+            psp_set_table_coalesce_policy(
+                self.0,
+                table_id.as_ptr(),
+                table_id.len(),
+                max_latency_ms,
+                max_rows,
+            )
+        }
+    }
+
+    /// Defer building each new view's context until it is first read.
+    pub fn set_lazy_views(&self, lazy: bool) {
+        unsafe { psp_set_lazy_views(self.0, lazy) }
+    }
+
     pub fn new_session(&self) -> u32 {
         unsafe { psp_new_session(self.0) }
     }
@@ -144,6 +182,13 @@ impl Server {
         unsafe { psp_poll(self.0) }
     }
 
+    /// How long until `poll()` has deferred work to do which no request will
+    /// trigger, if any.
+    pub fn poll_timeout(&self) -> Option<Duration> {
+        let timeout = unsafe { psp_poll_timeout(self.0) };
+        u64::try_from(timeout).ok().map(Duration::from_millis)
+    }
+
     pub fn close_session(&self, session_id: u32) {
         unsafe { psp_close_session(self.0, session_id) }
     }
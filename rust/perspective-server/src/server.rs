@@ -13,6 +13,7 @@
 use std::collections::HashMap;
 use std::error::Error;
 use std::sync::Arc;
+use std::time::Duration;
 
 use async_lock::RwLock;
 use futures::Future;
@@ -134,6 +135,59 @@ impl Server {
         .await
     }
 
+    /// Set the number of threads [`Server::poll`] may use to process updated
+    /// [`perspective_client::Table`]s concurrently. Tables are independent of
+    /// each other, so when many tables update between polls, `poll()` latency
+    /// is bounded by the slowest table rather than the sum of all of them.
+    /// Responses are emitted in the same order regardless of thread count.
+    ///
+    /// # Arguments
+    ///
+    /// - `num_threads` - `0` uses every thread in the shared CPU pool, `1` (the
+    ///   default) processes tables serially.
+    pub fn set_num_poll_threads(&self, num_threads: u32) {
+        self.server.set_num_poll_threads(num_threads)
+    }
+
+    /// Coalesce bursts of updates to a [`perspective_client::Table`], so that
+    /// repeated updates to the same primary key are merged and processed
+    /// once per window rather than once per [`Server::poll`]. The window
+    /// opens on the first update after the table was last processed, and
+    /// closes when either limit is reached.
+    ///
+    /// A table with an open window is skipped by [`Server::poll`], but is
+    /// always processed before it is read. A window without a latency limit
+    /// also closes once its table has had no update for 100ms. The first
+    /// `poll()` after a window closes processes the table; see
+    /// [`Server::poll_timeout`] for when to schedule it.
+    ///
+    /// # Arguments
+    ///
+    /// - `table_name` - The name of the table, which need not exist yet.
+    /// - `max_latency_ms` - The longest an update may be deferred, or `0` for
+    ///   no latency limit.
+    /// - `max_rows` - The number of pending rows which closes the window, or
+    ///   `0` for no row limit. If both limits are `0`, coalescing is disabled.
+    pub fn set_table_coalesce_policy(&self, table_name: &str, max_latency_ms: u32, max_rows: u64) {
+        self.server
+            .set_table_coalesce_policy(table_name, max_latency_ms, max_rows)
+    }
+
+    /// Defer building each new [`perspective_client::View`] until it is
+    /// first read (by e.g. `schema()`, `num_rows()` or `to_arrow()`), so
+    /// views which are replaced by a config change before they are read
+    /// never compute their expressions or group-bys. Views which share
+    /// trees with an existing view are unaffected, as sharing is cheap. An
+    /// `on_update` callback without a `mode` does not read the view.
+    ///
+    /// # Arguments
+    ///
+    /// - `lazy` - `true` to defer building views created after this call,
+    ///   `false` (the default) to build them when they are created.
+    pub fn set_lazy_views(&self, lazy: bool) {
+        self.server.set_lazy_views(lazy)
+    }
+
     /// Create a new [`Client`] instance bound to this [`Server`] directly.
     pub fn new_local_client(&self) -> LocalClient {
         LocalClient::new(self)
@@ -154,6 +208,11 @@ impl Server {
     ///
     /// `poll()` _must_ be called after [`Table::update`] or [`Table::remove`]
     /// and `on_poll_request` is notified, or the changes will not be applied.
+    ///
+    /// `on_update` notifications held back by a subscriber's `min_interval_ms`
+    /// are sent by the first `poll()` after the interval elapses. The
+    /// [`Server`] does not schedule this `poll()` itself, see
+    /// [`Server::poll_timeout`].
     pub async fn poll(&self) -> Result<(), ServerError> {
         let responses = self.server.poll();
         let mut results = Vec::with_capacity(responses.size());
@@ -172,4 +231,17 @@ impl Server {
 
         results.into_iter().collect()
     }
+
+    /// How long until [`Server::poll`] has deferred work to do which no
+    /// request will trigger, e.g. a coalescing window which closes or an
+    /// `on_update` held back by `min_interval_ms`, if any.
+    ///
+    /// The [`Server`] has no runtime of its own, so hosts which use
+    /// coalescing or `min_interval_ms` should check this after each
+    /// `poll()` (or request) and schedule the next `poll()` (or
+    /// `on_poll_request`) on their own executor, e.g. with
+    /// `tokio::time::sleep`.
+    pub fn poll_timeout(&self) -> Option<Duration> {
+        self.server.poll_timeout()
+    }
 }
@@ -0,0 +1,192 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+use std::error::Error;
+use std::sync::Arc;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::time::Duration;
+
+use futures::future::BoxFuture;
+use perspective::server::{Server, ServerError};
+use perspective_client::{
+    OnUpdateOptions, Table, TableInitOptions, UpdateData, UpdateOptions, View,
+};
+use perspective_server::LocalClient;
+
+/// A realtime-mode [`Server`] whose `on_poll_request` polls immediately.
+fn new_realtime_server() -> Server {
+    Server::new(Some(Arc::new(|server: &Server| {
+        let server = server.clone();
+        Box::pin(async move { server.poll().await }) as BoxFuture<'static, Result<(), ServerError>>
+    })))
+}
+
+async fn new_table(client: &LocalClient) -> Result<Table, Box<dyn Error>> {
+    let table = client
+        .table(
+            UpdateData::Csv("x,y\n1,2\n3,4".to_owned()).into(),
+            TableInitOptions {
+                name: Some("Table1".to_owned()),
+                index: Some("x".to_owned()),
+                limit: None,
+                format: None,
+            },
+        )
+        .await?;
+
+    Ok(table)
+}
+
+async fn count_updates(view: &View) -> Result<Arc<AtomicUsize>, Box<dyn Error>> {
+    let count = Arc::new(AtomicUsize::new(0));
+    view.on_update(
+        {
+            let count = count.clone();
+            move |_| {
+                let count = count.clone();
+                async move {
+                    count.fetch_add(1, Ordering::SeqCst);
+                }
+            }
+        },
+        OnUpdateOptions::default(),
+    )
+    .await?;
+
+    Ok(count)
+}
+
+async fn update(table: &Table, csv: &str) -> Result<(), Box<dyn Error>> {
+    table
+        .update(UpdateData::Csv(csv.to_owned()), UpdateOptions::default())
+        .await?;
+
+    Ok(())
+}
+
+/// Wait for the deadline reported by [`Server::poll_timeout`], which must be
+/// no later than the 100ms limit of the tests' policies, then `poll()`.
+async fn poll_after_timeout(server: &Server) -> Result<(), Box<dyn Error>> {
+    let timeout = server.poll_timeout().expect("No deferred work");
+    assert!(timeout <= Duration::from_millis(100));
+    tokio::time::sleep(timeout).await;
+    server.poll().await?;
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_coalesced_updates_are_flushed_when_latency_expires() -> Result<(), Box<dyn Error>> {
+    let server = Server::new(None);
+    server.set_table_coalesce_policy("Table1", 100, 0);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let count = count_updates(&view).await?;
+    update(&table, "x,y\n1,5").await?;
+    update(&table, "x,y\n1,6").await?;
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(count.load(Ordering::SeqCst), 0);
+
+    // No further requests: the host polls when the window closes.
+    poll_after_timeout(&server).await?;
+    assert_eq!(count.load(Ordering::SeqCst), 1);
+    assert_eq!(server.poll_timeout(), None);
+    assert_eq!(view.num_rows().await?, 3);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_coalesced_updates_are_flushed_when_latency_expires_realtime()
+-> Result<(), Box<dyn Error>> {
+    let server = new_realtime_server();
+    server.set_table_coalesce_policy("Table1", 100, 0);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let count = count_updates(&view).await?;
+    update(&table, "x,y\n1,5").await?;
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(count.load(Ordering::SeqCst), 0);
+    poll_after_timeout(&server).await?;
+    assert_eq!(count.load(Ordering::SeqCst), 1);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_coalesced_window_closes_at_max_rows() -> Result<(), Box<dyn Error>> {
+    let server = Server::new(None);
+    server.set_table_coalesce_policy("Table1", 0, 3);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let count = count_updates(&view).await?;
+    update(&table, "x,y\n1,5").await?;
+    update(&table, "x,y\n3,6").await?;
+    assert_eq!(count.load(Ordering::SeqCst), 0);
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(count.load(Ordering::SeqCst), 1);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_coalesced_window_without_latency_limit_closes_when_idle() -> Result<(), Box<dyn Error>>
+{
+    let server = Server::new(None);
+    server.set_table_coalesce_policy("Table1", 0, 1000);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let count = count_updates(&view).await?;
+    update(&table, "x,y\n1,5").await?;
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(count.load(Ordering::SeqCst), 0);
+    poll_after_timeout(&server).await?;
+    assert_eq!(count.load(Ordering::SeqCst), 1);
+    assert_eq!(view.num_rows().await?, 3);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_poll_timeout_is_none_without_deferred_work() -> Result<(), Box<dyn Error>> {
+    let server = Server::new(None);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(server.poll_timeout(), None);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_coalesced_table_is_processed_before_read() -> Result<(), Box<dyn Error>> {
+    let server = Server::new(None);
+    server.set_table_coalesce_policy("Table1", 60_000, 0);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(view.num_rows().await?, 3);
+    assert_eq!(table.size().await?, 3);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_coalesced_table_is_processed_before_read_realtime() -> Result<(), Box<dyn Error>> {
+    let server = new_realtime_server();
+    server.set_table_coalesce_policy("Table1", 60_000, 0);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    update(&table, "x,y\n5,7").await?;
+    assert_eq!(view.num_rows().await?, 3);
+    assert_eq!(table.size().await?, 3);
+    Ok(())
+}
@@ -0,0 +1,180 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+use std::error::Error;
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
+
+use perspective::server::Server;
+use perspective_client::{
+    DeleteOptions, OnUpdateMode, OnUpdateOptions, Table, TableInitOptions, UpdateData,
+    UpdateOptions, View,
+};
+use perspective_server::LocalClient;
+
+async fn new_table(client: &LocalClient) -> Result<Table, Box<dyn Error>> {
+    let table = client
+        .table(
+            UpdateData::Csv("x,y\n1,2\n3,4".to_owned()).into(),
+            TableInitOptions {
+                name: Some("Table1".to_owned()),
+                index: Some("x".to_owned()),
+                limit: None,
+                format: None,
+            },
+        )
+        .await?;
+
+    Ok(table)
+}
+
+/// Register a row-mode `on_update` callback with `options`, returning the
+/// deltas it receives.
+async fn capture_deltas(
+    view: &View,
+    options: OnUpdateOptions,
+) -> Result<Arc<Mutex<Vec<Vec<u8>>>>, Box<dyn Error>> {
+    let deltas = Arc::new(Mutex::new(vec![]));
+    view.on_update(
+        {
+            let deltas = deltas.clone();
+            move |update| {
+                let deltas = deltas.clone();
+                async move {
+                    deltas
+                        .lock()
+                        .unwrap()
+                        .push(update.delta.clone().unwrap_or_default());
+                }
+            }
+        },
+        OnUpdateOptions {
+            mode: Some(OnUpdateMode::Row),
+            ..options
+        },
+    )
+    .await?;
+
+    Ok(deltas)
+}
+
+/// The number of rows in the Arrow `delta`.
+async fn delta_rows(client: &LocalClient, delta: &[u8]) -> Result<usize, Box<dyn Error>> {
+    let table = client
+        .table(
+            UpdateData::Arrow(delta.to_vec().into()).into(),
+            TableInitOptions::default(),
+        )
+        .await?;
+
+    let size = table.size().await?;
+    table.delete(DeleteOptions::default()).await?;
+    Ok(size)
+}
+
+async fn update(table: &Table, csv: &str) -> Result<(), Box<dyn Error>> {
+    table
+        .update(UpdateData::Csv(csv.to_owned()), UpdateOptions::default())
+        .await?;
+
+    Ok(())
+}
+
+/// Wait for the deadline reported by [`Server::poll_timeout`], which must be
+/// no later than `max_ms`, then `poll()`.
+async fn poll_after_timeout(server: &Server, max_ms: u64) -> Result<(), Box<dyn Error>> {
+    let timeout = server.poll_timeout().expect("No held update");
+    assert!(timeout <= Duration::from_millis(max_ms));
+    tokio::time::sleep(timeout).await;
+    server.poll().await?;
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_min_interval_updates_are_sent_without_further_requests() -> Result<(), Box<dyn Error>>
+{
+    let server = Server::new(None);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let deltas = capture_deltas(&view, OnUpdateOptions {
+        min_interval_ms: Some(200),
+        ..OnUpdateOptions::default()
+    })
+    .await?;
+
+    update(&table, "x,y\n1,5").await?;
+    update(&table, "x,y\n5,6").await?;
+    update(&table, "x,y\n7,8").await?;
+    assert_eq!(deltas.lock().unwrap().len(), 1);
+
+    // No further requests: the host polls when the held update is due.
+    poll_after_timeout(&server, 200).await?;
+    let deltas = deltas.lock().unwrap().clone();
+    assert_eq!(deltas.len(), 2);
+    assert_eq!(delta_rows(&client, &deltas[0]).await?, 1);
+    assert_eq!(delta_rows(&client, &deltas[1]).await?, 2);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_merged_deltas_contain_every_update() -> Result<(), Box<dyn Error>> {
+    let server = Server::new(None);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let deltas = capture_deltas(&view, OnUpdateOptions {
+        min_interval_ms: Some(300),
+        ..OnUpdateOptions::default()
+    })
+    .await?;
+
+    update(&table, "x,y\n1,5").await?;
+    for x in 10..20 {
+        update(&table, &format!("x,y\n{},{}", x, x)).await?;
+        table.size().await?;
+    }
+
+    assert_eq!(deltas.lock().unwrap().len(), 1);
+    poll_after_timeout(&server, 300).await?;
+    let deltas = deltas.lock().unwrap().clone();
+    assert_eq!(deltas.len(), 2);
+    assert_eq!(delta_rows(&client, &deltas[1]).await?, 10);
+    assert_eq!(view.num_rows().await?, 12);
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_conflated_updates_are_sent_after_each_ack() -> Result<(), Box<dyn Error>> {
+    let server = Server::new(None);
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = table.view(None).await?;
+    let deltas = capture_deltas(&view, OnUpdateOptions {
+        conflate: Some(true),
+        ..OnUpdateOptions::default()
+    })
+    .await?;
+
+    for x in 10..15 {
+        update(&table, &format!("x,y\n{},{}", x, x)).await?;
+        table.size().await?;
+    }
+
+    let deltas = deltas.lock().unwrap().clone();
+    assert_eq!(deltas.len(), 5);
+    for delta in deltas {
+        assert_eq!(delta_rows(&client, &delta).await?, 1);
+    }
+
+    Ok(())
+}
@@ -0,0 +1,172 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ ██████ ██████ ██████       █      █      █      █      █ █▄  ▀███ █       ┃
+// ┃ ▄▄▄▄▄█ █▄▄▄▄▄ ▄▄▄▄▄█  ▀▀▀▀▀█▀▀▀▀▀ █ ▀▀▀▀▀█ ████████▌▐███ ███▄  ▀█ █ ▀▀▀▀▀ ┃
+// ┃ █▀▀▀▀▀ █▀▀▀▀▀ █▀██▀▀ ▄▄▄▄▄ █ ▄▄▄▄▄█ ▄▄▄▄▄█ ████████▌▐███ █████▄   █ ▄▄▄▄▄ ┃
+// ┃ █      ██████ █  ▀█▄       █ ██████      █      ███▌▐███ ███████▄ █       ┃
+// ┣━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┫
+// ┃ Copyright (c) 2017, the Perspective Authors.                              ┃
+// ┃ ╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌╌ ┃
+// ┃ This file is part of the Perspective library, distributed under the terms ┃
+// ┃ of the [Apache License 2.0](https://www.apache.org/licenses/LICENSE-2.0). ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+
+use std::collections::HashMap;
+use std::error::Error;
+use std::sync::{Arc, Mutex};
+
+use perspective::server::Server;
+use perspective_client::config::{Expressions, ViewConfigUpdate};
+use perspective_client::{
+    OnUpdateMode, OnUpdateOptions, Table, TableInitOptions, UpdateData, UpdateOptions, View,
+    ViewWindow,
+};
+use perspective_server::LocalClient;
+
+/// A [`Server`] which defers building views until they are read.
+fn new_lazy_server() -> Server {
+    let server = Server::new(None);
+    server.set_lazy_views(true);
+    server
+}
+
+async fn new_table(client: &LocalClient) -> Result<Table, Box<dyn Error>> {
+    let table = client
+        .table(
+            UpdateData::Csv("x,y\n1,2\n3,4".to_owned()).into(),
+            TableInitOptions {
+                name: Some("Table1".to_owned()),
+                index: Some("x".to_owned()),
+                limit: None,
+                format: None,
+            },
+        )
+        .await?;
+
+    Ok(table)
+}
+
+async fn new_expression_view(table: &Table) -> Result<View, Box<dyn Error>> {
+    let expressions = HashMap::from([("z".to_owned(), "\"y\" + 1".to_owned())]);
+    let view = table
+        .view(Some(ViewConfigUpdate {
+            expressions: Some(Expressions(expressions)),
+            ..ViewConfigUpdate::default()
+        }))
+        .await?;
+
+    Ok(view)
+}
+
+/// Apply each update in turn, processing it with a table read, which does
+/// not build the table's views.
+async fn apply_updates(table: &Table) -> Result<(), Box<dyn Error>> {
+    for csv in ["x,y\n5,6", "x,y\n1,7", "x,y\n7,8"] {
+        table
+            .update(UpdateData::Csv(csv.to_owned()), UpdateOptions::default())
+            .await?;
+
+        table.size().await?;
+    }
+
+    Ok(())
+}
+
+/// The total and last rows evaluated for the view's only expression.
+async fn rows_evaluated(view: &View) -> Result<(u64, u64), Box<dyn Error>> {
+    let profile = view.profile().await?;
+    let expression = &profile.expressions[0];
+    Ok((expression.rows_evaluated, expression.last_rows_evaluated))
+}
+
+/// Compare `view` with a view built eagerly from the same table.
+async fn assert_matches_eager_view(
+    server: &Server,
+    table: &Table,
+    view: &View,
+) -> Result<(), Box<dyn Error>> {
+    server.set_lazy_views(false);
+    let eager = new_expression_view(table).await?;
+    assert_eq!(
+        view.to_columns_string(ViewWindow::default()).await?,
+        eager.to_columns_string(ViewWindow::default()).await?
+    );
+
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_pending_view_expressions_are_computed_when_read() -> Result<(), Box<dyn Error>> {
+    let server = new_lazy_server();
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = new_expression_view(&table).await?;
+    apply_updates(&table).await?;
+
+    // The expression is computed once, for the 4 rows of the master table,
+    // when the view is first read.
+    assert_eq!(rows_evaluated(&view).await?, (4, 4));
+    assert_matches_eager_view(&server, &table, &view).await?;
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_on_update_without_mode_leaves_view_pending() -> Result<(), Box<dyn Error>> {
+    let server = new_lazy_server();
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = new_expression_view(&table).await?;
+    let count = Arc::new(Mutex::new(0));
+    view.on_update(
+        {
+            let count = count.clone();
+            move |_| {
+                let count = count.clone();
+                async move {
+                    *count.lock().unwrap() += 1;
+                }
+            }
+        },
+        OnUpdateOptions::default(),
+    )
+    .await?;
+
+    apply_updates(&table).await?;
+    assert_eq!(*count.lock().unwrap(), 3);
+    assert_eq!(rows_evaluated(&view).await?, (4, 4));
+    assert_matches_eager_view(&server, &table, &view).await?;
+    Ok(())
+}
+
+#[tokio::test]
+async fn test_on_update_with_row_mode_builds_view() -> Result<(), Box<dyn Error>> {
+    let server = new_lazy_server();
+    let client = LocalClient::new(&server);
+    let table = new_table(&client).await?;
+    let view = new_expression_view(&table).await?;
+    let deltas = Arc::new(Mutex::new(vec![]));
+    view.on_update(
+        {
+            let deltas = deltas.clone();
+            move |update| {
+                let deltas = deltas.clone();
+                async move {
+                    deltas.lock().unwrap().push(update.delta.is_some());
+                }
+            }
+        },
+        OnUpdateOptions {
+            mode: Some(OnUpdateMode::Row),
+            ..OnUpdateOptions::default()
+        },
+    )
+    .await?;
+
+    apply_updates(&table).await?;
+    assert_eq!(*deltas.lock().unwrap(), vec![true, true, true]);
+
+    // Built for the 2 initial rows, then each update evaluates its changed
+    // row of the master table and 4 transitional tables of 1 row.
+    assert_eq!(rows_evaluated(&view).await?, (2 + 3 * 5, 5));
+    assert_matches_eager_view(&server, &table, &view).await?;
+    Ok(())
+}